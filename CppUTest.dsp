@@ -98,6 +98,10 @@ SOURCE=.\src\CppUTestExt\MemoryReporterPlugin.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\CppUTestExt\PerfCounterPlugin.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\CppUTestExt\MemoryReportFormatter.cpp
 # End Source File
 # Begin Source File
@@ -150,6 +154,10 @@ SOURCE=.\SRC\CPPUTEST\JUnitTestOutput.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\SRC\CPPUTEST\TraceEventTestOutput.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\SRC\CPPUTEST\MemoryLeakDetector.cpp
 # End Source File
 # Begin Source File
@@ -194,6 +202,14 @@ SOURCE=.\SRC\CPPUTEST\TestRegistry.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\SRC\CPPUTEST\TestWorkerPool.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\SRC\CPPUTEST\TestBaseline.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\SRC\CPPUTEST\TestResult.cpp
 # End Source File
 # Begin Source File
@@ -230,6 +246,10 @@ SOURCE=.\include\CppUTestExt\MemoryReporterPlugin.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\include\CppUTestExt\PerfCounterPlugin.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\include\CppUTestExt\MemoryReportFormatter.h
 # End Source File
 # Begin Source File
@@ -342,6 +362,14 @@ SOURCE=.\include\CppUTest\TestRegistry.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\include\CppUTest\TestWorkerPool.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\include\CppUTest\TestBaseline.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\include\CppUTest\TestResult.h
 # End Source File
 # Begin Source File
@@ -48,17 +48,28 @@ public:
     int getRepeatCount() const;
     const TestFilter* getGroupFilters() const;
     const TestFilter* getNameFilters() const;
+    const TestFilter* getTestFilters() const;
     bool isJUnitOutput() const;
+    bool isTraceOutput() const;
     bool isEclipseOutput() const;
     bool runTestsInSeperateProcess() const;
+    bool isRunningBenchmarksOnly() const;
+    int getNumberOfWorkers() const;
+    int getNumberOfThreads() const;
+    int getShardIndex() const;
+    int getShardCount() const;
     const SimpleString& getPackageName() const;
+    const SimpleString& getBaselineFileName() const;
+    const SimpleString& getSaveBaselineFileName() const;
+    int getBaselineThreshold() const;
+    const SimpleString& getDurationsFileName() const;
     const char* usage() const;
 
 private:
 
     enum OutputType
     {
-        OUTPUT_ECLIPSE, OUTPUT_JUNIT
+        OUTPUT_ECLIPSE, OUTPUT_JUNIT, OUTPUT_TRACE
     };
     int ac_;
     const char** av_;
@@ -66,23 +77,43 @@ private:
     bool verbose_;
     bool color_;
     bool runTestsAsSeperateProcess_;
+    bool runBenchmarksOnly_;
     bool listTestGroupNames_;
     bool listTestGroupAndCaseNames_;
     int repeat_;
+    int numberOfWorkers_;
+    int numberOfThreads_;
+    int shardIndex_;
+    int shardCount_;
     TestFilter* groupFilters_;
     TestFilter* nameFilters_;
+    TestFilter* testFilters_;
     OutputType outputType_;
     SimpleString packageName_;
+    SimpleString baselineFileName_;
+    SimpleString saveBaselineFileName_;
+    int baselineThreshold_;
+    SimpleString durationsFileName_;
 
     SimpleString getParameterField(int ac, const char** av, int& i, const SimpleString& parameterName);
     void SetRepeatCount(int ac, const char** av, int& index);
+    bool SetNumberOfWorkers(int ac, const char** av, int& index);
+    bool SetNumberOfThreads(int ac, const char** av, int& index);
+    bool SetShardIndex(int ac, const char** av, int& index);
+    bool SetShardCount(int ac, const char** av, int& index);
     void AddGroupFilter(int ac, const char** av, int& index);
     void AddStrictGroupFilter(int ac, const char** av, int& index);
     void AddNameFilter(int ac, const char** av, int& index);
     void AddStrictNameFilter(int ac, const char** av, int& index);
+    void AddTestFilter(const SimpleString& groupAndName);
+    bool AddTestsFromFile(int ac, const char** av, int& index);
     void AddTestToRunBasedOnVerboseOutput(int ac, const char** av, int& index, const char* parameterName);
     bool SetOutputType(int ac, const char** av, int& index);
     void SetPackageName(int ac, const char** av, int& index);
+    bool SetBaselineFileName(int ac, const char** av, int& index);
+    bool SetSaveBaselineFileName(int ac, const char** av, int& index);
+    bool SetBaselineThreshold(int ac, const char** av, int& index);
+    bool SetDurationsFileName(int ac, const char** av, int& index);
 
     CommandLineArguments(const CommandLineArguments&);
     CommandLineArguments& operator=(const CommandLineArguments&);
@@ -51,6 +51,7 @@ public:
 
 protected:
     virtual TestOutput* createJUnitOutput(const SimpleString& packageName);
+    virtual TestOutput* createTraceOutput();
     virtual TestOutput* createConsoleOutput();
     virtual TestOutput* createCompositeOutput(TestOutput* outputOne, TestOutput* outputTwo);
 
@@ -183,6 +183,34 @@
 #define _override
 #endif
 
+/* Storage of which every thread has its own copy, for the state of the test a thread is running.
+ * Only usable for plain data. CPPUTEST_HAVE_THREAD_LOCAL is 0 where all threads share it.
+ * Without the Standard C library there is no runtime for it. A port that defines
+ * CPPUTEST_THREAD_LOCAL itself also defines CPPUTEST_HAVE_THREAD_LOCAL 1 when it is thread local.
+ */
+#ifndef CPPUTEST_THREAD_LOCAL
+  #if !CPPUTEST_USE_STD_C_LIB
+    #define CPPUTEST_THREAD_LOCAL
+    #define CPPUTEST_HAVE_THREAD_LOCAL 0
+  #elif defined(__GNUC__)
+    #define CPPUTEST_THREAD_LOCAL __thread
+    #define CPPUTEST_HAVE_THREAD_LOCAL 1
+  #elif defined(_MSC_VER)
+    #define CPPUTEST_THREAD_LOCAL __declspec(thread)
+    #define CPPUTEST_HAVE_THREAD_LOCAL 1
+  #elif defined(__cplusplus) && __cplusplus >= 201103L
+    #define CPPUTEST_THREAD_LOCAL thread_local
+    #define CPPUTEST_HAVE_THREAD_LOCAL 1
+  #else
+    #define CPPUTEST_THREAD_LOCAL
+    #define CPPUTEST_HAVE_THREAD_LOCAL 0
+  #endif
+#endif
+
+#ifndef CPPUTEST_HAVE_THREAD_LOCAL
+#define CPPUTEST_HAVE_THREAD_LOCAL 0
+#endif
+
 /* MinGW-w64 prefers to act like Visual C++, but we want the ANSI behaviors instead */
 #undef __USE_MINGW_ANSI_STDIO
 #define __USE_MINGW_ANSI_STDIO 1
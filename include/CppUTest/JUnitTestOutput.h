@@ -46,6 +46,8 @@ public:
     virtual void printCurrentTestEnded(const TestResult& res) _override;
     virtual void printCurrentGroupStarted(const UtestShell& test) _override;
     virtual void printCurrentGroupEnded(const TestResult& res) _override;
+    virtual void printBenchmarkResult(const UtestShell& test, const BenchmarkResult& benchmark) _override;
+    virtual void printTestProperty(const UtestShell& test, const SimpleString& name, const SimpleString& value) _override;
 
     virtual void printBuffer(const char*) _override;
     virtual void print(const char*) _override;
@@ -56,6 +58,7 @@ public:
 
     virtual SimpleString createFileName(const SimpleString& group);
     void setPackageName(const SimpleString &package);
+    void setShardIndex(int shardIndex);
 
 protected:
 
@@ -70,6 +73,7 @@ protected:
     virtual void writeXmlHeader();
     virtual void writeTestSuiteSummery();
     virtual void writeProperties();
+    virtual void writeBenchmarkProperty(JUnitTestCaseResultNode* node, const char* name, double value);
     virtual void writeTestCases();
     virtual void writeFailure(JUnitTestCaseResultNode* node);
     virtual void writeFileEnding();
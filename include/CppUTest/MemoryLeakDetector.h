@@ -37,6 +37,7 @@ enum MemLeakPeriod
 };
 
 class TestMemoryAllocator;
+class TestResult;
 class SimpleMutex;
 
 class MemoryLeakFailure
@@ -49,6 +50,47 @@ public:
     virtual void fail(char* fail_string)=0;
 };
 
+/* Receives a leak report piece by piece, so its size is not limited by the report buffer */
+class MemoryLeakReportSink
+{
+public:
+    virtual ~MemoryLeakReportSink()
+    {
+    }
+
+    virtual void write(const char* text)=0;
+    virtual const char* getName()=0;
+};
+
+/* Writes to the output of the test run, through the result of the running test */
+class TestResultMemoryLeakReportSink : public MemoryLeakReportSink
+{
+public:
+    TestResultMemoryLeakReportSink(TestResult& result);
+
+    virtual void write(const char* text);
+    virtual const char* getName();
+private:
+    TestResult& result_;
+};
+
+/* Overwrites the file. The file name is not copied */
+class FileMemoryLeakReportSink : public MemoryLeakReportSink
+{
+public:
+    FileMemoryLeakReportSink(const char* fileName);
+    virtual ~FileMemoryLeakReportSink();
+
+    virtual void write(const char* text);
+    virtual const char* getName();
+private:
+    const char* fileName_;
+    void* file_;
+
+    FileMemoryLeakReportSink(const FileMemoryLeakReportSink&);
+    FileMemoryLeakReportSink& operator=(const FileMemoryLeakReportSink&);
+};
+
 struct SimpleStringBuffer
 {
     enum
@@ -66,13 +108,19 @@ struct SimpleStringBuffer
     void setWriteLimit(size_t write_limit);
     void resetWriteLimit();
     bool reachedItsCapacity();
+
+    /* With a sink, the buffer is written to it and cleared whenever it is half full */
+    void streamTo(MemoryLeakReportSink* sink);
+    void flush();
 private:
     char buffer_[SIMPLE_STRING_BUFFER_LEN];
     size_t positions_filled_;
     size_t write_limit_;
+    MemoryLeakReportSink* sink_;
 };
 
 struct MemoryLeakDetectorNode;
+struct MemoryLeakCallStack;
 
 class MemoryLeakOutputStringBuffer
 {
@@ -85,6 +133,11 @@ public:
     void stopMemoryLeakReporting();
 
     void reportMemoryLeak(MemoryLeakDetectorNode* leak);
+    void reportMemoryLeaksWithCallStack(MemoryLeakDetectorNode* firstLeak, int leaks, size_t leakedBytes);
+    void reportSampledLeakEstimate(unsigned samplingRate);
+
+    void streamReportTo(MemoryLeakReportSink* sink);
+    void setLeakDumpSize(size_t leakDumpSize);
 
     void reportDeallocateNonAllocatedMemoryFailure(const char* freeFile, int freeLine, TestMemoryAllocator* freeAllocator, MemoryLeakFailure* reporter);
     void reportMemoryCorruptionFailure(MemoryLeakDetectorNode* node, const char* freeFile, int freeLineNumber, TestMemoryAllocator* freeAllocator, MemoryLeakFailure* reporter);
@@ -94,9 +147,12 @@ public:
 private:
     void addAllocationLocation(const char* allocationFile, int allocationLineNumber, size_t allocationSize, TestMemoryAllocator* allocator);
     void addDeallocationLocation(const char* freeFile, int freeLineNumber, TestMemoryAllocator* allocator);
+    void addCallStack(MemoryLeakCallStack* callStack);
 
     void addMemoryLeakHeader();
     void addMemoryLeakFooter(int totalAmountOfLeaks);
+    void addLeakDump(MemoryLeakDetectorNode* leak);
+    void addStreamedReportSummary();
     void addWarningForUsingMalloc();
     void addNoMemoryLeaksMessage();
     void addErrorMessageForTooMuchLeaks();
@@ -105,6 +161,8 @@ private:
 
     int total_leaks_;
     bool giveWarningOnUsingMalloc_;
+    MemoryLeakReportSink* sink_;
+    size_t leakDumpSize_;
 
     void reportFailure(const char* message, const char* allocFile,
             int allocLine, size_t allocSize,
@@ -117,7 +175,7 @@ private:
 struct MemoryLeakDetectorNode
 {
     MemoryLeakDetectorNode() :
-        size_(0), number_(0), memory_(0), file_(0), line_(0), allocator_(0), period_(mem_leak_period_enabled), next_(0)
+        size_(0), number_(0), memory_(0), file_(0), line_(0), allocator_(0), period_(mem_leak_period_enabled), callStack_(0), checkingThread_(0), next_(0), previous_(0)
     {
     }
 
@@ -130,10 +188,14 @@ struct MemoryLeakDetectorNode
     int line_;
     TestMemoryAllocator* allocator_;
     MemLeakPeriod period_;
+    MemoryLeakCallStack* callStack_;
+    unsigned long checkingThread_;
 
 private:
     friend struct MemoryLeakDetectorList;
+    friend struct MemoryLeakDetectorNodePool;
     MemoryLeakDetectorNode* next_;
+    MemoryLeakDetectorNode* previous_;
 };
 
 struct MemoryLeakDetectorList
@@ -145,6 +207,7 @@ struct MemoryLeakDetectorList
     void addNewNode(MemoryLeakDetectorNode* node);
     MemoryLeakDetectorNode* retrieveNode(char* memory);
     MemoryLeakDetectorNode* removeNode(char* memory);
+    void unlinkNode(MemoryLeakDetectorNode* node);
 
     MemoryLeakDetectorNode* getFirstLeak(MemLeakPeriod period);
     MemoryLeakDetectorNode* getNextLeak(MemoryLeakDetectorNode* node,
@@ -161,6 +224,56 @@ private:
     MemoryLeakDetectorNode* head_;
 };
 
+/*
+ * Open addressing index (linear probing, power of two capacity) from memory to
+ * its node. It grows with the number of live allocations, so lookups do not
+ * depend on how many allocations are tracked.
+ */
+struct MemoryLeakDetectorIndex
+{
+    MemoryLeakDetectorIndex();
+    ~MemoryLeakDetectorIndex();
+
+    MemoryLeakDetectorNode* find(char* memory);
+    void add(MemoryLeakDetectorNode* node);
+    void remove(char* memory);
+    void clear();
+
+    /* Puts back a node that was shadowed by a newer node for the same memory, after that one was removed */
+    void unshadow(MemoryLeakDetectorNode* node);
+
+    bool isAvailable();
+    bool hasShadowedNodes();
+    size_t getCapacity();
+
+private:
+    size_t slot(char* memory);
+    size_t findSlot(char* memory);
+    void insert(MemoryLeakDetectorNode* node);
+    bool grow();
+    void release();
+
+    enum
+    {
+        initial_capacity = 256
+    };
+
+    MemoryLeakDetectorNode** slots_;
+    size_t capacity_;
+    size_t size_;
+    bool available_;
+    size_t shadowedNodes_;
+
+    MemoryLeakDetectorIndex(const MemoryLeakDetectorIndex&);
+    MemoryLeakDetectorIndex& operator=(const MemoryLeakDetectorIndex&);
+};
+
+/*
+ * The per-bucket lists determine the order in which leaks are reported, the
+ * indexes are used to find a node. Buckets and indexes are split over shards;
+ * a shard is only touched by operations on memory that hashes into it, so
+ * operations on different shards can run concurrently.
+ */
 struct MemoryLeakDetectorTable
 {
     void clearAllAccounting(MemLeakPeriod period);
@@ -175,14 +288,106 @@ struct MemoryLeakDetectorTable
     MemoryLeakDetectorNode* getNextLeak(MemoryLeakDetectorNode* leak,
             MemLeakPeriod period);
 
+    size_t getIndexCapacity();
+
+    int getShard(char* memory);
+
+    enum
+    {
+        number_of_shards = 8
+    };
+
 private:
     unsigned long hash(char* memory);
+    void rebuildIndex(int shard);
 
     enum
     {
         hash_prime = MEMORY_LEAK_HASH_TABLE_SIZE
     };
     MemoryLeakDetectorList table_[hash_prime];
+    MemoryLeakDetectorIndex indexes_[number_of_shards];
+};
+
+/*
+ * Allocation call stacks are interned: all allocations made from the same
+ * place share one copy of their stack. The frames are allocated along with
+ * the stack. Stacks are kept until the table is destroyed, as nodes refer to
+ * them. The leak counters are only used while grouping leaks in a report.
+ */
+struct MemoryLeakCallStack
+{
+    MemoryLeakCallStack* next_;
+    unsigned long hash_;
+    int depth_;
+    int leaks_;
+    size_t leakedBytes_;
+    void* frames_[1];
+};
+
+struct MemoryLeakCallStackTable
+{
+    MemoryLeakCallStackTable();
+    ~MemoryLeakCallStackTable();
+
+    MemoryLeakCallStack* intern(void** frames, int depth);
+    int getNumberOfStacks();
+
+    /* The number of frames of the detector at the top of a captured stack, at most depth - 1.
+     * Each frame is named once, the platform is asked again only when its slot is reused */
+    int countFramesOfTheDetector(void** frames, int depth);
+
+private:
+    unsigned long hash(void** frames, int depth);
+    bool matches(MemoryLeakCallStack* stack, unsigned long hash, void** frames, int depth);
+    bool isDetectorFrame(void* frame);
+
+    enum
+    {
+        number_of_buckets = 1024,
+        number_of_named_frames = 256
+    };
+
+    MemoryLeakCallStack** buckets_;
+    int numberOfStacks_;
+    void* namedFrames_[number_of_named_frames];
+    bool namedFrameIsOfTheDetector_[number_of_named_frames];
+
+    MemoryLeakCallStackTable(const MemoryLeakCallStackTable&);
+    MemoryLeakCallStackTable& operator=(const MemoryLeakCallStackTable&);
+};
+
+struct MemoryLeakDetectorNodeSlab;
+
+/*
+ * Accounting nodes for allocations that keep their node separately (malloc)
+ * are taken from slabs of fixed size chunks instead of from the allocator, so
+ * tracking a malloc does not cost a second malloc. Freed nodes are kept on a
+ * free list for reuse; the slabs are only released when the pool is destroyed.
+ */
+struct MemoryLeakDetectorNodePool
+{
+    MemoryLeakDetectorNodePool();
+    ~MemoryLeakDetectorNodePool();
+
+    MemoryLeakDetectorNode* allocNode();
+    void freeNode(MemoryLeakDetectorNode* node);
+
+    int getNumberOfSlabs();
+
+    enum
+    {
+        nodes_per_slab = 128
+    };
+
+private:
+    bool addSlab();
+
+    MemoryLeakDetectorNodeSlab* slabs_;
+    MemoryLeakDetectorNode* freeNodes_;
+
+    MemoryLeakDetectorNodePool(const MemoryLeakDetectorNodePool&);
+    MemoryLeakDetectorNodePool& operator=(const MemoryLeakDetectorNodePool&);
 };
 
 class MemoryLeakDetector
@@ -197,6 +402,10 @@ public:
     void disableAllocationTypeChecking();
     void enableAllocationTypeChecking();
 
+    /* Only switch before allocating, nodes are returned to where they came from */
+    void disableNodePool();
+    void enableNodePool();
+
     void startChecking();
     void stopChecking();
 
@@ -221,26 +430,92 @@ public:
 
     unsigned getCurrentAllocationNumber();
 
-    SimpleMutex* getMutex(void);
+    /* Lock per shard inside the detector, for use from multiple threads */
+    void enableShardLocking();
+    void disableShardLocking();
+    bool isShardLockingEnabled() const;
+
+    /* Checks only the allocations of the calling thread, for tests that run concurrently on
+     * several threads. Needs shard locking. The report is built in the buffer of the caller */
+    void startCheckingOnThisThread();
+    void stopCheckingOnThisThread();
+    int totalMemoryLeaksOnThisThread();
+    const char* reportOnThisThread(MemoryLeakOutputStringBuffer& buffer);
+    void markLeaksOnThisThreadAsChecked();
+
+    /* Tracks only about 1 in samplingRate allocations, picked by a hash of their address, and just counts
+     * the others. Freeing unknown memory is then taken for freeing an untracked allocation, as long as
+     * there are untracked allocations and an allocation at that address would not have been tracked.
+     * Untracked allocations are counted per test, from the end of the previous checking period or the
+     * last clearAllAccounting, so untracked memory freed in a later test is reported */
+    void sampleAllocations(unsigned samplingRate);
+    unsigned getSamplingRate() const;
+    unsigned long getNumberOfUntrackedAllocations() const;
+    bool wouldTrackAllocationAt(const char* memory) const;
+
+    /* Records up to depth frames of the call stack of each tracked allocation, 0 turns it off.
+     * Leaks with a call stack are reported grouped per stack */
+    void captureCallStacks(int depth);
+    int getCallStackDepth() const;
+    int getNumberOfCallStacks();
+    enum
+    {
+        max_call_stack_depth = 32,
+        max_frames_of_the_detector = 8
+    };
+
+    /* Writes the whole leak report to the sink instead of keeping it in the (4K) report buffer.
+     * report() then only returns a summary. NULL stops streaming */
+    void streamReportTo(MemoryLeakReportSink* sink);
+    /* Dumps at most leakDumpSize bytes of the content of each leak. By default leaks are dumped entirely */
+    void setLeakDumpSize(size_t leakDumpSize);
+
 private:
     MemoryLeakFailure* reporter_;
     MemLeakPeriod current_period_;
     MemoryLeakOutputStringBuffer outputBuffer_;
     MemoryLeakDetectorTable memoryTable_;
+    MemoryLeakDetectorNodePool nodePools_[MemoryLeakDetectorTable::number_of_shards];
     bool doAllocationTypeChecking_;
+    bool useNodePool_;
     unsigned allocationSequenceNumber_;
-    SimpleMutex* mutex_;
+    SimpleMutex* shardMutexes_[MemoryLeakDetectorTable::number_of_shards];
+    SimpleMutex* sharedStateMutex_;
+    bool lockShards_;
+    unsigned samplingRate_;
+    unsigned untrackedSamplingRate_;
+    unsigned long untrackedAllocations_;
+    unsigned long untrackedDeallocations_;
+    unsigned long checkingThreads_;
+    size_t leakDumpSize_;
+    int callStackDepth_;
+    MemoryLeakCallStackTable callStacks_;
+
+    SimpleMutex* getShardMutex(char* memory);
+    bool shouldTrackAllocationAt(char* memory);
+    bool mayBeUntracked(char* memory);
+    void countUntrackedDeallocation();
+    void restartCountingUntrackedMemory();
+    MemoryLeakCallStack* captureCallStack();
+    SimpleMutex* getSharedStateMutex();
+    unsigned nextAllocationNumber();
 
     char* allocateMemoryWithAccountingInformation(TestMemoryAllocator* allocator, size_t size, const char* file, int line, bool allocatNodesSeperately);
     char* reallocateMemoryWithAccountingInformation(TestMemoryAllocator* allocator, char* memory, size_t size, const char* file, int line, bool allocatNodesSeperately);
     MemoryLeakDetectorNode* createMemoryLeakAccountingInformation(TestMemoryAllocator* allocator, size_t size, char* memory, bool allocatNodesSeperately);
+    MemoryLeakDetectorNode* allocateSeparateNode(TestMemoryAllocator* allocator, char* memory);
+    void freeSeparateNode(TestMemoryAllocator* allocator, MemoryLeakDetectorNode* node);
 
 
     bool validMemoryCorruptionInformation(char* memory);
     bool matchingAllocation(TestMemoryAllocator *alloc_allocator, TestMemoryAllocator *free_allocator);
 
     void storeLeakInformation(MemoryLeakDetectorNode * node, char *new_memory, size_t size, TestMemoryAllocator *allocator, const char *file, int line);
-    void ConstructMemoryLeakReport(MemLeakPeriod period);
+    void ConstructMemoryLeakReport(MemLeakPeriod period, MemoryLeakOutputStringBuffer& buffer, unsigned long checkingThread = 0);
+    void reportLeaksGroupedByCallStack(MemLeakPeriod period, MemoryLeakOutputStringBuffer& buffer, unsigned long checkingThread);
+    bool isLeakOfThread(MemoryLeakDetectorNode* leak, unsigned long checkingThread);
+    void lockAllShards();
+    void unlockAllShards();
 
     size_t sizeOfMemoryWithCorruptionInfo(size_t size);
     MemoryLeakDetectorNode* getNodeFromMemoryPointer(char* memory, size_t size);
@@ -249,6 +524,10 @@ private:
 
     void addMemoryCorruptionInformation(char* memory);
     void checkForCorruption(MemoryLeakDetectorNode* node, const char* file, int line, TestMemoryAllocator* allocator, bool allocateNodesSeperately);
+
+    bool mustBeFreedByItsOwnAllocator(MemoryLeakDetectorNode* node, TestMemoryAllocator* allocator);
+    char* reallocateGuardedMemory(TestMemoryAllocator* allocator, char* memory, size_t size, const char* file, int line, bool allocatNodesSeperately);
+    char* reallocateUntrackedMemory(TestMemoryAllocator* allocator, char* memory, size_t size, const char* file, int line, bool allocatNodesSeperately);
 };
 
 #endif
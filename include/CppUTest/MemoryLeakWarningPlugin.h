@@ -29,15 +29,20 @@
 #define D_MemoryLeakWarningPlugin_h
 
 #include "TestPlugin.h"
+#include "TestMemoryAllocator.h"
 #include "MemoryLeakDetectorNewMacros.h"
 
 #define IGNORE_ALL_LEAKS_IN_TEST() MemoryLeakWarningPlugin::getFirstPlugin()->ignoreAllLeaksInTest();
 #define EXPECT_N_LEAKS(n)          MemoryLeakWarningPlugin::getFirstPlugin()->expectLeaksInTest(n);
+#define DETECT_OVERFLOWS_IN_TEST() MemoryLeakWarningPlugin::getFirstPlugin()->guardPagesInTest(GuardPageMemoryAllocator::detect_overflow);
+#define DETECT_UNDERFLOWS_IN_TEST() MemoryLeakWarningPlugin::getFirstPlugin()->guardPagesInTest(GuardPageMemoryAllocator::detect_underflow);
 
 extern void crash_on_allocation_number(unsigned alloc_number);
 
 class MemoryLeakDetector;
 class MemoryLeakFailure;
+class MemoryLeakReportSink;
+class FileMemoryLeakReportSink;
 
 class MemoryLeakWarningPlugin: public TestPlugin
 {
@@ -47,16 +52,44 @@ public:
 
     virtual void preTestAction(UtestShell& test, TestResult& result) _override;
     virtual void postTestAction(UtestShell& test, TestResult& result) _override;
+    virtual bool parseArguments(int ac, const char** av, int index) _override;
+
+    /* The copy checks only the allocations of its own thread and reports leaks in full, without
+     * streaming. Guard pages are not available there */
+    virtual TestPlugin* createThreadCopy() _override;
 
     virtual const char* FinalReport(int toBeDeletedLeaks = 0);
 
     void ignoreAllLeaksInTest();
     void expectLeaksInTest(int n);
 
+    /* Fully tracks only about 1 in samplingRate allocations (-pleaksampling=N). Leaks are then
+     * estimated, a test fails when more leaks were found than expected */
+    void sampleAllocations(unsigned samplingRate);
+
+    /* Records the allocation call stack, depth frames deep, of each tracked allocation (-pleakstacks=N).
+     * Leaks are then reported grouped per call stack */
+    void captureCallStacks(int depth);
+
+    /* Streams complete leak reports to the sink, the test failure then only summarizes them
+     * (-pleakstream=file). NULL stops streaming */
+    void streamLeakReportsTo(MemoryLeakReportSink* sink);
+    /* Streams leak reports to the test output (-pleakstream) */
+    void streamLeakReportsToTestOutput();
+    /* Dumps at most leakDumpSize bytes of each leak (-pleakdump=N) */
+    void setLeakDumpSize(size_t leakDumpSize);
+
+    /* new, new [] and malloc use guard page allocators until the end of the test. Called from
+     * the setup of a group, it applies to the whole group */
+    void guardPagesInTest(GuardPageMemoryAllocator::Mode mode);
+    /* Guard pages in every test (-pguardpages=overflow or -pguardpages=underflow) */
+    void guardPagesInAllTests(GuardPageMemoryAllocator::Mode mode);
+
     void destroyGlobalDetectorAndTurnOffMemoryLeakDetectionInDestructor(bool des);
 
     MemoryLeakDetector* getMemoryLeakDetector();
 
+    /* On a thread of TestThreadPool, the copy for that thread */
     static MemoryLeakWarningPlugin* getFirstPlugin();
 
     static MemoryLeakDetector* getGlobalDetector();
@@ -66,14 +99,35 @@ public:
 
     static void turnOffNewDeleteOverloads();
     static void turnOnNewDeleteOverloads();
+    /* Turns on the shard locking of the global detector, which stays on until it is disabled on the detector */
     static void turnOnThreadSafeNewDeleteOverloads();
     static bool areNewDeleteOverloaded();
 private:
+    MemoryLeakWarningPlugin(MemoryLeakWarningPlugin* original);
+
     MemoryLeakDetector* memLeakDetector_;
+    bool checkingOnThisThread_;
     bool ignoreAllWarnings_;
     bool destroyGlobalDetectorAndTurnOfMemoryLeakDetectionInDestructor_;
     int expectedLeaks_;
     int failureCount_;
+    bool samplingAllocations_;
+    bool capturingCallStacks_;
+    bool limitingLeakDumps_;
+    bool streamLeakReportsToTestOutput_;
+    MemoryLeakReportSink* leakReportSink_;
+    FileMemoryLeakReportSink* leakReportFile_;
+    bool guardPagesInAllTests_;
+    GuardPageMemoryAllocator::Mode allTestsGuardPageMode_;
+    bool guardingPages_;
+    TestMemoryAllocator* unguardedNewAllocator_;
+    TestMemoryAllocator* unguardedNewArrayAllocator_;
+    TestMemoryAllocator* unguardedMallocAllocator_;
+
+    void restoreUnguardedAllocators();
+    void postTestActionOnThisThread(UtestShell& test, TestResult& result);
+
+    bool leaksAsExpected(int leaks, int expectedLeaks);
 
     static MemoryLeakWarningPlugin* firstPlugin_;
 };
@@ -36,6 +36,29 @@ extern void (*PlatformSpecificRunTestInASeperateProcess)(UtestShell* shell, Test
 extern int (*PlatformSpecificFork)(void);
 extern int (*PlatformSpecificWaitPid)(int pid, int* status, int options);
 
+/* Resources used by a test that ran in a separate process (-p) */
+struct PlatformSpecificResourceUsage
+{
+    double userTimeInNanos;
+    double systemTimeInNanos;
+    long maximumResidentSetSizeInKilobytes;
+    long minorPageFaults;
+    long majorPageFaults;
+    long voluntaryContextSwitches;
+    long involuntaryContextSwitches;
+};
+extern int (*PlatformSpecificWaitPidWithResourceUsage)(int pid, int* status, int options, PlatformSpecificResourceUsage* usage);
+extern int (*PlatformSpecificGetResourceUsage)(PlatformSpecificResourceUsage* usage);
+
+/* Communication with worker processes (-j) */
+extern int (*PlatformSpecificPipe)(int* readDescriptor, int* writeDescriptor);
+extern int (*PlatformSpecificRead)(int descriptor, char* buffer, int size);
+extern int (*PlatformSpecificWrite)(int descriptor, const char* buffer, int size);
+extern void (*PlatformSpecificClose)(int descriptor);
+extern int (*PlatformSpecificWaitForReadable)(const int* descriptors, int count);
+extern int (*PlatformSpecificTerminationSignal)(int status);
+extern void (*PlatformSpecificExit)(int status);
+
 /* Platform specific interface we use in order to minimize dependencies with LibC.
  * This enables porting to different embedded platforms.
  *
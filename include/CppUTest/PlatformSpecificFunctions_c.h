@@ -48,6 +48,8 @@ extern void (*PlatformSpecificRestoreJumpBuffer)(void);
 
 /* Time operations */
 extern long (*GetPlatformSpecificTimeInMillis)(void);
+/* Monotonic clock for measuring durations, in nanoseconds since an arbitrary point */
+extern double (*GetPlatformSpecificMonotonicTimeInNanos)(void);
 extern const char* (*GetPlatformSpecificTimeString)(void);
 
 /* String operations */
@@ -64,7 +66,9 @@ typedef void* PlatformSpecificFile;
 
 extern PlatformSpecificFile (*PlatformSpecificFOpen)(const char* filename, const char* flag);
 extern void (*PlatformSpecificFPuts)(const char* str, PlatformSpecificFile file);
+extern char* (*PlatformSpecificFGets)(char* str, int size, PlatformSpecificFile file);
 extern void (*PlatformSpecificFClose)(PlatformSpecificFile file);
+extern PlatformSpecificFile (*PlatformSpecificStdIn)(void);
 
 extern int (*PlatformSpecificPutchar)(int c);
 extern void (*PlatformSpecificFlush)(void);
@@ -82,6 +86,43 @@ extern void (*PlatformSpecificMutexLock)(PlatformSpecificMutex mtx);
 extern void (*PlatformSpecificMutexUnlock)(PlatformSpecificMutex mtx);
 extern void (*PlatformSpecificMutexDestroy)(PlatformSpecificMutex mtx);
 
+/* Threads. PlatformSpecificThreadCreate returns NULL when the platform has none */
+typedef void* PlatformSpecificThread;
+extern PlatformSpecificThread (*PlatformSpecificThreadCreate)(void (*function)(void*), void* data);
+extern void (*PlatformSpecificThreadJoin)(PlatformSpecificThread thread);
+
+/* Condition variables. Wait releases the locked mutex while waiting and locks it again before returning */
+typedef void* PlatformSpecificCondition;
+extern PlatformSpecificCondition (*PlatformSpecificConditionCreate)(void);
+extern void (*PlatformSpecificConditionWait)(PlatformSpecificCondition condition, PlatformSpecificMutex mtx);
+extern void (*PlatformSpecificConditionSignal)(PlatformSpecificCondition condition);
+extern void (*PlatformSpecificConditionBroadcast)(PlatformSpecificCondition condition);
+extern void (*PlatformSpecificConditionDestroy)(PlatformSpecificCondition condition);
+
+/* Atomic operations. Add returns the new value, CompareExchange the value before the exchange */
+extern long (*PlatformSpecificAtomicLoad)(volatile long* value);
+extern long (*PlatformSpecificAtomicAdd)(volatile long* value, long delta);
+extern long (*PlatformSpecificAtomicCompareExchange)(volatile long* value, long expected, long desired);
+
+/* Thread-local storage. Each thread sees NULL until it sets a value for the key */
+typedef void* PlatformSpecificThreadLocal;
+extern PlatformSpecificThreadLocal (*PlatformSpecificThreadLocalCreate)(void);
+extern void* (*PlatformSpecificThreadLocalGet)(PlatformSpecificThreadLocal key);
+extern void (*PlatformSpecificThreadLocalSet)(PlatformSpecificThreadLocal key, void* value);
+extern void (*PlatformSpecificThreadLocalDestroy)(PlatformSpecificThreadLocal key);
+
+/* Call stacks. Backtrace stores up to maxFrames return addresses, starting with its caller, and returns how many;
+ * 0 when the platform cannot walk the stack. BacktraceSymbol describes a frame, or leaves symbol empty */
+extern int (*PlatformSpecificBacktrace)(void** frames, int maxFrames);
+extern void (*PlatformSpecificBacktraceSymbol)(void* frame, char* symbol, size_t size);
+
+/* Pages of memory, for guard pages. PageSize returns 0 when the platform cannot protect memory.
+ * PageProtect makes pages accessible or not, it returns 0 on success */
+extern size_t (*PlatformSpecificPageSize)(void);
+extern void* (*PlatformSpecificPageAlloc)(size_t size);
+extern void (*PlatformSpecificPageFree)(void* memory, size_t size);
+extern int (*PlatformSpecificPageProtect)(void* memory, size_t size, int accessible);
+
 #ifdef __cplusplus
 }
 #endif
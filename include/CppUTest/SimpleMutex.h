@@ -42,6 +42,7 @@ private:
 };
 
 
+/* Does not lock a NULL mutex, as passed by the memory leak detector while its locking is off */
 class ScopedMutexLock
 {
 public:
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2007, Michael Feathers, James Grenning and Bas Vodde
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE EARLIER MENTIONED AUTHORS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// TestBaseline keeps the execution time of each test (the median time per
+// iteration for benchmarks) to compare a later run against. A test fails when
+// it is slower than its baseline by more than the threshold percentage and by
+// more than the measurement noise: three standard deviations for benchmarks,
+// a millisecond for a single timing.
+//
+// TestDurations keeps the measured execution time of each test between runs
+// so that parallel runs can dispatch the longest tests first and sharded runs
+// can pack shards to about the same total time.
+//
+
+#ifndef D_TestBaseline_h
+#define D_TestBaseline_h
+
+#include "SimpleString.h"
+
+class UtestShell;
+struct TestBaselineEntries;
+struct TestDurationsEntry;
+
+class TestBaseline
+{
+public:
+    TestBaseline();
+    virtual ~TestBaseline();
+
+    void setThreshold(int percentage);
+    int getThreshold() const;
+
+    virtual bool load(const SimpleString& fileName);
+    virtual bool save(const SimpleString& fileName) const;
+
+    virtual void record(const UtestShell& test, double nanos, double standardDeviation, int numberOfSamples);
+    virtual SimpleString checkForRegression(const UtestShell& test, double nanos) const;
+
+    int getNumberOfLoadedTests() const;
+    int getNumberOfRecordedTests() const;
+
+private:
+    TestBaselineEntries* loaded_;
+    TestBaselineEntries* recorded_;
+    int threshold_;
+
+    TestBaseline(const TestBaseline&);
+    TestBaseline& operator=(const TestBaseline&);
+};
+
+class TestDurations
+{
+public:
+    TestDurations();
+    virtual ~TestDurations();
+
+    /* Later lines win, so the files of several shards can simply be concatenated */
+    virtual bool load(const SimpleString& fileName);
+    virtual bool save(const SimpleString& fileName) const;
+
+    virtual void record(const UtestShell& test, double nanos);
+
+    /* The recorded time, or the average of all recorded times for a test that was never measured */
+    double getExpectedNanos(const UtestShell& test) const;
+    int getNumberOfTests() const;
+
+    /* Assigns the tests longest first to the shard with the least expected time so far */
+    void packIntoShards(UtestShell** tests, int numberOfTests, int shardCount);
+    int getShard(const UtestShell& test) const;
+
+    /* Stable sort of the indices 0..count-1 on descending nanos */
+    static void sortLongestFirst(int* order, const double* nanos, int count);
+
+private:
+    TestDurationsEntry** buckets_;
+    TestDurationsEntry* first_;
+    TestDurationsEntry* last_;
+    int numberOfMeasuredTests_;
+    double totalNanos_;
+
+    TestDurationsEntry* findEntry(const SimpleString& group, const SimpleString& name) const;
+    TestDurationsEntry* findOrAddEntry(const SimpleString& group, const SimpleString& name);
+    void setNanos(TestDurationsEntry* entry, double nanos);
+
+    TestDurations(const TestDurations&);
+    TestDurations& operator=(const TestDurations&);
+};
+
+#endif
@@ -30,6 +30,8 @@
 
 #include "SimpleString.h"
 
+struct TestFilterMatcherNode;
+
 class TestFilter
 {
 public:
@@ -50,11 +52,54 @@ public:
 
     SimpleString asString() const;
 private:
+    friend class TestFilterMatcher;
+
     SimpleString filter_;
     bool strictMatching_;
     TestFilter* next_;
 };
 
+/*
+ * TestFilterMatcher matches a name against a whole chain of filters at once:
+ * strict filters are looked up in a hash set and the others are searched for
+ * together by an Aho-Corasick automaton, so the cost of a match depends on the
+ * length of the name and not on the number of filters.
+ */
+class TestFilterMatcher
+{
+public:
+    TestFilterMatcher();
+    ~TestFilterMatcher();
+
+    void compile(const TestFilter* filters);
+    void clear();
+
+    /* Like matching each filter of the chain; an empty chain matches everything */
+    bool match(const char* name) const;
+    /* Matches "group.name" */
+    bool match(const char* group, const char* name) const;
+
+private:
+    bool matchesEverything_;
+
+    SimpleString* strictNames_;
+    int* strictSlots_;
+    size_t numberOfStrictSlots_;
+
+    TestFilterMatcherNode* nodes_;
+    int numberOfNodes_;
+
+    void addStrictName(const SimpleString& name, int index);
+    bool isStrictName(const char* group, const char* name) const;
+    void addPattern(const SimpleString& pattern);
+    void linkFailureTransitions();
+    int childOf(int node, char character) const;
+    bool containsPattern(const char* group, const char* name) const;
+
+    TestFilterMatcher(const TestFilterMatcher&);
+    TestFilterMatcher& operator=(const TestFilterMatcher&);
+};
+
 SimpleString StringFrom(const TestFilter& filter);
 
 #endif
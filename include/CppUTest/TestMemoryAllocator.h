@@ -62,6 +62,10 @@ public:
 
     virtual bool isOfEqualType(TestMemoryAllocator* allocator);
 
+    /* Whether running out of the bounds of memory faults by itself. The memory leak detector
+     * then does not add its own corruption check or accounting around the memory */
+    virtual bool guardsMemoryBounds();
+
     virtual char* allocMemoryLeakNode(size_t size);
     virtual void freeMemoryLeakNode(char* memory);
 
@@ -86,6 +90,42 @@ public:
 };
 
 
+/*
+ * Places each allocation right against a page that cannot be accessed, so writing or reading
+ * past its end (detect_overflow) or before its start (detect_underflow) faults at the offending
+ * instruction. Freed memory is unmapped, so using it faults as well. Every allocation takes at
+ * least two pages. Overflows are only detected beyond the padding to the alignment, which can be
+ * set down to 1. Platforms without page protection get ordinary memory.
+ */
+class GuardPageMemoryAllocator : public TestMemoryAllocator
+{
+public:
+    enum Mode
+    {
+        detect_overflow,
+        detect_underflow
+    };
+
+    GuardPageMemoryAllocator(Mode mode, const char* name_str = "generic", const char* alloc_name_str = "alloc", const char* free_name_str = "free");
+
+    virtual char* alloc_memory(size_t size, const char* file, int line) _override;
+    virtual void free_memory(char* memory, const char* file, int line) _override;
+    virtual bool guardsMemoryBounds() _override;
+
+    Mode getMode();
+    void setAlignment(size_t alignment);
+
+private:
+    char* allocPages(size_t length);
+    void protectGuardPage(char* guardPage, char* pages, size_t length);
+    char* allocWithGuardPageAfter(size_t size);
+    char* allocWithGuardPageBefore(size_t size);
+
+    Mode mode_;
+    size_t alignment_;
+    size_t pageSize_;
+};
+
 class NullUnknownAllocator: public TestMemoryAllocator
 {
 public:
@@ -40,6 +40,7 @@
 class UtestShell;
 class TestFailure;
 class TestResult;
+class BenchmarkResult;
 
 class TestOutput
 {
@@ -53,6 +54,13 @@ public:
     virtual void printCurrentTestEnded(const TestResult& res);
     virtual void printCurrentGroupStarted(const UtestShell& test);
     virtual void printCurrentGroupEnded(const TestResult& res);
+    virtual void printBenchmarkResult(const UtestShell& test, const BenchmarkResult& benchmark);
+    virtual void printTestProperty(const UtestShell& test, const SimpleString& name, const SimpleString& value);
+
+    /* Parts of running a test (setup, testBody, plugin actions...), only reported to outputs that trace them */
+    virtual bool isTracingTestPhases() const;
+    virtual void printTestPhaseStarted(const UtestShell& test, const char* phase, double timeInNanos, int track);
+    virtual void printTestPhaseEnded(const UtestShell& test, const char* phase, double timeInNanos, int track);
 
     virtual void verbose();
     virtual void color();
@@ -181,6 +189,11 @@ public:
     virtual void printCurrentTestEnded(const TestResult& res);
     virtual void printCurrentGroupStarted(const UtestShell& test);
     virtual void printCurrentGroupEnded(const TestResult& res);
+    virtual void printBenchmarkResult(const UtestShell& test, const BenchmarkResult& benchmark);
+    virtual void printTestProperty(const UtestShell& test, const SimpleString& name, const SimpleString& value);
+    virtual bool isTracingTestPhases() const;
+    virtual void printTestPhaseStarted(const UtestShell& test, const char* phase, double timeInNanos, int track);
+    virtual void printTestPhaseEnded(const UtestShell& test, const char* phase, double timeInNanos, int track);
 
     virtual void verbose();
     virtual void color();
@@ -202,4 +215,45 @@ private:
     TestOutput* outputTwo_;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+//
+//  TestPhaseLog
+//
+//  Keeps the phases of one test without allocating memory, as they are
+//  reported while the test runs (and while it checks for leaks or replaces
+//  the allocators). Phases beyond the capacity are dropped.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+class TestPhaseLog
+{
+public:
+    enum { capacity = 128, maximumPhaseLength = 48 };
+
+    TestPhaseLog();
+
+    void add(const UtestShell& test, const char* phase, double timeInNanos, int track, bool started);
+    void clear();
+
+    int size() const;
+    const UtestShell& getTest(int index) const;
+    const char* getPhase(int index) const;
+    double getTimeInNanos(int index) const;
+    int getTrack(int index) const;
+    bool isStarted(int index) const;
+
+private:
+    struct Entry
+    {
+        const UtestShell* test_;
+        char phase_[maximumPhaseLength];
+        double timeInNanos_;
+        int track_;
+        bool started_;
+    };
+
+    Entry entries_[capacity];
+    int size_;
+};
+
 #endif
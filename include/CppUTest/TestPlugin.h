@@ -51,6 +51,13 @@ public:
         return false;
     }
 
+    /* A plugin that can run around tests on another thread returns a new copy of itself, which is
+     * created, used and deleted on that thread. Returning 0, the default, leaves the plugin out there */
+    virtual TestPlugin* createThreadCopy()
+    {
+        return 0;
+    }
+
     virtual void runAllPreTestAction(UtestShell&, TestResult&);
     virtual void runAllPostTestAction(UtestShell&, TestResult&);
     virtual bool parseAllArguments(int ac, const char** av, int index);
@@ -92,6 +99,7 @@ public:
     SetPointerPlugin(const SimpleString& name);
     virtual ~SetPointerPlugin();
     virtual void postTestAction(UtestShell&, TestResult&) _override;
+    virtual TestPlugin* createThreadCopy() _override;
 
     enum
     {
@@ -39,6 +39,7 @@
 class UtestShell;
 class TestResult;
 class TestPlugin;
+class TestDurations;
 
 class TestRegistry
 {
@@ -54,6 +55,8 @@ public:
     virtual void listTestGroupAndCaseNames(TestResult& result);
     virtual void setNameFilters(const TestFilter* filters);
     virtual void setGroupFilters(const TestFilter* filters);
+    /* Filters on "group.name" */
+    virtual void setTestFilters(const TestFilter* filters);
 
     virtual void installPlugin(TestPlugin* plugin);
     virtual void resetPlugins();
@@ -65,6 +68,7 @@ public:
     virtual UtestShell* getFirstTest();
     virtual UtestShell* getTestWithNext(UtestShell* test);
 
+    /* Looked up through an index, rebuilt when tests were linked or renamed since it was built */
     virtual UtestShell* findTestWithName(const SimpleString& name);
     virtual UtestShell* findTestWithGroup(const SimpleString& name);
 
@@ -72,19 +76,59 @@ public:
     virtual void setCurrentRegistry(TestRegistry* registry);
 
     virtual void setRunTestsInSeperateProcess();
+    virtual void setRunTestsInParallel(int numberOfWorkers);
+    /* Runs the tests in reused worker processes (-p), or one process per test where workers cannot be started */
+    virtual void setRunTestsInPreforkedProcesses();
+    /* Runs the tests of thread-safe groups on a number of threads before the other tests, which stay serialized.
+     * Around the threaded tests only the plugins that implement createThreadCopy run, one copy per thread, also
+     * when no thread could be created: SetPointerPlugin (UT_PTR_SET) and MemoryLeakWarningPlugin. Those leak checks
+     * run concurrently, report in full without streaming and fail on guard pages. Any other plugin, mocks
+     * included, only runs around the serialized tests */
+    virtual void setRunTestsInThreads(int numberOfThreads);
+    virtual void setShard(int shardIndex, int shardCount);
+    virtual void setRunBenchmarksOnly();
+    virtual void setDurations(TestDurations* durations);
     int getCurrentRepetition();
 
 private:
 
+    void runAllTestsInWorkers(TestResult& result);
+    void runAllTestsInThreads(TestResult& result);
+
     bool testShouldRun(UtestShell* test, TestResult& result);
+    bool testIsSelected(UtestShell* test);
+    bool testMatchesFilters(UtestShell* test);
+    bool testIsInShard(UtestShell* test);
+    void packShards();
+    void compileFilters();
+    void clearCompiledFilters();
+    void buildIndex();
+    void dropIndex();
+    UtestShell* findTest(const SimpleString& key, bool byName);
     bool endOfGroup(UtestShell* test);
 
     UtestShell * tests_;
     const TestFilter* nameFilters_;
     const TestFilter* groupFilters_;
+    const TestFilter* testFilters_;
     TestPlugin* firstPlugin_;
     static TestRegistry* currentRegistry_;
     bool runInSeperateProcess_;
+    int numberOfWorkers_;
+    bool runInPreforkedProcesses_;
+    int numberOfThreads_;
+    int shardIndex_;
+    int shardCount_;
+    bool runBenchmarksOnly_;
+    TestDurations* durations_;
+    UtestShell** testsByName_;
+    UtestShell** testsByGroup_;
+    size_t indexSize_;
+    long indexedRelinksAndRenames_;
+    TestFilterMatcher groupMatcher_;
+    TestFilterMatcher nameMatcher_;
+    TestFilterMatcher testMatcher_;
+    bool filtersCompiled_;
     int currentRepetition_;
 
 };
@@ -37,6 +37,10 @@
 class TestFailure;
 class TestOutput;
 class UtestShell;
+class BenchmarkResult;
+class TestBaseline;
+class TestDurations;
+struct PlatformSpecificResourceUsage;
 
 class TestResult
 {
@@ -52,14 +56,36 @@ public:
     virtual void currentTestStarted(UtestShell* test);
     virtual void currentTestEnded(UtestShell* test);
 
+    /* Used when the test or group ran elsewhere (e.g. in a -j worker) and its time was measured there */
+    virtual void currentGroupEndedWithTime(UtestShell* test, double executionTimeInNanos);
+    virtual void currentTestEndedWithTime(UtestShell* test, double executionTimeInNanos);
+
     virtual void countTest();
     virtual void countRun();
     virtual void countCheck();
     virtual void countFilteredOut();
     virtual void countIgnored();
     virtual void addFailure(const TestFailure& failure);
+    virtual void addBenchmarkResult(const UtestShell& test, const BenchmarkResult& benchmark);
+    /* Measurements of the current test that plugins report, e.g. performance counters */
+    virtual void addTestProperty(const UtestShell& test, const SimpleString& name, const SimpleString& value);
+    /* Reports the resources used by a test that ran in a separate process as test properties, a negative peak memory is left out */
+    virtual void addResourceUsage(const UtestShell& test, const PlatformSpecificResourceUsage& usage);
+
+    /* Timeline of the parts of a test, only measured when the output traces them */
+    bool isTracingTestPhases() const;
+    virtual void testPhaseStarted(const UtestShell& test, const char* phase);
+    virtual void testPhaseEnded(const UtestShell& test, const char* phase);
+    virtual void testPhaseStartedWithTime(const UtestShell& test, const char* phase, double timeInNanos, int track);
+    virtual void testPhaseEndedWithTime(const UtestShell& test, const char* phase, double timeInNanos, int track);
     virtual void print(const char* text);
 
+    /* Fails tests that got slower than in baseline and records their times in it */
+    void setBaseline(TestBaseline* baseline);
+
+    /* Records the execution time of every test that ran in durations */
+    void setDurations(TestDurations* durations);
+
     int getTestCount() const
     {
         return testCount_;
@@ -90,6 +116,11 @@ public:
 
     long getCurrentTestTotalExecutionTime() const;
     long getCurrentGroupTotalExecutionTime() const;
+
+    /* Durations as measured with the monotonic clock; the getters above round these down to milliseconds */
+    double getTotalExecutionTimeInNanos() const;
+    double getCurrentTestTotalExecutionTimeInNanos() const;
+    double getCurrentGroupTotalExecutionTimeInNanos() const;
 private:
 
     TestOutput& output_;
@@ -99,12 +130,21 @@ private:
     int failureCount_;
     int filteredOutCount_;
     int ignoredCount_;
-    long totalExecutionTime_;
-    long timeStarted_;
-    long currentTestTimeStarted_;
-    long currentTestTotalExecutionTime_;
-    long currentGroupTimeStarted_;
-    long currentGroupTotalExecutionTime_;
+    double totalExecutionTime_;
+    double timeStarted_;
+    double currentTestTimeStarted_;
+    double currentTestTotalExecutionTime_;
+    double currentGroupTimeStarted_;
+    double currentGroupTotalExecutionTime_;
+    TestBaseline* baseline_;
+    TestDurations* durations_;
+    bool currentTestBenchmarked_;
+    double currentBenchmarkMedian_;
+    double currentBenchmarkStandardDeviation_;
+    int currentBenchmarkNumberOfSamples_;
+
+    void checkAgainstBaseline(UtestShell* test);
+    void recordDuration(UtestShell* test);
 };
 
 #endif
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2007, Michael Feathers, James Grenning and Bas Vodde
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE EARLIER MENTIONED AUTHORS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// TestWorkerPool runs tests in a number of forked worker processes (-j)
+// and hands their results back in the order the tests were scheduled.
+// Tests are dispatched longest expected time first, so a slow test
+// scheduled last does not leave the other workers idle at the end.
+//
+// TestThreadPool runs the tests of thread-safe groups on a number of
+// threads in this process (-t) and hands their results back the same way.
+// Each thread starts on its own share of the tests and steals from the
+// others once it runs out. Only the plugins with a thread copy run around
+// those tests, see TestPlugin::createThreadCopy.
+//
+
+#ifndef D_TestWorkerPool_h
+#define D_TestWorkerPool_h
+
+#include "SimpleString.h"
+
+class UtestShell;
+class TestResult;
+class TestPlugin;
+struct TestWorker;
+struct TestThread;
+struct TestThreadQueue;
+
+class TestWorkerPool
+{
+public:
+    TestWorkerPool(int numberOfWorkers, TestPlugin* plugin);
+    virtual ~TestWorkerPool();
+
+    /* False on platforms without pipes and fork, where no worker can be started */
+    static bool canStartWorkers();
+
+    /* Replaces a worker by a fresh one forked from the parent after a failing test (-p) */
+    virtual void restartWorkersAfterFailure();
+
+    /* Reports the resources each test used in its worker as test properties */
+    virtual void measureResourceUsage();
+
+    /* Replays the phases of each test on a trace track per worker (1..n) */
+    virtual void traceTestPhases();
+
+    virtual void scheduleTest(UtestShell* test, double expectedNanos = 0.0);
+    virtual int getNumberOfScheduledTests() const;
+
+    /* Replays the result of the next scheduled test into result and returns its execution time in nanoseconds */
+    virtual double replayNextTest(TestResult& result);
+
+private:
+
+    void startWorkers();
+    bool startWorker(TestWorker& worker);
+    void stopWorker(TestWorker& worker);
+    void runWorker(TestWorker& worker);
+    void dispatchNextTest(TestWorker& worker);
+    void collectResults();
+    void receiveFrom(TestWorker& worker);
+    void workerDied(TestWorker& worker);
+    void storeResult(int testIndex, const SimpleString& message);
+    bool resultHasFailures(int testIndex) const;
+
+    int numberOfWorkers_;
+    TestPlugin* plugin_;
+    bool restartAfterFailure_;
+    bool measureResourceUsage_;
+    bool traceTestPhases_;
+
+    UtestShell** tests_;
+    double* expectedNanos_;
+    int* dispatchOrder_;
+    SimpleString* results_;
+    bool* hasResult_;
+    int numberOfTests_;
+    int capacity_;
+    int nextTestToDispatch_;
+    int nextTestToReplay_;
+
+    TestWorker* workers_;
+    bool workersStarted_;
+
+    TestWorkerPool(const TestWorkerPool&);
+    TestWorkerPool& operator=(const TestWorkerPool&);
+};
+
+class TestThreadPool
+{
+public:
+    TestThreadPool(int numberOfThreads, TestPlugin* plugin);
+    virtual ~TestThreadPool();
+
+    /* Replays the phases of each test on a trace track per thread (1..n) */
+    virtual void traceTestPhases();
+
+    virtual void scheduleTest(UtestShell* test, double expectedNanos = 0.0);
+    virtual int getNumberOfScheduledTests() const;
+
+    /* Runs all scheduled tests and returns when they are done. Runs them on the calling thread when the platform has no threads */
+    virtual void runTests();
+
+    /* Replays the result of the next scheduled test into result and returns its execution time in nanoseconds */
+    virtual double replayNextTest(TestResult& result);
+
+private:
+
+    static void runThread(void* thread);
+    void runTestsOn(int threadIndex, TestPlugin* plugin);
+    int takeTest(int threadIndex);
+
+    int numberOfThreads_;
+    TestPlugin* plugin_;
+    bool traceTestPhases_;
+
+    UtestShell** tests_;
+    double* expectedNanos_;
+    SimpleString* results_;
+    int numberOfTests_;
+    int capacity_;
+    int nextTestToReplay_;
+
+    TestThreadQueue* queues_;
+    TestThread* threads_;
+
+    TestThreadPool(const TestThreadPool&);
+    TestThreadPool& operator=(const TestThreadPool&);
+};
+
+#endif
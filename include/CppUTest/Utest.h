@@ -37,6 +37,7 @@ class TestResult;
 class TestPlugin;
 class TestFailure;
 class TestFilter;
+class TestFilterMatcher;
 class TestTerminator;
 
 extern bool doubles_equal(double d1, double d2, double threshold);
@@ -55,6 +56,15 @@ public:
     virtual void setup();
     virtual void teardown();
     virtual void testBody();
+
+    /* TEST_GROUPs are not marked thread-safe, see THREAD_SAFE_TEST_GROUP */
+    static bool isThreadSafeGroup();
+};
+
+class ThreadSafeUtest : public Utest
+{
+public:
+    static bool isThreadSafeGroup();
 };
 
 //////////////////// TestTerminator
@@ -86,6 +96,8 @@ class UtestShell
 {
 public:
     static UtestShell *getCurrent();
+    /* Runs setup, testBody or teardown of the current test and reports it as a phase on the trace */
+    static int runTestPhase(void (*function) (void*), void* data, const char* phase);
 
 public:
     UtestShell(const char* groupName, const char* testName, const char* fileName, int lineNumber);
@@ -94,15 +106,23 @@ public:
     virtual UtestShell* addTest(UtestShell* test);
     virtual UtestShell *getNext() const;
     virtual int countTests();
+    /* Counts every link and name change of any test, so the registry can tell when its index is stale */
+    static long getNumberOfRelinksAndRenames();
 
     bool shouldRun(const TestFilter* groupFilters, const TestFilter* nameFilters) const;
+    bool shouldRun(const TestFilterMatcher& groupMatcher, const TestFilterMatcher& nameMatcher, const TestFilterMatcher& testMatcher) const;
     const SimpleString getName() const;
     const SimpleString getGroup() const;
+    bool hasName(const SimpleString& name) const;
+    bool hasGroup(const SimpleString& group) const;
     virtual SimpleString getFormattedName() const;
     const SimpleString getFile() const;
     int getLineNumber() const;
     virtual bool willRun() const;
     virtual bool hasFailed() const;
+    virtual bool isBenchmark() const;
+    /* May run concurrently with other thread-safe tests (-t) */
+    virtual bool isThreadSafe() const;
     void countCheck();
 
     virtual void assertTrue(bool condition, const char *checkString, const char *conditionString, const char* text, const char *fileName, int lineNumber, const TestTerminator& testTerminator = NormalTestTerminator());
@@ -150,6 +170,8 @@ protected:
 
     virtual SimpleString getMacroName() const;
     TestResult *getTestResult();
+    void setTestResult(TestResult* result);
+    void setCurrentTest(UtestShell* test);
 private:
     const char *group_;
     const char *name_;
@@ -159,12 +181,11 @@ private:
     bool isRunAsSeperateProcess_;
     bool hasFailed_;
 
-    void setTestResult(TestResult* result);
-    void setCurrentTest(UtestShell* test);
     bool match(const char* target, const TestFilter* filters) const;
 
-    static UtestShell* currentTest_;
-    static TestResult* testResult_;
+    static volatile long relinksAndRenames_;
+    static CPPUTEST_THREAD_LOCAL UtestShell* currentTest_;
+    static CPPUTEST_THREAD_LOCAL TestResult* testResult_;
 
 };
 
@@ -229,6 +250,95 @@ private:
 
 };
 
+//////////////////// BenchmarkResult
+
+class BenchmarkResult
+{
+public:
+    BenchmarkResult();
+
+    /* Summarizes the time per iteration of each sample; sorts nanosPerIteration */
+    void calculate(double* nanosPerIteration, int numberOfSamples, long iterationsPerSample);
+
+    int getNumberOfSamples() const;
+    long getIterationsPerSample() const;
+    double getMinimum() const;
+    double getMedian() const;
+    double getPercentile99() const;
+    double getStandardDeviation() const;
+
+private:
+    int numberOfSamples_;
+    long iterationsPerSample_;
+    double minimum_;
+    double median_;
+    double percentile99_;
+    double standardDeviation_;
+};
+
+//////////////////// BenchmarkUtestShell
+
+class BenchmarkUtestShell : public UtestShell
+{
+public:
+    enum { numberOfWarmupSamples = 2, minimumNumberOfSamples = 5, maximumNumberOfSamples = 100 };
+
+    BenchmarkUtestShell();
+    virtual ~BenchmarkUtestShell();
+    explicit BenchmarkUtestShell(const char* groupName, const char* testName,
+            const char* fileName, int lineNumber);
+    virtual bool isBenchmark() const _override;
+
+    /* Called from the test body; scales the iterations per sample until a sample takes
+     * at least a millisecond, warms up and then samples for at most about a second */
+    virtual void runBenchmark(Utest* test);
+
+protected:
+    virtual SimpleString getMacroName() const _override;
+    virtual void runIteration(Utest* test)=0;
+
+private:
+    double measureIterations(Utest* test, long iterations);
+    long calibrateIterations(Utest* test);
+
+    BenchmarkUtestShell(const BenchmarkUtestShell&);
+    BenchmarkUtestShell& operator=(const BenchmarkUtestShell&);
+};
+
+//////////////////// ConcurrentUtestShell
+
+struct ConcurrentTestThread;
+
+class ConcurrentUtestShell : public UtestShell
+{
+public:
+    explicit ConcurrentUtestShell(int numberOfThreads);
+    virtual ~ConcurrentUtestShell();
+    int getNumberOfThreads() const;
+
+    /* Called from the test body; runs the concurrent body on all threads, released together
+     * once they have all started. Their checks and failures are added to this test, their
+     * execution times are reported as the properties thread_<n>_ms */
+    virtual void runConcurrently(Utest* test);
+
+    virtual void failWith(const TestFailure& failure) _override;
+    virtual void failWith(const TestFailure& failure, const TestTerminator& terminator) _override;
+
+protected:
+    virtual SimpleString getMacroName() const _override;
+    virtual void runConcurrentBody(Utest* test)=0;
+
+private:
+    static void runThread(void* thread);
+    static void runBody(void* thread);
+    void gatherResultOf(ConcurrentTestThread& thread, int threadNumber);
+
+    int numberOfThreads_;
+
+    ConcurrentUtestShell(const ConcurrentUtestShell&);
+    ConcurrentUtestShell& operator=(const ConcurrentUtestShell&);
+};
+
 //////////////////// TestInstaller
 
 class TestInstaller
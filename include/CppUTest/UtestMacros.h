@@ -49,6 +49,18 @@
 #define TEST_GROUP(testGroup) \
   TEST_GROUP_BASE(testGroup, Utest)
 
+/*! \brief Define a group of tests that may run concurrently
+ *
+ * Same as TEST_GROUP, but with -t the tests of the group run on a
+ * pool of threads, next to the tests of the other thread-safe groups.
+ * Their setup(), body and teardown() must not share unguarded state
+ * with other tests. Only the plugins that implement createThreadCopy(),
+ * such as those of UT_PTR_SET and the leak check, run around these tests,
+ * one copy per thread. mock() is global and does not.
+ */
+#define THREAD_SAFE_TEST_GROUP(testGroup) \
+  TEST_GROUP_BASE(testGroup, ThreadSafeUtest)
+
 #define TEST_SETUP() \
   virtual void setup()
 
@@ -65,6 +77,7 @@
        void testBody(); }; \
   class TEST_##testGroup##_##testName##_TestShell : public UtestShell { \
       virtual Utest* createTest() _override { return new TEST_##testGroup##_##testName##_Test; } \
+      virtual bool isThreadSafe() const _override { return TEST_GROUP_##CppUTestGroup##testGroup::isThreadSafeGroup(); } \
   } TEST_##testGroup##_##testName##_TestShell_instance; \
   static TestInstaller TEST_##testGroup##_##testName##_Installer(TEST_##testGroup##_##testName##_TestShell_instance, #testGroup, #testName, __FILE__,__LINE__); \
     void TEST_##testGroup##_##testName##_Test::testBody()
@@ -83,6 +96,63 @@
    static TestInstaller TEST_##testGroup##testName##_Installer(IGNORE##testGroup##_##testName##_TestShell_instance, #testGroup, #testName, __FILE__,__LINE__); \
     void IGNORE##testGroup##_##testName##_Test::testBodyThatNeverRuns ()
 
+/*! \brief Define a test whose body runs on several threads at once
+ *
+ * setup() and teardown() run once around the body, which runs on
+ * numberOfThreads threads released together after they all started.
+ * Checks and failures of every thread are added to this test.
+ */
+#define TEST_CONCURRENT(testGroup, testName, numberOfThreads) \
+  /* External declarations for strict compilers */ \
+  class TEST_CONCURRENT_##testGroup##_##testName##_TestShell; \
+  extern TEST_CONCURRENT_##testGroup##_##testName##_TestShell TEST_CONCURRENT_##testGroup##_##testName##_TestShell_instance; \
+  \
+  class TEST_CONCURRENT_##testGroup##_##testName##_Test : public TEST_GROUP_##CppUTestGroup##testGroup \
+{ public: TEST_CONCURRENT_##testGroup##_##testName##_Test () : TEST_GROUP_##CppUTestGroup##testGroup () {} \
+       void testBody(); \
+       void concurrentBody(); }; \
+  class TEST_CONCURRENT_##testGroup##_##testName##_TestShell : public ConcurrentUtestShell { \
+  public: TEST_CONCURRENT_##testGroup##_##testName##_TestShell() : ConcurrentUtestShell(numberOfThreads) {} \
+      virtual Utest* createTest() _override { return new TEST_CONCURRENT_##testGroup##_##testName##_Test; } \
+      virtual bool isThreadSafe() const _override { return TEST_GROUP_##CppUTestGroup##testGroup::isThreadSafeGroup(); } \
+      virtual void runConcurrentBody(Utest* test) _override { static_cast<TEST_CONCURRENT_##testGroup##_##testName##_Test*>(test)->concurrentBody(); } \
+  } TEST_CONCURRENT_##testGroup##_##testName##_TestShell_instance; \
+  void TEST_CONCURRENT_##testGroup##_##testName##_Test::testBody() { TEST_CONCURRENT_##testGroup##_##testName##_TestShell_instance.runConcurrently(this); } \
+  static TestInstaller TEST_CONCURRENT_##testGroup##_##testName##_Installer(TEST_CONCURRENT_##testGroup##_##testName##_TestShell_instance, #testGroup, #testName, __FILE__,__LINE__); \
+    void TEST_CONCURRENT_##testGroup##_##testName##_Test::concurrentBody()
+
+/*! \brief Define a group of benchmarks
+ *
+ * Same as TEST_GROUP; setup() and teardown() run once around
+ * all the measured iterations of a BENCHMARK.
+ */
+#define BENCHMARK_GROUP(testGroup) \
+  TEST_GROUP(testGroup)
+
+/*! \brief Define a benchmark
+ *
+ * The body is one iteration. It is run repeatedly to scale the
+ * iterations per sample, warm up and take the samples whose min,
+ * median, p99 and standard deviation are reported. Benchmarks
+ * run with the other tests; -b runs only the benchmarks.
+ */
+#define BENCHMARK(testGroup, benchmarkName) \
+  /* External declarations for strict compilers */ \
+  class BENCHMARK_##testGroup##_##benchmarkName##_TestShell; \
+  extern BENCHMARK_##testGroup##_##benchmarkName##_TestShell BENCHMARK_##testGroup##_##benchmarkName##_TestShell_instance; \
+  \
+  class BENCHMARK_##testGroup##_##benchmarkName##_Test : public TEST_GROUP_##CppUTestGroup##testGroup \
+{ public: BENCHMARK_##testGroup##_##benchmarkName##_Test () : TEST_GROUP_##CppUTestGroup##testGroup () {} \
+       void testBody(); \
+       void benchmarkBody(); }; \
+  class BENCHMARK_##testGroup##_##benchmarkName##_TestShell : public BenchmarkUtestShell { \
+      virtual Utest* createTest() _override { return new BENCHMARK_##testGroup##_##benchmarkName##_Test; } \
+      virtual void runIteration(Utest* test) _override { static_cast<BENCHMARK_##testGroup##_##benchmarkName##_Test*>(test)->benchmarkBody(); } \
+  } BENCHMARK_##testGroup##_##benchmarkName##_TestShell_instance; \
+  void BENCHMARK_##testGroup##_##benchmarkName##_Test::testBody() { BENCHMARK_##testGroup##_##benchmarkName##_TestShell_instance.runBenchmark(this); } \
+  static TestInstaller BENCHMARK_##testGroup##_##benchmarkName##_Installer(BENCHMARK_##testGroup##_##benchmarkName##_TestShell_instance, #testGroup, #benchmarkName, __FILE__,__LINE__); \
+    void BENCHMARK_##testGroup##_##benchmarkName##_Test::benchmarkBody()
+
 #define IMPORT_TEST_GROUP(testGroup) \
   extern int externTestGroup##testGroup;\
   extern int* p##testGroup; \
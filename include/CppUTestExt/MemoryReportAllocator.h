@@ -50,6 +50,7 @@ public:
 
     virtual char* alloc_memory(size_t size, const char* file, int line) _override;
     virtual void free_memory(char* memory, const char* file, int line) _override;
+    virtual bool guardsMemoryBounds() _override;
 
     virtual const char* name() _override;
     virtual const char* alloc_name() _override;
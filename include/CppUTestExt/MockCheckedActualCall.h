@@ -81,10 +81,11 @@ public:
 
     virtual MockActualCall& onObject(void* objectPtr) _override;
 
-    virtual bool isFulfilled() const;
+    virtual bool isFulfilled();
     virtual bool hasFailed() const;
 
     virtual void checkExpectations();
+    virtual void finalizeCallWhenFulfilled();
 
     virtual void setMockFailureReporter(MockFailureReporter* reporter);
 protected:
@@ -93,7 +94,7 @@ protected:
     virtual UtestShell* getTest() const;
     virtual void callHasSucceeded();
     virtual void finalizeOutputParameters(MockCheckedExpectedCall* call);
-    virtual void finalizeCallWhenFulfilled();
+    virtual void finalizeOutputParametersWhenFulfilled();
     virtual void failTest(const MockFailure& failure);
     virtual void checkInputParameter(const MockNamedValue& actualParameter);
     virtual void checkOutputParameter(const MockNamedValue& outputParameter);
@@ -114,8 +115,34 @@ private:
     ActualCallState state_;
     MockCheckedExpectedCall* fulfilledExpectation_;
 
+    /* Candidates are taken from the name chain of allExpectations_ one at a time, only when the ones
+     * taken so far are not enough. Those not taken yet get the passed arguments when they are taken */
     MockExpectedCallsList unfulfilledExpectations_;
     const MockExpectedCallsList& allExpectations_;
+    MockExpectedCallsList::MockExpectedCallsListNode* nextExpectation_;
+    MockExpectedCallsList::MockExpectedCallsListNode* lastExpectation_;
+
+    class MockPassedArgumentsListNode
+    {
+    public:
+        enum Kind { INPUT_PARAMETER, OUTPUT_PARAMETER, OBJECT };
+
+        Kind kind_;
+        MockNamedValue parameter_;
+        SimpleString stringValue_;
+        void* objectPtr_;
+
+        MockPassedArgumentsListNode* next_;
+        MockPassedArgumentsListNode(Kind kind, const MockNamedValue& parameter, void* objectPtr);
+    };
+
+    MockPassedArgumentsListNode* passedArguments_;
+
+    virtual void addPassedArgument(MockPassedArgumentsListNode::Kind kind, const MockNamedValue& parameter, void* objectPtr);
+    virtual void cleanUpPassedArgumentsList();
+    virtual bool passArgumentsTo(MockCheckedExpectedCall* expectation);
+    virtual MockCheckedExpectedCall* addNextUnfulfilledExpectation();
+    virtual void addAllUnfulfilledExpectations();
 
     class MockOutputParametersListNode
     {
@@ -97,10 +97,10 @@ public:
 
     enum { NOT_CALLED_YET = -1, NO_EXPECTED_CALL_ORDER = -1};
     virtual int getCallOrder() const;
+    SimpleString getName() const;
 
 protected:
     void setName(const SimpleString& name);
-    SimpleString getName() const;
 
 private:
     SimpleString functionName_;
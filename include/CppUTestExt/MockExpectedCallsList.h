@@ -54,6 +54,7 @@ public:
     virtual void addExpectations(const MockExpectedCallsList& list);
     virtual void addExpectationsRelatedTo(const SimpleString& name, const MockExpectedCallsList& list);
     virtual void addUnfulfilledExpectations(const MockExpectedCallsList& list);
+    virtual void addUnfulfilledExpectationsRelatedTo(const SimpleString& name, const MockExpectedCallsList& list);
 
     virtual void onlyKeepExpectationsRelatedTo(const SimpleString& name);
     virtual void onlyKeepExpectationsWithInputParameter(const MockNamedValue& parameter);
@@ -77,8 +78,7 @@ public:
     virtual SimpleString fulfilledCallsToString(const SimpleString& linePrefix = "") const;
     virtual SimpleString missingParametersToString() const;
 
-protected:
-    virtual void pruneEmptyNodeFromList();
+    class MockExpectedCallsNameEntry;
 
     class MockExpectedCallsListNode
     {
@@ -86,13 +86,51 @@ protected:
         MockCheckedExpectedCall* expectedCall_;
 
         MockExpectedCallsListNode* next_;
+        MockExpectedCallsListNode* nextWithSameName_;
+        MockExpectedCallsNameEntry* nameEntry_;
         MockExpectedCallsListNode(MockCheckedExpectedCall* expectedCall)
-            : expectedCall_(expectedCall), next_(NULL) {}
+            : expectedCall_(expectedCall), next_(NULL), nextWithSameName_(NULL), nameEntry_(NULL) {}
+    };
+
+    /* All expectations with the same function name, in the order they were added.
+     * firstUnfulfilled_ skips the fulfilled ones at the front, which stay fulfilled once their actual call is done */
+    class MockExpectedCallsNameEntry
+    {
+    public:
+        SimpleString name_;
+        MockExpectedCallsListNode* first_;
+        MockExpectedCallsListNode* last_;
+        MockExpectedCallsListNode* firstUnfulfilled_;
+
+        MockExpectedCallsNameEntry* next_;
+        MockExpectedCallsNameEntry(const SimpleString& name)
+            : name_(name), first_(NULL), last_(NULL), firstUnfulfilled_(NULL), next_(NULL) {}
     };
 
+    /* Walk on with nextWithSameName_; fulfilled expectations may still follow the returned node */
+    virtual MockExpectedCallsListNode* firstUnfulfilledNodeRelatedTo(const SimpleString& name) const;
+
+protected:
+    virtual void pruneEmptyNodeFromList();
+
     virtual MockExpectedCallsListNode* findNodeWithCallOrderOf(int callOrder) const;
+    virtual MockExpectedCallsNameEntry* findNameEntry(const SimpleString& name) const;
 private:
+    MockExpectedCallsNameEntry* findOrCreateNameEntry(const SimpleString& name);
+    void addToNameIndex(MockExpectedCallsListNode* node);
+    void relinkNameIndex();
+    void clearNameIndex();
+    void growNameIndex();
+
+    /* Embedded so that a list with few names needs no allocation; grown once there are more names than buckets */
+    enum { INITIAL_NAME_INDEX_SIZE = 61 };
+
     MockExpectedCallsListNode* head_;
+    MockExpectedCallsListNode* tail_;
+    MockExpectedCallsNameEntry** nameIndex_;
+    size_t nameIndexSize_;
+    size_t amountOfNames_;
+    MockExpectedCallsNameEntry* initialNameIndex_[INITIAL_NAME_INDEX_SIZE];
 
     MockExpectedCallsList(const MockExpectedCallsList&);
 };
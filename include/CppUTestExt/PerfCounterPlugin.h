@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2007, Michael Feathers, James Grenning and Bas Vodde
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE EARLIER MENTIONED AUTHORS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef D_PerfCounterPlugin_h
+#define D_PerfCounterPlugin_h
+
+#include "CppUTest/TestPlugin.h"
+
+/*
+ * Reads the hardware performance counters around every test and reports
+ * them as test properties, e.g. for the JUnit output. Enabled with
+ * -pperfcounters. Only available on Linux (perf_event_open); elsewhere,
+ * or when the kernel refuses access, the tests run without counters.
+ */
+class PerfCounterPlugin : public TestPlugin
+{
+public:
+    enum Counter { cycles, instructions, cacheMisses, branchMisses, numberOfCounters };
+
+    PerfCounterPlugin();
+    virtual ~PerfCounterPlugin();
+
+    virtual void preTestAction(UtestShell & test, TestResult & result) _override;
+    virtual void postTestAction(UtestShell & test, TestResult & result) _override;
+    virtual bool parseArguments(int, const char**, int) _override;
+
+    bool isMeasuring() const;
+
+    static const char* getCounterName(Counter counter);
+
+protected:
+    /* Return a handle >= 0, or a negative value when the counter is not available */
+    virtual int openCounter(Counter counter);
+    virtual void startCounter(int handle);
+    virtual double stopAndReadCounter(int handle);
+    virtual void closeCounter(int handle);
+
+    /* Subclasses overriding closeCounter call this from their destructor */
+    void closeCounters();
+
+private:
+    void openCounters(TestResult& result);
+
+    bool measuring_;
+    bool opened_;
+    int handles_[numberOfCounters];
+};
+
+#endif
@@ -30,7 +30,7 @@
 #include "CppUTest/PlatformSpecificFunctions.h"
 
 CommandLineArguments::CommandLineArguments(int ac, const char** av) :
-    ac_(ac), av_(av), verbose_(false), color_(false), runTestsAsSeperateProcess_(false), listTestGroupNames_(false), listTestGroupAndCaseNames_(false), repeat_(1), groupFilters_(NULL), nameFilters_(NULL), outputType_(OUTPUT_ECLIPSE)
+    ac_(ac), av_(av), verbose_(false), color_(false), runTestsAsSeperateProcess_(false), runBenchmarksOnly_(false), listTestGroupNames_(false), listTestGroupAndCaseNames_(false), repeat_(1), numberOfWorkers_(1), numberOfThreads_(1), shardIndex_(0), shardCount_(1), groupFilters_(NULL), nameFilters_(NULL), testFilters_(NULL), outputType_(OUTPUT_ECLIPSE), baselineThreshold_(10)
 {
 }
 
@@ -46,6 +46,11 @@ CommandLineArguments::~CommandLineArguments()
         nameFilters_ = nameFilters_->getNext();
         delete current;
     }
+    while(testFilters_) {
+        TestFilter* current = testFilters_;
+        testFilters_ = testFilters_->getNext();
+        delete current;
+    }
 }
 
 bool CommandLineArguments::parse(TestPlugin* plugin)
@@ -54,18 +59,30 @@ bool CommandLineArguments::parse(TestPlugin* plugin)
     for (int i = 1; i < ac_; i++) {
         SimpleString argument = av_[i];
         
-        if      (argument == "-v") verbose_ = true;
+        if      (argument.startsWith("--shard-index")) correctParameters = SetShardIndex(ac_, av_, i);
+        else if (argument.startsWith("--baseline-threshold")) correctParameters = SetBaselineThreshold(ac_, av_, i);
+        else if (argument.startsWith("--baseline")) correctParameters = SetBaselineFileName(ac_, av_, i);
+        else if (argument.startsWith("--save-baseline")) correctParameters = SetSaveBaselineFileName(ac_, av_, i);
+        else if (argument.startsWith("--shard-count")) correctParameters = SetShardCount(ac_, av_, i);
+        else if (argument.startsWith("--durations")) correctParameters = SetDurationsFileName(ac_, av_, i);
+        else if (argument.startsWith("--tests-from-file")) correctParameters = AddTestsFromFile(ac_, av_, i);
+        else if (argument == "-v") verbose_ = true;
         else if (argument == "-c") color_ = true;
         else if (argument == "-p") runTestsAsSeperateProcess_ = true;
+        else if (argument == "-b") runBenchmarksOnly_ = true;
         else if (argument == "-lg") listTestGroupNames_ = true;
         else if (argument == "-ln") listTestGroupAndCaseNames_ = true;
         else if (argument.startsWith("-r")) SetRepeatCount(ac_, av_, i);
+        else if (argument.startsWith("-j")) correctParameters = SetNumberOfWorkers(ac_, av_, i);
+        else if (argument.startsWith("-t")) correctParameters = SetNumberOfThreads(ac_, av_, i);
         else if (argument.startsWith("-g")) AddGroupFilter(ac_, av_, i);
         else if (argument.startsWith("-sg")) AddStrictGroupFilter(ac_, av_, i);
         else if (argument.startsWith("-n")) AddNameFilter(ac_, av_, i);
         else if (argument.startsWith("-sn")) AddStrictNameFilter(ac_, av_, i);
         else if (argument.startsWith("TEST(")) AddTestToRunBasedOnVerboseOutput(ac_, av_, i, "TEST(");
         else if (argument.startsWith("IGNORE_TEST(")) AddTestToRunBasedOnVerboseOutput(ac_, av_, i, "IGNORE_TEST(");
+        else if (argument.startsWith("BENCHMARK(")) AddTestToRunBasedOnVerboseOutput(ac_, av_, i, "BENCHMARK(");
+        else if (argument.startsWith("TEST_CONCURRENT(")) AddTestToRunBasedOnVerboseOutput(ac_, av_, i, "TEST_CONCURRENT(");
         else if (argument.startsWith("-o")) correctParameters = SetOutputType(ac_, av_, i);
         else if (argument.startsWith("-p")) correctParameters = plugin->parseAllArguments(ac_, av_, i);
         else if (argument.startsWith("-k")) SetPackageName(ac_, av_, i);
@@ -75,12 +92,12 @@ bool CommandLineArguments::parse(TestPlugin* plugin)
             return false;
         }
     }
-    return true;
+    return shardIndex_ < shardCount_;
 }
 
 const char* CommandLineArguments::usage() const
 {
-    return "usage [-v] [-c] [-p] [-lg] [-ln] [-r#] [-g|sg groupName]... [-n|sn testName]... [\"TEST(groupName, testName)\"]... [-o{normal, junit}] [-k packageName]\n";
+    return "usage [-v] [-c] [-p] [-b] [-lg] [-ln] [-r#] [-j#] [-t#] [--shard-index # --shard-count #] [--baseline file] [--save-baseline file] [--baseline-threshold #] [--durations file] [--tests-from-file file|-] [-g|sg groupName]... [-n|sn testName]... [\"TEST(groupName, testName)\"]... [-o{normal, junit, trace}] [-k packageName]\n";
 }
 
 bool CommandLineArguments::isVerbose() const
@@ -108,12 +125,36 @@ bool CommandLineArguments::runTestsInSeperateProcess() const
     return runTestsAsSeperateProcess_;
 }
 
+bool CommandLineArguments::isRunningBenchmarksOnly() const
+{
+    return runBenchmarksOnly_;
+}
 
 int CommandLineArguments::getRepeatCount() const
 {
     return repeat_;
 }
 
+int CommandLineArguments::getNumberOfWorkers() const
+{
+    return numberOfWorkers_;
+}
+
+int CommandLineArguments::getNumberOfThreads() const
+{
+    return numberOfThreads_;
+}
+
+int CommandLineArguments::getShardIndex() const
+{
+    return shardIndex_;
+}
+
+int CommandLineArguments::getShardCount() const
+{
+    return shardCount_;
+}
+
 const TestFilter* CommandLineArguments::getGroupFilters() const
 {
     return groupFilters_;
@@ -124,6 +165,11 @@ const TestFilter* CommandLineArguments::getNameFilters() const
     return nameFilters_;
 }
 
+const TestFilter* CommandLineArguments::getTestFilters() const
+{
+    return testFilters_;
+}
+
 void CommandLineArguments::SetRepeatCount(int ac, const char** av, int& i)
 {
     repeat_ = 0;
@@ -139,6 +185,74 @@ void CommandLineArguments::SetRepeatCount(int ac, const char** av, int& i)
 
 }
 
+bool CommandLineArguments::SetNumberOfWorkers(int ac, const char** av, int& i)
+{
+    numberOfWorkers_ = SimpleString::AtoI(getParameterField(ac, av, i, "-j").asCharString());
+    return numberOfWorkers_ > 0;
+}
+
+bool CommandLineArguments::SetNumberOfThreads(int ac, const char** av, int& i)
+{
+    numberOfThreads_ = SimpleString::AtoI(getParameterField(ac, av, i, "-t").asCharString());
+    return numberOfThreads_ > 0;
+}
+
+static bool isNumber(const SimpleString& field)
+{
+    const char* characters = field.asCharString();
+    if (*characters == '\0') return false;
+    for (; *characters; characters++)
+        if (*characters < '0' || *characters > '9') return false;
+    return true;
+}
+
+static SimpleString withoutEqualsSign(const SimpleString& field)
+{
+    return field.startsWith("=") ? field.subString(1, field.size()) : field;
+}
+
+bool CommandLineArguments::SetShardIndex(int ac, const char** av, int& i)
+{
+    SimpleString field = withoutEqualsSign(getParameterField(ac, av, i, "--shard-index"));
+    if (!isNumber(field)) return false;
+    shardIndex_ = SimpleString::AtoI(field.asCharString());
+    return true;
+}
+
+bool CommandLineArguments::SetBaselineFileName(int ac, const char** av, int& i)
+{
+    baselineFileName_ = withoutEqualsSign(getParameterField(ac, av, i, "--baseline"));
+    return !baselineFileName_.isEmpty();
+}
+
+bool CommandLineArguments::SetSaveBaselineFileName(int ac, const char** av, int& i)
+{
+    saveBaselineFileName_ = withoutEqualsSign(getParameterField(ac, av, i, "--save-baseline"));
+    return !saveBaselineFileName_.isEmpty();
+}
+
+bool CommandLineArguments::SetDurationsFileName(int ac, const char** av, int& i)
+{
+    durationsFileName_ = withoutEqualsSign(getParameterField(ac, av, i, "--durations"));
+    return !durationsFileName_.isEmpty();
+}
+
+bool CommandLineArguments::SetBaselineThreshold(int ac, const char** av, int& i)
+{
+    SimpleString field = withoutEqualsSign(getParameterField(ac, av, i, "--baseline-threshold"));
+    if (!isNumber(field)) return false;
+    baselineThreshold_ = SimpleString::AtoI(field.asCharString());
+    return true;
+}
+
+bool CommandLineArguments::SetShardCount(int ac, const char** av, int& i)
+{
+    SimpleString field = withoutEqualsSign(getParameterField(ac, av, i, "--shard-count"));
+    if (!isNumber(field)) return false;
+    shardCount_ = SimpleString::AtoI(field.asCharString());
+    return shardCount_ > 0;
+}
+
 SimpleString CommandLineArguments::getParameterField(int ac, const char** av, int& i, const SimpleString& parameterName)
 {
     size_t parameterLength = parameterName.size();
@@ -174,6 +288,50 @@ void CommandLineArguments::AddStrictNameFilter(int ac, const char** av, int& ind
     nameFilters_= nameFilter->add(nameFilters_);
 }
 
+void CommandLineArguments::AddTestFilter(const SimpleString& groupAndName)
+{
+    TestFilter* testFilter = new TestFilter(groupAndName);
+    testFilter->strictMatching();
+    testFilters_ = testFilter->add(testFilters_);
+}
+
+static bool isWhiteSpace(char character)
+{
+    return character == ' ' || character == '\t' || character == '\r' || character == '\n';
+}
+
+/* "Group.Name" selections separated by white space, as -ln prints them; "-" reads them from stdin */
+bool CommandLineArguments::AddTestsFromFile(int ac, const char** av, int& i)
+{
+    SimpleString fileName = withoutEqualsSign(getParameterField(ac, av, i, "--tests-from-file"));
+    if (fileName.isEmpty()) return false;
+
+    bool readsStdIn = (fileName == "-");
+    PlatformSpecificFile file = readsStdIn ? PlatformSpecificStdIn() : PlatformSpecificFOpen(fileName.asCharString(), "r");
+    if (file == NULL) return false;
+
+    char buffer[256];
+    SimpleString selection;
+    while (PlatformSpecificFGets(buffer, (int) sizeof(buffer), file) != NULL) {
+        for (const char* character = buffer; *character; ) {
+            const char* start = character;
+            while (*character && !isWhiteSpace(*character)) character++;
+            if (character != start) selection += SimpleString(start).subString(0, (size_t) (character - start));
+            if (*character == '\0') break;
+
+            if (!selection.isEmpty()) AddTestFilter(selection);
+            selection = "";
+            character++;
+        }
+    }
+    if (!selection.isEmpty()) AddTestFilter(selection);
+    if (!readsStdIn) PlatformSpecificFClose(file);
+
+    /* An empty selection runs no test, as no "group.name" is empty */
+    if (testFilters_ == NULL) AddTestFilter("");
+    return true;
+}
+
 void CommandLineArguments::AddTestToRunBasedOnVerboseOutput(int ac, const char** av, int& index, const char* parameterName)
 {
     SimpleString wholename = getParameterField(ac, av, index, parameterName);
@@ -208,6 +366,10 @@ bool CommandLineArguments::SetOutputType(int ac, const char** av, int& i)
         outputType_ = OUTPUT_JUNIT;
         return true;
     }
+    if (outputType == "trace") {
+        outputType_ = OUTPUT_TRACE;
+        return true;
+    }
     return false;
 }
 
@@ -221,8 +383,33 @@ bool CommandLineArguments::isJUnitOutput() const
     return outputType_ == OUTPUT_JUNIT;
 }
 
+bool CommandLineArguments::isTraceOutput() const
+{
+    return outputType_ == OUTPUT_TRACE;
+}
+
 const SimpleString& CommandLineArguments::getPackageName() const
 {
     return packageName_;
 }
 
+const SimpleString& CommandLineArguments::getBaselineFileName() const
+{
+    return baselineFileName_;
+}
+
+const SimpleString& CommandLineArguments::getSaveBaselineFileName() const
+{
+    return saveBaselineFileName_;
+}
+
+int CommandLineArguments::getBaselineThreshold() const
+{
+    return baselineThreshold_;
+}
+
+const SimpleString& CommandLineArguments::getDurationsFileName() const
+{
+    return durationsFileName_;
+}
+
@@ -29,7 +29,9 @@
 #include "CppUTest/CommandLineTestRunner.h"
 #include "CppUTest/TestOutput.h"
 #include "CppUTest/JUnitTestOutput.h"
+#include "CppUTest/TraceEventTestOutput.h"
 #include "CppUTest/TestRegistry.h"
+#include "CppUTest/TestBaseline.h"
 
 int CommandLineTestRunner::RunAllTests(int ac, char** av)
 {
@@ -87,9 +89,14 @@ void CommandLineTestRunner::initializeTestRun()
 {
     registry_->setGroupFilters(arguments_->getGroupFilters());
     registry_->setNameFilters(arguments_->getNameFilters());
+    registry_->setTestFilters(arguments_->getTestFilters());
     if (arguments_->isVerbose()) output_->verbose();
     if (arguments_->isColor()) output_->color();
-    if (arguments_->runTestsInSeperateProcess()) registry_->setRunTestsInSeperateProcess();
+    if (arguments_->runTestsInSeperateProcess()) registry_->setRunTestsInPreforkedProcesses();
+    if (arguments_->isRunningBenchmarksOnly()) registry_->setRunBenchmarksOnly();
+    if (arguments_->getNumberOfWorkers() > 1) registry_->setRunTestsInParallel(arguments_->getNumberOfWorkers());
+    if (arguments_->getNumberOfThreads() > 1) registry_->setRunTestsInThreads(arguments_->getNumberOfThreads());
+    if (arguments_->getShardCount() > 1) registry_->setShard(arguments_->getShardIndex(), arguments_->getShardCount());
 }
 
 int CommandLineTestRunner::runAllTests()
@@ -106,19 +113,47 @@ int CommandLineTestRunner::runAllTests()
         return 0;
     }
 
+    TestDurations durations;
+    bool usesDurations = !arguments_->getDurationsFileName().isEmpty();
+    if (usesDurations) {
+        durations.load(arguments_->getDurationsFileName());
+        registry_->setDurations(&durations);
+    }
+
     if (arguments_->isListingTestGroupAndCaseNames())
     {
         TestResult tr(*output_);
         registry_->listTestGroupAndCaseNames(tr);
+        registry_->setDurations(NULL);
         return 0;
     }
 
+    TestBaseline baseline;
+    bool usesBaseline = !arguments_->getBaselineFileName().isEmpty() || !arguments_->getSaveBaselineFileName().isEmpty();
+    baseline.setThreshold(arguments_->getBaselineThreshold());
+    if (!arguments_->getBaselineFileName().isEmpty() && !baseline.load(arguments_->getBaselineFileName())) {
+        output_->print(StringFromFormat("Could not read baseline %s, nothing to compare against\n", arguments_->getBaselineFileName().asCharString()).asCharString());
+    }
+
     while (loopCount++ < repeat_) {
         output_->printTestRun(loopCount, repeat_);
         TestResult tr(*output_);
+        if (usesBaseline) tr.setBaseline(&baseline);
+        if (usesDurations) tr.setDurations(&durations);
         registry_->runAllTests(tr);
         failureCount += tr.getFailureCount();
     }
+    registry_->setDurations(NULL);
+
+    if (!arguments_->getSaveBaselineFileName().isEmpty() && !baseline.save(arguments_->getSaveBaselineFileName())) {
+        output_->print(StringFromFormat("Could not write baseline %s\n", arguments_->getSaveBaselineFileName().asCharString()).asCharString());
+        failureCount++;
+    }
+
+    if (usesDurations && !durations.save(arguments_->getDurationsFileName())) {
+        output_->print(StringFromFormat("Could not write durations %s\n", arguments_->getDurationsFileName().asCharString()).asCharString());
+        failureCount++;
+    }
 
     return failureCount;
 }
@@ -128,10 +163,18 @@ TestOutput* CommandLineTestRunner::createJUnitOutput(const SimpleString& package
     JUnitTestOutput* junitOutput = new JUnitTestOutput;
     if (junitOutput != NULL) {
       junitOutput->setPackageName(packageName);
+      if (arguments_->getShardCount() > 1) junitOutput->setShardIndex(arguments_->getShardIndex());
     }
     return junitOutput;
 }
 
+TestOutput* CommandLineTestRunner::createTraceOutput()
+{
+    TraceEventTestOutput* traceOutput = new TraceEventTestOutput;
+    if (arguments_->getShardCount() > 1) traceOutput->setShardIndex(arguments_->getShardIndex());
+    return traceOutput;
+}
+
 TestOutput* CommandLineTestRunner::createConsoleOutput()
 {
     return new ConsoleTestOutput;
@@ -158,6 +201,11 @@ bool CommandLineTestRunner::parseArguments(TestPlugin* plugin)
     if (arguments_->isVerbose())
       output_ = createCompositeOutput(output_, createConsoleOutput());
   }
+  else if (arguments_->isTraceOutput()) {
+    output_= createTraceOutput();
+    if (arguments_->isVerbose())
+      output_ = createCompositeOutput(output_, createConsoleOutput());
+  }
   else
     output_ = createConsoleOutput();
   return true;
@@ -34,14 +34,17 @@
 struct JUnitTestCaseResultNode
 {
     JUnitTestCaseResultNode() :
-        execTime_(0), failure_(0), ignored_(false), next_(0)
+        execTime_(0), failure_(0), ignored_(false), benchmarked_(false), next_(0)
     {
     }
 
     SimpleString name_;
-    long execTime_;
+    double execTime_;
     TestFailure* failure_;
     bool ignored_;
+    bool benchmarked_;
+    BenchmarkResult benchmark_;
+    SimpleString properties_;
     JUnitTestCaseResultNode* next_;
 };
 
@@ -54,8 +57,8 @@ struct JUnitTestGroupResult
 
     int testCount_;
     int failureCount_;
-    long startTime_;
-    long groupExecTime_;
+    double startTime_;
+    double groupExecTime_;
     SimpleString group_;
     JUnitTestCaseResultNode* head_;
     JUnitTestCaseResultNode* tail_;
@@ -66,6 +69,7 @@ struct JUnitTestOutputImpl
     JUnitTestGroupResult results_;
     PlatformSpecificFile file_;
     SimpleString package_;
+    SimpleString shardSuffix_;
 };
 
 JUnitTestOutput::JUnitTestOutput() :
@@ -107,7 +111,19 @@ void JUnitTestOutput::printCurrentGroupStarted(const UtestShell& /*test*/)
 void JUnitTestOutput::printCurrentTestEnded(const TestResult& result)
 {
     impl_->results_.tail_->execTime_
-            = result.getCurrentTestTotalExecutionTime();
+            = result.getCurrentTestTotalExecutionTimeInNanos();
+}
+
+void JUnitTestOutput::printBenchmarkResult(const UtestShell& /*test*/, const BenchmarkResult& benchmark)
+{
+    impl_->results_.tail_->benchmarked_ = true;
+    impl_->results_.tail_->benchmark_ = benchmark;
+}
+
+void JUnitTestOutput::printTestProperty(const UtestShell& /*test*/, const SimpleString& name, const SimpleString& value)
+{
+    impl_->results_.tail_->properties_ += StringFromFormat("<property name=\"%s.%s\" value=\"%s\"/>\n",
+            impl_->results_.tail_->name_.asCharString(), name.asCharString(), value.asCharString());
 }
 
 void JUnitTestOutput::printTestsEnded(const TestResult& /*result*/)
@@ -116,8 +132,8 @@ void JUnitTestOutput::printTestsEnded(const TestResult& /*result*/)
 
 void JUnitTestOutput::printCurrentGroupEnded(const TestResult& result)
 {
-    impl_->results_.groupExecTime_ = result.getCurrentGroupTotalExecutionTime();
-    writeTestGroupToFile();
+    impl_->results_.groupExecTime_ = result.getCurrentGroupTotalExecutionTimeInNanos();
+    if (impl_->results_.testCount_ > 0) writeTestGroupToFile();
     resetTestGroupResult();
 }
 
@@ -125,7 +141,7 @@ void JUnitTestOutput::printCurrentTestStarted(const UtestShell& test)
 {
     impl_->results_.testCount_++;
     impl_->results_.group_ = test.getGroup();
-    impl_->results_.startTime_ = GetPlatformSpecificTimeInMillis();
+    impl_->results_.startTime_ = GetPlatformSpecificMonotonicTimeInNanos();
 
     if (impl_->results_.tail_ == 0) {
         impl_->results_.head_ = impl_->results_.tail_
@@ -146,6 +162,7 @@ SimpleString JUnitTestOutput::createFileName(const SimpleString& group)
     SimpleString fileName = "cpputest_";
     fileName += group;
     fileName.replace('/', '_');
+    fileName += impl_->shardSuffix_;
     fileName += ".xml";
     return fileName;
 }
@@ -157,6 +174,17 @@ void JUnitTestOutput::setPackageName(const SimpleString& package)
     }
 }
 
+void JUnitTestOutput::setShardIndex(int shardIndex)
+{
+    impl_->shardSuffix_ = StringFromFormat("_shard%d", shardIndex);
+}
+
+static SimpleString StringFromNanosAsSeconds(double nanos)
+{
+    long micros = (long) (nanos / 1000.0);
+    return StringFromFormat("%ld.%06ld", micros / 1000000, micros % 1000000);
+}
+
 void JUnitTestOutput::writeXmlHeader()
 {
     writeToFile("<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n");
@@ -167,18 +195,33 @@ void JUnitTestOutput::writeTestSuiteSummery()
     SimpleString
             buf =
                     StringFromFormat(
-                            "<testsuite errors=\"0\" failures=\"%d\" hostname=\"localhost\" name=\"%s\" tests=\"%d\" time=\"%d.%03d\" timestamp=\"%s\">\n",
+                            "<testsuite errors=\"0\" failures=\"%d\" hostname=\"localhost\" name=\"%s\" tests=\"%d\" time=\"%s\" timestamp=\"%s\">\n",
                             impl_->results_.failureCount_,
                             impl_->results_.group_.asCharString(),
                             impl_->results_.testCount_,
-                            (int) (impl_->results_.groupExecTime_ / 1000), (int) (impl_->results_.groupExecTime_ % 1000),
+                            StringFromNanosAsSeconds(impl_->results_.groupExecTime_).asCharString(),
                             GetPlatformSpecificTimeString());
     writeToFile(buf.asCharString());
 }
 
+void JUnitTestOutput::writeBenchmarkProperty(JUnitTestCaseResultNode* node, const char* name, double value)
+{
+    writeToFile(StringFromFormat("<property name=\"%s.%s\" value=\"%.3f\"/>\n", node->name_.asCharString(), name, value));
+}
+
 void JUnitTestOutput::writeProperties()
 {
     writeToFile("<properties>\n");
+    for (JUnitTestCaseResultNode* cur = impl_->results_.head_; cur; cur = cur->next_) {
+        writeToFile(cur->properties_);
+        if (!cur->benchmarked_) continue;
+        writeBenchmarkProperty(cur, "min_ns", cur->benchmark_.getMinimum());
+        writeBenchmarkProperty(cur, "median_ns", cur->benchmark_.getMedian());
+        writeBenchmarkProperty(cur, "p99_ns", cur->benchmark_.getPercentile99());
+        writeBenchmarkProperty(cur, "stddev_ns", cur->benchmark_.getStandardDeviation());
+        writeToFile(StringFromFormat("<property name=\"%s.samples\" value=\"%d\"/>\n", cur->name_.asCharString(), cur->benchmark_.getNumberOfSamples()));
+        writeToFile(StringFromFormat("<property name=\"%s.iterations\" value=\"%ld\"/>\n", cur->name_.asCharString(), cur->benchmark_.getIterationsPerSample()));
+    }
     writeToFile("</properties>\n");
 }
 
@@ -187,11 +230,11 @@ void JUnitTestOutput::writeTestCases()
     JUnitTestCaseResultNode* cur = impl_->results_.head_;
     while (cur) {
         SimpleString buf = StringFromFormat(
-                "<testcase classname=\"%s%s%s\" name=\"%s\" time=\"%d.%03d\">\n",
+                "<testcase classname=\"%s%s%s\" name=\"%s\" time=\"%s\">\n",
                 impl_->package_.asCharString(),
                 impl_->package_.isEmpty() == true ? "" : ".",
                 impl_->results_.group_.asCharString(),
-                cur->name_.asCharString(), (int) (cur->execTime_ / 1000), (int)(cur->execTime_ % 1000));
+                cur->name_.asCharString(), StringFromNanosAsSeconds(cur->execTime_).asCharString());
         writeToFile(buf.asCharString());
 
         if (cur->failure_) {
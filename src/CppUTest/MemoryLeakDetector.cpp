@@ -33,7 +33,7 @@
 #define UNKNOWN ((char*)("<unknown>"))
 
 SimpleStringBuffer::SimpleStringBuffer() :
-    positions_filled_(0), write_limit_(SIMPLE_STRING_BUFFER_LEN-1)
+    positions_filled_(0), write_limit_(SIMPLE_STRING_BUFFER_LEN-1), sink_(0)
 {
     buffer_[0] = '\0';
 }
@@ -46,6 +46,8 @@ void SimpleStringBuffer::clear()
 
 void SimpleStringBuffer::add(const char* format, ...)
 {
+    if (sink_ && positions_filled_ > SIMPLE_STRING_BUFFER_LEN / 2) flush();
+
     int count = 0;
     size_t positions_left = write_limit_ - positions_filled_;
     if (positions_left <= 0) return;
@@ -58,15 +60,19 @@ void SimpleStringBuffer::add(const char* format, ...)
     va_end(arguments);
 }
 
+/* Formats a line at a time, the dump of a large leak is by far the biggest part of a report */
 void SimpleStringBuffer::addMemoryDump(const void* memory, size_t memorySize)
 {
+    static const char hexDigits[] = "0123456789abcdef";
     const unsigned char* byteMemory = (const unsigned char*)memory;
     const size_t maxLineBytes = 16;
     size_t currentPos = 0;
-	size_t p;
+    size_t p;
 
     while (currentPos < memorySize) {
-        add("    %04lx: ", (unsigned long) currentPos);
+        char line[80];
+        size_t length = 0;
+
         size_t bytesInLine = memorySize - currentPos;
         if (bytesInLine > maxLineBytes) {
             bytesInLine = maxLineBytes;
@@ -74,27 +80,34 @@ void SimpleStringBuffer::addMemoryDump(const void* memory, size_t memorySize)
         const size_t leftoverBytes = maxLineBytes - bytesInLine;
 
         for (p = 0; p < bytesInLine; p++) {
-            add("%02hx ", (unsigned short) byteMemory[currentPos + p]);
+            line[length++] = hexDigits[byteMemory[currentPos + p] >> 4];
+            line[length++] = hexDigits[byteMemory[currentPos + p] & 0xf];
+            line[length++] = ' ';
             if (p == ((maxLineBytes / 2) - 1)) {
-                add(" ");
+                line[length++] = ' ';
             }
         }
         for (p = 0; p < leftoverBytes; p++) {
-            add("   ");
+            line[length++] = ' ';
+            line[length++] = ' ';
+            line[length++] = ' ';
         }
         if (leftoverBytes > (maxLineBytes/2)) {
-            add(" ");
+            line[length++] = ' ';
         }
 
-        add("|");
+        line[length++] = '|';
         for (p = 0; p < bytesInLine; p++) {
             char toAdd = (char)byteMemory[currentPos + p];
             if (toAdd < ' ' || toAdd > '~') {
                 toAdd = '.';
             }
-            add("%c", (int)toAdd);
+            line[length++] = toAdd;
         }
-        add("|\n");
+        line[length++] = '|';
+        line[length] = '\0';
+
+        add("    %04lx: %s\n", (unsigned long) currentPos, line);
         currentPos += bytesInLine;
     }
 }
@@ -120,18 +133,79 @@ bool SimpleStringBuffer::reachedItsCapacity()
     return positions_filled_ >= write_limit_;
 }
 
+void SimpleStringBuffer::streamTo(MemoryLeakReportSink* sink)
+{
+    sink_ = sink;
+}
+
+void SimpleStringBuffer::flush()
+{
+    if (sink_ == 0 || positions_filled_ == 0) return;
+    sink_->write(buffer_);
+    clear();
+}
+
+////////////////////////
+
+TestResultMemoryLeakReportSink::TestResultMemoryLeakReportSink(TestResult& result) :
+    result_(result)
+{
+}
+
+void TestResultMemoryLeakReportSink::write(const char* text)
+{
+    result_.print(text);
+}
+
+const char* TestResultMemoryLeakReportSink::getName()
+{
+    return "the test output";
+}
+
+FileMemoryLeakReportSink::FileMemoryLeakReportSink(const char* fileName) :
+    fileName_(fileName), file_(PlatformSpecificFOpen(fileName, "w"))
+{
+}
+
+FileMemoryLeakReportSink::~FileMemoryLeakReportSink()
+{
+    if (file_) PlatformSpecificFClose(file_);
+}
+
+void FileMemoryLeakReportSink::write(const char* text)
+{
+    if (file_) PlatformSpecificFPuts(text, file_);
+}
+
+const char* FileMemoryLeakReportSink::getName()
+{
+    return fileName_;
+}
+
 ////////////////////////
 
 #define MEM_LEAK_TOO_MUCH "\netc etc etc etc. !!!! Too much memory leaks to report. Bailing out\n"
 #define MEM_LEAK_FOOTER "Total number of leaks: "
+#define MEM_LEAK_STREAMED "The leak report was written to %s\n"
+#define MEM_LEAK_SAMPLED_ESTIMATE "Sampled 1 in %u allocations, estimated number of leaks: %lu\n"
 #define MEM_LEAK_ADDITION_MALLOC_WARNING "NOTE:\n" \
                                          "\tMemory leak reports about malloc and free can be caused by allocating using the cpputest version of malloc,\n" \
                                          "\tbut deallocate using the standard free.\n" \
                                          "\tIf this is the case, check whether your malloc/free replacements are working (#define malloc cpputest_malloc etc).\n"
 
 MemoryLeakOutputStringBuffer::MemoryLeakOutputStringBuffer()
-    : total_leaks_(0), giveWarningOnUsingMalloc_(false)
+    : total_leaks_(0), giveWarningOnUsingMalloc_(false), sink_(0), leakDumpSize_((size_t) -1)
+{
+}
+
+void MemoryLeakOutputStringBuffer::streamReportTo(MemoryLeakReportSink* sink)
 {
+    sink_ = sink;
+}
+
+void MemoryLeakOutputStringBuffer::setLeakDumpSize(size_t leakDumpSize)
+{
+    leakDumpSize_ = leakDumpSize;
 }
 
 void MemoryLeakOutputStringBuffer::addAllocationLocation(const char* allocationFile, int allocationLineNumber, size_t allocationSize, TestMemoryAllocator* allocator)
@@ -154,7 +228,14 @@ void MemoryLeakOutputStringBuffer::startMemoryLeakReporting()
     giveWarningOnUsingMalloc_ = false;
     total_leaks_ = 0;
 
-    size_t memory_leak_normal_footer_size = sizeof(MEM_LEAK_FOOTER) + 10 + sizeof(MEM_LEAK_TOO_MUCH); /* the number of leaks */
+    if (sink_) {
+        outputBuffer_.clear();
+        outputBuffer_.resetWriteLimit();
+        outputBuffer_.streamTo(sink_);
+        return;
+    }
+
+    size_t memory_leak_normal_footer_size = sizeof(MEM_LEAK_FOOTER) + 10 + sizeof(MEM_LEAK_TOO_MUCH) + sizeof(MEM_LEAK_SAMPLED_ESTIMATE) + 20; /* the number of leaks and their estimate */
     size_t memory_leak_foot_size_with_malloc_warning = memory_leak_normal_footer_size + sizeof(MEM_LEAK_ADDITION_MALLOC_WARNING);
 
     outputBuffer_.setWriteLimit(SimpleStringBuffer::SIMPLE_STRING_BUFFER_LEN - memory_leak_foot_size_with_malloc_warning);
@@ -169,19 +250,83 @@ void MemoryLeakOutputStringBuffer::reportMemoryLeak(MemoryLeakDetectorNode* leak
     total_leaks_++;
     outputBuffer_.add("Alloc num (%u) Leak size: %lu Allocated at: %s and line: %d. Type: \"%s\"\n\tMemory: <%p> Content:\n",
             leak->number_, (unsigned long) leak->size_, leak->file_, leak->line_, leak->allocator_->alloc_name(), leak->memory_);
-    outputBuffer_.addMemoryDump(leak->memory_, leak->size_);
+    addLeakDump(leak);
 
     if (SimpleString::StrCmp(leak->allocator_->alloc_name(), (const char*) "malloc") == 0)
         giveWarningOnUsingMalloc_ = true;
 }
 
+void MemoryLeakOutputStringBuffer::addLeakDump(MemoryLeakDetectorNode* leak)
+{
+    if (leak->size_ <= leakDumpSize_) {
+        outputBuffer_.addMemoryDump(leak->memory_, leak->size_);
+        return;
+    }
+    outputBuffer_.addMemoryDump(leak->memory_, leakDumpSize_);
+    outputBuffer_.add("    (%lu more bytes)\n", (unsigned long) (leak->size_ - leakDumpSize_));
+}
+
+void MemoryLeakOutputStringBuffer::reportMemoryLeaksWithCallStack(MemoryLeakDetectorNode* firstLeak, int leaks, size_t leakedBytes)
+{
+    if (total_leaks_ == 0) {
+        addMemoryLeakHeader();
+    }
+
+    total_leaks_ += leaks;
+    outputBuffer_.add("%d leak(s) with %lu bytes in total. First alloc num (%u) Allocated at: %s and line: %d. Type: \"%s\"\n\tCall stack:\n",
+            leaks, (unsigned long) leakedBytes, firstLeak->number_, firstLeak->file_, firstLeak->line_, firstLeak->allocator_->alloc_name());
+    addCallStack(firstLeak->callStack_);
+
+    if (SimpleString::StrCmp(firstLeak->allocator_->alloc_name(), (const char*) "malloc") == 0)
+        giveWarningOnUsingMalloc_ = true;
+}
+
+/* The stack starts inside the detector and its operators, those frames are left out when the platform can name them */
+static bool isFrameOfTheDetector(const char* symbol)
+{
+    return SimpleString::StrStr(symbol, "MemoryLeakDetector") != NULL || SimpleString::StrStr(symbol, "mem_leak_operator") != NULL;
+}
+
+void MemoryLeakOutputStringBuffer::addCallStack(MemoryLeakCallStack* callStack)
+{
+    char symbol[256];
+    int frame = 0;
+
+    PlatformSpecificBacktraceSymbol(callStack->frames_[frame], symbol, sizeof(symbol));
+    while (frame < callStack->depth_ - 1 && isFrameOfTheDetector(symbol))
+        PlatformSpecificBacktraceSymbol(callStack->frames_[++frame], symbol, sizeof(symbol));
+
+    for (int printedFrames = 0; frame < callStack->depth_; printedFrames++) {
+        outputBuffer_.add("\t#%d <%p> %s\n", printedFrames, callStack->frames_[frame], symbol);
+        if (++frame < callStack->depth_)
+            PlatformSpecificBacktraceSymbol(callStack->frames_[frame], symbol, sizeof(symbol));
+    }
+}
+
+void MemoryLeakOutputStringBuffer::reportSampledLeakEstimate(unsigned samplingRate)
+{
+    if (total_leaks_ == 0) return;
+    outputBuffer_.add(MEM_LEAK_SAMPLED_ESTIMATE, samplingRate, (unsigned long) total_leaks_ * samplingRate);
+}
+
 void MemoryLeakOutputStringBuffer::stopMemoryLeakReporting()
 {
     if (total_leaks_ == 0) {
+        outputBuffer_.streamTo(0);
         addNoMemoryLeaksMessage();
         return;
     }
 
+    if (sink_) {
+        addMemoryLeakFooter(total_leaks_);
+        if (giveWarningOnUsingMalloc_)
+            addWarningForUsingMalloc();
+        outputBuffer_.flush();
+        outputBuffer_.streamTo(0);
+        addStreamedReportSummary();
+        return;
+    }
+
     bool buffer_reached_its_capacity = outputBuffer_.reachedItsCapacity();
     outputBuffer_.resetWriteLimit();
 
@@ -210,6 +355,14 @@ void MemoryLeakOutputStringBuffer::addMemoryLeakFooter(int amountOfLeaks)
     outputBuffer_.add("%s %d\n", MEM_LEAK_FOOTER, amountOfLeaks);
 }
 
+/* What is left for the failure message of the test */
+void MemoryLeakOutputStringBuffer::addStreamedReportSummary()
+{
+    addMemoryLeakHeader();
+    addMemoryLeakFooter(total_leaks_);
+    outputBuffer_.add(MEM_LEAK_STREAMED, sink_->getName());
+}
+
 void MemoryLeakOutputStringBuffer::addWarningForUsingMalloc()
 {
     outputBuffer_.add(MEM_LEAK_ADDITION_MALLOC_WARNING);
@@ -261,6 +414,8 @@ void MemoryLeakDetectorNode::init(char* memory, unsigned number, size_t size, Te
     period_ = period;
     file_ = file;
     line_ = line;
+    callStack_ = 0;
+    checkingThread_ = 0;
 }
 
 ///////////////////////
@@ -273,50 +428,40 @@ bool MemoryLeakDetectorList::isInPeriod(MemoryLeakDetectorNode* node, MemLeakPer
 void MemoryLeakDetectorList::clearAllAccounting(MemLeakPeriod period)
 {
     MemoryLeakDetectorNode* cur = head_;
-    MemoryLeakDetectorNode* prev = 0;
 
     while (cur) {
-        if (isInPeriod(cur, period)) {
-            if (prev) {
-                prev->next_ = cur->next_;
-                cur = prev;
-            }
-            else {
-                head_ = cur->next_;
-                cur = head_;
-                continue;
-            }
-        }
-        prev = cur;
-        cur = cur->next_;
+        MemoryLeakDetectorNode* next = cur->next_;
+        if (isInPeriod(cur, period))
+            unlinkNode(cur);
+        cur = next;
     }
 }
 
 void MemoryLeakDetectorList::addNewNode(MemoryLeakDetectorNode* node)
 {
     node->next_ = head_;
+    node->previous_ = 0;
+    if (head_) head_->previous_ = node;
     head_ = node;
 }
 
 MemoryLeakDetectorNode* MemoryLeakDetectorList::removeNode(char* memory)
 {
-    MemoryLeakDetectorNode* cur = head_;
-    MemoryLeakDetectorNode* prev = 0;
-    while (cur) {
-        if (cur->memory_ == memory) {
-            if (prev) {
-                prev->next_ = cur->next_;
-                return cur;
-            }
-            else {
-                head_ = cur->next_;
-                return cur;
-            }
-        }
-        prev = cur;
-        cur = cur->next_;
-    }
-    return 0;
+    MemoryLeakDetectorNode* node = retrieveNode(memory);
+    if (node) unlinkNode(node);
+    return node;
+}
+
+void MemoryLeakDetectorList::unlinkNode(MemoryLeakDetectorNode* node)
+{
+    if (node->previous_)
+        node->previous_->next_ = node->next_;
+    else
+        head_ = node->next_;
+    if (node->next_)
+        node->next_->previous_ = node->previous_;
+    node->next_ = 0;
+    node->previous_ = 0;
 }
 
 MemoryLeakDetectorNode* MemoryLeakDetectorList::retrieveNode(char* memory)
@@ -358,30 +503,208 @@ int MemoryLeakDetectorList::getTotalLeaks(MemLeakPeriod period)
 
 /////////////////////////////////////////////////////////////
 
+MemoryLeakDetectorIndex::MemoryLeakDetectorIndex() :
+    slots_(0), capacity_(0), size_(0), available_(true), shadowedNodes_(0)
+{
+}
+
+MemoryLeakDetectorIndex::~MemoryLeakDetectorIndex()
+{
+    release();
+}
+
+bool MemoryLeakDetectorIndex::isAvailable()
+{
+    return available_;
+}
+
+bool MemoryLeakDetectorIndex::hasShadowedNodes()
+{
+    return shadowedNodes_ > 0;
+}
+
+size_t MemoryLeakDetectorIndex::getCapacity()
+{
+    return capacity_;
+}
+
+size_t MemoryLeakDetectorIndex::slot(char* memory)
+{
+    size_t value = (size_t) memory;
+    value ^= value >> 16;
+    value *= 0x45d9f3bUL;
+    value ^= value >> 16;
+    return value & (capacity_ - 1);
+}
+
+size_t MemoryLeakDetectorIndex::findSlot(char* memory)
+{
+    size_t index = slot(memory);
+    while (slots_[index] && slots_[index]->memory_ != memory)
+        index = (index + 1) & (capacity_ - 1);
+    return index;
+}
+
+MemoryLeakDetectorNode* MemoryLeakDetectorIndex::find(char* memory)
+{
+    if (size_ == 0) return 0;
+    return slots_[findSlot(memory)];
+}
+
+void MemoryLeakDetectorIndex::insert(MemoryLeakDetectorNode* node)
+{
+    size_t index = findSlot(node->memory_);
+    if (slots_[index])
+        shadowedNodes_++;
+    else
+        size_++;
+    slots_[index] = node;
+}
+
+void MemoryLeakDetectorIndex::release()
+{
+    if (slots_) PlatformSpecificFree(slots_);
+    slots_ = 0;
+    capacity_ = 0;
+    size_ = 0;
+    shadowedNodes_ = 0;
+}
+
+bool MemoryLeakDetectorIndex::grow()
+{
+    size_t newCapacity = (capacity_) ? capacity_ * 2 : (size_t) initial_capacity;
+    MemoryLeakDetectorNode** newSlots = (MemoryLeakDetectorNode**) PlatformSpecificMalloc(newCapacity * sizeof(MemoryLeakDetectorNode*));
+    if (newSlots == 0) return false;
+    PlatformSpecificMemset(newSlots, 0, newCapacity * sizeof(MemoryLeakDetectorNode*));
+
+    MemoryLeakDetectorNode** oldSlots = slots_;
+    size_t oldCapacity = capacity_;
+
+    slots_ = newSlots;
+    capacity_ = newCapacity;
+    size_ = 0;
+    for (size_t i = 0; i < oldCapacity; i++)
+        if (oldSlots[i]) insert(oldSlots[i]);
+
+    if (oldSlots) PlatformSpecificFree(oldSlots);
+    return true;
+}
+
+void MemoryLeakDetectorIndex::add(MemoryLeakDetectorNode* node)
+{
+    if (!available_) return;
+
+    /* Keep the load factor below 0.7 so probe sequences stay short */
+    if ((size_ + 1) * 10 > capacity_ * 7 && !grow()) {
+        available_ = false;
+        release();
+        return;
+    }
+    insert(node);
+}
+
+void MemoryLeakDetectorIndex::remove(char* memory)
+{
+    if (size_ == 0) return;
+
+    size_t mask = capacity_ - 1;
+    size_t hole = findSlot(memory);
+    if (slots_[hole] == 0) return;
+
+    /* Backward shift deletion: move later entries of the probe sequence into the hole */
+    for (size_t index = (hole + 1) & mask; slots_[index]; index = (index + 1) & mask) {
+        size_t home = slot(slots_[index]->memory_);
+        if (((index - home) & mask) >= ((index - hole) & mask)) {
+            slots_[hole] = slots_[index];
+            hole = index;
+        }
+    }
+    slots_[hole] = 0;
+    size_--;
+}
+
+void MemoryLeakDetectorIndex::unshadow(MemoryLeakDetectorNode* node)
+{
+    if (shadowedNodes_ > 0) shadowedNodes_--;
+    add(node);
+}
+
+void MemoryLeakDetectorIndex::clear()
+{
+    shadowedNodes_ = 0;
+    if (size_ == 0) return;
+    PlatformSpecificMemset(slots_, 0, capacity_ * sizeof(MemoryLeakDetectorNode*));
+    size_ = 0;
+}
+
+/////////////////////////////////////////////////////////////
+
 unsigned long MemoryLeakDetectorTable::hash(char* memory)
 {
     return (unsigned long)((size_t)memory % hash_prime);
 }
 
+int MemoryLeakDetectorTable::getShard(char* memory)
+{
+    return (int) (hash(memory) % number_of_shards);
+}
+
+size_t MemoryLeakDetectorTable::getIndexCapacity()
+{
+    size_t capacity = 0;
+    for (int i = 0; i < number_of_shards; i++)
+        capacity += indexes_[i].getCapacity();
+    return capacity;
+}
+
+void MemoryLeakDetectorTable::rebuildIndex(int shard)
+{
+    MemoryLeakDetectorIndex& index = indexes_[shard];
+    if (!index.isAvailable()) return;
+
+    index.clear();
+    for (int i = shard; i < hash_prime; i += number_of_shards)
+        for (MemoryLeakDetectorNode* node = table_[i].getFirstLeak(mem_leak_period_all); node; node = table_[i].getNextLeak(node, mem_leak_period_all))
+            if (index.find(node->memory_) == 0) index.add(node);
+}
+
 void MemoryLeakDetectorTable::clearAllAccounting(MemLeakPeriod period)
 {
     for (int i = 0; i < hash_prime; i++)
         table_[i].clearAllAccounting(period);
+    for (int j = 0; j < number_of_shards; j++)
+        rebuildIndex(j);
 }
 
 void MemoryLeakDetectorTable::addNewNode(MemoryLeakDetectorNode* node)
 {
     table_[hash(node->memory_)].addNewNode(node);
+    indexes_[getShard(node->memory_)].add(node);
 }
 
 MemoryLeakDetectorNode* MemoryLeakDetectorTable::removeNode(char* memory)
 {
-    return table_[hash(memory)].removeNode(memory);
+    MemoryLeakDetectorNode* node = retrieveNode(memory);
+    if (node == 0) return 0;
+
+    MemoryLeakDetectorList& list = table_[hash(memory)];
+    MemoryLeakDetectorIndex& index = indexes_[getShard(memory)];
+    list.unlinkNode(node);
+    if (index.isAvailable()) {
+        index.remove(memory);
+        if (index.hasShadowedNodes()) {
+            MemoryLeakDetectorNode* shadowed = list.retrieveNode(memory);
+            if (shadowed) index.unshadow(shadowed);
+        }
+    }
+    return node;
 }
 
 MemoryLeakDetectorNode* MemoryLeakDetectorTable::retrieveNode(char* memory)
 {
-  return table_[hash(memory)].retrieveNode(memory);
+    MemoryLeakDetectorIndex& index = indexes_[getShard(memory)];
+    if (index.isAvailable()) return index.find(memory);
+    return table_[hash(memory)].retrieveNode(memory);
 }
 
 int MemoryLeakDetectorTable::getTotalLeaks(MemLeakPeriod period)
@@ -416,26 +739,190 @@ MemoryLeakDetectorNode* MemoryLeakDetectorTable::getNextLeak(MemoryLeakDetectorN
 
 /////////////////////////////////////////////////////////////
 
+MemoryLeakCallStackTable::MemoryLeakCallStackTable() :
+    buckets_(0), numberOfStacks_(0)
+{
+    PlatformSpecificMemset(namedFrames_, 0, sizeof(namedFrames_));
+    PlatformSpecificMemset(namedFrameIsOfTheDetector_, 0, sizeof(namedFrameIsOfTheDetector_));
+}
+
+MemoryLeakCallStackTable::~MemoryLeakCallStackTable()
+{
+    if (buckets_ == 0) return;
+
+    for (int i = 0; i < number_of_buckets; i++) {
+        while (buckets_[i]) {
+            MemoryLeakCallStack* stack = buckets_[i];
+            buckets_[i] = stack->next_;
+            PlatformSpecificFree(stack);
+        }
+    }
+    PlatformSpecificFree(buckets_);
+}
+
+unsigned long MemoryLeakCallStackTable::hash(void** frames, int depth)
+{
+    unsigned long hash = (unsigned long) depth;
+    for (int i = 0; i < depth; i++)
+        hash = hash * 31 + (unsigned long) ((size_t) frames[i] >> 2);
+    return hash;
+}
+
+bool MemoryLeakCallStackTable::matches(MemoryLeakCallStack* stack, unsigned long hash, void** frames, int depth)
+{
+    if (stack->hash_ != hash || stack->depth_ != depth) return false;
+    for (int i = 0; i < depth; i++)
+        if (stack->frames_[i] != frames[i]) return false;
+    return true;
+}
+
+MemoryLeakCallStack* MemoryLeakCallStackTable::intern(void** frames, int depth)
+{
+    if (buckets_ == 0) {
+        buckets_ = (MemoryLeakCallStack**) PlatformSpecificMalloc(number_of_buckets * sizeof(MemoryLeakCallStack*));
+        if (buckets_ == 0) return 0;
+        PlatformSpecificMemset(buckets_, 0, number_of_buckets * sizeof(MemoryLeakCallStack*));
+    }
+
+    unsigned long stackHash = hash(frames, depth);
+    MemoryLeakCallStack** bucket = &buckets_[stackHash & (number_of_buckets - 1)];
+    for (MemoryLeakCallStack* stack = *bucket; stack; stack = stack->next_)
+        if (matches(stack, stackHash, frames, depth)) return stack;
+
+    size_t framesSize = (size_t) depth * sizeof(void*);
+    MemoryLeakCallStack* stack = (MemoryLeakCallStack*) PlatformSpecificMalloc(sizeof(MemoryLeakCallStack) - sizeof(void*) + framesSize);
+    if (stack == 0) return 0;
+
+    stack->hash_ = stackHash;
+    stack->depth_ = depth;
+    stack->leaks_ = 0;
+    stack->leakedBytes_ = 0;
+    PlatformSpecificMemCpy(stack->frames_, frames, framesSize);
+    stack->next_ = *bucket;
+    *bucket = stack;
+    numberOfStacks_++;
+    return stack;
+}
+
+int MemoryLeakCallStackTable::getNumberOfStacks()
+{
+    return numberOfStacks_;
+}
+
+bool MemoryLeakCallStackTable::isDetectorFrame(void* frame)
+{
+    size_t slot = ((size_t) frame >> 2) & (number_of_named_frames - 1);
+    if (namedFrames_[slot] != frame) {
+        char symbol[256];
+        PlatformSpecificBacktraceSymbol(frame, symbol, sizeof(symbol));
+        namedFrames_[slot] = frame;
+        namedFrameIsOfTheDetector_[slot] = isFrameOfTheDetector(symbol);
+    }
+    return namedFrameIsOfTheDetector_[slot];
+}
+
+int MemoryLeakCallStackTable::countFramesOfTheDetector(void** frames, int depth)
+{
+    int framesOfTheDetector = 0;
+    while (framesOfTheDetector < depth - 1 && isDetectorFrame(frames[framesOfTheDetector]))
+        framesOfTheDetector++;
+    return framesOfTheDetector;
+}
+
+/////////////////////////////////////////////////////////////
+
+struct MemoryLeakDetectorNodeSlab
+{
+    MemoryLeakDetectorNodeSlab* next_;
+    MemoryLeakDetectorNode nodes_[MemoryLeakDetectorNodePool::nodes_per_slab];
+};
+
+MemoryLeakDetectorNodePool::MemoryLeakDetectorNodePool() :
+    slabs_(0), freeNodes_(0)
+{
+}
+
+MemoryLeakDetectorNodePool::~MemoryLeakDetectorNodePool()
+{
+    while (slabs_) {
+        MemoryLeakDetectorNodeSlab* slab = slabs_;
+        slabs_ = slab->next_;
+        PlatformSpecificFree(slab);
+    }
+}
+
+bool MemoryLeakDetectorNodePool::addSlab()
+{
+    MemoryLeakDetectorNodeSlab* slab = (MemoryLeakDetectorNodeSlab*) PlatformSpecificMalloc(sizeof(MemoryLeakDetectorNodeSlab));
+    if (slab == 0) return false;
+
+    slab->next_ = slabs_;
+    slabs_ = slab;
+    for (int i = nodes_per_slab - 1; i >= 0; i--) {
+        slab->nodes_[i].next_ = freeNodes_;
+        freeNodes_ = &slab->nodes_[i];
+    }
+    return true;
+}
+
+MemoryLeakDetectorNode* MemoryLeakDetectorNodePool::allocNode()
+{
+    if (freeNodes_ == 0 && !addSlab()) return 0;
+
+    MemoryLeakDetectorNode* node = freeNodes_;
+    freeNodes_ = node->next_;
+    node->next_ = 0;
+    return node;
+}
+
+void MemoryLeakDetectorNodePool::freeNode(MemoryLeakDetectorNode* node)
+{
+    if (node == 0) return;
+    node->next_ = freeNodes_;
+    freeNodes_ = node;
+}
+
+int MemoryLeakDetectorNodePool::getNumberOfSlabs()
+{
+    int numberOfSlabs = 0;
+    for (MemoryLeakDetectorNodeSlab* slab = slabs_; slab; slab = slab->next_)
+        numberOfSlabs++;
+    return numberOfSlabs;
+}
+
+/////////////////////////////////////////////////////////////
+
 MemoryLeakDetector::MemoryLeakDetector(MemoryLeakFailure* reporter)
 {
     doAllocationTypeChecking_ = true;
+    useNodePool_ = true;
     allocationSequenceNumber_ = 1;
     current_period_ = mem_leak_period_disabled;
     reporter_ = reporter;
-    mutex_ = new SimpleMutex;
+    for (int i = 0; i < MemoryLeakDetectorTable::number_of_shards; i++)
+        shardMutexes_[i] = new SimpleMutex;
+    sharedStateMutex_ = new SimpleMutex;
+    lockShards_ = false;
+    samplingRate_ = 1;
+    untrackedSamplingRate_ = 1;
+    untrackedAllocations_ = 0;
+    untrackedDeallocations_ = 0;
+    checkingThreads_ = 0;
+    leakDumpSize_ = (size_t) -1;
+    callStackDepth_ = 0;
 }
 
 MemoryLeakDetector::~MemoryLeakDetector()
 {
-    if (mutex_)
-    {
-        delete mutex_;
-    }
+    for (int i = 0; i < MemoryLeakDetectorTable::number_of_shards; i++)
+        delete shardMutexes_[i];
+    delete sharedStateMutex_;
 }
 
 void MemoryLeakDetector::clearAllAccounting(MemLeakPeriod period)
 {
     memoryTable_.clearAllAccounting(period);
+    restartCountingUntrackedMemory();
 }
 
 void MemoryLeakDetector::startChecking()
@@ -469,14 +956,227 @@ void MemoryLeakDetector::enableAllocationTypeChecking()
     doAllocationTypeChecking_ = true;
 }
 
-unsigned MemoryLeakDetector::getCurrentAllocationNumber()
+void MemoryLeakDetector::enableShardLocking()
 {
-    return allocationSequenceNumber_;
+    lockShards_ = true;
 }
 
-SimpleMutex *MemoryLeakDetector::getMutex()
+void MemoryLeakDetector::disableShardLocking()
+{
+    lockShards_ = false;
+}
+
+bool MemoryLeakDetector::isShardLockingEnabled() const
+{
+    return lockShards_;
+}
+
+void MemoryLeakDetector::lockAllShards()
+{
+    if (!lockShards_) return;
+    for (int i = 0; i < MemoryLeakDetectorTable::number_of_shards; i++)
+        shardMutexes_[i]->Lock();
+}
+
+void MemoryLeakDetector::unlockAllShards()
+{
+    if (!lockShards_) return;
+    for (int i = MemoryLeakDetectorTable::number_of_shards - 1; i >= 0; i--)
+        shardMutexes_[i]->Unlock();
+}
+
+/* Allocations of a thread that checks its own are marked with a number for that thread */
+static CPPUTEST_THREAD_LOCAL unsigned long threadCheckingNumber = 0;
+static CPPUTEST_THREAD_LOCAL bool threadIsChecking = false;
+
+void MemoryLeakDetector::startCheckingOnThisThread()
 {
-    return mutex_;
+    ScopedMutexLock lock(getSharedStateMutex());
+    threadCheckingNumber = ++checkingThreads_;
+    threadIsChecking = true;
+}
+
+void MemoryLeakDetector::stopCheckingOnThisThread()
+{
+    threadIsChecking = false;
+}
+
+bool MemoryLeakDetector::isLeakOfThread(MemoryLeakDetectorNode* leak, unsigned long thread)
+{
+    return thread == 0 || leak->checkingThread_ == thread;
+}
+
+int MemoryLeakDetector::totalMemoryLeaksOnThisThread()
+{
+    if (threadCheckingNumber == 0) return 0;
+
+    int leaks = 0;
+    lockAllShards();
+    for (MemoryLeakDetectorNode* leak = memoryTable_.getFirstLeak(mem_leak_period_enabled); leak; leak = memoryTable_.getNextLeak(leak, mem_leak_period_enabled))
+        if (isLeakOfThread(leak, threadCheckingNumber)) leaks++;
+    unlockAllShards();
+    return leaks;
+}
+
+const char* MemoryLeakDetector::reportOnThisThread(MemoryLeakOutputStringBuffer& buffer)
+{
+    buffer.setLeakDumpSize(leakDumpSize_);
+    lockAllShards();
+    {
+        ScopedMutexLock lock(getSharedStateMutex());
+        ConstructMemoryLeakReport(mem_leak_period_enabled, buffer, threadCheckingNumber);
+    }
+    unlockAllShards();
+    return buffer.toString();
+}
+
+void MemoryLeakDetector::markLeaksOnThisThreadAsChecked()
+{
+    lockAllShards();
+    for (MemoryLeakDetectorNode* leak = memoryTable_.getFirstLeak(mem_leak_period_enabled); leak; leak = memoryTable_.getNextLeak(leak, mem_leak_period_enabled))
+        if (leak->checkingThread_ == threadCheckingNumber) leak->checkingThread_ = 0;
+    unlockAllShards();
+    threadCheckingNumber = 0;
+}
+
+SimpleMutex* MemoryLeakDetector::getShardMutex(char* memory)
+{
+    if (!lockShards_) return NULL;
+    return shardMutexes_[memoryTable_.getShard(memory)];
+}
+
+SimpleMutex* MemoryLeakDetector::getSharedStateMutex()
+{
+    if (!lockShards_) return NULL;
+    return sharedStateMutex_;
+}
+
+void MemoryLeakDetector::sampleAllocations(unsigned samplingRate)
+{
+    samplingRate_ = (samplingRate == 0) ? 1 : samplingRate;
+}
+
+unsigned MemoryLeakDetector::getSamplingRate() const
+{
+    return samplingRate_;
+}
+
+unsigned long MemoryLeakDetector::getNumberOfUntrackedAllocations() const
+{
+    return untrackedAllocations_;
+}
+
+/*
+ * A multiplicative hash of the address picks the sample, so the allocations of the code under
+ * test spread evenly over it. An address is in the sample when its hash is below the share of
+ * the sampling rate, so an address outside the sample of a rate is outside that of higher rates.
+ */
+static bool isInSample(const char* memory, unsigned samplingRate)
+{
+    if (samplingRate <= 1) return true;
+    unsigned long hash = ((unsigned long) ((size_t) memory >> 3) * 2654435761UL) & 0xFFFFFFFFUL;
+    return (hash >> 16) < 0x10000UL / samplingRate;
+}
+
+bool MemoryLeakDetector::wouldTrackAllocationAt(const char* memory) const
+{
+    return isInSample(memory, samplingRate_);
+}
+
+bool MemoryLeakDetector::shouldTrackAllocationAt(char* memory)
+{
+    if (isInSample(memory, samplingRate_)) return true;
+
+    ScopedMutexLock lock(getSharedStateMutex());
+    untrackedAllocations_++;
+    if (untrackedSamplingRate_ < samplingRate_) untrackedSamplingRate_ = samplingRate_;
+    return false;
+}
+
+/* The highest rate untracked memory was allocated with leaves out all of it */
+bool MemoryLeakDetector::mayBeUntracked(char* memory)
+{
+    ScopedMutexLock lock(getSharedStateMutex());
+    return untrackedDeallocations_ < untrackedAllocations_ && !isInSample(memory, untrackedSamplingRate_);
+}
+
+void MemoryLeakDetector::countUntrackedDeallocation()
+{
+    ScopedMutexLock lock(getSharedStateMutex());
+    untrackedDeallocations_++;
+}
+
+/* Otherwise untracked memory left over from an earlier test would let any later free of unknown memory pass */
+void MemoryLeakDetector::restartCountingUntrackedMemory()
+{
+    ScopedMutexLock lock(getSharedStateMutex());
+    untrackedAllocations_ = 0;
+    untrackedDeallocations_ = 0;
+    untrackedSamplingRate_ = samplingRate_;
+}
+
+void MemoryLeakDetector::captureCallStacks(int depth)
+{
+    if (depth < 0) depth = 0;
+    if (depth > max_call_stack_depth) depth = max_call_stack_depth;
+    callStackDepth_ = depth;
+}
+
+void MemoryLeakDetector::streamReportTo(MemoryLeakReportSink* sink)
+{
+    outputBuffer_.streamReportTo(sink);
+}
+
+void MemoryLeakDetector::setLeakDumpSize(size_t leakDumpSize)
+{
+    leakDumpSize_ = leakDumpSize;
+    outputBuffer_.setLeakDumpSize(leakDumpSize);
+}
+
+int MemoryLeakDetector::getCallStackDepth() const
+{
+    return callStackDepth_;
+}
+
+int MemoryLeakDetector::getNumberOfCallStacks()
+{
+    ScopedMutexLock lock(getSharedStateMutex());
+    return callStacks_.getNumberOfStacks();
+}
+
+/* Captures enough frames for the frames of the detector to not count against the depth */
+MemoryLeakCallStack* MemoryLeakDetector::captureCallStack()
+{
+    void* frames[max_call_stack_depth + max_frames_of_the_detector];
+    int depth = PlatformSpecificBacktrace(frames, callStackDepth_ + max_frames_of_the_detector);
+    if (depth <= 0) return 0;
+
+    ScopedMutexLock lock(getSharedStateMutex());
+    int framesOfTheDetector = callStacks_.countFramesOfTheDetector(frames, depth);
+    depth -= framesOfTheDetector;
+    if (depth > callStackDepth_) depth = callStackDepth_;
+    return callStacks_.intern(frames + framesOfTheDetector, depth);
+}
+
+unsigned MemoryLeakDetector::nextAllocationNumber()
+{
+    ScopedMutexLock lock(getSharedStateMutex());
+    return allocationSequenceNumber_++;
+}
+
+void MemoryLeakDetector::disableNodePool()
+{
+    useNodePool_ = false;
+}
+
+void MemoryLeakDetector::enableNodePool()
+{
+    useNodePool_ = true;
+}
+
+unsigned MemoryLeakDetector::getCurrentAllocationNumber()
+{
+    return allocationSequenceNumber_;
 }
 
 static size_t calculateVoidPointerAlignedSize(size_t size)
@@ -496,8 +1196,10 @@ MemoryLeakDetectorNode* MemoryLeakDetector::getNodeFromMemoryPointer(char* memor
 
 void MemoryLeakDetector::storeLeakInformation(MemoryLeakDetectorNode * node, char *new_memory, size_t size, TestMemoryAllocator *allocator, const char *file, int line)
 {
-    node->init(new_memory, allocationSequenceNumber_++, size, allocator, current_period_, file, line);
-    addMemoryCorruptionInformation(node->memory_ + node->size_);
+    node->init(new_memory, nextAllocationNumber(), size, allocator, current_period_, file, line);
+    if (threadIsChecking) node->checkingThread_ = threadCheckingNumber;
+    if (callStackDepth_ > 0) node->callStack_ = captureCallStack();
+    if (!allocator->guardsMemoryBounds()) addMemoryCorruptionInformation(node->memory_ + node->size_);
     memoryTable_.addNewNode(node);
 }
 
@@ -506,6 +1208,7 @@ char* MemoryLeakDetector::reallocateMemoryAndLeakInformation(TestMemoryAllocator
     char* new_memory = reallocateMemoryWithAccountingInformation(allocator, memory, size, file, line, allocatNodesSeperately);
     if (new_memory == NULL) return NULL;
 
+    ScopedMutexLock lock(getShardMutex(new_memory));
     MemoryLeakDetectorNode *node = createMemoryLeakAccountingInformation(allocator, size, new_memory, allocatNodesSeperately);
     storeLeakInformation(node, new_memory, size, allocator, file, line);
     return node->memory_;
@@ -513,6 +1216,7 @@ char* MemoryLeakDetector::reallocateMemoryAndLeakInformation(TestMemoryAllocator
 
 void MemoryLeakDetector::invalidateMemory(char* memory)
 {
+  ScopedMutexLock lock(getShardMutex(memory));
   MemoryLeakDetectorNode* node = memoryTable_.retrieveNode(memory);
   if (node)
     PlatformSpecificMemset(memory, 0xCD, node->size_);
@@ -539,12 +1243,16 @@ bool MemoryLeakDetector::matchingAllocation(TestMemoryAllocator *alloc_allocator
 
 void MemoryLeakDetector::checkForCorruption(MemoryLeakDetectorNode* node, const char* file, int line, TestMemoryAllocator* allocator, bool allocateNodesSeperately)
 {
-    if (!matchingAllocation(node->allocator_, allocator))
+    if (!matchingAllocation(node->allocator_, allocator)) {
+        ScopedMutexLock lock(getSharedStateMutex());
         outputBuffer_.reportAllocationDeallocationMismatchFailure(node, file, line, allocator, reporter_);
-    else if (!validMemoryCorruptionInformation(node->memory_ + node->size_))
+    }
+    else if (!node->allocator_->guardsMemoryBounds() && !validMemoryCorruptionInformation(node->memory_ + node->size_)) {
+        ScopedMutexLock lock(getSharedStateMutex());
         outputBuffer_.reportMemoryCorruptionFailure(node, file, line, allocator, reporter_);
+    }
     else if (allocateNodesSeperately)
-        allocator->freeMemoryLeakNode((char*) node);
+        freeSeparateNode(allocator, node);
 }
 
 char* MemoryLeakDetector::allocMemory(TestMemoryAllocator* allocator, size_t size, bool allocatNodesSeperately)
@@ -554,6 +1262,7 @@ char* MemoryLeakDetector::allocMemory(TestMemoryAllocator* allocator, size_t siz
 
 char* MemoryLeakDetector::allocateMemoryWithAccountingInformation(TestMemoryAllocator* allocator, size_t size, const char* file, int line, bool allocatNodesSeperately)
 {
+    if (allocator->guardsMemoryBounds()) return allocator->alloc_memory(size, file, line);
     if (allocatNodesSeperately) return allocator->alloc_memory(sizeOfMemoryWithCorruptionInfo(size), file, line);
     else return allocator->alloc_memory(sizeOfMemoryWithCorruptionInfo(size) + sizeof(MemoryLeakDetectorNode), file, line);
 }
@@ -566,10 +1275,24 @@ char* MemoryLeakDetector::reallocateMemoryWithAccountingInformation(TestMemoryAl
 
 MemoryLeakDetectorNode* MemoryLeakDetector::createMemoryLeakAccountingInformation(TestMemoryAllocator* allocator, size_t size, char* memory, bool allocatNodesSeperately)
 {
-    if (allocatNodesSeperately) return (MemoryLeakDetectorNode*) (void*) allocator->allocMemoryLeakNode(sizeof(MemoryLeakDetectorNode));
+    if (allocatNodesSeperately) return allocateSeparateNode(allocator, memory);
     else return getNodeFromMemoryPointer(memory, size);
 }
 
+MemoryLeakDetectorNode* MemoryLeakDetector::allocateSeparateNode(TestMemoryAllocator* allocator, char* memory)
+{
+    if (useNodePool_) return nodePools_[memoryTable_.getShard(memory)].allocNode();
+    return (MemoryLeakDetectorNode*) (void*) allocator->allocMemoryLeakNode(sizeof(MemoryLeakDetectorNode));
+}
+
+void MemoryLeakDetector::freeSeparateNode(TestMemoryAllocator* allocator, MemoryLeakDetectorNode* node)
+{
+    if (useNodePool_) {
+        if (node) nodePools_[memoryTable_.getShard(node->memory_)].freeNode(node);
+    }
+    else allocator->freeMemoryLeakNode((char*) node);
+}
+
 char* MemoryLeakDetector::allocMemory(TestMemoryAllocator* allocator, size_t size, const char* file, int line, bool allocatNodesSeperately)
 {
     /* With malloc, it is harder to guarantee that the allocator free is called.
@@ -579,8 +1302,13 @@ char* MemoryLeakDetector::allocMemory(TestMemoryAllocator* allocator, size_t siz
      * So, for malloc, we'll allocate the memory separately so we can detect this and give a proper error.
      */
 
+    if (allocator->guardsMemoryBounds()) allocatNodesSeperately = true;
+
     char* memory = allocateMemoryWithAccountingInformation(allocator, size, file, line, allocatNodesSeperately);
     if (memory == NULL) return NULL;
+    if (!allocator->guardsMemoryBounds() && !shouldTrackAllocationAt(memory)) return memory;
+
+    ScopedMutexLock lock(getShardMutex(memory));
     MemoryLeakDetectorNode* node = createMemoryLeakAccountingInformation(allocator, size, memory, allocatNodesSeperately);
 
     storeLeakInformation(node, memory, size, allocator, file, line);
@@ -589,23 +1317,40 @@ char* MemoryLeakDetector::allocMemory(TestMemoryAllocator* allocator, size_t siz
 
 void MemoryLeakDetector::removeMemoryLeakInformationWithoutCheckingOrDeallocatingTheMemoryButDeallocatingTheAccountInformation(TestMemoryAllocator* allocator, void* memory, bool allocatNodesSeperately)
 {
+    ScopedMutexLock lock(getShardMutex((char*) memory));
     MemoryLeakDetectorNode* node = memoryTable_.removeNode((char*) memory);
-    if (allocatNodesSeperately) allocator->freeMemoryLeakNode( (char*) node);
+    if (allocatNodesSeperately || (node && node->allocator_->guardsMemoryBounds())) freeSeparateNode(allocator, node);
+}
+
+/* Guarded memory is always tracked, so untracked memory never needs a guard page allocator to free it */
+static TestMemoryAllocator* allocatorOfUntrackedMemory(TestMemoryAllocator* allocator)
+{
+    return allocator->guardsMemoryBounds() ? defaultMallocAllocator() : allocator;
 }
 
 void MemoryLeakDetector::deallocMemory(TestMemoryAllocator* allocator, void* memory, const char* file, int line, bool allocatNodesSeperately)
 {
     if (memory == 0) return;
 
-    MemoryLeakDetectorNode* node = memoryTable_.removeNode((char*) memory);
-    if (node == NULL) {
-        outputBuffer_.reportDeallocateNonAllocatedMemoryFailure(file, line, allocator, reporter_);
-        return;
-    }
-    if (!allocator->hasBeenDestroyed()) {
-        checkForCorruption(node, file, line, allocator, allocatNodesSeperately);
-        allocator->free_memory((char*) memory, file, line);
+    TestMemoryAllocator* deallocator = allocator;
+    {
+        ScopedMutexLock lock(getShardMutex((char*) memory));
+        MemoryLeakDetectorNode* node = memoryTable_.removeNode((char*) memory);
+        if (node == NULL && mayBeUntracked((char*) memory)) {
+            countUntrackedDeallocation();
+            allocatorOfUntrackedMemory(allocator)->free_memory((char*) memory, file, line);
+            return;
+        }
+        if (node == NULL) {
+            ScopedMutexLock sharedStateLock(getSharedStateMutex());
+            outputBuffer_.reportDeallocateNonAllocatedMemoryFailure(file, line, allocator, reporter_);
+            return;
+        }
+        if (allocator->hasBeenDestroyed()) return;
+        if (mustBeFreedByItsOwnAllocator(node, allocator)) deallocator = node->allocator_;
+        checkForCorruption(node, file, line, allocator, allocatNodesSeperately || node->allocator_->guardsMemoryBounds());
     }
+    deallocator->free_memory((char*) memory, file, line);
 }
 
 void MemoryLeakDetector::deallocMemory(TestMemoryAllocator* allocator, void* memory, bool allocatNodesSeperately)
@@ -613,36 +1358,116 @@ void MemoryLeakDetector::deallocMemory(TestMemoryAllocator* allocator, void* mem
     deallocMemory(allocator, (char*) memory, UNKNOWN, 0, allocatNodesSeperately);
 }
 
+/* Memory of a guard page allocator can only be freed by that allocator, which can only free its own memory */
+bool MemoryLeakDetector::mustBeFreedByItsOwnAllocator(MemoryLeakDetectorNode* node, TestMemoryAllocator* allocator)
+{
+    return node->allocator_->guardsMemoryBounds() || allocator->guardsMemoryBounds();
+}
+
+/* Guarded memory cannot be grown in place, so it is moved to a new allocation */
+char* MemoryLeakDetector::reallocateGuardedMemory(TestMemoryAllocator* allocator, char* memory, size_t size, const char* file, int line, bool allocatNodesSeperately)
+{
+    size_t oldSize = 0;
+    if (memory) {
+        ScopedMutexLock lock(getShardMutex(memory));
+        MemoryLeakDetectorNode* node = memoryTable_.retrieveNode(memory);
+        if (node) oldSize = node->size_;
+    }
+
+    char* new_memory = allocMemory(allocator, size, file, line, allocatNodesSeperately);
+    if (new_memory && memory) PlatformSpecificMemCpy(new_memory, memory, (oldSize < size) ? oldSize : size);
+    deallocMemory(allocator, memory, file, line, allocatNodesSeperately);
+    return new_memory;
+}
+
 char* MemoryLeakDetector::reallocMemory(TestMemoryAllocator* allocator, char* memory, size_t size, const char* file, int line, bool allocatNodesSeperately)
 {
+    bool guardedMemory = allocator->guardsMemoryBounds();
+    bool untrackedMemory = false;
     if (memory) {
-        MemoryLeakDetectorNode* node = memoryTable_.removeNode(memory);
-        if (node == NULL) {
+        ScopedMutexLock lock(getShardMutex(memory));
+        MemoryLeakDetectorNode* node = memoryTable_.retrieveNode(memory);
+        untrackedMemory = node == NULL && mayBeUntracked(memory);
+        if (node == NULL && !untrackedMemory) {
+            ScopedMutexLock sharedStateLock(getSharedStateMutex());
             outputBuffer_.reportDeallocateNonAllocatedMemoryFailure(file, line, allocator, reporter_);
             return NULL;
         }
-        checkForCorruption(node, file, line, allocator, allocatNodesSeperately);
+        guardedMemory = node && (guardedMemory || node->allocator_->guardsMemoryBounds());
+        if (node && !guardedMemory) {
+            node = memoryTable_.removeNode(memory);
+            checkForCorruption(node, file, line, allocator, allocatNodesSeperately);
+        }
     }
+    if (guardedMemory)
+        return reallocateGuardedMemory(allocator, memory, size, file, line, allocatNodesSeperately);
+    if (untrackedMemory)
+        return reallocateUntrackedMemory(allocator, memory, size, file, line, allocatNodesSeperately);
     return reallocateMemoryAndLeakInformation(allocator, memory, size, file, line, allocatNodesSeperately);
 }
 
-void MemoryLeakDetector::ConstructMemoryLeakReport(MemLeakPeriod period)
+/* Untracked memory stays untracked, unless it moves to an address in the sample */
+char* MemoryLeakDetector::reallocateUntrackedMemory(TestMemoryAllocator* allocator, char* memory, size_t size, const char* file, int line, bool allocatNodesSeperately)
+{
+    allocator = allocatorOfUntrackedMemory(allocator);
+    char* new_memory = reallocateMemoryWithAccountingInformation(allocator, memory, size, file, line, allocatNodesSeperately);
+    if (new_memory == NULL || !isInSample(new_memory, samplingRate_)) return new_memory;
+
+    countUntrackedDeallocation();
+    ScopedMutexLock lock(getShardMutex(new_memory));
+    MemoryLeakDetectorNode *node = createMemoryLeakAccountingInformation(allocator, size, new_memory, allocatNodesSeperately);
+    storeLeakInformation(node, new_memory, size, allocator, file, line);
+    return node->memory_;
+}
+
+/* Only reports the leaks of checkingThread, unless it is 0 */
+void MemoryLeakDetector::ConstructMemoryLeakReport(MemLeakPeriod period, MemoryLeakOutputStringBuffer& buffer, unsigned long checkingThread)
 {
     MemoryLeakDetectorNode* leak = memoryTable_.getFirstLeak(period);
 
-    outputBuffer_.startMemoryLeakReporting();
+    buffer.startMemoryLeakReporting();
+
+    if (callStacks_.getNumberOfStacks() > 0) {
+        reportLeaksGroupedByCallStack(period, buffer, checkingThread);
+        leak = 0;
+    }
 
     while (leak) {
-        outputBuffer_.reportMemoryLeak(leak);
+        if (isLeakOfThread(leak, checkingThread)) buffer.reportMemoryLeak(leak);
         leak = memoryTable_.getNextLeak(leak, period);
     }
 
-    outputBuffer_.stopMemoryLeakReporting();
+    buffer.stopMemoryLeakReporting();
+    if (samplingRate_ > 1) buffer.reportSampledLeakEstimate(samplingRate_);
+}
+
+/* Counts the leaks per stack first, then reports each stack where its first leak is */
+void MemoryLeakDetector::reportLeaksGroupedByCallStack(MemLeakPeriod period, MemoryLeakOutputStringBuffer& buffer, unsigned long checkingThread)
+{
+    MemoryLeakDetectorNode* leak;
+
+    for (leak = memoryTable_.getFirstLeak(period); leak; leak = memoryTable_.getNextLeak(leak, period)) {
+        if (leak->callStack_ == 0 || !isLeakOfThread(leak, checkingThread)) continue;
+        leak->callStack_->leaks_++;
+        leak->callStack_->leakedBytes_ += leak->size_;
+    }
+
+    for (leak = memoryTable_.getFirstLeak(period); leak; leak = memoryTable_.getNextLeak(leak, period)) {
+        MemoryLeakCallStack* stack = leak->callStack_;
+        if (!isLeakOfThread(leak, checkingThread)) continue;
+        if (stack == 0)
+            buffer.reportMemoryLeak(leak);
+        else if (stack->leaks_) {
+            buffer.reportMemoryLeaksWithCallStack(leak, stack->leaks_, stack->leakedBytes_);
+            stack->leaks_ = 0;
+            stack->leakedBytes_ = 0;
+        }
+    }
 }
 
 const char* MemoryLeakDetector::report(MemLeakPeriod period)
 {
-    ConstructMemoryLeakReport(period);
+    ConstructMemoryLeakReport(period, outputBuffer_);
 
     return outputBuffer_.toString();
 }
@@ -654,6 +1479,7 @@ void MemoryLeakDetector::markCheckingPeriodLeaksAsNonCheckingPeriod()
         if (leak->period_ == mem_leak_period_checking) leak->period_ = mem_leak_period_enabled;
         leak = memoryTable_.getNextLeak(leak, mem_leak_period_checking);
     }
+    restartCountingUntrackedMemory();
 }
 
 int MemoryLeakDetector::totalMemoryLeaks(MemLeakPeriod period)
@@ -30,40 +30,14 @@
 #include "CppUTest/MemoryLeakDetector.h"
 #include "CppUTest/TestMemoryAllocator.h"
 #include "CppUTest/PlatformSpecificFunctions.h"
-#include "CppUTest/SimpleMutex.h"
+
+static MemoryLeakFailure* globalReporter = 0;
+static MemoryLeakDetector* globalDetector = 0;
 
 /********** Enabling and disabling for C also *********/
 
 #if CPPUTEST_USE_MEM_LEAK_DETECTION
 
-class MemLeakScopedMutex
-{
-public:
-    MemLeakScopedMutex() : lock(MemoryLeakWarningPlugin::getGlobalDetector()->getMutex()) { }
-private:
-    ScopedMutexLock lock;
-};
-
-static void* threadsafe_mem_leak_malloc(size_t size, const char* file, int line)
-{
-    MemLeakScopedMutex lock;
-    return MemoryLeakWarningPlugin::getGlobalDetector()->allocMemory(getCurrentMallocAllocator(), size, file, line, true);
-}
-
-static void threadsafe_mem_leak_free(void* buffer, const char* file, int line)
-{
-    MemLeakScopedMutex lock;
-    MemoryLeakWarningPlugin::getGlobalDetector()->invalidateMemory((char*) buffer);
-    MemoryLeakWarningPlugin::getGlobalDetector()->deallocMemory(getCurrentMallocAllocator(), (char*) buffer, file, line, true);
-}
-
-static void* threadsafe_mem_leak_realloc(void* memory, size_t size, const char* file, int line)
-{
-    MemLeakScopedMutex lock;
-    return MemoryLeakWarningPlugin::getGlobalDetector()->reallocMemory(getCurrentMallocAllocator(), (char*) memory, size, file, line, true);
-}
-
-
 static void* mem_leak_malloc(size_t size, const char* file, int line)
 {
     return MemoryLeakWarningPlugin::getGlobalDetector()->allocMemory(getCurrentMallocAllocator(), size, file, line, true);
@@ -133,64 +107,6 @@ void cpputest_free_location_with_leak_detection(void* buffer, const char* file,
 #define UT_THROW_BAD_ALLOC_WHEN_NULL(memory)
 #endif
 
-static void* threadsafe_mem_leak_operator_new (size_t size) UT_THROW(std::bad_alloc)
-{
-    MemLeakScopedMutex lock;
-    void* memory = MemoryLeakWarningPlugin::getGlobalDetector()->allocMemory(getCurrentNewAllocator(), size);
-    UT_THROW_BAD_ALLOC_WHEN_NULL(memory);
-    return memory;
-}
-
-static void* threadsafe_mem_leak_operator_new_nothrow (size_t size) UT_NOTHROW
-{
-    MemLeakScopedMutex lock;
-    return MemoryLeakWarningPlugin::getGlobalDetector()->allocMemory(getCurrentNewAllocator(), size);
-}
-
-static void* threadsafe_mem_leak_operator_new_debug (size_t size, const char* file, int line) UT_THROW(std::bad_alloc)
-{
-    MemLeakScopedMutex lock;
-    void *memory = MemoryLeakWarningPlugin::getGlobalDetector()->allocMemory(getCurrentNewAllocator(), size, (char*) file, line);
-    UT_THROW_BAD_ALLOC_WHEN_NULL(memory);
-    return memory;
-}
-
-static void* threadsafe_mem_leak_operator_new_array (size_t size) UT_THROW(std::bad_alloc)
-{
-    MemLeakScopedMutex lock;
-    void* memory = MemoryLeakWarningPlugin::getGlobalDetector()->allocMemory(getCurrentNewArrayAllocator(), size);
-    UT_THROW_BAD_ALLOC_WHEN_NULL(memory);
-    return memory;
-}
-
-static void* threadsafe_mem_leak_operator_new_array_nothrow (size_t size) UT_NOTHROW
-{
-    MemLeakScopedMutex lock;
-    return MemoryLeakWarningPlugin::getGlobalDetector()->allocMemory(getCurrentNewArrayAllocator(), size);
-}
-
-static void* threadsafe_mem_leak_operator_new_array_debug (size_t size, const char* file, int line) UT_THROW(std::bad_alloc)
-{
-    MemLeakScopedMutex lock;
-    void* memory = MemoryLeakWarningPlugin::getGlobalDetector()->allocMemory(getCurrentNewArrayAllocator(), size, (char*) file, line);
-    UT_THROW_BAD_ALLOC_WHEN_NULL(memory);
-    return memory;
-}
-
-static void threadsafe_mem_leak_operator_delete (void* mem) UT_NOTHROW
-{
-    MemLeakScopedMutex lock;
-    MemoryLeakWarningPlugin::getGlobalDetector()->invalidateMemory((char*) mem);
-    MemoryLeakWarningPlugin::getGlobalDetector()->deallocMemory(getCurrentNewAllocator(), (char*) mem);
-}
-
-static void threadsafe_mem_leak_operator_delete_array (void* mem) UT_NOTHROW
-{
-    MemLeakScopedMutex lock;
-    MemoryLeakWarningPlugin::getGlobalDetector()->invalidateMemory((char*) mem);
-    MemoryLeakWarningPlugin::getGlobalDetector()->deallocMemory(getCurrentNewArrayAllocator(), (char*) mem);
-}
-
 
 static void* mem_leak_operator_new (size_t size) UT_THROW(std::bad_alloc)
 {
@@ -419,17 +335,8 @@ bool MemoryLeakWarningPlugin::areNewDeleteOverloaded()
 void MemoryLeakWarningPlugin::turnOnThreadSafeNewDeleteOverloads()
 {
 #if CPPUTEST_USE_MEM_LEAK_DETECTION
-    operator_new_fptr = threadsafe_mem_leak_operator_new;
-    operator_new_nothrow_fptr = threadsafe_mem_leak_operator_new_nothrow;
-    operator_new_debug_fptr = threadsafe_mem_leak_operator_new_debug;
-    operator_new_array_fptr = threadsafe_mem_leak_operator_new_array;
-    operator_new_array_nothrow_fptr = threadsafe_mem_leak_operator_new_array_nothrow;
-    operator_new_array_debug_fptr = threadsafe_mem_leak_operator_new_array_debug;
-    operator_delete_fptr = threadsafe_mem_leak_operator_delete;
-    operator_delete_array_fptr = threadsafe_mem_leak_operator_delete_array;
-    malloc_fptr = threadsafe_mem_leak_malloc;
-    realloc_fptr = threadsafe_mem_leak_realloc;
-    free_fptr = threadsafe_mem_leak_free;
+    turnOnNewDeleteOverloads();
+    getGlobalDetector()->enableShardLocking();
 #endif
 }
 
@@ -456,9 +363,6 @@ public:
     } // LCOV_EXCL_LINE
 };
 
-static MemoryLeakFailure* globalReporter = 0;
-static MemoryLeakDetector* globalDetector = 0;
-
 MemoryLeakDetector* MemoryLeakWarningPlugin::getGlobalDetector()
 {
     if (globalDetector == 0) {
@@ -499,9 +403,11 @@ void MemoryLeakWarningPlugin::destroyGlobalDetector()
 
 
 MemoryLeakWarningPlugin* MemoryLeakWarningPlugin::firstPlugin_ = 0;
+static CPPUTEST_THREAD_LOCAL MemoryLeakWarningPlugin* threadCopyOfFirstPlugin = 0;
 
 MemoryLeakWarningPlugin* MemoryLeakWarningPlugin::getFirstPlugin()
 {
+    if (threadCopyOfFirstPlugin) return threadCopyOfFirstPlugin;
     return firstPlugin_;
 }
 
@@ -521,7 +427,10 @@ void MemoryLeakWarningPlugin::expectLeaksInTest(int n)
 }
 
 MemoryLeakWarningPlugin::MemoryLeakWarningPlugin(const SimpleString& name, MemoryLeakDetector* localDetector) :
-    TestPlugin(name), ignoreAllWarnings_(false), destroyGlobalDetectorAndTurnOfMemoryLeakDetectionInDestructor_(false), expectedLeaks_(0)
+    TestPlugin(name), checkingOnThisThread_(false), ignoreAllWarnings_(false), destroyGlobalDetectorAndTurnOfMemoryLeakDetectionInDestructor_(false), expectedLeaks_(0), failureCount_(0), samplingAllocations_(false), capturingCallStacks_(false),
+    limitingLeakDumps_(false), streamLeakReportsToTestOutput_(false), leakReportSink_(0), leakReportFile_(0),
+    guardPagesInAllTests_(false), allTestsGuardPageMode_(GuardPageMemoryAllocator::detect_overflow), guardingPages_(false),
+    unguardedNewAllocator_(0), unguardedNewArrayAllocator_(0), unguardedMallocAllocator_(0)
 {
     if (firstPlugin_ == 0) firstPlugin_ = this;
 
@@ -531,8 +440,28 @@ MemoryLeakWarningPlugin::MemoryLeakWarningPlugin(const SimpleString& name, Memor
     memLeakDetector_->enable();
 }
 
+MemoryLeakWarningPlugin::MemoryLeakWarningPlugin(MemoryLeakWarningPlugin* original) :
+    TestPlugin(original->getName()), memLeakDetector_(original->memLeakDetector_), checkingOnThisThread_(true), ignoreAllWarnings_(false), destroyGlobalDetectorAndTurnOfMemoryLeakDetectionInDestructor_(false), expectedLeaks_(0), failureCount_(0), samplingAllocations_(false), capturingCallStacks_(false),
+    limitingLeakDumps_(false), streamLeakReportsToTestOutput_(false), leakReportSink_(0), leakReportFile_(0),
+    guardPagesInAllTests_(false), allTestsGuardPageMode_(GuardPageMemoryAllocator::detect_overflow), guardingPages_(false),
+    unguardedNewAllocator_(0), unguardedNewArrayAllocator_(0), unguardedMallocAllocator_(0)
+{
+    if (threadCopyOfFirstPlugin == 0) threadCopyOfFirstPlugin = this;
+}
+
+TestPlugin* MemoryLeakWarningPlugin::createThreadCopy()
+{
+    return new MemoryLeakWarningPlugin(this);
+}
+
 MemoryLeakWarningPlugin::~MemoryLeakWarningPlugin()
 {
+    if (threadCopyOfFirstPlugin == this) threadCopyOfFirstPlugin = 0;
+    if (samplingAllocations_) memLeakDetector_->sampleAllocations(1);
+    if (capturingCallStacks_) memLeakDetector_->captureCallStacks(0);
+    if (limitingLeakDumps_) memLeakDetector_->setLeakDumpSize((size_t) -1);
+    restoreUnguardedAllocators();
+    delete leakReportFile_;
     if (destroyGlobalDetectorAndTurnOfMemoryLeakDetectionInDestructor_) {
         MemoryLeakWarningPlugin::turnOffNewDeleteOverloads();
         MemoryLeakWarningPlugin::destroyGlobalDetector();
@@ -541,29 +470,196 @@ MemoryLeakWarningPlugin::~MemoryLeakWarningPlugin()
 
 void MemoryLeakWarningPlugin::preTestAction(UtestShell& /*test*/, TestResult& result)
 {
+    if (checkingOnThisThread_) {
+        memLeakDetector_->startCheckingOnThisThread();
+        failureCount_ = result.getFailureCount();
+        return;
+    }
     memLeakDetector_->startChecking();
     failureCount_ = result.getFailureCount();
+    if (guardPagesInAllTests_) guardPagesInTest(allTestsGuardPageMode_);
 }
 
 void MemoryLeakWarningPlugin::postTestAction(UtestShell& test, TestResult& result)
 {
+    if (checkingOnThisThread_) {
+        postTestActionOnThisThread(test, result);
+        return;
+    }
     memLeakDetector_->stopChecking();
     int leaks = memLeakDetector_->totalMemoryLeaks(mem_leak_period_checking);
 
-    if (!ignoreAllWarnings_ && expectedLeaks_ != leaks && failureCount_ == result.getFailureCount()) {
+    if (!ignoreAllWarnings_ && !leaksAsExpected(leaks, expectedLeaks_) && failureCount_ == result.getFailureCount()) {
+        TestResultMemoryLeakReportSink outputSink(result);
+        if (streamLeakReportsToTestOutput_) memLeakDetector_->streamReportTo(&outputSink);
+        else if (leakReportSink_) memLeakDetector_->streamReportTo(leakReportSink_);
+
         TestFailure f(&test, memLeakDetector_->report(mem_leak_period_checking));
+        if (streamLeakReportsToTestOutput_ || leakReportSink_) memLeakDetector_->streamReportTo(NULL);
         result.addFailure(f);
     }
     memLeakDetector_->markCheckingPeriodLeaksAsNonCheckingPeriod();
     ignoreAllWarnings_ = false;
     expectedLeaks_ = 0;
+    restoreUnguardedAllocators();
+}
+
+void MemoryLeakWarningPlugin::postTestActionOnThisThread(UtestShell& test, TestResult& result)
+{
+    memLeakDetector_->stopCheckingOnThisThread();
+    int leaks = memLeakDetector_->totalMemoryLeaksOnThisThread();
+
+    if (!ignoreAllWarnings_ && !leaksAsExpected(leaks, expectedLeaks_) && failureCount_ == result.getFailureCount()) {
+        MemoryLeakOutputStringBuffer buffer;
+        TestFailure f(&test, memLeakDetector_->reportOnThisThread(buffer));
+        result.addFailure(f);
+    }
+    memLeakDetector_->markLeaksOnThisThreadAsChecked();
+    ignoreAllWarnings_ = false;
+    expectedLeaks_ = 0;
+}
+
+bool MemoryLeakWarningPlugin::parseArguments(int /* ac */, const char** av, int index)
+{
+    SimpleString argument(av[index]);
+    if (argument.startsWith("-pleaksampling=")) {
+        int samplingRate = SimpleString::AtoI(argument.subString(sizeof("-pleaksampling=") - 1, argument.size()).asCharString());
+        if (samplingRate <= 0) return false;
+        sampleAllocations((unsigned) samplingRate);
+        return true;
+    }
+    if (argument.startsWith("-pleakstacks=")) {
+        int depth = SimpleString::AtoI(argument.subString(sizeof("-pleakstacks=") - 1, argument.size()).asCharString());
+        if (depth <= 0) return false;
+        captureCallStacks(depth);
+        return true;
+    }
+    if (argument == "-pleakstream") {
+        streamLeakReportsToTestOutput();
+        return true;
+    }
+    if (argument.startsWith("-pleakstream=")) {
+        delete leakReportFile_;
+        leakReportFile_ = new FileMemoryLeakReportSink(av[index] + sizeof("-pleakstream=") - 1);
+        streamLeakReportsTo(leakReportFile_);
+        return true;
+    }
+    if (argument == "-pguardpages=overflow" || argument == "-pguardpages=underflow") {
+        guardPagesInAllTests(argument.contains("underflow") ? GuardPageMemoryAllocator::detect_underflow : GuardPageMemoryAllocator::detect_overflow);
+        return true;
+    }
+    if (argument.startsWith("-pleakdump=")) {
+        const char* leakDumpSize = av[index] + sizeof("-pleakdump=") - 1;
+        if (*leakDumpSize < '0' || *leakDumpSize > '9') return false;
+        setLeakDumpSize((size_t) SimpleString::AtoI(leakDumpSize));
+        return true;
+    }
+    return false;
+}
+
+void MemoryLeakWarningPlugin::streamLeakReportsTo(MemoryLeakReportSink* sink)
+{
+    streamLeakReportsToTestOutput_ = false;
+    leakReportSink_ = sink;
+}
+
+void MemoryLeakWarningPlugin::streamLeakReportsToTestOutput()
+{
+    streamLeakReportsToTestOutput_ = true;
+}
+
+void MemoryLeakWarningPlugin::setLeakDumpSize(size_t leakDumpSize)
+{
+    limitingLeakDumps_ = true;
+    memLeakDetector_->setLeakDumpSize(leakDumpSize);
+}
+
+/* Named like the standard allocators, so memory can be freed by either without a type mismatch */
+struct GuardPageAllocators
+{
+    GuardPageAllocators(GuardPageMemoryAllocator::Mode mode) :
+        newAllocator(mode, defaultNewAllocator()->name(), defaultNewAllocator()->alloc_name(), defaultNewAllocator()->free_name()),
+        newArrayAllocator(mode, defaultNewArrayAllocator()->name(), defaultNewArrayAllocator()->alloc_name(), defaultNewArrayAllocator()->free_name()),
+        mallocAllocator(mode, defaultMallocAllocator()->name(), defaultMallocAllocator()->alloc_name(), defaultMallocAllocator()->free_name())
+    {
+    }
+
+    GuardPageMemoryAllocator newAllocator;
+    GuardPageMemoryAllocator newArrayAllocator;
+    GuardPageMemoryAllocator mallocAllocator;
+};
+
+static GuardPageAllocators& guardPageAllocators(GuardPageMemoryAllocator::Mode mode)
+{
+    static GuardPageAllocators overflowAllocators(GuardPageMemoryAllocator::detect_overflow);
+    static GuardPageAllocators underflowAllocators(GuardPageMemoryAllocator::detect_underflow);
+    return (mode == GuardPageMemoryAllocator::detect_underflow) ? underflowAllocators : overflowAllocators;
+}
+
+void MemoryLeakWarningPlugin::guardPagesInTest(GuardPageMemoryAllocator::Mode mode)
+{
+    if (checkingOnThisThread_)
+        FAIL("Guard pages change the allocators of all threads, they are not available in tests that run on threads");
+
+    if (!guardingPages_) {
+        unguardedNewAllocator_ = getCurrentNewAllocator();
+        unguardedNewArrayAllocator_ = getCurrentNewArrayAllocator();
+        unguardedMallocAllocator_ = getCurrentMallocAllocator();
+        guardingPages_ = true;
+    }
+
+    GuardPageAllocators& allocators = guardPageAllocators(mode);
+    setCurrentNewAllocator(&allocators.newAllocator);
+    setCurrentNewArrayAllocator(&allocators.newArrayAllocator);
+    setCurrentMallocAllocator(&allocators.mallocAllocator);
+}
+
+void MemoryLeakWarningPlugin::guardPagesInAllTests(GuardPageMemoryAllocator::Mode mode)
+{
+    guardPagesInAllTests_ = true;
+    allTestsGuardPageMode_ = mode;
+}
+
+void MemoryLeakWarningPlugin::restoreUnguardedAllocators()
+{
+    if (!guardingPages_) return;
+
+    setCurrentNewAllocator(unguardedNewAllocator_);
+    setCurrentNewArrayAllocator(unguardedNewArrayAllocator_);
+    setCurrentMallocAllocator(unguardedMallocAllocator_);
+    guardingPages_ = false;
+}
+
+void MemoryLeakWarningPlugin::sampleAllocations(unsigned samplingRate)
+{
+    samplingAllocations_ = samplingRate > 1;
+    memLeakDetector_->sampleAllocations(samplingRate);
+}
+
+void MemoryLeakWarningPlugin::captureCallStacks(int depth)
+{
+    capturingCallStacks_ = depth > 0;
+    memLeakDetector_->captureCallStacks(depth);
+}
+
+/* A sample finds at most the leaks there are, so fewer than expected is fine when sampling */
+bool MemoryLeakWarningPlugin::leaksAsExpected(int leaks, int expectedLeaks)
+{
+    if (memLeakDetector_->getSamplingRate() > 1) return leaks <= expectedLeaks;
+    return leaks == expectedLeaks;
 }
 
 const char* MemoryLeakWarningPlugin::FinalReport(int toBeDeletedLeaks)
 {
     int leaks = memLeakDetector_->totalMemoryLeaks(mem_leak_period_enabled);
-    if (leaks != toBeDeletedLeaks) return memLeakDetector_->report(mem_leak_period_enabled);
-    return "";
+    if (leaksAsExpected(leaks, toBeDeletedLeaks)) return "";
+
+    if (leakReportSink_ == 0) return memLeakDetector_->report(mem_leak_period_enabled);
+
+    memLeakDetector_->streamReportTo(leakReportSink_);
+    const char* report = memLeakDetector_->report(mem_leak_period_enabled);
+    memLeakDetector_->streamReportTo(NULL);
+    return report;
 }
 
 
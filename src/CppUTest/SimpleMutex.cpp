@@ -52,12 +52,12 @@ void SimpleMutex::Unlock(void)
 ScopedMutexLock::ScopedMutexLock(SimpleMutex *mtx) :
     mutex(mtx)
 {
-    mutex->Lock();
+    if (mutex) mutex->Lock();
 }
 
 ScopedMutexLock::~ScopedMutexLock()
 {
-    mutex->Unlock();
+    if (mutex) mutex->Unlock();
 }
 
 
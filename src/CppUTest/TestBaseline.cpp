@@ -0,0 +1,407 @@
+/*
+ * Copyright (c) 2007, Michael Feathers, James Grenning and Bas Vodde
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE EARLIER MENTIONED AUTHORS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestBaseline.h"
+#include "CppUTest/PlatformSpecificFunctions.h"
+
+/*
+ * The baseline file has one test per line: "<group> <name> <nanoseconds> <standard deviation> <samples>"
+ */
+
+static const double minimumRegressionOfSingleTimingInNanos = 1000000.0;
+
+static const unsigned long numberOfBuckets = 1024;
+
+static unsigned long bucketOf(const SimpleString& group, const SimpleString& name)
+{
+    unsigned long hash = 2166136261UL;
+    for (const char* characters = group.asCharString(); *characters; characters++)
+        hash = ((hash ^ (unsigned char) *characters) * 16777619UL) & 0xFFFFFFFFUL;
+    for (const char* characters = name.asCharString(); *characters; characters++)
+        hash = ((hash ^ (unsigned char) *characters) * 16777619UL) & 0xFFFFFFFFUL;
+    return hash % numberOfBuckets;
+}
+
+struct TestBaselineEntry
+{
+    TestBaselineEntry(const SimpleString& group, const SimpleString& name, TestBaselineEntry* nextInBucket)
+        : group_(group), name_(name), nanos_(0.0), standardDeviation_(0.0), numberOfSamples_(0), nextInBucket_(nextInBucket), next_(NULL)
+    {
+    }
+
+    SimpleString group_;
+    SimpleString name_;
+    double nanos_;
+    double standardDeviation_;
+    int numberOfSamples_;
+    TestBaselineEntry* nextInBucket_;
+    TestBaselineEntry* next_;
+};
+
+/* Hashed like TestDurations, as record and checkForRegression look up every test of the run */
+struct TestBaselineEntries
+{
+    TestBaselineEntries()
+        : buckets_(new TestBaselineEntry*[numberOfBuckets]), first_(NULL), count_(0)
+    {
+        for (unsigned long i = 0; i < numberOfBuckets; i++)
+            buckets_[i] = NULL;
+    }
+
+    ~TestBaselineEntries()
+    {
+        while (first_) {
+            TestBaselineEntry* next = first_->next_;
+            delete first_;
+            first_ = next;
+        }
+        delete [] buckets_;
+    }
+
+    TestBaselineEntry* find(const SimpleString& group, const SimpleString& name) const
+    {
+        for (TestBaselineEntry* entry = buckets_[bucketOf(group, name)]; entry; entry = entry->nextInBucket_)
+            if (entry->name_ == name && entry->group_ == group) return entry;
+        return NULL;
+    }
+
+    void set(const SimpleString& group, const SimpleString& name, double nanos, double standardDeviation, int numberOfSamples)
+    {
+        TestBaselineEntry* entry = find(group, name);
+        if (entry == NULL) {
+            unsigned long bucket = bucketOf(group, name);
+            entry = new TestBaselineEntry(group, name, buckets_[bucket]);
+            buckets_[bucket] = entry;
+            entry->next_ = first_;
+            first_ = entry;
+            count_++;
+        }
+        entry->nanos_ = nanos;
+        entry->standardDeviation_ = standardDeviation;
+        entry->numberOfSamples_ = numberOfSamples;
+    }
+
+    TestBaselineEntry** buckets_;
+    /* Newest first */
+    TestBaselineEntry* first_;
+    int count_;
+
+private:
+    TestBaselineEntries(const TestBaselineEntries&);
+    TestBaselineEntries& operator=(const TestBaselineEntries&);
+};
+
+static bool readLine(PlatformSpecificFile file, SimpleString& line)
+{
+    char buffer[256];
+    line = "";
+    while (PlatformSpecificFGets(buffer, (int) sizeof(buffer), file) != NULL) {
+        line += buffer;
+        if (line.endsWith("\n")) {
+            line = line.subString(0, line.size() - 1);
+            return true;
+        }
+    }
+    return !line.isEmpty();
+}
+
+static SimpleString readField(const char*& current)
+{
+    while (*current == ' ') current++;
+    const char* start = current;
+    while (*current && *current != ' ') current++;
+    return SimpleString(start).subString(0, (size_t) (current - start));
+}
+
+static bool parseDouble(const SimpleString& field, double& value)
+{
+    const char* characters = field.asCharString();
+    if (*characters < '0' || *characters > '9') return false;
+
+    value = 0.0;
+    for (; *characters >= '0' && *characters <= '9'; characters++)
+        value = value * 10.0 + (*characters - '0');
+    if (*characters == '.') {
+        double scale = 0.1;
+        for (characters++; *characters >= '0' && *characters <= '9'; characters++, scale /= 10.0)
+            value += scale * (*characters - '0');
+    }
+    return *characters == '\0';
+}
+
+TestBaseline::TestBaseline()
+    : loaded_(new TestBaselineEntries), recorded_(new TestBaselineEntries), threshold_(10)
+{
+}
+
+TestBaseline::~TestBaseline()
+{
+    delete loaded_;
+    delete recorded_;
+}
+
+void TestBaseline::setThreshold(int percentage)
+{
+    threshold_ = percentage;
+}
+
+int TestBaseline::getThreshold() const
+{
+    return threshold_;
+}
+
+bool TestBaseline::load(const SimpleString& fileName)
+{
+    PlatformSpecificFile file = PlatformSpecificFOpen(fileName.asCharString(), "r");
+    if (file == NULL) return false;
+
+    SimpleString line;
+    while (readLine(file, line)) {
+        const char* current = line.asCharString();
+        SimpleString group = readField(current);
+        SimpleString name = readField(current);
+        double nanos, standardDeviation, numberOfSamples;
+        if (parseDouble(readField(current), nanos) && parseDouble(readField(current), standardDeviation) && parseDouble(readField(current), numberOfSamples))
+            loaded_->set(group, name, nanos, standardDeviation, (int) numberOfSamples);
+    }
+    PlatformSpecificFClose(file);
+    return true;
+}
+
+bool TestBaseline::save(const SimpleString& fileName) const
+{
+    PlatformSpecificFile file = PlatformSpecificFOpen(fileName.asCharString(), "w");
+    if (file == NULL) return false;
+
+    for (TestBaselineEntry* entry = recorded_->first_; entry; entry = entry->next_) {
+        SimpleString line = StringFromFormat("%s %s %.3f %.3f %d\n", entry->group_.asCharString(), entry->name_.asCharString(),
+                entry->nanos_, entry->standardDeviation_, entry->numberOfSamples_);
+        PlatformSpecificFPuts(line.asCharString(), file);
+    }
+    PlatformSpecificFClose(file);
+    return true;
+}
+
+void TestBaseline::record(const UtestShell& test, double nanos, double standardDeviation, int numberOfSamples)
+{
+    recorded_->set(test.getGroup(), test.getName(), nanos, standardDeviation, numberOfSamples);
+}
+
+SimpleString TestBaseline::checkForRegression(const UtestShell& test, double nanos) const
+{
+    TestBaselineEntry* entry = loaded_->find(test.getGroup(), test.getName());
+    if (entry == NULL) return "";
+
+    double allowed = entry->nanos_ * threshold_ / 100.0;
+    double noise = (entry->numberOfSamples_ > 1) ? 3.0 * entry->standardDeviation_ : minimumRegressionOfSingleTimingInNanos;
+    if (noise > allowed) allowed = noise;
+    if (nanos - entry->nanos_ <= allowed) return "";
+
+    return StringFromFormat("Performance regression: %.3f ns against a baseline of %.3f ns (more than %d%% and the noise allow)",
+            nanos, entry->nanos_, threshold_);
+}
+
+int TestBaseline::getNumberOfLoadedTests() const
+{
+    return loaded_->count_;
+}
+
+int TestBaseline::getNumberOfRecordedTests() const
+{
+    return recorded_->count_;
+}
+
+/*
+ * The durations file has one test per line: "<group> <name> <nanoseconds>"
+ */
+
+struct TestDurationsEntry
+{
+    TestDurationsEntry(const SimpleString& group, const SimpleString& name, TestDurationsEntry* nextInBucket)
+        : group_(group), name_(name), nanos_(0.0), measured_(false), shard_(-1), nextInBucket_(nextInBucket), next_(NULL)
+    {
+    }
+
+    SimpleString group_;
+    SimpleString name_;
+    double nanos_;
+    bool measured_;
+    int shard_;
+    TestDurationsEntry* nextInBucket_;
+    TestDurationsEntry* next_;
+};
+
+TestDurations::TestDurations()
+    : buckets_(new TestDurationsEntry*[numberOfBuckets]), first_(NULL), last_(NULL), numberOfMeasuredTests_(0), totalNanos_(0.0)
+{
+    for (unsigned long i = 0; i < numberOfBuckets; i++)
+        buckets_[i] = NULL;
+}
+
+TestDurations::~TestDurations()
+{
+    while (first_) {
+        TestDurationsEntry* next = first_->next_;
+        delete first_;
+        first_ = next;
+    }
+    delete [] buckets_;
+}
+
+TestDurationsEntry* TestDurations::findEntry(const SimpleString& group, const SimpleString& name) const
+{
+    for (TestDurationsEntry* entry = buckets_[bucketOf(group, name)]; entry; entry = entry->nextInBucket_)
+        if (entry->name_ == name && entry->group_ == group) return entry;
+    return NULL;
+}
+
+TestDurationsEntry* TestDurations::findOrAddEntry(const SimpleString& group, const SimpleString& name)
+{
+    TestDurationsEntry* entry = findEntry(group, name);
+    if (entry) return entry;
+
+    unsigned long bucket = bucketOf(group, name);
+    entry = new TestDurationsEntry(group, name, buckets_[bucket]);
+    buckets_[bucket] = entry;
+    if (last_) last_->next_ = entry;
+    else first_ = entry;
+    last_ = entry;
+    return entry;
+}
+
+void TestDurations::setNanos(TestDurationsEntry* entry, double nanos)
+{
+    if (entry->measured_) totalNanos_ -= entry->nanos_;
+    else numberOfMeasuredTests_++;
+    entry->nanos_ = nanos;
+    entry->measured_ = true;
+    totalNanos_ += nanos;
+}
+
+bool TestDurations::load(const SimpleString& fileName)
+{
+    PlatformSpecificFile file = PlatformSpecificFOpen(fileName.asCharString(), "r");
+    if (file == NULL) return false;
+
+    SimpleString line;
+    while (readLine(file, line)) {
+        const char* current = line.asCharString();
+        SimpleString group = readField(current);
+        SimpleString name = readField(current);
+        double nanos;
+        if (parseDouble(readField(current), nanos))
+            setNanos(findOrAddEntry(group, name), nanos);
+    }
+    PlatformSpecificFClose(file);
+    return true;
+}
+
+bool TestDurations::save(const SimpleString& fileName) const
+{
+    PlatformSpecificFile file = PlatformSpecificFOpen(fileName.asCharString(), "w");
+    if (file == NULL) return false;
+
+    for (TestDurationsEntry* entry = first_; entry; entry = entry->next_) {
+        if (!entry->measured_) continue;
+        SimpleString line = StringFromFormat("%s %s %.0f\n", entry->group_.asCharString(), entry->name_.asCharString(), entry->nanos_);
+        PlatformSpecificFPuts(line.asCharString(), file);
+    }
+    PlatformSpecificFClose(file);
+    return true;
+}
+
+void TestDurations::record(const UtestShell& test, double nanos)
+{
+    setNanos(findOrAddEntry(test.getGroup(), test.getName()), nanos);
+}
+
+double TestDurations::getExpectedNanos(const UtestShell& test) const
+{
+    TestDurationsEntry* entry = findEntry(test.getGroup(), test.getName());
+    if (entry && entry->measured_) return entry->nanos_;
+    return (numberOfMeasuredTests_ > 0) ? totalNanos_ / numberOfMeasuredTests_ : 0.0;
+}
+
+int TestDurations::getNumberOfTests() const
+{
+    return numberOfMeasuredTests_;
+}
+
+void TestDurations::packIntoShards(UtestShell** tests, int numberOfTests, int shardCount)
+{
+    int* order = new int[(size_t) numberOfTests + 1];
+    double* nanos = new double[(size_t) numberOfTests + 1];
+    double* shardNanos = new double[(size_t) shardCount];
+    for (int i = 0; i < numberOfTests; i++)
+        nanos[i] = getExpectedNanos(*tests[i]);
+    for (int shard = 0; shard < shardCount; shard++)
+        shardNanos[shard] = 0.0;
+
+    sortLongestFirst(order, nanos, numberOfTests);
+    for (int i = 0; i < numberOfTests; i++) {
+        int leastLoaded = 0;
+        for (int shard = 1; shard < shardCount; shard++)
+            if (shardNanos[shard] < shardNanos[leastLoaded]) leastLoaded = shard;
+        shardNanos[leastLoaded] += nanos[order[i]];
+        findOrAddEntry(tests[order[i]]->getGroup(), tests[order[i]]->getName())->shard_ = leastLoaded;
+    }
+
+    delete [] shardNanos;
+    delete [] nanos;
+    delete [] order;
+}
+
+int TestDurations::getShard(const UtestShell& test) const
+{
+    TestDurationsEntry* entry = findEntry(test.getGroup(), test.getName());
+    return entry ? entry->shard_ : -1;
+}
+
+/* Bottom-up merge sort, so tests of equal length keep their registry order */
+void TestDurations::sortLongestFirst(int* order, const double* nanos, int count)
+{
+    for (int i = 0; i < count; i++)
+        order[i] = i;
+
+    int* merged = new int[(size_t) count + 1];
+    for (int width = 1; width < count; width *= 2) {
+        for (int start = 0; start < count; start += 2 * width) {
+            int middle = (start + width < count) ? start + width : count;
+            int end = (start + 2 * width < count) ? start + 2 * width : count;
+            int left = start, right = middle, target = start;
+            while (left < middle && right < end)
+                merged[target++] = (nanos[order[right]] > nanos[order[left]]) ? order[right++] : order[left++];
+            while (left < middle) merged[target++] = order[left++];
+            while (right < end) merged[target++] = order[right++];
+        }
+        for (int i = 0; i < count; i++)
+            order[i] = merged[i];
+    }
+    delete [] merged;
+}
@@ -88,3 +88,203 @@ SimpleString StringFrom(const TestFilter& filter)
     return filter.asString();
 }
 
+
+struct TestFilterMatcherNode
+{
+    int firstChild_;
+    int nextSibling_;
+    int failure_;
+    char character_;
+    bool endsPattern_;
+};
+
+/* Walks "group.name" without joining it, or just the name when there is no group */
+class TestFilterMatcherName
+{
+public:
+    TestFilterMatcherName(const char* group, const char* name)
+        : name_(name), current_(group ? group : name), inGroup_(group != NULL)
+    {
+    }
+
+    char next()
+    {
+        if (*current_) return *current_++;
+        if (!inGroup_) return '\0';
+        inGroup_ = false;
+        current_ = name_;
+        return '.';
+    }
+
+private:
+    const char* name_;
+    const char* current_;
+    bool inGroup_;
+};
+
+static size_t hashOfName(TestFilterMatcherName characters)
+{
+    unsigned long hash = 2166136261UL;
+    for (char character = characters.next(); character; character = characters.next())
+        hash = ((hash ^ (unsigned char) character) * 16777619UL) & 0xFFFFFFFFUL;
+    return (size_t) hash;
+}
+
+static bool isSameName(const char* text, TestFilterMatcherName characters)
+{
+    for (char character = characters.next(); character; character = characters.next())
+        if (*text++ != character) return false;
+    return *text == '\0';
+}
+
+TestFilterMatcher::TestFilterMatcher()
+    : matchesEverything_(true), strictNames_(NULL), strictSlots_(NULL), numberOfStrictSlots_(0), nodes_(NULL), numberOfNodes_(0)
+{
+}
+
+TestFilterMatcher::~TestFilterMatcher()
+{
+    clear();
+}
+
+void TestFilterMatcher::clear()
+{
+    delete [] strictNames_;
+    delete [] strictSlots_;
+    delete [] nodes_;
+    strictNames_ = NULL;
+    strictSlots_ = NULL;
+    numberOfStrictSlots_ = 0;
+    nodes_ = NULL;
+    numberOfNodes_ = 0;
+    matchesEverything_ = true;
+}
+
+void TestFilterMatcher::compile(const TestFilter* filters)
+{
+    clear();
+    if (filters == NULL) return;
+    matchesEverything_ = false;
+
+    int numberOfStrictNames = 0;
+    size_t totalPatternLength = 0;
+    for (const TestFilter* filter = filters; filter; filter = filter->getNext()) {
+        if (filter->strictMatching_) numberOfStrictNames++;
+        else totalPatternLength += filter->filter_.size();
+    }
+
+    numberOfStrictSlots_ = 16;
+    while (numberOfStrictSlots_ < 2 * (size_t) numberOfStrictNames)
+        numberOfStrictSlots_ *= 2;
+    strictNames_ = new SimpleString[numberOfStrictNames + 1];
+    strictSlots_ = new int[numberOfStrictSlots_];
+    for (size_t slot = 0; slot < numberOfStrictSlots_; slot++)
+        strictSlots_[slot] = -1;
+
+    nodes_ = new TestFilterMatcherNode[totalPatternLength + 1];
+    nodes_[0].firstChild_ = -1;
+    nodes_[0].nextSibling_ = -1;
+    nodes_[0].failure_ = 0;
+    nodes_[0].character_ = '\0';
+    nodes_[0].endsPattern_ = false;
+    numberOfNodes_ = 1;
+
+    int strictIndex = 0;
+    for (const TestFilter* filter = filters; filter; filter = filter->getNext()) {
+        if (filter->strictMatching_) addStrictName(filter->filter_, strictIndex++);
+        else addPattern(filter->filter_);
+    }
+    linkFailureTransitions();
+}
+
+void TestFilterMatcher::addStrictName(const SimpleString& name, int index)
+{
+    strictNames_[index] = name;
+    size_t slot = hashOfName(TestFilterMatcherName(NULL, name.asCharString())) & (numberOfStrictSlots_ - 1);
+    while (strictSlots_[slot] != -1)
+        slot = (slot + 1) & (numberOfStrictSlots_ - 1);
+    strictSlots_[slot] = index;
+}
+
+bool TestFilterMatcher::isStrictName(const char* group, const char* name) const
+{
+    for (size_t slot = hashOfName(TestFilterMatcherName(group, name)) & (numberOfStrictSlots_ - 1); strictSlots_[slot] != -1; slot = (slot + 1) & (numberOfStrictSlots_ - 1))
+        if (isSameName(strictNames_[strictSlots_[slot]].asCharString(), TestFilterMatcherName(group, name))) return true;
+    return false;
+}
+
+int TestFilterMatcher::childOf(int node, char character) const
+{
+    for (int child = nodes_[node].firstChild_; child != -1; child = nodes_[child].nextSibling_)
+        if (nodes_[child].character_ == character) return child;
+    return -1;
+}
+
+void TestFilterMatcher::addPattern(const SimpleString& pattern)
+{
+    int node = 0;
+    for (const char* character = pattern.asCharString(); *character; character++) {
+        int child = childOf(node, *character);
+        if (child == -1) {
+            child = numberOfNodes_++;
+            nodes_[child].firstChild_ = -1;
+            nodes_[child].nextSibling_ = nodes_[node].firstChild_;
+            nodes_[child].failure_ = 0;
+            nodes_[child].character_ = *character;
+            nodes_[child].endsPattern_ = false;
+            nodes_[node].firstChild_ = child;
+        }
+        node = child;
+    }
+    nodes_[node].endsPattern_ = true;
+}
+
+/* Breadth first, so the failure transition of a node's parent is known when the node is linked */
+void TestFilterMatcher::linkFailureTransitions()
+{
+    int* queue = new int[numberOfNodes_];
+    int head = 0, tail = 0;
+    for (int child = nodes_[0].firstChild_; child != -1; child = nodes_[child].nextSibling_)
+        queue[tail++] = child;
+
+    while (head < tail) {
+        int node = queue[head++];
+        for (int child = nodes_[node].firstChild_; child != -1; child = nodes_[child].nextSibling_) {
+            int failure = nodes_[node].failure_;
+            while (failure != 0 && childOf(failure, nodes_[child].character_) == -1)
+                failure = nodes_[failure].failure_;
+            int target = childOf(failure, nodes_[child].character_);
+            nodes_[child].failure_ = (target == -1) ? 0 : target;
+            nodes_[child].endsPattern_ = nodes_[child].endsPattern_ || nodes_[nodes_[child].failure_].endsPattern_;
+            queue[tail++] = child;
+        }
+    }
+    delete [] queue;
+}
+
+bool TestFilterMatcher::containsPattern(const char* group, const char* name) const
+{
+    if (nodes_[0].endsPattern_) return true;
+
+    TestFilterMatcherName characters(group, name);
+    int node = 0;
+    for (char character = characters.next(); character; character = characters.next()) {
+        while (node != 0 && childOf(node, character) == -1)
+            node = nodes_[node].failure_;
+        int child = childOf(node, character);
+        node = (child == -1) ? 0 : child;
+        if (nodes_[node].endsPattern_) return true;
+    }
+    return false;
+}
+
+bool TestFilterMatcher::match(const char* name) const
+{
+    return match(NULL, name);
+}
+
+bool TestFilterMatcher::match(const char* group, const char* name) const
+{
+    if (matchesEverything_) return true;
+    return isStrictName(group, name) || containsPattern(group, name);
+}
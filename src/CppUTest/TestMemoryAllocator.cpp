@@ -130,6 +130,11 @@ bool TestMemoryAllocator::isOfEqualType(TestMemoryAllocator* allocator)
     return SimpleString::StrCmp(this->name(), allocator->name()) == 0;
 }
 
+bool TestMemoryAllocator::guardsMemoryBounds()
+{
+    return false;
+}
+
 char* TestMemoryAllocator::allocMemoryLeakNode(size_t size)
 {
     return alloc_memory(size, "MemoryLeakNode", 1);
@@ -181,6 +186,109 @@ char* CrashOnAllocationAllocator::alloc_memory(size_t size, const char* file, in
     return TestMemoryAllocator::alloc_memory(size, file, line);
 }
 
+struct GuardedMemoryHeader
+{
+    char* pages_;
+    size_t length_;
+};
+
+static size_t roundUp(size_t size, size_t multiple)
+{
+    return (size + multiple - 1) / multiple * multiple;
+}
+
+GuardPageMemoryAllocator::GuardPageMemoryAllocator(Mode mode, const char* name_str, const char* alloc_name_str, const char* free_name_str)
+    : TestMemoryAllocator(name_str, alloc_name_str, free_name_str), mode_(mode), alignment_(2 * sizeof(double)), pageSize_(PlatformSpecificPageSize())
+{
+}
+
+GuardPageMemoryAllocator::Mode GuardPageMemoryAllocator::getMode()
+{
+    return mode_;
+}
+
+void GuardPageMemoryAllocator::setAlignment(size_t alignment)
+{
+    alignment_ = (alignment == 0) ? 1 : alignment;
+}
+
+bool GuardPageMemoryAllocator::guardsMemoryBounds()
+{
+    return pageSize_ != 0;
+}
+
+char* GuardPageMemoryAllocator::allocPages(size_t length)
+{
+    char* pages = (char*) PlatformSpecificPageAlloc(length);
+    if (pages == 0)
+        FAIL("could not allocate guard pages");
+    return pages;
+}
+
+/* Without the guard page the memory would silently go unguarded, while the leak detector leaves out its canary */
+void GuardPageMemoryAllocator::protectGuardPage(char* guardPage, char* pages, size_t length)
+{
+    if (PlatformSpecificPageProtect(guardPage, pageSize_, 0) == 0) return;
+    PlatformSpecificPageFree(pages, length);
+    FAIL("could not protect guard page");
+}
+
+/* The header sits right before the memory, an underflow is not detected in this mode anyway */
+char* GuardPageMemoryAllocator::allocWithGuardPageAfter(size_t size)
+{
+    size_t alignedSize = roundUp(size, alignment_);
+    size_t accessibleLength = roundUp(alignedSize + sizeof(GuardedMemoryHeader), pageSize_);
+    GuardedMemoryHeader header;
+    header.length_ = accessibleLength + pageSize_;
+    header.pages_ = allocPages(header.length_);
+
+    char* guardPage = header.pages_ + accessibleLength;
+    protectGuardPage(guardPage, header.pages_, header.length_);
+
+    char* memory = guardPage - alignedSize;
+    PlatformSpecificMemCpy(memory - sizeof(header), &header, sizeof(header));
+    return memory;
+}
+
+/* The header is kept in the guard page itself, which is made accessible again to free the memory */
+char* GuardPageMemoryAllocator::allocWithGuardPageBefore(size_t size)
+{
+    GuardedMemoryHeader header;
+    header.length_ = pageSize_ + roundUp(size, pageSize_);
+    header.pages_ = allocPages(header.length_);
+
+    PlatformSpecificMemCpy(header.pages_, &header, sizeof(header));
+    protectGuardPage(header.pages_, header.pages_, header.length_);
+    return header.pages_ + pageSize_;
+}
+
+char* GuardPageMemoryAllocator::alloc_memory(size_t size, const char* file, int line)
+{
+    if (!guardsMemoryBounds()) return TestMemoryAllocator::alloc_memory(size, file, line);
+    if (mode_ == detect_underflow) return allocWithGuardPageBefore(size);
+    return allocWithGuardPageAfter(size);
+}
+
+void GuardPageMemoryAllocator::free_memory(char* memory, const char* file, int line)
+{
+    if (!guardsMemoryBounds()) {
+        TestMemoryAllocator::free_memory(memory, file, line);
+        return;
+    }
+    if (memory == 0) return;
+
+    GuardedMemoryHeader header;
+    if (mode_ == detect_underflow) {
+        char* guardPage = memory - pageSize_;
+        if (PlatformSpecificPageProtect(guardPage, pageSize_, 1) != 0)
+            FAIL("could not unprotect guard page");
+        PlatformSpecificMemCpy(&header, guardPage, sizeof(header));
+    }
+    else
+        PlatformSpecificMemCpy(&header, memory - sizeof(header), sizeof(header));
+
+    PlatformSpecificPageFree(header.pages_, header.length_);
+}
 
 char* NullUnknownAllocator::alloc_memory(size_t /*size*/, const char*, int)
 {
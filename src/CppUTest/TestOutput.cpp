@@ -105,8 +105,9 @@ void TestOutput::printCurrentTestStarted(const UtestShell& test)
 void TestOutput::printCurrentTestEnded(const TestResult& res)
 {
     if (verbose_) {
+        long micros = (long) (res.getCurrentTestTotalExecutionTimeInNanos() / 1000.0);
         print(" - ");
-        print(res.getCurrentTestTotalExecutionTime());
+        print(StringFromFormat("%ld.%03ld", micros / 1000, micros % 1000).asCharString());
         print(" ms\n");
     }
     else {
@@ -114,6 +115,41 @@ void TestOutput::printCurrentTestEnded(const TestResult& res)
     }
 }
 
+void TestOutput::printBenchmarkResult(const UtestShell& test, const BenchmarkResult& benchmark)
+{
+    if (!verbose_) {
+        print("\n");
+        print(test.getFormattedName().asCharString());
+    }
+    print(StringFromFormat(" - min %.3f ns, median %.3f ns, p99 %.3f ns, stddev %.3f ns (%d samples of %ld iterations)",
+            benchmark.getMinimum(), benchmark.getMedian(), benchmark.getPercentile99(), benchmark.getStandardDeviation(),
+            benchmark.getNumberOfSamples(), benchmark.getIterationsPerSample()).asCharString());
+    if (!verbose_) print("\n");
+}
+
+bool TestOutput::isTracingTestPhases() const
+{
+    return false;
+}
+
+void TestOutput::printTestPhaseStarted(const UtestShell&, const char*, double, int)
+{
+}
+
+void TestOutput::printTestPhaseEnded(const UtestShell&, const char*, double, int)
+{
+}
+
+void TestOutput::printTestProperty(const UtestShell& /*test*/, const SimpleString& name, const SimpleString& value)
+{
+    if (verbose_) {
+        print(" - ");
+        print(name.asCharString());
+        print(" ");
+        print(value.asCharString());
+    }
+}
+
 void TestOutput::printProgressIndicator()
 {
     print(progressIndication_);
@@ -313,6 +349,35 @@ void CompositeTestOutput::printCurrentTestEnded(const TestResult& res)
   if (outputTwo_) outputTwo_->printCurrentTestEnded(res);
 }
 
+void CompositeTestOutput::printBenchmarkResult(const UtestShell& test, const BenchmarkResult& benchmark)
+{
+  if (outputOne_) outputOne_->printBenchmarkResult(test, benchmark);
+  if (outputTwo_) outputTwo_->printBenchmarkResult(test, benchmark);
+}
+
+void CompositeTestOutput::printTestProperty(const UtestShell& test, const SimpleString& name, const SimpleString& value)
+{
+  if (outputOne_) outputOne_->printTestProperty(test, name, value);
+  if (outputTwo_) outputTwo_->printTestProperty(test, name, value);
+}
+
+bool CompositeTestOutput::isTracingTestPhases() const
+{
+  return (outputOne_ && outputOne_->isTracingTestPhases()) || (outputTwo_ && outputTwo_->isTracingTestPhases());
+}
+
+void CompositeTestOutput::printTestPhaseStarted(const UtestShell& test, const char* phase, double timeInNanos, int track)
+{
+  if (outputOne_) outputOne_->printTestPhaseStarted(test, phase, timeInNanos, track);
+  if (outputTwo_) outputTwo_->printTestPhaseStarted(test, phase, timeInNanos, track);
+}
+
+void CompositeTestOutput::printTestPhaseEnded(const UtestShell& test, const char* phase, double timeInNanos, int track)
+{
+  if (outputOne_) outputOne_->printTestPhaseEnded(test, phase, timeInNanos, track);
+  if (outputTwo_) outputTwo_->printTestPhaseEnded(test, phase, timeInNanos, track);
+}
+
 void CompositeTestOutput::printCurrentGroupStarted(const UtestShell& test)
 {
   if (outputOne_) outputOne_->printCurrentGroupStarted(test);
@@ -379,3 +444,54 @@ void CompositeTestOutput::flush()
   if (outputTwo_) outputTwo_->flush();
 }
 
+TestPhaseLog::TestPhaseLog() : size_(0)
+{
+}
+
+void TestPhaseLog::add(const UtestShell& test, const char* phase, double timeInNanos, int track, bool started)
+{
+    if (size_ == capacity) return;
+
+    Entry& entry = entries_[size_++];
+    entry.test_ = &test;
+    SimpleString::StrNCpy(entry.phase_, phase, maximumPhaseLength - 1);
+    entry.phase_[maximumPhaseLength - 1] = '\0';
+    entry.timeInNanos_ = timeInNanos;
+    entry.track_ = track;
+    entry.started_ = started;
+}
+
+void TestPhaseLog::clear()
+{
+    size_ = 0;
+}
+
+int TestPhaseLog::size() const
+{
+    return size_;
+}
+
+const UtestShell& TestPhaseLog::getTest(int index) const
+{
+    return *entries_[index].test_;
+}
+
+const char* TestPhaseLog::getPhase(int index) const
+{
+    return entries_[index].phase_;
+}
+
+double TestPhaseLog::getTimeInNanos(int index) const
+{
+    return entries_[index].timeInNanos_;
+}
+
+int TestPhaseLog::getTrack(int index) const
+{
+    return entries_[index].track_;
+}
+
+bool TestPhaseLog::isStarted(int index) const
+{
+    return entries_[index].started_;
+}
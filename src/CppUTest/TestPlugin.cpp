@@ -50,14 +50,22 @@ TestPlugin* TestPlugin::addPlugin(TestPlugin* plugin)
 
 void TestPlugin::runAllPreTestAction(UtestShell& test, TestResult& result)
 {
-    if (enabled_) preTestAction(test, result);
+    if (enabled_) {
+        result.testPhaseStarted(test, name_.asCharString());
+        preTestAction(test, result);
+        result.testPhaseEnded(test, name_.asCharString());
+    }
     next_->runAllPreTestAction(test, result);
 }
 
 void TestPlugin::runAllPostTestAction(UtestShell& test, TestResult& result)
 {
     next_ ->runAllPostTestAction(test, result);
-    if (enabled_) postTestAction(test, result);
+    if (enabled_) {
+        result.testPhaseStarted(test, name_.asCharString());
+        postTestAction(test, result);
+        result.testPhaseEnded(test, name_.asCharString());
+    }
 }
 
 bool TestPlugin::parseAllArguments(int ac, char** av, int index)
@@ -121,8 +129,9 @@ struct cpputest_pair
 
 //////// SetPlugin
 
-static int pointerTableIndex;
-static cpputest_pair setlist[SetPointerPlugin::MAX_SET];
+/* Per thread, so the copies on the threads of TestThreadPool each restore their own pointers */
+static CPPUTEST_THREAD_LOCAL int pointerTableIndex;
+static CPPUTEST_THREAD_LOCAL cpputest_pair setlist[SetPointerPlugin::MAX_SET];
 
 SetPointerPlugin::SetPointerPlugin(const SimpleString& name) :
     TestPlugin(name)
@@ -134,6 +143,11 @@ SetPointerPlugin::~SetPointerPlugin()
 {
 }
 
+TestPlugin* SetPointerPlugin::createThreadCopy()
+{
+    return new SetPointerPlugin(getName());
+}
+
 void CppUTestStore(void**function)
 {
     if (pointerTableIndex >= SetPointerPlugin::MAX_SET) {
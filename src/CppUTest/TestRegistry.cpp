@@ -27,24 +27,47 @@
 
 #include "CppUTest/TestHarness.h"
 #include "CppUTest/TestRegistry.h"
+#include "CppUTest/TestWorkerPool.h"
+#include "CppUTest/TestBaseline.h"
+#include "CppUTest/PlatformSpecificFunctions.h"
 
 TestRegistry::TestRegistry() :
-    tests_(NULL), nameFilters_(NULL), groupFilters_(NULL), firstPlugin_(NullTestPlugin::instance()), runInSeperateProcess_(false), currentRepetition_(0)
+    tests_(NULL), nameFilters_(NULL), groupFilters_(NULL), testFilters_(NULL), firstPlugin_(NullTestPlugin::instance()), runInSeperateProcess_(false), numberOfWorkers_(1), runInPreforkedProcesses_(false), numberOfThreads_(1), shardIndex_(0), shardCount_(1), runBenchmarksOnly_(false), durations_(NULL), testsByName_(NULL), testsByGroup_(NULL), indexSize_(0), indexedRelinksAndRenames_(0), filtersCompiled_(false), currentRepetition_(0)
 
 {
 }
 
 TestRegistry::~TestRegistry()
 {
+    dropIndex();
 }
 
 void TestRegistry::addTest(UtestShell *test)
 {
     tests_ = test->addTest(tests_);
+    dropIndex();
 }
 
 void TestRegistry::runAllTests(TestResult& result)
 {
+    compileFilters();
+    packShards();
+    if (runInPreforkedProcesses_ && !TestWorkerPool::canStartWorkers()) {
+        runInSeperateProcess_ = true;
+        runInPreforkedProcesses_ = false;
+        numberOfWorkers_ = 1;
+    }
+    if (numberOfWorkers_ > 1 || runInPreforkedProcesses_) {
+        runAllTestsInWorkers(result);
+        clearCompiledFilters();
+        return;
+    }
+    if (numberOfThreads_ > 1 && !runInSeperateProcess_) {
+        runAllTestsInThreads(result);
+        clearCompiledFilters();
+        return;
+    }
+
     bool groupStart = true;
 
     result.testsStarted();
@@ -70,6 +93,84 @@ void TestRegistry::runAllTests(TestResult& result)
     }
     result.testsEnded();
     currentRepetition_++;
+    clearCompiledFilters();
+}
+
+void TestRegistry::runAllTestsInWorkers(TestResult& result)
+{
+    TestWorkerPool pool(numberOfWorkers_, firstPlugin_);
+    if (runInPreforkedProcesses_) {
+        pool.restartWorkersAfterFailure();
+        pool.measureResourceUsage();
+    }
+    if (result.isTracingTestPhases()) pool.traceTestPhases();
+    for (UtestShell *test = tests_; test != NULL; test = test->getNext()) {
+        if (runInSeperateProcess_) test->setRunInSeperateProcess();
+        if (testIsSelected(test)) pool.scheduleTest(test, durations_ ? durations_->getExpectedNanos(*test) : 0.0);
+    }
+
+    bool groupStart = true;
+    double groupExecutionTime = 0;
+
+    result.testsStarted();
+    for (UtestShell *test = tests_; test != NULL; test = test->getNext()) {
+        if (groupStart) {
+            result.currentGroupStarted(test);
+            groupStart = false;
+            groupExecutionTime = 0;
+        }
+
+        result.countTest();
+        if (testShouldRun(test, result))
+            groupExecutionTime += pool.replayNextTest(result);
+
+        if (endOfGroup(test)) {
+            groupStart = true;
+            result.currentGroupEndedWithTime(test, groupExecutionTime);
+        }
+    }
+    result.testsEnded();
+    currentRepetition_++;
+}
+
+void TestRegistry::runAllTestsInThreads(TestResult& result)
+{
+    TestThreadPool pool(numberOfThreads_, firstPlugin_);
+    if (result.isTracingTestPhases()) pool.traceTestPhases();
+    for (UtestShell *test = tests_; test != NULL; test = test->getNext())
+        if (test->isThreadSafe() && testIsSelected(test)) pool.scheduleTest(test, durations_ ? durations_->getExpectedNanos(*test) : 0.0);
+    pool.runTests();
+
+    bool groupStart = true;
+    double groupExecutionTime = 0;
+
+    result.testsStarted();
+    for (UtestShell *test = tests_; test != NULL; test = test->getNext()) {
+        if (groupStart) {
+            result.currentGroupStarted(test);
+            groupStart = false;
+            groupExecutionTime = 0;
+        }
+
+        result.countTest();
+        if (testShouldRun(test, result)) {
+            if (test->isThreadSafe())
+                groupExecutionTime += pool.replayNextTest(result);
+            else {
+                result.currentTestStarted(test);
+                test->runOneTest(firstPlugin_, result);
+                result.currentTestEnded(test);
+                groupExecutionTime += result.getCurrentTestTotalExecutionTimeInNanos();
+            }
+        }
+
+        if (endOfGroup(test)) {
+            groupStart = true;
+            result.currentGroupEndedWithTime(test, groupExecutionTime);
+        }
+    }
+    result.testsEnded();
+    currentRepetition_++;
 }
 
 void TestRegistry::listTestGroupNames(TestResult& result)
@@ -98,6 +199,8 @@ void TestRegistry::listTestGroupNames(TestResult& result)
 void TestRegistry::listTestGroupAndCaseNames(TestResult& result)
 {
     SimpleString groupAndNameList;
+    compileFilters();
+    packShards();
 
     for (UtestShell *test = tests_; test != NULL; test = test->getNext()) {
         if (testShouldRun(test, result)) {
@@ -120,6 +223,7 @@ void TestRegistry::listTestGroupAndCaseNames(TestResult& result)
     if (groupAndNameList.endsWith(" "))
         groupAndNameList = groupAndNameList.subString(0, groupAndNameList.size() - 1);
     result.print(groupAndNameList.asCharString());
+    clearCompiledFilters();
 }
 
 bool TestRegistry::endOfGroup(UtestShell* test)
@@ -148,7 +252,7 @@ void TestRegistry::setCurrentRegistry(TestRegistry* registry)
 void TestRegistry::unDoLastAddTest()
 {
     tests_ = tests_ ? tests_->getNext() : NULL;
-
+    dropIndex();
 }
 
 void TestRegistry::setNameFilters(const TestFilter* filters)
@@ -161,19 +265,123 @@ void TestRegistry::setGroupFilters(const TestFilter* filters)
     groupFilters_ = filters;
 }
 
+void TestRegistry::setTestFilters(const TestFilter* filters)
+{
+    testFilters_ = filters;
+}
+
 void TestRegistry::setRunTestsInSeperateProcess()
 {
     runInSeperateProcess_ = true;
 }
 
+void TestRegistry::setRunTestsInParallel(int numberOfWorkers)
+{
+    numberOfWorkers_ = numberOfWorkers;
+}
+
+void TestRegistry::setRunTestsInPreforkedProcesses()
+{
+    runInPreforkedProcesses_ = true;
+}
+
+void TestRegistry::setRunTestsInThreads(int numberOfThreads)
+{
+    numberOfThreads_ = numberOfThreads;
+}
+
+void TestRegistry::setShard(int shardIndex, int shardCount)
+{
+    shardIndex_ = shardIndex;
+    shardCount_ = shardCount;
+}
+
+void TestRegistry::setRunBenchmarksOnly()
+{
+    runBenchmarksOnly_ = true;
+}
+
+void TestRegistry::setDurations(TestDurations* durations)
+{
+    durations_ = durations;
+}
+
 int TestRegistry::getCurrentRepetition()
 {
     return currentRepetition_;
 }
 
+static unsigned long hashOfString(unsigned long hash, const SimpleString& string)
+{
+    const char* characters = string.asCharString();
+    for (size_t i = 0; characters[i]; i++)
+        hash = ((hash ^ (unsigned char) characters[i]) * 16777619UL) & 0xFFFFFFFFUL;
+    return hash;
+}
+
+/* With recorded durations every machine packs the same tests into the same shards */
+void TestRegistry::packShards()
+{
+    if (shardCount_ <= 1 || durations_ == NULL || durations_->getNumberOfTests() == 0) return;
+
+    int numberOfTests = 0;
+    for (UtestShell *test = tests_; test != NULL; test = test->getNext())
+        if (testMatchesFilters(test)) numberOfTests++;
+
+    UtestShell** tests = new UtestShell*[(size_t) numberOfTests + 1];
+    int index = 0;
+    for (UtestShell *test = tests_; test != NULL; test = test->getNext())
+        if (testMatchesFilters(test)) tests[index++] = test;
+    durations_->packIntoShards(tests, numberOfTests, shardCount_);
+    delete [] tests;
+}
+
+/* Otherwise FNV-1a of "group.name", so every machine assigns a test to the same shard */
+bool TestRegistry::testIsInShard(UtestShell* test)
+{
+    if (shardCount_ <= 1) return true;
+
+    int packedShard = durations_ ? durations_->getShard(*test) : -1;
+    if (packedShard >= 0) return packedShard == shardIndex_;
+
+    unsigned long hash = hashOfString(2166136261UL, test->getGroup());
+    hash = hashOfString(hash, ".");
+    hash = hashOfString(hash, test->getName());
+    return (hash % (unsigned long) shardCount_) == (unsigned long) shardIndex_;
+}
+
+/* For the length of a run the filter chains are compiled, so thousands of filters cost no more than one */
+void TestRegistry::compileFilters()
+{
+    groupMatcher_.compile(groupFilters_);
+    nameMatcher_.compile(nameFilters_);
+    testMatcher_.compile(testFilters_);
+    filtersCompiled_ = true;
+}
+
+void TestRegistry::clearCompiledFilters()
+{
+    groupMatcher_.clear();
+    nameMatcher_.clear();
+    testMatcher_.clear();
+    filtersCompiled_ = false;
+}
+
+bool TestRegistry::testMatchesFilters(UtestShell* test)
+{
+    if (runBenchmarksOnly_ && !test->isBenchmark()) return false;
+    if (!filtersCompiled_) compileFilters();
+    return test->shouldRun(groupMatcher_, nameMatcher_, testMatcher_);
+}
+
+bool TestRegistry::testIsSelected(UtestShell* test)
+{
+    return testMatchesFilters(test) && testIsInShard(test);
+}
+
 bool TestRegistry::testShouldRun(UtestShell* test, TestResult& result)
 {
-    if (test->shouldRun(groupFilters_, nameFilters_)) return true;
+    if (testIsSelected(test)) return true;
     else {
         result.countFilteredOut();
         return false;
@@ -229,25 +437,83 @@ UtestShell* TestRegistry::getTestWithNext(UtestShell* test)
     return current;
 }
 
-UtestShell* TestRegistry::findTestWithName(const SimpleString& name)
+static bool testHasKey(const UtestShell* test, const SimpleString& key, bool byName)
 {
-    UtestShell* current = tests_;
-    while (current) {
-        if (current->getName() == name)
-            return current;
-        current = current->getNext();
+    return byName ? test->hasName(key) : test->hasGroup(key);
+}
+
+static size_t slotOf(const SimpleString& key, size_t indexSize)
+{
+    return (size_t) hashOfString(2166136261UL, key) & (indexSize - 1);
+}
+
+static void addToIndex(UtestShell** index, size_t indexSize, UtestShell* test, const SimpleString& key, bool byName)
+{
+    size_t slot = slotOf(key, indexSize);
+    while (index[slot]) {
+        if (testHasKey(index[slot], key, byName)) return;
+        slot = (slot + 1) & (indexSize - 1);
     }
-    return NULL;
+    index[slot] = test;
 }
 
-UtestShell* TestRegistry::findTestWithGroup(const SimpleString& group)
+/* Open addressing tables, kept out of the memory leak detector as they may be built during a test */
+void TestRegistry::buildIndex()
 {
-    UtestShell* current = tests_;
-    while (current) {
-        if (current->getGroup() == group)
-            return current;
-        current = current->getNext();
+    size_t numberOfTests = (size_t) countTests();
+    size_t indexSize = 16;
+    while (indexSize < 2 * numberOfTests)
+        indexSize *= 2;
+
+    UtestShell** index = (UtestShell**) PlatformSpecificMalloc(2 * indexSize * sizeof(UtestShell*));
+    if (index == NULL) return;
+    for (size_t i = 0; i < 2 * indexSize; i++)
+        index[i] = NULL;
+
+    testsByName_ = index;
+    testsByGroup_ = index + indexSize;
+    indexSize_ = indexSize;
+    indexedRelinksAndRenames_ = UtestShell::getNumberOfRelinksAndRenames();
+    for (UtestShell* test = tests_; test != NULL; test = test->getNext()) {
+        addToIndex(testsByName_, indexSize_, test, test->getName(), true);
+        addToIndex(testsByGroup_, indexSize_, test, test->getGroup(), false);
     }
+}
+
+void TestRegistry::dropIndex()
+{
+    if (testsByName_) PlatformSpecificFree(testsByName_);
+    testsByName_ = NULL;
+    testsByGroup_ = NULL;
+    indexSize_ = 0;
+}
+
+/* Tests linked in behind the registry's back, as ordered tests are, or renamed make the index stale.
+ * The scan is only used when the index could not be allocated */
+UtestShell* TestRegistry::findTest(const SimpleString& key, bool byName)
+{
+    if (indexSize_ != 0 && indexedRelinksAndRenames_ != UtestShell::getNumberOfRelinksAndRenames()) dropIndex();
+    if (indexSize_ == 0) buildIndex();
+
+    if (indexSize_ != 0) {
+        UtestShell** index = byName ? testsByName_ : testsByGroup_;
+        for (size_t slot = slotOf(key, indexSize_); index[slot]; slot = (slot + 1) & (indexSize_ - 1))
+            if (testHasKey(index[slot], key, byName)) return index[slot];
+        return NULL;
+    }
+
+    for (UtestShell* test = tests_; test != NULL; test = test->getNext())
+        if (testHasKey(test, key, byName)) return test;
     return NULL;
 }
 
+UtestShell* TestRegistry::findTestWithName(const SimpleString& name)
+{
+    return findTest(name, true);
+}
+
+UtestShell* TestRegistry::findTestWithGroup(const SimpleString& group)
+{
+    return findTest(group, false);
+}
+
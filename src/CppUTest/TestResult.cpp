@@ -29,11 +29,13 @@
 #include "CppUTest/TestResult.h"
 #include "CppUTest/TestFailure.h"
 #include "CppUTest/TestOutput.h"
+#include "CppUTest/TestBaseline.h"
 #include "CppUTest/PlatformSpecificFunctions.h"
 
 TestResult::TestResult(TestOutput& p) :
     output_(p), testCount_(0), runCount_(0), checkCount_(0), failureCount_(0), filteredOutCount_(0), ignoredCount_(0), totalExecutionTime_(0), timeStarted_(0), currentTestTimeStarted_(0),
-            currentTestTotalExecutionTime_(0), currentGroupTimeStarted_(0), currentGroupTotalExecutionTime_(0)
+            currentTestTotalExecutionTime_(0), currentGroupTimeStarted_(0), currentGroupTotalExecutionTime_(0),
+            baseline_(NULL), durations_(NULL), currentTestBenchmarked_(false), currentBenchmarkMedian_(0), currentBenchmarkStandardDeviation_(0), currentBenchmarkNumberOfSamples_(0)
 {
 }
 
@@ -44,19 +46,26 @@ TestResult::~TestResult()
 void TestResult::currentGroupStarted(UtestShell* test)
 {
     output_.printCurrentGroupStarted(*test);
-    currentGroupTimeStarted_ = GetPlatformSpecificTimeInMillis();
+    currentGroupTimeStarted_ = GetPlatformSpecificMonotonicTimeInNanos();
 }
 
 void TestResult::currentGroupEnded(UtestShell* /*test*/)
 {
-    currentGroupTotalExecutionTime_ = GetPlatformSpecificTimeInMillis() - currentGroupTimeStarted_;
+    currentGroupTotalExecutionTime_ = GetPlatformSpecificMonotonicTimeInNanos() - currentGroupTimeStarted_;
+    output_.printCurrentGroupEnded(*this);
+}
+
+void TestResult::currentGroupEndedWithTime(UtestShell* /*test*/, double executionTimeInNanos)
+{
+    currentGroupTotalExecutionTime_ = executionTimeInNanos;
     output_.printCurrentGroupEnded(*this);
 }
 
 void TestResult::currentTestStarted(UtestShell* test)
 {
     output_.printCurrentTestStarted(*test);
-    currentTestTimeStarted_ = GetPlatformSpecificTimeInMillis();
+    currentTestBenchmarked_ = false;
+    currentTestTimeStarted_ = GetPlatformSpecificMonotonicTimeInNanos();
 }
 
 void TestResult::print(const char* text)
@@ -64,19 +73,113 @@ void TestResult::print(const char* text)
     output_.print(text);
 }
 
-void TestResult::currentTestEnded(UtestShell* /*test*/)
+void TestResult::currentTestEnded(UtestShell* test)
 {
-    currentTestTotalExecutionTime_ = GetPlatformSpecificTimeInMillis() - currentTestTimeStarted_;
+    currentTestTotalExecutionTime_ = GetPlatformSpecificMonotonicTimeInNanos() - currentTestTimeStarted_;
+    checkAgainstBaseline(test);
+    recordDuration(test);
     output_.printCurrentTestEnded(*this);
 
 }
 
+void TestResult::currentTestEndedWithTime(UtestShell* test, double executionTimeInNanos)
+{
+    currentTestTotalExecutionTime_ = executionTimeInNanos;
+    checkAgainstBaseline(test);
+    recordDuration(test);
+    output_.printCurrentTestEnded(*this);
+}
+
 void TestResult::addFailure(const TestFailure& failure)
 {
     output_.print(failure);
     failureCount_++;
 }
 
+void TestResult::addBenchmarkResult(const UtestShell& test, const BenchmarkResult& benchmark)
+{
+    currentTestBenchmarked_ = true;
+    currentBenchmarkMedian_ = benchmark.getMedian();
+    currentBenchmarkStandardDeviation_ = benchmark.getStandardDeviation();
+    currentBenchmarkNumberOfSamples_ = benchmark.getNumberOfSamples();
+    output_.printBenchmarkResult(test, benchmark);
+}
+
+void TestResult::addTestProperty(const UtestShell& test, const SimpleString& name, const SimpleString& value)
+{
+    output_.printTestProperty(test, name, value);
+}
+
+void TestResult::addResourceUsage(const UtestShell& test, const PlatformSpecificResourceUsage& usage)
+{
+    addTestProperty(test, "user_time_ms", StringFromFormat("%.3f", usage.userTimeInNanos / 1000000.0));
+    addTestProperty(test, "system_time_ms", StringFromFormat("%.3f", usage.systemTimeInNanos / 1000000.0));
+    if (usage.maximumResidentSetSizeInKilobytes >= 0)
+        addTestProperty(test, "max_rss_kb", StringFrom(usage.maximumResidentSetSizeInKilobytes));
+    addTestProperty(test, "minor_faults", StringFrom(usage.minorPageFaults));
+    addTestProperty(test, "major_faults", StringFrom(usage.majorPageFaults));
+    addTestProperty(test, "voluntary_context_switches", StringFrom(usage.voluntaryContextSwitches));
+    addTestProperty(test, "involuntary_context_switches", StringFrom(usage.involuntaryContextSwitches));
+}
+
+bool TestResult::isTracingTestPhases() const
+{
+    return output_.isTracingTestPhases();
+}
+
+void TestResult::testPhaseStarted(const UtestShell& test, const char* phase)
+{
+    if (output_.isTracingTestPhases())
+        testPhaseStartedWithTime(test, phase, GetPlatformSpecificMonotonicTimeInNanos(), 0);
+}
+
+void TestResult::testPhaseEnded(const UtestShell& test, const char* phase)
+{
+    if (output_.isTracingTestPhases())
+        testPhaseEndedWithTime(test, phase, GetPlatformSpecificMonotonicTimeInNanos(), 0);
+}
+
+void TestResult::testPhaseStartedWithTime(const UtestShell& test, const char* phase, double timeInNanos, int track)
+{
+    output_.printTestPhaseStarted(test, phase, timeInNanos, track);
+}
+
+void TestResult::testPhaseEndedWithTime(const UtestShell& test, const char* phase, double timeInNanos, int track)
+{
+    output_.printTestPhaseEnded(test, phase, timeInNanos, track);
+}
+
+void TestResult::setBaseline(TestBaseline* baseline)
+{
+    baseline_ = baseline;
+}
+
+void TestResult::checkAgainstBaseline(UtestShell* test)
+{
+    if (baseline_ == NULL || test == NULL || !test->willRun()) return;
+
+    double nanos = currentTestBenchmarked_ ? currentBenchmarkMedian_ : currentTestTotalExecutionTime_;
+    SimpleString regression = baseline_->checkForRegression(*test, nanos);
+    if (!regression.isEmpty())
+        addFailure(TestFailure(test, regression));
+
+    if (currentTestBenchmarked_)
+        baseline_->record(*test, currentBenchmarkMedian_, currentBenchmarkStandardDeviation_, currentBenchmarkNumberOfSamples_);
+    else
+        baseline_->record(*test, nanos, 0.0, 1);
+}
+
+void TestResult::setDurations(TestDurations* durations)
+{
+    durations_ = durations;
+}
+
+void TestResult::recordDuration(UtestShell* test)
+{
+    if (durations_ == NULL || test == NULL || !test->willRun()) return;
+    durations_->record(*test, currentTestTotalExecutionTime_);
+}
+
 void TestResult::countTest()
 {
     testCount_++;
@@ -104,33 +207,53 @@ void TestResult::countIgnored()
 
 void TestResult::testsStarted()
 {
-    timeStarted_ = GetPlatformSpecificTimeInMillis();
+    timeStarted_ = GetPlatformSpecificMonotonicTimeInNanos();
     output_.printTestsStarted();
 }
 
 void TestResult::testsEnded()
 {
-    long timeEnded = GetPlatformSpecificTimeInMillis();
+    double timeEnded = GetPlatformSpecificMonotonicTimeInNanos();
     totalExecutionTime_ = timeEnded - timeStarted_;
     output_.printTestsEnded(*this);
 }
 
+static long nanosToMillis(double nanos)
+{
+    return (long) (nanos / 1000000.0);
+}
+
 long TestResult::getTotalExecutionTime() const
 {
-    return totalExecutionTime_;
+    return nanosToMillis(totalExecutionTime_);
 }
 
 void TestResult::setTotalExecutionTime(long exTime)
 {
-    totalExecutionTime_ = exTime;
+    totalExecutionTime_ = (double) exTime * 1000000.0;
 }
 
 long TestResult::getCurrentTestTotalExecutionTime() const
 {
-    return currentTestTotalExecutionTime_;
+    return nanosToMillis(currentTestTotalExecutionTime_);
 }
 
 long TestResult::getCurrentGroupTotalExecutionTime() const
+{
+    return nanosToMillis(currentGroupTotalExecutionTime_);
+}
+
+double TestResult::getTotalExecutionTimeInNanos() const
+{
+    return totalExecutionTime_;
+}
+
+double TestResult::getCurrentTestTotalExecutionTimeInNanos() const
+{
+    return currentTestTotalExecutionTime_;
+}
+
+double TestResult::getCurrentGroupTotalExecutionTimeInNanos() const
 {
     return currentGroupTotalExecutionTime_;
 }
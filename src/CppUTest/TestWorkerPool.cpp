@@ -0,0 +1,791 @@
+/*
+ * Copyright (c) 2007, Michael Feathers, James Grenning and Bas Vodde
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE EARLIER MENTIONED AUTHORS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestWorkerPool.h"
+#include "CppUTest/TestOutput.h"
+#include "CppUTest/TestBaseline.h"
+#include "CppUTest/SimpleMutex.h"
+#include "CppUTest/MemoryLeakWarningPlugin.h"
+#include "CppUTest/MemoryLeakDetector.h"
+#include "CppUTest/PlatformSpecificFunctions.h"
+
+/*
+ * Workers receive the index of the test to run as "<index>\n" and answer with one
+ * length prefixed message ("<length>:<payload>") per test. The payload holds the
+ * counters, the number of failures, the execution time (seconds and nanoseconds) and the worker's trace track followed by what the
+ * test printed, the failures and properties it added and its traced phases, in the order they happened, so the parent can replay
+ * them unchanged.
+ */
+
+static const char failureEvent[] = "F";
+static const char printEvent[] = "P";
+static const char propertyEvent[] = "R";
+static const char phaseStartedEvent[] = "B";
+static const char phaseEndedEvent[] = "E";
+
+static void encodeNumber(SimpleString& buffer, long number)
+{
+    buffer += StringFrom(number);
+    buffer += " ";
+}
+
+static void encodeDuration(SimpleString& buffer, double nanos)
+{
+    long seconds = (long) (nanos / 1000000000.0);
+    encodeNumber(buffer, seconds);
+    encodeNumber(buffer, (long) (nanos - (double) seconds * 1000000000.0));
+}
+
+static void encodeString(SimpleString& buffer, const SimpleString& string)
+{
+    buffer += StringFrom((long) string.size());
+    buffer += ":";
+    buffer += string;
+}
+
+class TestWorkerMessageReader
+{
+public:
+    TestWorkerMessageReader(const SimpleString& message)
+        : current_(message.asCharString()), end_(message.asCharString() + message.size())
+    {
+    }
+
+    bool atEnd() const
+    {
+        return current_ >= end_;
+    }
+
+    char readEvent()
+    {
+        return *current_++;
+    }
+
+    long readNumber()
+    {
+        long number = SimpleString::AtoI(current_);
+        while (current_ < end_ && *current_ != ' ') current_++;
+        if (current_ < end_) current_++;
+        return number;
+    }
+
+    double readDuration()
+    {
+        double seconds = (double) readNumber();
+        return seconds * 1000000000.0 + (double) readNumber();
+    }
+
+    SimpleString readString()
+    {
+        size_t length = (size_t) SimpleString::AtoI(current_);
+        while (current_ < end_ && *current_ != ':') current_++;
+        if (current_ < end_) current_++;
+        if (length > (size_t) (end_ - current_)) length = (size_t) (end_ - current_);
+        char* buffer = SimpleString::allocStringBuffer(length + 1, __FILE__, __LINE__);
+        SimpleString::StrNCpy(buffer, current_, length);
+        buffer[length] = '\0';
+        SimpleString string(buffer);
+        SimpleString::deallocStringBuffer(buffer, __FILE__, __LINE__);
+        current_ += length;
+        return string;
+    }
+
+private:
+    const char* current_;
+    const char* end_;
+};
+
+class TestWorkerOutput : public TestOutput
+{
+public:
+    TestWorkerOutput(bool tracingTestPhases) : tracingTestPhases_(tracingTestPhases)
+    {
+    }
+
+    virtual ~TestWorkerOutput()
+    {
+    }
+
+    virtual void printCurrentTestStarted(const UtestShell&) _override
+    {
+    }
+
+    virtual void printCurrentTestEnded(const TestResult&) _override
+    {
+    }
+
+    virtual void printBuffer(const char* s) _override
+    {
+        events_ += printEvent;
+        encodeString(events_, s);
+    }
+
+    virtual void print(const char* s) _override
+    {
+        TestOutput::print(s);
+    }
+
+    virtual void print(long number) _override
+    {
+        TestOutput::print(number);
+    }
+
+    virtual void printTestProperty(const UtestShell&, const SimpleString& name, const SimpleString& value) _override
+    {
+        events_ += propertyEvent;
+        encodeString(events_, name);
+        encodeString(events_, value);
+    }
+
+    virtual bool isTracingTestPhases() const _override
+    {
+        return tracingTestPhases_;
+    }
+
+    virtual void printTestPhaseStarted(const UtestShell& test, const char* phase, double timeInNanos, int track) _override
+    {
+        phases_.add(test, phase, timeInNanos, track, true);
+    }
+
+    virtual void printTestPhaseEnded(const UtestShell& test, const char* phase, double timeInNanos, int track) _override
+    {
+        phases_.add(test, phase, timeInNanos, track, false);
+    }
+
+    virtual void print(const TestFailure& failure) _override
+    {
+        events_ += failureEvent;
+        encodeString(events_, failure.getFileName());
+        encodeNumber(events_, failure.getFailureLineNumber());
+        encodeString(events_, failure.getMessage());
+    }
+
+    virtual void flush() _override
+    {
+    }
+
+    /* The phases are encoded after the test, see TestPhaseLog */
+    SimpleString getEvents() const
+    {
+        SimpleString events = events_;
+        for (int i = 0; i < phases_.size(); i++) {
+            events += phases_.isStarted(i) ? phaseStartedEvent : phaseEndedEvent;
+            encodeString(events, phases_.getPhase(i));
+            encodeDuration(events, phases_.getTimeInNanos(i));
+        }
+        return events;
+    }
+
+private:
+    bool tracingTestPhases_;
+    SimpleString events_;
+    TestPhaseLog phases_;
+};
+
+struct TestWorker
+{
+    int pid_;
+    int commandDescriptor_;
+    int resultDescriptor_;
+    int runningTest_;
+    SimpleString received_;
+};
+
+static void closeDescriptor(int& descriptor)
+{
+    if (descriptor == -1) return;
+    PlatformSpecificClose(descriptor);
+    descriptor = -1;
+}
+
+static bool writeAll(int descriptor, const SimpleString& data)
+{
+    const char* buffer = data.asCharString();
+    int remaining = (int) data.size();
+    while (remaining > 0) {
+        int written = PlatformSpecificWrite(descriptor, buffer, remaining);
+        if (written <= 0) return false;
+        buffer += written;
+        remaining -= written;
+    }
+    return true;
+}
+
+static int readCommand(int descriptor)
+{
+    SimpleString command;
+    char character[2] = { 0, 0 };
+    while (PlatformSpecificRead(descriptor, character, 1) == 1) {
+        if (character[0] == '\n')
+            return SimpleString::AtoI(command.asCharString());
+        command += character;
+    }
+    return -1;
+}
+
+/*
+ * Workers run many tests, so the counters are taken as a difference. The peak memory cannot be,
+ * it is only the test's own in a fresh worker and is otherwise reported as the peak of the worker
+ */
+static void addResourceUsageBetween(TestResult& result, UtestShell* test, const PlatformSpecificResourceUsage& before, const PlatformSpecificResourceUsage& after, bool freshWorker)
+{
+    PlatformSpecificResourceUsage usage = after;
+    if (!freshWorker) usage.maximumResidentSetSizeInKilobytes = -1;
+    usage.userTimeInNanos -= before.userTimeInNanos;
+    usage.systemTimeInNanos -= before.systemTimeInNanos;
+    usage.minorPageFaults -= before.minorPageFaults;
+    usage.majorPageFaults -= before.majorPageFaults;
+    usage.voluntaryContextSwitches -= before.voluntaryContextSwitches;
+    usage.involuntaryContextSwitches -= before.involuntaryContextSwitches;
+    result.addResourceUsage(*test, usage);
+    if (!freshWorker) result.addTestProperty(*test, "worker_max_rss_kb", StringFrom(after.maximumResidentSetSizeInKilobytes));
+}
+
+/* Runs the test into a recording output and returns the result payload, see the format above */
+static SimpleString recordTest(UtestShell* test, TestPlugin* plugin, bool traceTestPhases, bool measureResourceUsage, bool freshWorker, long track)
+{
+    TestWorkerOutput output(traceTestPhases);
+    TestResult result(output);
+
+    PlatformSpecificResourceUsage before, after;
+    bool measuring = measureResourceUsage && PlatformSpecificGetResourceUsage(&before) == 0;
+
+    result.currentTestStarted(test);
+    test->runOneTest(plugin, result);
+    if (measuring && PlatformSpecificGetResourceUsage(&after) == 0)
+        addResourceUsageBetween(result, test, before, after, freshWorker);
+    result.currentTestEnded(test);
+    PlatformSpecificFlush();
+
+    SimpleString payload;
+    encodeNumber(payload, result.getRunCount());
+    encodeNumber(payload, result.getCheckCount());
+    encodeNumber(payload, result.getIgnoredCount());
+    encodeNumber(payload, result.getFailureCount());
+    encodeDuration(payload, result.getCurrentTestTotalExecutionTimeInNanos());
+    encodeNumber(payload, track);
+    payload += output.getEvents();
+    return payload;
+}
+
+/* Replays a payload of recordTest into result and returns the execution time of the test */
+static double replayRecordedTest(UtestShell* test, const SimpleString& payload, TestResult& result)
+{
+    TestWorkerMessageReader reader(payload);
+    long runCount = reader.readNumber();
+    long checkCount = reader.readNumber();
+    long ignoredCount = reader.readNumber();
+    reader.readNumber();
+    double executionTime = reader.readDuration();
+    int track = (int) reader.readNumber();
+
+    result.currentTestStarted(test);
+    while (!reader.atEnd()) {
+        char event = reader.readEvent();
+        if (event == failureEvent[0]) {
+            SimpleString fileName = reader.readString();
+            int lineNumber = (int) reader.readNumber();
+            SimpleString message = reader.readString();
+            result.addFailure(TestFailure(test, fileName.asCharString(), lineNumber, message));
+        }
+        else if (event == propertyEvent[0]) {
+            SimpleString name = reader.readString();
+            SimpleString value = reader.readString();
+            result.addTestProperty(*test, name, value);
+        }
+        else if (event == phaseStartedEvent[0] || event == phaseEndedEvent[0]) {
+            SimpleString phase = reader.readString();
+            double time = reader.readDuration();
+            if (event == phaseStartedEvent[0])
+                result.testPhaseStartedWithTime(*test, phase.asCharString(), time, track);
+            else
+                result.testPhaseEndedWithTime(*test, phase.asCharString(), time, track);
+        }
+        else
+            result.print(reader.readString().asCharString());
+    }
+    for (long i = 0; i < runCount; i++) result.countRun();
+    for (long i = 0; i < checkCount; i++) result.countCheck();
+    for (long i = 0; i < ignoredCount; i++) result.countIgnored();
+    result.currentTestEndedWithTime(test, executionTime);
+    return executionTime;
+}
+
+static SimpleString failedResult(UtestShell* test, const SimpleString& message)
+{
+    SimpleString result;
+    encodeNumber(result, 1);
+    encodeNumber(result, 0);
+    encodeNumber(result, 0);
+    encodeNumber(result, 1);
+    encodeDuration(result, 0);
+    encodeNumber(result, 0);
+    result += failureEvent;
+    encodeString(result, test->getFile());
+    encodeNumber(result, test->getLineNumber());
+    encodeString(result, message);
+    return result;
+}
+
+TestWorkerPool::TestWorkerPool(int numberOfWorkers, TestPlugin* plugin)
+    : numberOfWorkers_(numberOfWorkers), plugin_(plugin), restartAfterFailure_(false), measureResourceUsage_(false), traceTestPhases_(false), tests_(NULL), expectedNanos_(NULL), dispatchOrder_(NULL), results_(NULL), hasResult_(NULL),
+      numberOfTests_(0), capacity_(0), nextTestToDispatch_(0), nextTestToReplay_(0), workers_(NULL), workersStarted_(false)
+{
+}
+
+TestWorkerPool::~TestWorkerPool()
+{
+    for (int i = 0; workersStarted_ && i < numberOfWorkers_; i++)
+        stopWorker(workers_[i]);
+    delete [] workers_;
+    delete [] tests_;
+    delete [] expectedNanos_;
+    delete [] dispatchOrder_;
+    delete [] results_;
+    delete [] hasResult_;
+}
+
+bool TestWorkerPool::canStartWorkers()
+{
+    int readDescriptor, writeDescriptor;
+    if (PlatformSpecificPipe(&readDescriptor, &writeDescriptor) == -1)
+        return false;
+    PlatformSpecificClose(readDescriptor);
+    PlatformSpecificClose(writeDescriptor);
+    return true;
+}
+
+void TestWorkerPool::restartWorkersAfterFailure()
+{
+    restartAfterFailure_ = true;
+}
+
+void TestWorkerPool::measureResourceUsage()
+{
+    measureResourceUsage_ = true;
+}
+
+void TestWorkerPool::traceTestPhases()
+{
+    traceTestPhases_ = true;
+}
+
+void TestWorkerPool::scheduleTest(UtestShell* test, double expectedNanos)
+{
+    if (numberOfTests_ == capacity_) {
+        capacity_ = (capacity_ == 0) ? 64 : capacity_ * 2;
+        UtestShell** tests = new UtestShell*[capacity_];
+        double* nanos = new double[capacity_];
+        for (int i = 0; i < numberOfTests_; i++) {
+            tests[i] = tests_[i];
+            nanos[i] = expectedNanos_[i];
+        }
+        delete [] tests_;
+        delete [] expectedNanos_;
+        tests_ = tests;
+        expectedNanos_ = nanos;
+    }
+    expectedNanos_[numberOfTests_] = expectedNanos;
+    tests_[numberOfTests_++] = test;
+}
+
+int TestWorkerPool::getNumberOfScheduledTests() const
+{
+    return numberOfTests_;
+}
+
+double TestWorkerPool::replayNextTest(TestResult& result)
+{
+    if (!workersStarted_) startWorkers();
+
+    int index = nextTestToReplay_++;
+    while (!hasResult_[index])
+        collectResults();
+
+    double executionTime = replayRecordedTest(tests_[index], results_[index], result);
+    results_[index] = "";
+    return executionTime;
+}
+
+void TestWorkerPool::startWorkers()
+{
+    workersStarted_ = true;
+    results_ = new SimpleString[numberOfTests_ + 1];
+    hasResult_ = new bool[numberOfTests_ + 1];
+    for (int i = 0; i < numberOfTests_; i++)
+        hasResult_[i] = false;
+    dispatchOrder_ = new int[numberOfTests_ + 1];
+    TestDurations::sortLongestFirst(dispatchOrder_, expectedNanos_, numberOfTests_);
+
+    if (numberOfWorkers_ > numberOfTests_) numberOfWorkers_ = numberOfTests_;
+    workers_ = new TestWorker[numberOfWorkers_ + 1];
+    for (int i = 0; i < numberOfWorkers_; i++) {
+        workers_[i].pid_ = -1;
+        workers_[i].commandDescriptor_ = -1;
+        workers_[i].resultDescriptor_ = -1;
+        workers_[i].runningTest_ = -1;
+    }
+    for (int i = 0; i < numberOfWorkers_; i++)
+        dispatchNextTest(workers_[i]);
+}
+
+bool TestWorkerPool::startWorker(TestWorker& worker)
+{
+    int commandRead, commandWrite, resultRead, resultWrite;
+    if (PlatformSpecificPipe(&commandRead, &commandWrite) == -1)
+        return false;
+    if (PlatformSpecificPipe(&resultRead, &resultWrite) == -1) {
+        PlatformSpecificClose(commandRead);
+        PlatformSpecificClose(commandWrite);
+        return false;
+    }
+
+    PlatformSpecificFlush();
+    worker.pid_ = PlatformSpecificFork();
+    if (worker.pid_ == 0) {
+        PlatformSpecificClose(commandWrite);          // LCOV_EXCL_LINE
+        PlatformSpecificClose(resultRead);            // LCOV_EXCL_LINE
+        worker.commandDescriptor_ = commandRead;      // LCOV_EXCL_LINE
+        worker.resultDescriptor_ = resultWrite;       // LCOV_EXCL_LINE
+        runWorker(worker);                            // LCOV_EXCL_LINE
+    }
+
+    PlatformSpecificClose(commandRead);
+    PlatformSpecificClose(resultWrite);
+    if (worker.pid_ == -1) {
+        PlatformSpecificClose(commandWrite);
+        PlatformSpecificClose(resultRead);
+        return false;
+    }
+    worker.commandDescriptor_ = commandWrite;
+    worker.resultDescriptor_ = resultRead;
+    worker.received_ = "";
+    return true;
+}
+
+void TestWorkerPool::stopWorker(TestWorker& worker)
+{
+    if (worker.pid_ <= 0) return;
+
+    closeDescriptor(worker.commandDescriptor_);
+    closeDescriptor(worker.resultDescriptor_);
+    int status;
+    PlatformSpecificWaitPid(worker.pid_, &status, 0);
+    worker.pid_ = -1;
+}
+
+void TestWorkerPool::runWorker(TestWorker& worker)
+{
+    for (int i = 0; i < numberOfWorkers_; i++) {
+        if (&workers_[i] == &worker) continue;
+        closeDescriptor(workers_[i].commandDescriptor_);
+        closeDescriptor(workers_[i].resultDescriptor_);
+    }
+
+    int index;
+    bool freshWorker = true;
+    while ((index = readCommand(worker.commandDescriptor_)) >= 0 && index < numberOfTests_) {
+        SimpleString message;
+        encodeString(message, recordTest(tests_[index], plugin_, traceTestPhases_, measureResourceUsage_, freshWorker, (long) (&worker - workers_) + 1));
+        if (!writeAll(worker.resultDescriptor_, message)) break;
+        freshWorker = false;
+    }
+    PlatformSpecificExit(0);
+}
+
+void TestWorkerPool::dispatchNextTest(TestWorker& worker)
+{
+    worker.runningTest_ = -1;
+    while (nextTestToDispatch_ < numberOfTests_) {
+        int index = dispatchOrder_[nextTestToDispatch_++];
+
+        if (worker.pid_ <= 0 && !startWorker(worker)) {
+            storeResult(index, failedResult(tests_[index], "Failed to start worker process"));
+            continue;
+        }
+
+        SimpleString command = StringFrom(index);
+        command += "\n";
+        worker.runningTest_ = index;
+        if (!writeAll(worker.commandDescriptor_, command)) {
+            workerDied(worker);
+            return;
+        }
+        return;
+    }
+    stopWorker(worker);
+}
+
+void TestWorkerPool::collectResults()
+{
+    int* descriptors = new int[numberOfWorkers_ + 1];
+    TestWorker** busyWorkers = new TestWorker*[numberOfWorkers_ + 1];
+    int numberOfBusyWorkers = 0;
+    for (int i = 0; i < numberOfWorkers_; i++) {
+        if (workers_[i].runningTest_ == -1) continue;
+        descriptors[numberOfBusyWorkers] = workers_[i].resultDescriptor_;
+        busyWorkers[numberOfBusyWorkers++] = &workers_[i];
+    }
+
+    if (numberOfBusyWorkers > 0) {
+        int readable = PlatformSpecificWaitForReadable(descriptors, numberOfBusyWorkers);
+        receiveFrom(*busyWorkers[(readable < 0) ? 0 : readable]);
+    }
+
+    delete [] descriptors;
+    delete [] busyWorkers;
+}
+
+void TestWorkerPool::receiveFrom(TestWorker& worker)
+{
+    char buffer[4096];
+    int bytesRead = PlatformSpecificRead(worker.resultDescriptor_, buffer, (int) sizeof(buffer) - 1);
+    if (bytesRead <= 0) {
+        workerDied(worker);
+        return;
+    }
+    buffer[bytesRead] = '\0';
+    worker.received_ += buffer;
+
+    int separator = worker.received_.find(':');
+    if (separator < 0) return;
+    size_t begin = (size_t) separator + 1;
+    size_t length = (size_t) SimpleString::AtoI(worker.received_.asCharString());
+    if (worker.received_.size() < begin + length) return;
+
+    storeResult(worker.runningTest_, worker.received_.subString(begin, length));
+    worker.received_ = worker.received_.subString(begin + length, worker.received_.size());
+    if (restartAfterFailure_ && resultHasFailures(worker.runningTest_))
+        stopWorker(worker);
+    dispatchNextTest(worker);
+}
+
+void TestWorkerPool::workerDied(TestWorker& worker)
+{
+    int status = 0;
+    closeDescriptor(worker.commandDescriptor_);
+    closeDescriptor(worker.resultDescriptor_);
+    PlatformSpecificWaitPid(worker.pid_, &status, 0);
+    worker.pid_ = -1;
+
+    int signal = PlatformSpecificTerminationSignal(status);
+    SimpleString message("Failed in worker process");
+    if (signal != 0) {
+        message += " - killed by signal ";
+        message += StringFrom(signal);
+    }
+    storeResult(worker.runningTest_, failedResult(tests_[worker.runningTest_], message));
+    dispatchNextTest(worker);
+}
+
+void TestWorkerPool::storeResult(int testIndex, const SimpleString& message)
+{
+    results_[testIndex] = message;
+    hasResult_[testIndex] = true;
+}
+
+bool TestWorkerPool::resultHasFailures(int testIndex) const
+{
+    TestWorkerMessageReader reader(results_[testIndex]);
+    reader.readNumber();
+    reader.readNumber();
+    reader.readNumber();
+    return reader.readNumber() != 0;
+}
+
+struct TestThreadQueue
+{
+    SimpleMutex* mutex_;
+    int* tests_;
+    int head_;
+    int tail_;
+};
+
+struct TestThread
+{
+    TestThreadPool* pool_;
+    int index_;
+    PlatformSpecificThread thread_;
+};
+
+TestThreadPool::TestThreadPool(int numberOfThreads, TestPlugin* plugin)
+    : numberOfThreads_(numberOfThreads), plugin_(plugin), traceTestPhases_(false), tests_(NULL), expectedNanos_(NULL), results_(NULL), numberOfTests_(0), capacity_(0), nextTestToReplay_(0), queues_(NULL), threads_(NULL)
+{
+}
+
+TestThreadPool::~TestThreadPool()
+{
+    delete [] tests_;
+    delete [] expectedNanos_;
+    delete [] results_;
+}
+
+void TestThreadPool::traceTestPhases()
+{
+    traceTestPhases_ = true;
+}
+
+void TestThreadPool::scheduleTest(UtestShell* test, double expectedNanos)
+{
+    if (numberOfTests_ == capacity_) {
+        capacity_ = (capacity_ == 0) ? 64 : capacity_ * 2;
+        UtestShell** tests = new UtestShell*[capacity_];
+        double* nanos = new double[capacity_];
+        for (int i = 0; i < numberOfTests_; i++) {
+            tests[i] = tests_[i];
+            nanos[i] = expectedNanos_[i];
+        }
+        delete [] tests_;
+        delete [] expectedNanos_;
+        tests_ = tests;
+        expectedNanos_ = nanos;
+    }
+    expectedNanos_[numberOfTests_] = expectedNanos;
+    tests_[numberOfTests_++] = test;
+}
+
+int TestThreadPool::getNumberOfScheduledTests() const
+{
+    return numberOfTests_;
+}
+
+/*
+ * The tests are dealt out longest expected time first, so every queue starts with its
+ * longest test. A thread takes from the head of its own queue and steals from the tail
+ * of the others, where the shortest tests are. The leak detector locks its shards while
+ * the threads allocate, so the leak checks do not stay serialized: each thread checks the
+ * leaks of its own tests. A queue whose thread could not be created runs on the calling
+ * thread with the same plugin copies.
+ */
+void TestThreadPool::runTests()
+{
+    results_ = new SimpleString[numberOfTests_ + 1];
+    if (numberOfThreads_ > numberOfTests_) numberOfThreads_ = numberOfTests_;
+    if (numberOfThreads_ < 1) return;
+
+    int* order = new int[numberOfTests_ + 1];
+    TestDurations::sortLongestFirst(order, expectedNanos_, numberOfTests_);
+    queues_ = new TestThreadQueue[numberOfThreads_];
+    for (int i = 0; i < numberOfThreads_; i++) {
+        queues_[i].mutex_ = new SimpleMutex;
+        queues_[i].tests_ = new int[numberOfTests_ / numberOfThreads_ + 1];
+        queues_[i].head_ = 0;
+        queues_[i].tail_ = 0;
+    }
+    for (int i = 0; i < numberOfTests_; i++) {
+        TestThreadQueue& queue = queues_[i % numberOfThreads_];
+        queue.tests_[queue.tail_++] = order[i];
+    }
+    delete [] order;
+
+    MemoryLeakDetector* detector = MemoryLeakWarningPlugin::getGlobalDetector();
+    bool shardLockingWasEnabled = detector->isShardLockingEnabled();
+    detector->enableShardLocking();
+
+    threads_ = new TestThread[numberOfThreads_];
+    for (int i = 0; i < numberOfThreads_; i++) {
+        threads_[i].pool_ = this;
+        threads_[i].index_ = i;
+        threads_[i].thread_ = CPPUTEST_HAVE_THREAD_LOCAL ? PlatformSpecificThreadCreate(runThread, &threads_[i]) : NULL;
+    }
+    for (int i = 0; i < numberOfThreads_; i++) {
+        if (threads_[i].thread_)
+            PlatformSpecificThreadJoin(threads_[i].thread_);
+        else
+            runThread(&threads_[i]);
+    }
+    if (!shardLockingWasEnabled) detector->disableShardLocking();
+
+    for (int i = 0; i < numberOfThreads_; i++) {
+        delete queues_[i].mutex_;
+        delete [] queues_[i].tests_;
+    }
+    delete [] queues_;
+    delete [] threads_;
+    queues_ = NULL;
+    threads_ = NULL;
+}
+
+/* Copies the enabled plugins that have a thread copy, in the same order */
+static TestPlugin* createThreadCopies(TestPlugin* plugin)
+{
+    if (plugin == NULL || plugin == NullTestPlugin::instance()) return NullTestPlugin::instance();
+
+    TestPlugin* next = createThreadCopies(plugin->getNext());
+    TestPlugin* copy = plugin->isEnabled() ? plugin->createThreadCopy() : NULL;
+    if (copy == NULL) return next;
+    return copy->addPlugin(next);
+}
+
+static void deleteThreadCopies(TestPlugin* plugin)
+{
+    while (plugin != NullTestPlugin::instance()) {
+        TestPlugin* next = plugin->getNext();
+        delete plugin;
+        plugin = next;
+    }
+}
+
+void TestThreadPool::runThread(void* thread)
+{
+    TestThread* testThread = (TestThread*) thread;
+    TestPlugin* plugin = createThreadCopies(testThread->pool_->plugin_);
+    testThread->pool_->runTestsOn(testThread->index_, plugin);
+    deleteThreadCopies(plugin);
+}
+
+void TestThreadPool::runTestsOn(int threadIndex, TestPlugin* plugin)
+{
+    int index;
+    while ((index = takeTest(threadIndex)) >= 0)
+        results_[index] = recordTest(tests_[index], plugin, traceTestPhases_, false, false, threadIndex + 1);
+}
+
+int TestThreadPool::takeTest(int threadIndex)
+{
+    TestThreadQueue& own = queues_[threadIndex];
+    {
+        ScopedMutexLock lock(own.mutex_);
+        if (own.head_ < own.tail_) return own.tests_[own.head_++];
+    }
+    for (int i = 1; i < numberOfThreads_; i++) {
+        TestThreadQueue& other = queues_[(threadIndex + i) % numberOfThreads_];
+        ScopedMutexLock lock(other.mutex_);
+        if (other.head_ < other.tail_) return other.tests_[--other.tail_];
+    }
+    return -1;
+}
+
+double TestThreadPool::replayNextTest(TestResult& result)
+{
+    int index = nextTestToReplay_++;
+    double executionTime = replayRecordedTest(tests_[index], results_[index], result);
+    results_[index] = "";
+    return executionTime;
+}
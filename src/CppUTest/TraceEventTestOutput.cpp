@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2007, Michael Feathers, James Grenning and Bas Vodde
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE EARLIER MENTIONED AUTHORS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TraceEventTestOutput.h"
+#include "CppUTest/PlatformSpecificFunctions.h"
+
+static SimpleString escapedForJson(const SimpleString& text)
+{
+    SimpleString escaped = text;
+    escaped.replace("\\", "\\\\");
+    escaped.replace("\"", "\\\"");
+    escaped.replace("\n", "\\n");
+    return escaped;
+}
+
+struct TraceEventTestOutputImpl
+{
+    TraceEventTestOutputImpl() : file_(0), groupStartTime_(0), groupWritten_(false), numberOfNamedTracks_(0), firstEvent_(true)
+    {
+    }
+
+    PlatformSpecificFile file_;
+    SimpleString shardSuffix_;
+    SimpleString currentGroup_;
+    double groupStartTime_;
+    bool groupWritten_;
+    TestPhaseLog phases_;
+    int numberOfNamedTracks_;
+    bool firstEvent_;
+};
+
+TraceEventTestOutput::TraceEventTestOutput() :
+    impl_(new TraceEventTestOutputImpl)
+{
+}
+
+TraceEventTestOutput::~TraceEventTestOutput()
+{
+    delete impl_;
+}
+
+SimpleString TraceEventTestOutput::createFileName()
+{
+    SimpleString fileName = "cpputest_trace";
+    fileName += impl_->shardSuffix_;
+    fileName += ".json";
+    return fileName;
+}
+
+void TraceEventTestOutput::setShardIndex(int shardIndex)
+{
+    impl_->shardSuffix_ = StringFromFormat("_shard%d", shardIndex);
+}
+
+void TraceEventTestOutput::printTestsStarted()
+{
+    openFileForWrite(createFileName());
+    writeToFile("[");
+    impl_->firstEvent_ = true;
+    impl_->numberOfNamedTracks_ = 0;
+    impl_->phases_.clear();
+    nameTracksUpTo(0);
+}
+
+void TraceEventTestOutput::printTestsEnded(const TestResult& /*result*/)
+{
+    writeToFile("\n]\n");
+    closeFile();
+}
+
+void TraceEventTestOutput::printCurrentTestStarted(const UtestShell& /*test*/)
+{
+}
+
+void TraceEventTestOutput::printCurrentTestEnded(const TestResult& /*result*/)
+{
+    writeTestPhases();
+}
+
+/* The group is only written once one of its tests runs, filtered out groups would just clutter the timeline */
+void TraceEventTestOutput::printCurrentGroupStarted(const UtestShell& test)
+{
+    impl_->currentGroup_ = test.getGroup();
+    impl_->groupStartTime_ = GetPlatformSpecificMonotonicTimeInNanos();
+    impl_->groupWritten_ = false;
+}
+
+void TraceEventTestOutput::printCurrentGroupEnded(const TestResult& /*result*/)
+{
+    if (impl_->groupWritten_)
+        writeEvent(impl_->currentGroup_, "group", 'E', GetPlatformSpecificMonotonicTimeInNanos(), 0);
+    impl_->groupWritten_ = false;
+}
+
+void TraceEventTestOutput::writeGroupStartedWhenNeeded()
+{
+    if (impl_->groupWritten_ || impl_->currentGroup_.isEmpty()) return;
+    writeEvent(impl_->currentGroup_, "group", 'B', impl_->groupStartTime_, 0);
+    impl_->groupWritten_ = true;
+}
+
+bool TraceEventTestOutput::isTracingTestPhases() const
+{
+    return true;
+}
+
+SimpleString TraceEventTestOutput::nameOfPhase(const UtestShell& test, const char* phase) const
+{
+    SimpleString name(phase);
+    if (name == "TEST") return test.getFormattedName();
+    return name;
+}
+
+void TraceEventTestOutput::printTestPhaseStarted(const UtestShell& test, const char* phase, double timeInNanos, int track)
+{
+    impl_->phases_.add(test, phase, timeInNanos, track, true);
+}
+
+void TraceEventTestOutput::printTestPhaseEnded(const UtestShell& test, const char* phase, double timeInNanos, int track)
+{
+    impl_->phases_.add(test, phase, timeInNanos, track, false);
+}
+
+/* Phases are written once the test ended, as writing while it runs would allocate memory and use file functions it may have replaced */
+void TraceEventTestOutput::writeTestPhases()
+{
+    const TestPhaseLog& phases = impl_->phases_;
+    for (int i = 0; i < phases.size(); i++) {
+        nameTracksUpTo(phases.getTrack(i));
+        writeGroupStartedWhenNeeded();
+        writeEvent(nameOfPhase(phases.getTest(i), phases.getPhase(i)), "test", phases.isStarted(i) ? 'B' : 'E', phases.getTimeInNanos(i), phases.getTrack(i));
+    }
+    impl_->phases_.clear();
+}
+
+void TraceEventTestOutput::writeSeparator()
+{
+    writeToFile(impl_->firstEvent_ ? "\n" : ",\n");
+    impl_->firstEvent_ = false;
+}
+
+void TraceEventTestOutput::writeEvent(const SimpleString& name, const char* category, char type, double timeInNanos, int track)
+{
+    writeSeparator();
+    writeToFile(StringFromFormat("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+            escapedForJson(name).asCharString(), category, type, timeInNanos / 1000.0, track));
+}
+
+void TraceEventTestOutput::writeTrackName(int track)
+{
+    SimpleString name = (track == 0) ? SimpleString("main") : StringFromFormat("worker %d", track);
+    writeSeparator();
+    writeToFile(StringFromFormat("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+            track, name.asCharString()));
+}
+
+void TraceEventTestOutput::nameTracksUpTo(int track)
+{
+    while (impl_->numberOfNamedTracks_ <= track)
+        writeTrackName(impl_->numberOfNamedTracks_++);
+}
+
+// LCOV_EXCL_START
+
+void TraceEventTestOutput::printBuffer(const char*)
+{
+}
+
+void TraceEventTestOutput::print(const char*)
+{
+}
+
+void TraceEventTestOutput::print(long)
+{
+}
+
+void TraceEventTestOutput::print(const TestFailure&)
+{
+}
+
+void TraceEventTestOutput::flush()
+{
+}
+
+// LCOV_EXCL_STOP
+
+void TraceEventTestOutput::openFileForWrite(const SimpleString& fileName)
+{
+    impl_->file_ = PlatformSpecificFOpen(fileName.asCharString(), "w");
+}
+
+void TraceEventTestOutput::writeToFile(const SimpleString& buffer)
+{
+    PlatformSpecificFPuts(buffer.asCharString(), impl_->file_);
+}
+
+void TraceEventTestOutput::closeFile()
+{
+    PlatformSpecificFClose(impl_->file_);
+}
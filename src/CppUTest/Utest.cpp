@@ -29,6 +29,7 @@
 #include "CppUTest/TestRegistry.h"
 #include "CppUTest/PlatformSpecificFunctions.h"
 #include "CppUTest/TestOutput.h"
+#include "CppUTest/MemoryLeakDetector.h"
 
 bool doubles_equal(double d1, double d2, double threshold)
 {
@@ -74,6 +75,30 @@ OutsideTestRunnerUTest& OutsideTestRunnerUTest::instance()
     return instance_;
 }
 
+/* Reports a part of running a test to the timeline, also when a failure jumps out of it */
+class TestPhase
+{
+public:
+    TestPhase(const UtestShell& test, TestResult& result, const char* phase)
+        : test_(test), result_(result), phase_(phase)
+    {
+        result_.testPhaseStarted(test_, phase_);
+    }
+
+    ~TestPhase()
+    {
+        result_.testPhaseEnded(test_, phase_);
+    }
+
+private:
+    const UtestShell& test_;
+    TestResult& result_;
+    const char* phase_;
+
+    TestPhase(const TestPhase&);
+    TestPhase& operator=(const TestPhase&);
+};
+
 /*
  * Below helpers are used for the PlatformSpecificSetJmp and LongJmp. They pass a method for what needs to happen after
  * the jump, so that the stack stays right.
@@ -176,6 +201,7 @@ void UtestShell::crash()
 
 void UtestShell::runOneTest(TestPlugin* plugin, TestResult& result)
 {
+    TestPhase phase(*this, result, "TEST");
     HelperTestRunInfo runInfo(this, plugin, &result);
     if (isRunInSeperateProcess())
         PlatformSpecificSetJmp(helperDoRunOneTestSeperateProcess, &runInfo);
@@ -195,7 +221,10 @@ void UtestShell::destroyTest(Utest* test)
 
 void UtestShell::runOneTestInCurrentProcess(TestPlugin* plugin, TestResult& result)
 {
-    plugin->runAllPreTestAction(*this, result);
+    {
+        TestPhase phase(*this, result, "preTestAction");
+        plugin->runAllPreTestAction(*this, result);
+    }
 
     //save test context, so that test class can be tested
     UtestShell* savedTest = UtestShell::getCurrent();
@@ -212,6 +241,7 @@ void UtestShell::runOneTestInCurrentProcess(TestPlugin* plugin, TestResult& resu
     UtestShell::setCurrentTest(savedTest);
     UtestShell::setTestResult(savedResult);
 
+    TestPhase phase(*this, result, "postTestAction");
     plugin->runAllPostTestAction(*this, result);
 }
 
@@ -223,12 +253,21 @@ UtestShell *UtestShell::getNext() const
 UtestShell* UtestShell::addTest(UtestShell *test)
 {
     next_ = test;
+    PlatformSpecificAtomicAdd(&relinksAndRenames_, 1);
     return this;
 }
 
+long UtestShell::getNumberOfRelinksAndRenames()
+{
+    return PlatformSpecificAtomicLoad(&relinksAndRenames_);
+}
+
 int UtestShell::countTests()
 {
-    return next_ ? next_->countTests() + 1 : 1;
+    int count = 0;
+    for (const UtestShell* test = this; test; test = test->next_)
+        count++;
+    return count;
 }
 
 SimpleString UtestShell::getMacroName() const
@@ -263,6 +302,16 @@ bool UtestShell::hasFailed() const
     return hasFailed_;
 }
 
+bool UtestShell::isBenchmark() const
+{
+    return false;
+}
+
+bool UtestShell::isThreadSafe() const
+{
+    return false;
+}
+
 void UtestShell::countCheck()
 {
     getTestResult()->countCheck();
@@ -297,11 +346,23 @@ void UtestShell::setLineNumber(int lineNumber)
 void UtestShell::setGroupName(const char* groupName)
 {
     group_ = groupName;
+    PlatformSpecificAtomicAdd(&relinksAndRenames_, 1);
 }
 
 void UtestShell::setTestName(const char* testName)
 {
     name_ = testName;
+    PlatformSpecificAtomicAdd(&relinksAndRenames_, 1);
+}
+
+bool UtestShell::hasName(const SimpleString& name) const
+{
+    return SimpleString::StrCmp(name_, name.asCharString()) == 0;
+}
+
+bool UtestShell::hasGroup(const SimpleString& group) const
+{
+    return SimpleString::StrCmp(group_, group.asCharString()) == 0;
 }
 
 const SimpleString UtestShell::getFile() const
@@ -329,6 +390,11 @@ bool UtestShell::shouldRun(const TestFilter* groupFilters, const TestFilter* nam
     return match(group_, groupFilters) && match(name_, nameFilters);
 }
 
+bool UtestShell::shouldRun(const TestFilterMatcher& groupMatcher, const TestFilterMatcher& nameMatcher, const TestFilterMatcher& testMatcher) const
+{
+    return groupMatcher.match(group_) && nameMatcher.match(name_) && testMatcher.match(group_, name_);
+}
+
 void UtestShell::failWith(const TestFailure& failure)
 {
     failWith(failure, NormalTestTerminator());
@@ -473,8 +539,9 @@ void UtestShell::print(const SimpleString& text, const char* fileName, int lineN
     print(text.asCharString(), fileName, lineNumber);
 }
 
-TestResult* UtestShell::testResult_ = NULL;
-UtestShell* UtestShell::currentTest_ = NULL;
+volatile long UtestShell::relinksAndRenames_ = 0;
+CPPUTEST_THREAD_LOCAL TestResult* UtestShell::testResult_ = NULL;
+CPPUTEST_THREAD_LOCAL UtestShell* UtestShell::currentTest_ = NULL;
 
 void UtestShell::setTestResult(TestResult* result)
 {
@@ -500,6 +567,13 @@ UtestShell* UtestShell::getCurrent()
     return currentTest_;
 }
 
+int UtestShell::runTestPhase(void (*function) (void*), void* data, const char* phase)
+{
+    UtestShell* current = getCurrent();
+    TestPhase tracedPhase(*current, *current->getTestResult(), phase);
+    return PlatformSpecificSetJmp(function, data);
+}
+
 
 ExecFunctionTestShell::~ExecFunctionTestShell()
 {
@@ -520,8 +594,8 @@ Utest::~Utest()
 void Utest::run()
 {
     try {
-        if (PlatformSpecificSetJmp(helperDoTestSetup, this)) {
-            PlatformSpecificSetJmp(helperDoTestBody, this);
+        if (UtestShell::runTestPhase(helperDoTestSetup, this, "setup")) {
+            UtestShell::runTestPhase(helperDoTestBody, this, "testBody");
         }
     }
     catch (CppUTestFailedException&)
@@ -530,7 +604,7 @@ void Utest::run()
     }
 
     try {
-        PlatformSpecificSetJmp(helperDoTestTeardown, this);
+        UtestShell::runTestPhase(helperDoTestTeardown, this, "teardown");
     }
     catch (CppUTestFailedException&)
     {
@@ -542,10 +616,10 @@ void Utest::run()
 
 void Utest::run()
 {
-    if (PlatformSpecificSetJmp(helperDoTestSetup, this)) {
-        PlatformSpecificSetJmp(helperDoTestBody, this);
+    if (UtestShell::runTestPhase(helperDoTestSetup, this, "setup")) {
+        UtestShell::runTestPhase(helperDoTestBody, this, "testBody");
     }
-    PlatformSpecificSetJmp(helperDoTestTeardown, this);
+    UtestShell::runTestPhase(helperDoTestTeardown, this, "teardown");
 }
 
 #endif
@@ -562,6 +636,16 @@ void Utest::teardown()
 {
 }
 
+bool Utest::isThreadSafeGroup()
+{
+    return false;
+}
+
+bool ThreadSafeUtest::isThreadSafeGroup()
+{
+    return true;
+}
+
 
 /////////////////// Terminators
 
@@ -643,6 +727,380 @@ void IgnoredUtestShell::runOneTest(TestPlugin* /* plugin */, TestResult& result)
 }
 
 
+////////////// BenchmarkResult /////////////
+
+static void sortDoubles(double* values, int count)
+{
+    for (int i = 1; i < count; i++) {
+        double value = values[i];
+        int j = i;
+        for (; j > 0 && values[j - 1] > value; j--)
+            values[j] = values[j - 1];
+        values[j] = value;
+    }
+}
+
+static double squareRoot(double value)
+{
+    if (value <= 0.0) return 0.0;
+    double root = (value > 1.0) ? value : 1.0;
+    for (;;) {
+        double next = 0.5 * (root + value / root);
+        if (next >= root) return root;
+        root = next;
+    }
+}
+
+BenchmarkResult::BenchmarkResult()
+    : numberOfSamples_(0), iterationsPerSample_(0), minimum_(0.0), median_(0.0), percentile99_(0.0), standardDeviation_(0.0)
+{
+}
+
+void BenchmarkResult::calculate(double* nanosPerIteration, int numberOfSamples, long iterationsPerSample)
+{
+    numberOfSamples_ = numberOfSamples;
+    iterationsPerSample_ = iterationsPerSample;
+    if (numberOfSamples == 0) return;
+
+    sortDoubles(nanosPerIteration, numberOfSamples);
+    minimum_ = nanosPerIteration[0];
+    median_ = (numberOfSamples % 2) ? nanosPerIteration[numberOfSamples / 2]
+            : (nanosPerIteration[numberOfSamples / 2 - 1] + nanosPerIteration[numberOfSamples / 2]) / 2.0;
+    percentile99_ = nanosPerIteration[(99 * numberOfSamples + 99) / 100 - 1];
+
+    double sum = 0.0;
+    for (int i = 0; i < numberOfSamples; i++)
+        sum += nanosPerIteration[i];
+    double mean = sum / numberOfSamples;
+    double squaredDeviations = 0.0;
+    for (int i = 0; i < numberOfSamples; i++)
+        squaredDeviations += (nanosPerIteration[i] - mean) * (nanosPerIteration[i] - mean);
+    standardDeviation_ = (numberOfSamples > 1) ? squareRoot(squaredDeviations / (numberOfSamples - 1)) : 0.0;
+}
+
+int BenchmarkResult::getNumberOfSamples() const
+{
+    return numberOfSamples_;
+}
+
+long BenchmarkResult::getIterationsPerSample() const
+{
+    return iterationsPerSample_;
+}
+
+double BenchmarkResult::getMinimum() const
+{
+    return minimum_;
+}
+
+double BenchmarkResult::getMedian() const
+{
+    return median_;
+}
+
+double BenchmarkResult::getPercentile99() const
+{
+    return percentile99_;
+}
+
+double BenchmarkResult::getStandardDeviation() const
+{
+    return standardDeviation_;
+}
+
+////////////// BenchmarkUtestShell /////////////
+
+static const double minimumSampleTimeInNanos = 1000000.0;
+static const double maximumSamplingTimeInNanos = 1000000000.0;
+static const long maximumIterationsPerSample = 1000000000L;
+
+BenchmarkUtestShell::BenchmarkUtestShell()
+{
+}
+
+BenchmarkUtestShell::BenchmarkUtestShell(const char* groupName, const char* testName, const char* fileName, int lineNumber) :
+   UtestShell(groupName, testName, fileName, lineNumber)
+{
+}
+
+BenchmarkUtestShell::~BenchmarkUtestShell()
+{
+}
+
+bool BenchmarkUtestShell::isBenchmark() const
+{
+    return true;
+}
+
+SimpleString BenchmarkUtestShell::getMacroName() const
+{
+    return "BENCHMARK";
+}
+
+double BenchmarkUtestShell::measureIterations(Utest* test, long iterations)
+{
+    double started = GetPlatformSpecificMonotonicTimeInNanos();
+    for (long i = 0; i < iterations; i++)
+        runIteration(test);
+    return GetPlatformSpecificMonotonicTimeInNanos() - started;
+}
+
+long BenchmarkUtestShell::calibrateIterations(Utest* test)
+{
+    long iterations = 1;
+    double nanos = measureIterations(test, iterations);
+    while (nanos < minimumSampleTimeInNanos && iterations < maximumIterationsPerSample) {
+        double scale = (nanos > 0.0) ? 1.2 * minimumSampleTimeInNanos / nanos : 10.0;
+        if (scale > 10.0) scale = 10.0;
+        if (scale < 2.0) scale = 2.0;
+        double scaled = (double) iterations * scale;
+        iterations = (scaled < (double) maximumIterationsPerSample) ? (long) scaled : maximumIterationsPerSample;
+        nanos = measureIterations(test, iterations);
+    }
+    return iterations;
+}
+
+void BenchmarkUtestShell::runBenchmark(Utest* test)
+{
+    long iterations = calibrateIterations(test);
+    for (int i = 0; i < numberOfWarmupSamples; i++)
+        measureIterations(test, iterations);
+
+    double nanosPerIteration[maximumNumberOfSamples];
+    double samplingTime = 0.0;
+    int samples = 0;
+    while (samples < maximumNumberOfSamples && (samples < minimumNumberOfSamples || samplingTime < maximumSamplingTimeInNanos)) {
+        double nanos = measureIterations(test, iterations);
+        samplingTime += nanos;
+        nanosPerIteration[samples++] = nanos / (double) iterations;
+    }
+
+    BenchmarkResult benchmark;
+    benchmark.calculate(nanosPerIteration, samples, iterations);
+    getTestResult()->addBenchmarkResult(*this, benchmark);
+}
+
+////////////// ConcurrentUtestShell ////////////
+
+/* Holds the threads until all of them have started, so their bodies start together */
+class ConcurrentStartBarrier
+{
+public:
+    ConcurrentStartBarrier()
+        : mutex_(PlatformSpecificMutexCreate()), condition_(PlatformSpecificConditionCreate()), arrived_(0), released_(false)
+    {
+    }
+
+    ~ConcurrentStartBarrier()
+    {
+        PlatformSpecificConditionDestroy(condition_);
+        PlatformSpecificMutexDestroy(mutex_);
+    }
+
+    void arriveAndWait()
+    {
+        PlatformSpecificMutexLock(mutex_);
+        arrived_++;
+        PlatformSpecificConditionBroadcast(condition_);
+        while (!released_)
+            PlatformSpecificConditionWait(condition_, mutex_);
+        PlatformSpecificMutexUnlock(mutex_);
+    }
+
+    void releaseWhenArrived(int numberOfThreads)
+    {
+        PlatformSpecificMutexLock(mutex_);
+        while (arrived_ < numberOfThreads)
+            PlatformSpecificConditionWait(condition_, mutex_);
+        released_ = true;
+        PlatformSpecificConditionBroadcast(condition_);
+        PlatformSpecificMutexUnlock(mutex_);
+    }
+
+private:
+    PlatformSpecificMutex mutex_;
+    PlatformSpecificCondition condition_;
+    int arrived_;
+    bool released_;
+};
+
+/* Keeps the checks, the first failure and the prints of one thread until they are gathered into the test */
+class ConcurrentThreadResult : public TestResult
+{
+public:
+    ConcurrentThreadResult(TestOutput& output) : TestResult(output), failed_(false), lineNumber_(0)
+    {
+    }
+
+    virtual void addFailure(const TestFailure& failure) _override
+    {
+        if (failed_) return;
+        failed_ = true;
+        fileName_ = failure.getFileName();
+        lineNumber_ = failure.getFailureLineNumber();
+        message_ = failure.getMessage();
+    }
+
+    bool failed_;
+    SimpleString fileName_;
+    int lineNumber_;
+    SimpleString message_;
+};
+
+/* The failures of the threads are gathered after the body on the calling thread has ended */
+class ContinuingTestTerminator : public TestTerminator
+{
+public:
+    virtual void exitCurrentTest() const _override
+    {
+    }
+};
+
+struct ConcurrentTestThread
+{
+    ConcurrentTestThread() : result_(output_), shell_(NULL), test_(NULL), barrier_(NULL), thread_(NULL), executionTimeInNanos_(0.0)
+    {
+    }
+
+    StringBufferTestOutput output_;
+    ConcurrentThreadResult result_;
+    ConcurrentUtestShell* shell_;
+    Utest* test_;
+    ConcurrentStartBarrier* barrier_;
+    PlatformSpecificThread thread_;
+    double executionTimeInNanos_;
+};
+
+/* The thread running a concurrent body, whose result keeps the failures until they are gathered */
+static CPPUTEST_THREAD_LOCAL ConcurrentTestThread* currentConcurrentThread = NULL;
+
+ConcurrentUtestShell::ConcurrentUtestShell(int numberOfThreads) : numberOfThreads_(numberOfThreads)
+{
+}
+
+ConcurrentUtestShell::~ConcurrentUtestShell()
+{
+}
+
+int ConcurrentUtestShell::getNumberOfThreads() const
+{
+    return numberOfThreads_;
+}
+
+SimpleString ConcurrentUtestShell::getMacroName() const
+{
+    return "TEST_CONCURRENT";
+}
+
+void ConcurrentUtestShell::failWith(const TestFailure& failure)
+{
+    failWith(failure, NormalTestTerminator());
+} // LCOV_EXCL_LINE
+
+/* A body only fails its own thread, the test fails when the threads are gathered */
+void ConcurrentUtestShell::failWith(const TestFailure& failure, const TestTerminator& terminator)
+{
+    if (currentConcurrentThread == NULL) {
+        UtestShell::failWith(failure, terminator);
+        return;
+    }
+    currentConcurrentThread->result_.addFailure(failure);
+    terminator.exitCurrentTest();
+} // LCOV_EXCL_LINE
+
+void ConcurrentUtestShell::runBody(void* thread)
+{
+    ConcurrentTestThread* concurrentThread = (ConcurrentTestThread*) thread;
+    concurrentThread->shell_->runConcurrentBody(concurrentThread->test_);
+}
+
+/* Failures end the body with a jump or exception on the thread itself, never across threads */
+void ConcurrentUtestShell::runThread(void* thread)
+{
+    ConcurrentTestThread* concurrentThread = (ConcurrentTestThread*) thread;
+    ConcurrentUtestShell* shell = concurrentThread->shell_;
+    UtestShell* savedTest = UtestShell::getCurrent();
+    TestResult* savedResult = shell->getTestResult();
+    ConcurrentTestThread* savedThread = currentConcurrentThread;
+    shell->setCurrentTest(shell);
+    shell->setTestResult(&concurrentThread->result_);
+    currentConcurrentThread = concurrentThread;
+
+    if (concurrentThread->barrier_) concurrentThread->barrier_->arriveAndWait();
+    double started = GetPlatformSpecificMonotonicTimeInNanos();
+#if CPPUTEST_USE_STD_CPP_LIB
+    try {
+        PlatformSpecificSetJmp(runBody, thread);
+    }
+    catch (CppUTestFailedException&)
+    {
+        PlatformSpecificRestoreJumpBuffer();
+    }
+#else
+    PlatformSpecificSetJmp(runBody, thread);
+#endif
+    concurrentThread->executionTimeInNanos_ = GetPlatformSpecificMonotonicTimeInNanos() - started;
+
+    currentConcurrentThread = savedThread;
+    shell->setCurrentTest(savedTest);
+    shell->setTestResult(savedResult);
+}
+
+/*
+ * The threads that could not be created run their body on the calling thread after the
+ * others were released. Without thread-local test state all bodies run that way, as the
+ * threads would report into each other's results. The leak detector locks its shards
+ * while the bodies allocate.
+ */
+void ConcurrentUtestShell::runConcurrently(Utest* test)
+{
+    MemoryLeakDetector* detector = MemoryLeakWarningPlugin::getGlobalDetector();
+    bool shardLockingWasEnabled = detector->isShardLockingEnabled();
+    detector->enableShardLocking();
+
+    ConcurrentTestThread* threads = new ConcurrentTestThread[numberOfThreads_];
+    ConcurrentStartBarrier barrier;
+    int started = 0;
+    for (int i = 0; i < numberOfThreads_; i++) {
+        threads[i].shell_ = this;
+        threads[i].test_ = test;
+        threads[i].barrier_ = &barrier;
+        threads[i].thread_ = CPPUTEST_HAVE_THREAD_LOCAL ? PlatformSpecificThreadCreate(runThread, &threads[i]) : NULL;
+        if (threads[i].thread_) started++;
+    }
+    barrier.releaseWhenArrived(started);
+
+    for (int i = 0; i < numberOfThreads_; i++) {
+        if (threads[i].thread_)
+            PlatformSpecificThreadJoin(threads[i].thread_);
+        else {
+            threads[i].barrier_ = NULL;
+            runThread(&threads[i]);
+        }
+    }
+    if (!shardLockingWasEnabled) detector->disableShardLocking();
+
+    for (int i = 0; i < numberOfThreads_; i++) {
+        gatherResultOf(threads[i], i + 1);
+        getTestResult()->addTestProperty(*this, StringFromFormat("thread_%d_ms", i + 1), StringFromFormat("%.3f", threads[i].executionTimeInNanos_ / 1000000.0));
+    }
+    delete [] threads;
+}
+
+void ConcurrentUtestShell::gatherResultOf(ConcurrentTestThread& thread, int threadNumber)
+{
+    TestResult* result = getTestResult();
+    for (long i = 0; i < thread.result_.getCheckCount(); i++)
+        result->countCheck();
+    if (thread.output_.getOutput().size() > 0)
+        result->print(thread.output_.getOutput().asCharString());
+    if (thread.result_.failed_) {
+        SimpleString message = StringFromFormat("Failed in thread %d: ", threadNumber);
+        message += thread.result_.message_;
+        failWith(TestFailure(this, thread.result_.fileName_.asCharString(), thread.result_.lineNumber_, message), ContinuingTestTerminator());
+    }
+}
+
 ////////////// TestInstaller ////////////
 
 TestInstaller::TestInstaller(UtestShell& shell, const char* groupName, const char* testName, const char* fileName, int lineNumber)
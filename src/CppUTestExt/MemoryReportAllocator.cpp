@@ -72,6 +72,11 @@ void MemoryReportAllocator::setFormatter(MemoryReportFormatter* formatter)
     formatter_ = formatter;
 }
 
+bool MemoryReportAllocator::guardsMemoryBounds()
+{
+    return realAllocator_->guardsMemoryBounds();
+}
+
 char* MemoryReportAllocator::alloc_memory(size_t size, const char* file, int line)
 {
     char* memory = realAllocator_->alloc_memory(size, file, line);
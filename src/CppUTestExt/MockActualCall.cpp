@@ -50,13 +50,14 @@ SimpleString MockCheckedActualCall::getName() const
 }
 
 MockCheckedActualCall::MockCheckedActualCall(int callOrder, MockFailureReporter* reporter, const MockExpectedCallsList& allExpectations)
-    : callOrder_(callOrder), reporter_(reporter), state_(CALL_SUCCEED), fulfilledExpectation_(NULL), allExpectations_(allExpectations), outputParameterExpectations_(NULL)
+    : callOrder_(callOrder), reporter_(reporter), state_(CALL_SUCCEED), fulfilledExpectation_(NULL), allExpectations_(allExpectations),
+      nextExpectation_(NULL), lastExpectation_(NULL), passedArguments_(NULL), outputParameterExpectations_(NULL)
 {
-    unfulfilledExpectations_.addUnfulfilledExpectations(allExpectations);
 }
 
 MockCheckedActualCall::~MockCheckedActualCall()
 {
+    cleanUpPassedArgumentsList();
     cleanUpOutputParameterList();
 }
 
@@ -103,10 +104,31 @@ void MockCheckedActualCall::finalizeOutputParameters(MockCheckedExpectedCall* ex
     }
 }
 
+void MockCheckedActualCall::finalizeOutputParametersWhenFulfilled()
+{
+    if (outputParameterExpectations_ == NULL)
+        return;
+
+    MockCheckedExpectedCall* expectation = unfulfilledExpectations_.getOneFulfilledExpectationWithIgnoredParameters();
+    while (expectation == NULL) {
+        MockCheckedExpectedCall* addedExpectation = addNextUnfulfilledExpectation();
+        if (addedExpectation == NULL)
+            return;
+        if (addedExpectation->isFulfilledWithoutIgnoredParameters())
+            expectation = addedExpectation;
+    }
+    finalizeOutputParameters(expectation);
+}
+
 void MockCheckedActualCall::finalizeCallWhenFulfilled()
 {
-    if (unfulfilledExpectations_.hasFulfilledExpectationsWithoutIgnoredParameters()) {
-        finalizeOutputParameters(unfulfilledExpectations_.getOneFulfilledExpectationWithIgnoredParameters());
+    if (state_ != CALL_IN_PROGRESS)
+        return;
+
+    if (! unfulfilledExpectations_.hasFulfilledExpectations()) {
+        MockCheckedExpectedCall* addedExpectation = addNextUnfulfilledExpectation();
+        while (addedExpectation && ! addedExpectation->isFulfilled())
+            addedExpectation = addNextUnfulfilledExpectation();
     }
 
     if (unfulfilledExpectations_.hasFulfilledExpectations()) {
@@ -115,6 +137,54 @@ void MockCheckedActualCall::finalizeCallWhenFulfilled()
     }
 }
 
+bool MockCheckedActualCall::passArgumentsTo(MockCheckedExpectedCall* expectation)
+{
+    expectation->callWasMade(callOrder_);
+    for (MockPassedArgumentsListNode* p = passedArguments_; p; p = p->next_) {
+        if (expectation->isFulfilled()) {
+            expectation->resetExpectation();
+            return false;
+        }
+
+        if (p->kind_ == MockPassedArgumentsListNode::INPUT_PARAMETER) {
+            if (! expectation->hasInputParameter(p->parameter_))
+                return false;
+            expectation->inputParameterWasPassed(p->parameter_.getName());
+        }
+        else if (p->kind_ == MockPassedArgumentsListNode::OUTPUT_PARAMETER) {
+            if (! expectation->hasOutputParameter(p->parameter_))
+                return false;
+            expectation->outputParameterWasPassed(p->parameter_.getName());
+        }
+        else {
+            if (! expectation->relatesToObject(p->objectPtr_))
+                return false;
+            expectation->wasPassedToObject();
+        }
+    }
+    return true;
+}
+
+MockCheckedExpectedCall* MockCheckedActualCall::addNextUnfulfilledExpectation()
+{
+    while (nextExpectation_) {
+        MockCheckedExpectedCall* expectation = nextExpectation_->expectedCall_;
+        nextExpectation_ = (nextExpectation_ == lastExpectation_) ? NULL : nextExpectation_->nextWithSameName_;
+
+        if (! expectation->isFulfilled() && passArgumentsTo(expectation)) {
+            unfulfilledExpectations_.addExpectedCall(expectation);
+            return expectation;
+        }
+    }
+    return NULL;
+}
+
+void MockCheckedActualCall::addAllUnfulfilledExpectations()
+{
+    while (addNextUnfulfilledExpectation())
+        ;
+}
+
 void MockCheckedActualCall::callHasSucceeded()
 {
     setState(CALL_SUCCEED);
@@ -136,20 +206,25 @@ MockActualCall& MockCheckedActualCall::withName(const SimpleString& name)
     setName(name);
     callIsInProgress();
 
-    unfulfilledExpectations_.onlyKeepExpectationsRelatedTo(name);
-    if (unfulfilledExpectations_.isEmpty()) {
+    nextExpectation_ = allExpectations_.firstUnfulfilledNodeRelatedTo(name);
+    lastExpectation_ = (nextExpectation_) ? nextExpectation_->nameEntry_->last_ : NULL;
+    if (addNextUnfulfilledExpectation() == NULL) {
         MockUnexpectedCallHappenedFailure failure(getTest(), name, allExpectations_);
         failTest(failure);
         return *this;
     }
 
-    unfulfilledExpectations_.callWasMade(callOrder_);
-
-    finalizeCallWhenFulfilled();
+    finalizeOutputParametersWhenFulfilled();
 
     return *this;
 }
 
+/* Memory buffers and objects of custom types are not copied, so they are compared with all candidates while they are around */
+static bool canBeComparedLater(const MockNamedValue& parameter)
+{
+    return parameter.getComparator() == NULL && parameter.getType() != "const unsigned char*";
+}
+
 MockActualCall& MockCheckedActualCall::withCallOrder(int)
 {
     return *this;
@@ -162,18 +237,22 @@ void MockCheckedActualCall::checkInputParameter(const MockNamedValue& actualPara
         return;
     }
 
+    if (! canBeComparedLater(actualParameter))
+        addAllUnfulfilledExpectations();
+
     callIsInProgress();
 
     unfulfilledExpectations_.onlyKeepExpectationsWithInputParameter(actualParameter);
+    addPassedArgument(MockPassedArgumentsListNode::INPUT_PARAMETER, actualParameter, NULL);
 
-    if (unfulfilledExpectations_.isEmpty()) {
+    if (unfulfilledExpectations_.isEmpty() && addNextUnfulfilledExpectation() == NULL) {
         MockUnexpectedInputParameterFailure failure(getTest(), getName(), actualParameter, allExpectations_);
         failTest(failure);
         return;
     }
 
     unfulfilledExpectations_.parameterWasPassed(actualParameter.getName());
-    finalizeCallWhenFulfilled();
+    finalizeOutputParametersWhenFulfilled();
 }
 
 void MockCheckedActualCall::checkOutputParameter(const MockNamedValue& outputParameter)
@@ -186,15 +265,16 @@ void MockCheckedActualCall::checkOutputParameter(const MockNamedValue& outputPar
     callIsInProgress();
 
     unfulfilledExpectations_.onlyKeepExpectationsWithOutputParameter(outputParameter);
+    addPassedArgument(MockPassedArgumentsListNode::OUTPUT_PARAMETER, outputParameter, NULL);
 
-    if (unfulfilledExpectations_.isEmpty()) {
+    if (unfulfilledExpectations_.isEmpty() && addNextUnfulfilledExpectation() == NULL) {
         MockUnexpectedOutputParameterFailure failure(getTest(), getName(), outputParameter, allExpectations_);
         failTest(failure);
         return;
     }
 
     unfulfilledExpectations_.outputParameterWasPassed(outputParameter.getName());
-    finalizeCallWhenFulfilled();
+    finalizeOutputParametersWhenFulfilled();
 }
 
 MockActualCall& MockCheckedActualCall::withUnsignedIntParameter(const SimpleString& name, unsigned int value)
@@ -305,8 +385,9 @@ MockActualCall& MockCheckedActualCall::withOutputParameterOfType(const SimpleStr
     return *this;
 }
 
-bool MockCheckedActualCall::isFulfilled() const
+bool MockCheckedActualCall::isFulfilled()
 {
+    finalizeCallWhenFulfilled();
     return state_ == CALL_SUCCEED;
 }
 
@@ -317,6 +398,7 @@ bool MockCheckedActualCall::hasFailed() const
 
 void MockCheckedActualCall::checkExpectations()
 {
+    finalizeCallWhenFulfilled();
     if (state_ != CALL_IN_PROGRESS)
     {
         unfulfilledExpectations_.resetExpectations();
@@ -470,8 +552,9 @@ MockActualCall& MockCheckedActualCall::onObject(void* objectPtr)
     callIsInProgress();
 
     unfulfilledExpectations_.onlyKeepExpectationsOnObject(objectPtr);
+    addPassedArgument(MockPassedArgumentsListNode::OBJECT, MockNamedValue(""), objectPtr);
 
-    if (unfulfilledExpectations_.isEmpty()) {
+    if (unfulfilledExpectations_.isEmpty() && addNextUnfulfilledExpectation() == NULL) {
         MockUnexpectedObjectFailure failure(getTest(), getName(), objectPtr, allExpectations_);
         failTest(failure);
         return *this;
@@ -479,7 +562,7 @@ MockActualCall& MockCheckedActualCall::onObject(void* objectPtr)
 
     unfulfilledExpectations_.wasPassedToObject();
 
-    finalizeCallWhenFulfilled();
+    finalizeOutputParametersWhenFulfilled();
     return *this;
 }
 
@@ -496,6 +579,40 @@ void MockCheckedActualCall::addOutputParameter(const SimpleString& name, const S
     }
 }
 
+MockCheckedActualCall::MockPassedArgumentsListNode::MockPassedArgumentsListNode(Kind kind, const MockNamedValue& parameter, void* objectPtr)
+    : kind_(kind), parameter_(parameter), objectPtr_(objectPtr), next_(NULL)
+{
+    if (parameter_.getType() == "const char*") {
+        stringValue_ = parameter.getStringValue();
+        parameter_.setValue(stringValue_.asCharString());
+    }
+}
+
+void MockCheckedActualCall::addPassedArgument(MockPassedArgumentsListNode::Kind kind, const MockNamedValue& parameter, void* objectPtr)
+{
+    MockPassedArgumentsListNode* newNode = new MockPassedArgumentsListNode(kind, parameter, objectPtr);
+
+    if (passedArguments_ == NULL)
+        passedArguments_ = newNode;
+    else {
+        MockPassedArgumentsListNode* lastNode = passedArguments_;
+        while (lastNode->next_) lastNode = lastNode->next_;
+        lastNode->next_ = newNode;
+    }
+}
+
+void MockCheckedActualCall::cleanUpPassedArgumentsList()
+{
+    MockPassedArgumentsListNode* current = passedArguments_;
+    MockPassedArgumentsListNode* toBeDeleted = NULL;
+
+    while (current) {
+        toBeDeleted = current;
+        passedArguments_ = current = current->next_;
+        delete toBeDeleted;
+    }
+}
+
 void MockCheckedActualCall::cleanUpOutputParameterList()
 {
     MockOutputParametersListNode* current = outputParameterExpectations_;
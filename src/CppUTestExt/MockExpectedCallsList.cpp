@@ -29,8 +29,11 @@
 #include "CppUTestExt/MockExpectedCallsList.h"
 #include "CppUTestExt/MockCheckedExpectedCall.h"
 
-MockExpectedCallsList::MockExpectedCallsList() : head_(NULL)
+MockExpectedCallsList::MockExpectedCallsList()
+    : head_(NULL), tail_(NULL), nameIndex_(initialNameIndex_), nameIndexSize_(INITIAL_NAME_INDEX_SIZE), amountOfNames_(0)
 {
+    for (size_t i = 0; i < nameIndexSize_; i++)
+        nameIndex_[i] = NULL;
 }
 
 MockExpectedCallsList::~MockExpectedCallsList()
@@ -40,6 +43,7 @@ MockExpectedCallsList::~MockExpectedCallsList()
         delete head_;
         head_ = next;
     }
+    clearNameIndex();
 }
 
 bool MockExpectedCallsList::hasCallsOutOfOrder() const
@@ -60,15 +64,16 @@ int MockExpectedCallsList::size() const
 
 bool MockExpectedCallsList::isEmpty() const
 {
-    return size() == 0;
+    return head_ == NULL;
 }
 
 
 int MockExpectedCallsList::amountOfExpectationsFor(const SimpleString& name) const
 {
     int count = 0;
-    for (MockExpectedCallsListNode* p = head_; p; p = p->next_)
-        if (p->expectedCall_->relatesTo(name)) count++;
+    MockExpectedCallsNameEntry* entry = findNameEntry(name);
+    for (MockExpectedCallsListNode* p = entry ? entry->first_ : NULL; p; p = p->nextWithSameName_)
+        count++;
     return count;
 
 }
@@ -101,10 +106,8 @@ bool MockExpectedCallsList::hasUnfulfilledExpectations() const
 
 bool MockExpectedCallsList::hasExpectationWithName(const SimpleString& name) const
 {
-        for (MockExpectedCallsListNode* p = head_; p; p = p->next_)
-            if (p->expectedCall_->relatesTo(name))
-                return true;
-    return false;
+    MockExpectedCallsNameEntry* entry = findNameEntry(name);
+    return entry && entry->first_;
 }
 
 void MockExpectedCallsList::addExpectedCall(MockCheckedExpectedCall* call)
@@ -113,11 +116,12 @@ void MockExpectedCallsList::addExpectedCall(MockCheckedExpectedCall* call)
 
     if (head_ == NULL)
         head_ = newCall;
-    else {
-        MockExpectedCallsListNode* lastCall = head_;
-        while (lastCall->next_) lastCall = lastCall->next_;
-        lastCall->next_ = newCall;
-    }
+    else
+        tail_->next_ = newCall;
+    tail_ = newCall;
+
+    newCall->nameEntry_ = findOrCreateNameEntry(call->getName());
+    addToNameIndex(newCall);
 }
 
 void MockExpectedCallsList::addUnfulfilledExpectations(const MockExpectedCallsList& list)
@@ -127,13 +131,20 @@ void MockExpectedCallsList::addUnfulfilledExpectations(const MockExpectedCallsLi
             addExpectedCall(p->expectedCall_);
 }
 
-void MockExpectedCallsList::addExpectationsRelatedTo(const SimpleString& name, const MockExpectedCallsList& list)
+void MockExpectedCallsList::addUnfulfilledExpectationsRelatedTo(const SimpleString& name, const MockExpectedCallsList& list)
 {
-    for (MockExpectedCallsListNode* p = list.head_; p; p = p->next_)
-        if (p->expectedCall_->relatesTo(name))
+    for (MockExpectedCallsListNode* p = list.firstUnfulfilledNodeRelatedTo(name); p; p = p->nextWithSameName_)
+        if (! p->expectedCall_->isFulfilled())
             addExpectedCall(p->expectedCall_);
 }
 
+void MockExpectedCallsList::addExpectationsRelatedTo(const SimpleString& name, const MockExpectedCallsList& list)
+{
+    MockExpectedCallsNameEntry* entry = list.findNameEntry(name);
+    for (MockExpectedCallsListNode* p = entry ? entry->first_ : NULL; p; p = p->nextWithSameName_)
+        addExpectedCall(p->expectedCall_);
+}
+
 void MockExpectedCallsList::addExpectations(const MockExpectedCallsList& list)
 {
     for (MockExpectedCallsListNode* p = list.head_; p; p = p->next_)
@@ -243,6 +254,7 @@ void MockExpectedCallsList::pruneEmptyNodeFromList()
     MockExpectedCallsListNode* current = head_;
     MockExpectedCallsListNode* previous = NULL;
     MockExpectedCallsListNode* toBeDeleted = NULL;
+    bool anyDeleted = false;
 
     while (current) {
         if (current->expectedCall_ == NULL) {
@@ -252,12 +264,16 @@ void MockExpectedCallsList::pruneEmptyNodeFromList()
             else
                 current = previous->next_ = current->next_;
             delete toBeDeleted;
+            anyDeleted = true;
         }
         else {
             previous = current;
             current = current->next_;
         }
     }
+    tail_ = previous;
+
+    if (anyDeleted) relinkNameIndex();
 }
 
 void MockExpectedCallsList::deleteAllExpectationsAndClearList()
@@ -268,6 +284,8 @@ void MockExpectedCallsList::deleteAllExpectationsAndClearList()
         delete head_;
         head_ = next;
     }
+    tail_ = NULL;
+    clearNameIndex();
 }
 
 void MockExpectedCallsList::resetExpectations()
@@ -367,3 +385,110 @@ bool MockExpectedCallsList::hasUnfulfilledExpectationsBecauseOfMissingParameters
     return false;
 }
 
+static size_t hashOfName(const SimpleString& name)
+{
+    size_t hash = 5381;
+    for (const char* p = name.asCharString(); *p; p++)
+        hash = hash * 33 + (unsigned char) *p;
+    return hash;
+}
+
+MockExpectedCallsList::MockExpectedCallsNameEntry* MockExpectedCallsList::findNameEntry(const SimpleString& name) const
+{
+    for (MockExpectedCallsNameEntry* entry = nameIndex_[hashOfName(name) % nameIndexSize_]; entry; entry = entry->next_)
+        if (entry->name_ == name)
+            return entry;
+    return NULL;
+}
+
+MockExpectedCallsList::MockExpectedCallsNameEntry* MockExpectedCallsList::findOrCreateNameEntry(const SimpleString& name)
+{
+    MockExpectedCallsNameEntry* entry = findNameEntry(name);
+    if (entry) return entry;
+
+    if (amountOfNames_ == nameIndexSize_)
+        growNameIndex();
+
+    size_t bucket = hashOfName(name) % nameIndexSize_;
+    entry = new MockExpectedCallsNameEntry(name);
+    entry->next_ = nameIndex_[bucket];
+    nameIndex_[bucket] = entry;
+    amountOfNames_++;
+    return entry;
+}
+
+void MockExpectedCallsList::growNameIndex()
+{
+    size_t newSize = nameIndexSize_ * 2 + 1;
+    MockExpectedCallsNameEntry** newIndex = new MockExpectedCallsNameEntry*[newSize];
+    for (size_t i = 0; i < newSize; i++)
+        newIndex[i] = NULL;
+
+    for (size_t i = 0; i < nameIndexSize_; i++) {
+        while (nameIndex_[i]) {
+            MockExpectedCallsNameEntry* entry = nameIndex_[i];
+            nameIndex_[i] = entry->next_;
+            size_t bucket = hashOfName(entry->name_) % newSize;
+            entry->next_ = newIndex[bucket];
+            newIndex[bucket] = entry;
+        }
+    }
+
+    if (nameIndex_ != initialNameIndex_)
+        delete [] nameIndex_;
+    nameIndex_ = newIndex;
+    nameIndexSize_ = newSize;
+}
+
+MockExpectedCallsList::MockExpectedCallsListNode* MockExpectedCallsList::firstUnfulfilledNodeRelatedTo(const SimpleString& name) const
+{
+    MockExpectedCallsNameEntry* entry = findNameEntry(name);
+    if (entry == NULL) return NULL;
+
+    while (entry->firstUnfulfilled_ && entry->firstUnfulfilled_->expectedCall_->isFulfilled())
+        entry->firstUnfulfilled_ = entry->firstUnfulfilled_->nextWithSameName_;
+    return entry->firstUnfulfilled_;
+}
+
+void MockExpectedCallsList::addToNameIndex(MockExpectedCallsListNode* node)
+{
+    MockExpectedCallsNameEntry* entry = node->nameEntry_;
+    node->nextWithSameName_ = NULL;
+    if (entry->first_ == NULL)
+        entry->first_ = node;
+    else
+        entry->last_->nextWithSameName_ = node;
+    entry->last_ = node;
+    if (entry->firstUnfulfilled_ == NULL)
+        entry->firstUnfulfilled_ = node;
+}
+
+void MockExpectedCallsList::relinkNameIndex()
+{
+    for (size_t i = 0; i < nameIndexSize_; i++)
+        for (MockExpectedCallsNameEntry* entry = nameIndex_[i]; entry; entry = entry->next_)
+            entry->first_ = entry->last_ = entry->firstUnfulfilled_ = NULL;
+
+    for (MockExpectedCallsListNode* p = head_; p; p = p->next_)
+        addToNameIndex(p);
+}
+
+void MockExpectedCallsList::clearNameIndex()
+{
+    for (size_t i = 0; i < nameIndexSize_; i++) {
+        while (nameIndex_[i]) {
+            MockExpectedCallsNameEntry* next = nameIndex_[i]->next_;
+            delete nameIndex_[i];
+            nameIndex_[i] = next;
+        }
+    }
+
+    if (nameIndex_ != initialNameIndex_) {
+        delete [] nameIndex_;
+        nameIndex_ = initialNameIndex_;
+        nameIndexSize_ = INITIAL_NAME_INDEX_SIZE;
+        for (size_t i = 0; i < nameIndexSize_; i++)
+            nameIndex_[i] = NULL;
+    }
+    amountOfNames_ = 0;
+}
@@ -230,6 +230,9 @@ const char* MockSupport::getTraceOutput()
 
 bool MockSupport::expectedCallsLeft()
 {
+    if (lastActualFunctionCall_)
+        lastActualFunctionCall_->finalizeCallWhenFulfilled();
+
     int callsLeft = expectations_.hasUnfulfilledExpectations();
 
     for (MockNamedValueListNode* p = data_.begin(); p; p = p->next())
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2007, Michael Feathers, James Grenning and Bas Vodde
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE EARLIER MENTIONED AUTHORS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/PerfCounterPlugin.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <string.h>
+#endif
+
+PerfCounterPlugin::PerfCounterPlugin()
+    : TestPlugin("PerfCounterPlugin"), measuring_(false), opened_(false)
+{
+    for (int i = 0; i < numberOfCounters; i++)
+        handles_[i] = -1;
+}
+
+PerfCounterPlugin::~PerfCounterPlugin()
+{
+    closeCounters();
+}
+
+bool PerfCounterPlugin::parseArguments(int /* ac */, const char** av, int index)
+{
+    SimpleString argument (av[index]);
+    if (argument == "-pperfcounters") {
+        measuring_ = true;
+        return true;
+    }
+    return false;
+}
+
+bool PerfCounterPlugin::isMeasuring() const
+{
+    return measuring_;
+}
+
+static const char* counterNames[PerfCounterPlugin::numberOfCounters] =
+    { "cycles", "instructions", "cache_misses", "branch_misses" };
+
+const char* PerfCounterPlugin::getCounterName(Counter counter)
+{
+    return counterNames[counter];
+}
+
+void PerfCounterPlugin::openCounters(TestResult& result)
+{
+    opened_ = true;
+
+    bool anyCounterOpened = false;
+    for (int i = 0; i < numberOfCounters; i++) {
+        handles_[i] = openCounter((Counter) i);
+        if (handles_[i] >= 0) anyCounterOpened = true;
+    }
+
+    if (!anyCounterOpened)
+        result.print("\nNote: performance counters are not available on this system, running without them.\n");
+}
+
+void PerfCounterPlugin::closeCounters()
+{
+    for (int i = 0; i < numberOfCounters; i++) {
+        if (handles_[i] >= 0) closeCounter(handles_[i]);
+        handles_[i] = -1;
+    }
+    opened_ = false;
+}
+
+void PerfCounterPlugin::preTestAction(UtestShell& /* test */, TestResult& result)
+{
+    if (!measuring_) return;
+
+    if (!opened_) openCounters(result);
+
+    for (int i = 0; i < numberOfCounters; i++)
+        if (handles_[i] >= 0) startCounter(handles_[i]);
+}
+
+void PerfCounterPlugin::postTestAction(UtestShell& test, TestResult& result)
+{
+    if (!measuring_ || !opened_) return;
+
+    for (int i = 0; i < numberOfCounters; i++) {
+        if (handles_[i] < 0) continue;
+        double value = stopAndReadCounter(handles_[i]);
+        if (value >= 0)
+            result.addTestProperty(test, getCounterName((Counter) i), StringFromFormat("%.0f", value));
+    }
+}
+
+#ifdef __linux__
+
+static const __u64 perfConfigs[PerfCounterPlugin::numberOfCounters] =
+    { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+int PerfCounterPlugin::openCounter(Counter counter)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = perfConfigs[counter];
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+void PerfCounterPlugin::startCounter(int handle)
+{
+    ioctl(handle, PERF_EVENT_IOC_RESET, 0);
+    ioctl(handle, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+double PerfCounterPlugin::stopAndReadCounter(int handle)
+{
+    ioctl(handle, PERF_EVENT_IOC_DISABLE, 0);
+
+    __u64 value = 0;
+    if (read(handle, &value, sizeof(value)) != (ssize_t) sizeof(value))
+        return -1;
+    return (double) value;
+}
+
+void PerfCounterPlugin::closeCounter(int handle)
+{
+    close(handle);
+}
+
+#else
+
+int PerfCounterPlugin::openCounter(Counter)
+{
+    return -1;
+}
+
+void PerfCounterPlugin::startCounter(int)
+{
+}
+
+double PerfCounterPlugin::stopAndReadCounter(int)
+{
+    return -1;
+}
+
+void PerfCounterPlugin::closeCounter(int)
+{
+}
+
+#endif
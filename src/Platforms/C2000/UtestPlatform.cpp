@@ -70,6 +70,71 @@ static void C2000RunTestInASeperateProcess(UtestShell* shell, TestPlugin* plugin
 void (*PlatformSpecificRunTestInASeperateProcess)(UtestShell*, TestPlugin*, TestResult*) =
     C2000RunTestInASeperateProcess;
 
+static int C2000Fork(void)
+{
+    return 0;
+}
+
+static int C2000WaitPid(int, int*, int)
+{
+    return 0;
+}
+
+static int C2000WaitPidWithResourceUsage(int, int*, int, PlatformSpecificResourceUsage*)
+{
+    return 0;
+}
+
+static int C2000GetResourceUsage(PlatformSpecificResourceUsage*)
+{
+    return -1;
+}
+
+static int C2000Pipe(int*, int*)
+{
+    return -1;
+}
+
+static int C2000Read(int, char*, int)
+{
+    return -1;
+}
+
+static int C2000Write(int, const char*, int)
+{
+    return -1;
+}
+
+static void C2000Close(int)
+{
+}
+
+static int C2000WaitForReadable(const int*, int)
+{
+    return -1;
+}
+
+static int C2000TerminationSignal(int)
+{
+    return 0;
+}
+
+static void C2000Exit(int)
+{
+}
+
+int (*PlatformSpecificFork)(void) = C2000Fork;
+int (*PlatformSpecificWaitPid)(int, int*, int) = C2000WaitPid;
+int (*PlatformSpecificWaitPidWithResourceUsage)(int, int*, int, PlatformSpecificResourceUsage*) = C2000WaitPidWithResourceUsage;
+int (*PlatformSpecificGetResourceUsage)(PlatformSpecificResourceUsage*) = C2000GetResourceUsage;
+int (*PlatformSpecificPipe)(int*, int*) = C2000Pipe;
+int (*PlatformSpecificRead)(int, char*, int) = C2000Read;
+int (*PlatformSpecificWrite)(int, const char*, int) = C2000Write;
+void (*PlatformSpecificClose)(int) = C2000Close;
+int (*PlatformSpecificWaitForReadable)(const int*, int) = C2000WaitForReadable;
+int (*PlatformSpecificTerminationSignal)(int) = C2000TerminationSignal;
+void (*PlatformSpecificExit)(int) = C2000Exit;
+
 extern "C" {
 
 static int C2000SetJmp(void (*function) (void* data), void* data)
@@ -124,6 +189,13 @@ static const char* TimeStringImplementation()
 long (*GetPlatformSpecificTimeInMillis)() = C2000TimeInMillis;
 const char* (*GetPlatformSpecificTimeString)() = TimeStringImplementation;
 
+static double C2000MonotonicTimeInNanos()
+{
+    return (double) C2000TimeInMillis() * 1000000.0;
+}
+
+double (*GetPlatformSpecificMonotonicTimeInNanos)() = C2000MonotonicTimeInNanos;
+
 extern int vsnprintf(char*, size_t, const char*, va_list); // not std::vsnprintf()
 
 extern int (*PlatformSpecificVSNprintf)(char *, size_t, const char*, va_list) = vsnprintf;
@@ -138,14 +210,26 @@ static void C2000FPuts(const char* str, PlatformSpecificFile file)
    fputs(str, (FILE*)file);
 }
 
+static char* C2000FGets(char* str, int size, PlatformSpecificFile file)
+{
+   return fgets(str, size, (FILE*)file);
+}
+
 static void C2000FClose(PlatformSpecificFile file)
 {
    fclose((FILE*)file);
 }
 
+static PlatformSpecificFile C2000StdIn()
+{
+   return stdin;
+}
+
 PlatformSpecificFile (*PlatformSpecificFOpen)(const char* filename, const char* flag) = C2000FOpen;
 void (*PlatformSpecificFPuts)(const char* str, PlatformSpecificFile file) = C2000FPuts;
+char* (*PlatformSpecificFGets)(char* str, int size, PlatformSpecificFile file) = C2000FGets;
 void (*PlatformSpecificFClose)(PlatformSpecificFile file) = C2000FClose;
+PlatformSpecificFile (*PlatformSpecificStdIn)(void) = C2000StdIn;
 
 static int CL2000Putchar(int c)
 {
@@ -249,4 +333,125 @@ void (*PlatformSpecificMutexLock)(PlatformSpecificMutex) = DummyMutexLock;
 void (*PlatformSpecificMutexUnlock)(PlatformSpecificMutex) = DummyMutexUnlock;
 void (*PlatformSpecificMutexDestroy)(PlatformSpecificMutex) = DummyMutexDestroy;
 
+static PlatformSpecificThread DummyThreadCreate(void (*function)(void*), void* data)
+{
+    return 0;
+}
+
+static void DummyThreadJoin(PlatformSpecificThread thread)
+{
+}
+
+PlatformSpecificThread (*PlatformSpecificThreadCreate)(void (*)(void*), void*) = DummyThreadCreate;
+void (*PlatformSpecificThreadJoin)(PlatformSpecificThread) = DummyThreadJoin;
+
+/* Without threads there is nothing to wait for or to race with */
+static PlatformSpecificCondition DummyConditionCreate(void)
+{
+    return 0;
+}
+
+static void DummyConditionWait(PlatformSpecificCondition condition, PlatformSpecificMutex mtx)
+{
+}
+
+static void DummyConditionNotify(PlatformSpecificCondition condition)
+{
+}
+
+static void DummyConditionDestroy(PlatformSpecificCondition condition)
+{
+}
+
+PlatformSpecificCondition (*PlatformSpecificConditionCreate)(void) = DummyConditionCreate;
+void (*PlatformSpecificConditionWait)(PlatformSpecificCondition, PlatformSpecificMutex) = DummyConditionWait;
+void (*PlatformSpecificConditionSignal)(PlatformSpecificCondition) = DummyConditionNotify;
+void (*PlatformSpecificConditionBroadcast)(PlatformSpecificCondition) = DummyConditionNotify;
+void (*PlatformSpecificConditionDestroy)(PlatformSpecificCondition) = DummyConditionDestroy;
+
+static long DummyAtomicLoad(volatile long* value)
+{
+    return *value;
+}
+
+static long DummyAtomicAdd(volatile long* value, long delta)
+{
+    return *value += delta;
+}
+
+static long DummyAtomicCompareExchange(volatile long* value, long expected, long desired)
+{
+    long previous = *value;
+    if (previous == expected) *value = desired;
+    return previous;
+}
+
+long (*PlatformSpecificAtomicLoad)(volatile long*) = DummyAtomicLoad;
+long (*PlatformSpecificAtomicAdd)(volatile long*, long) = DummyAtomicAdd;
+long (*PlatformSpecificAtomicCompareExchange)(volatile long*, long, long) = DummyAtomicCompareExchange;
+
+static PlatformSpecificThreadLocal DummyThreadLocalCreate(void)
+{
+    void** key = new void*;
+    *key = 0;
+    return (PlatformSpecificThreadLocal)key;
+}
+
+static void* DummyThreadLocalGet(PlatformSpecificThreadLocal key)
+{
+    return *(void**)key;
+}
+
+static void DummyThreadLocalSet(PlatformSpecificThreadLocal key, void* value)
+{
+    *(void**)key = value;
+}
+
+static void DummyThreadLocalDestroy(PlatformSpecificThreadLocal key)
+{
+    delete (void**)key;
+}
+
+PlatformSpecificThreadLocal (*PlatformSpecificThreadLocalCreate)(void) = DummyThreadLocalCreate;
+void* (*PlatformSpecificThreadLocalGet)(PlatformSpecificThreadLocal) = DummyThreadLocalGet;
+void (*PlatformSpecificThreadLocalSet)(PlatformSpecificThreadLocal, void*) = DummyThreadLocalSet;
+void (*PlatformSpecificThreadLocalDestroy)(PlatformSpecificThreadLocal) = DummyThreadLocalDestroy;
+
+static int DummyBacktrace(void** frames, int maxFrames)
+{
+    return 0;
+}
+
+static void DummyBacktraceSymbol(void* frame, char* symbol, size_t size)
+{
+    if (size) symbol[0] = '\0';
+}
+
+int (*PlatformSpecificBacktrace)(void**, int) = DummyBacktrace;
+void (*PlatformSpecificBacktraceSymbol)(void*, char*, size_t) = DummyBacktraceSymbol;
+
+static size_t DummyPageSize(void)
+{
+    return 0;
+}
+
+static void* DummyPageAlloc(size_t size)
+{
+    return 0;
+}
+
+static void DummyPageFree(void* memory, size_t size)
+{
+}
+
+static int DummyPageProtect(void* memory, size_t size, int accessible)
+{
+    return -1;
+}
+
+size_t (*PlatformSpecificPageSize)(void) = DummyPageSize;
+void* (*PlatformSpecificPageAlloc)(size_t) = DummyPageAlloc;
+void (*PlatformSpecificPageFree)(void*, size_t) = DummyPageFree;
+int (*PlatformSpecificPageProtect)(void*, size_t, int) = DummyPageProtect;
+
 }
\ No newline at end of file
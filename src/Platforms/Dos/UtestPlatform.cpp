@@ -63,6 +63,71 @@ static void DummyRunTestInASeperateProcess(UtestShell* shell, TestPlugin* plugin
 void (*PlatformSpecificRunTestInASeperateProcess)(UtestShell*, TestPlugin*, TestResult*) =
     DummyRunTestInASeperateProcess;
 
+static int DosFork(void)
+{
+    return 0;
+}
+
+static int DosWaitPid(int, int*, int)
+{
+    return 0;
+}
+
+static int DosWaitPidWithResourceUsage(int, int*, int, PlatformSpecificResourceUsage*)
+{
+    return 0;
+}
+
+static int DosGetResourceUsage(PlatformSpecificResourceUsage*)
+{
+    return -1;
+}
+
+static int DosPipe(int*, int*)
+{
+    return -1;
+}
+
+static int DosRead(int, char*, int)
+{
+    return -1;
+}
+
+static int DosWrite(int, const char*, int)
+{
+    return -1;
+}
+
+static void DosClose(int)
+{
+}
+
+static int DosWaitForReadable(const int*, int)
+{
+    return -1;
+}
+
+static int DosTerminationSignal(int)
+{
+    return 0;
+}
+
+static void DosExit(int)
+{
+}
+
+int (*PlatformSpecificFork)(void) = DosFork;
+int (*PlatformSpecificWaitPid)(int, int*, int) = DosWaitPid;
+int (*PlatformSpecificWaitPidWithResourceUsage)(int, int*, int, PlatformSpecificResourceUsage*) = DosWaitPidWithResourceUsage;
+int (*PlatformSpecificGetResourceUsage)(PlatformSpecificResourceUsage*) = DosGetResourceUsage;
+int (*PlatformSpecificPipe)(int*, int*) = DosPipe;
+int (*PlatformSpecificRead)(int, char*, int) = DosRead;
+int (*PlatformSpecificWrite)(int, const char*, int) = DosWrite;
+void (*PlatformSpecificClose)(int) = DosClose;
+int (*PlatformSpecificWaitForReadable)(const int*, int) = DosWaitForReadable;
+int (*PlatformSpecificTerminationSignal)(int) = DosTerminationSignal;
+void (*PlatformSpecificExit)(int) = DosExit;
+
 extern "C" {
 
 static int DosSetJmp(void (*function) (void* data), void* data)
@@ -105,6 +170,13 @@ static const char* TimeStringImplementation()
 long (*GetPlatformSpecificTimeInMillis)() = DosTimeInMillis;
 const char* (*GetPlatformSpecificTimeString)() = TimeStringImplementation;
 
+static double DosMonotonicTimeInNanos()
+{
+    return (double) DosTimeInMillis() * 1000000.0;
+}
+
+double (*GetPlatformSpecificMonotonicTimeInNanos)() = DosMonotonicTimeInNanos;
+
 extern int (*PlatformSpecificVSNprintf)(char *, size_t, const char*, va_list) = vsnprintf;
 
 PlatformSpecificFile DosFOpen(const char* filename, const char* flag)
@@ -117,14 +189,26 @@ static void DosFPuts(const char* str, PlatformSpecificFile file)
    fputs(str, (FILE*)file);
 }
 
+static char* DosFGets(char* str, int size, PlatformSpecificFile file)
+{
+   return fgets(str, size, (FILE*)file);
+}
+
 static void DosFClose(PlatformSpecificFile file)
 {
    fclose((FILE*)file);
 }
 
+static PlatformSpecificFile DosStdIn()
+{
+   return stdin;
+}
+
 PlatformSpecificFile (*PlatformSpecificFOpen)(const char* filename, const char* flag) = DosFOpen;
 void (*PlatformSpecificFPuts)(const char* str, PlatformSpecificFile file) = DosFPuts;
+char* (*PlatformSpecificFGets)(char* str, int size, PlatformSpecificFile file) = DosFGets;
 void (*PlatformSpecificFClose)(PlatformSpecificFile file) = DosFClose;
+PlatformSpecificFile (*PlatformSpecificStdIn)(void) = DosStdIn;
 
 static int DosPutchar(int c)
 {
@@ -206,4 +290,125 @@ void (*PlatformSpecificMutexLock)(PlatformSpecificMutex) = DummyMutexLock;
 void (*PlatformSpecificMutexUnlock)(PlatformSpecificMutex) = DummyMutexUnlock;
 void (*PlatformSpecificMutexDestroy)(PlatformSpecificMutex) = DummyMutexDestroy;
 
+static PlatformSpecificThread DummyThreadCreate(void (*function)(void*), void* data)
+{
+    return 0;
+}
+
+static void DummyThreadJoin(PlatformSpecificThread thread)
+{
+}
+
+PlatformSpecificThread (*PlatformSpecificThreadCreate)(void (*)(void*), void*) = DummyThreadCreate;
+void (*PlatformSpecificThreadJoin)(PlatformSpecificThread) = DummyThreadJoin;
+
+/* Without threads there is nothing to wait for or to race with */
+static PlatformSpecificCondition DummyConditionCreate(void)
+{
+    return 0;
+}
+
+static void DummyConditionWait(PlatformSpecificCondition condition, PlatformSpecificMutex mtx)
+{
+}
+
+static void DummyConditionNotify(PlatformSpecificCondition condition)
+{
+}
+
+static void DummyConditionDestroy(PlatformSpecificCondition condition)
+{
+}
+
+PlatformSpecificCondition (*PlatformSpecificConditionCreate)(void) = DummyConditionCreate;
+void (*PlatformSpecificConditionWait)(PlatformSpecificCondition, PlatformSpecificMutex) = DummyConditionWait;
+void (*PlatformSpecificConditionSignal)(PlatformSpecificCondition) = DummyConditionNotify;
+void (*PlatformSpecificConditionBroadcast)(PlatformSpecificCondition) = DummyConditionNotify;
+void (*PlatformSpecificConditionDestroy)(PlatformSpecificCondition) = DummyConditionDestroy;
+
+static long DummyAtomicLoad(volatile long* value)
+{
+    return *value;
+}
+
+static long DummyAtomicAdd(volatile long* value, long delta)
+{
+    return *value += delta;
+}
+
+static long DummyAtomicCompareExchange(volatile long* value, long expected, long desired)
+{
+    long previous = *value;
+    if (previous == expected) *value = desired;
+    return previous;
+}
+
+long (*PlatformSpecificAtomicLoad)(volatile long*) = DummyAtomicLoad;
+long (*PlatformSpecificAtomicAdd)(volatile long*, long) = DummyAtomicAdd;
+long (*PlatformSpecificAtomicCompareExchange)(volatile long*, long, long) = DummyAtomicCompareExchange;
+
+static PlatformSpecificThreadLocal DummyThreadLocalCreate(void)
+{
+    void** key = new void*;
+    *key = 0;
+    return (PlatformSpecificThreadLocal)key;
+}
+
+static void* DummyThreadLocalGet(PlatformSpecificThreadLocal key)
+{
+    return *(void**)key;
+}
+
+static void DummyThreadLocalSet(PlatformSpecificThreadLocal key, void* value)
+{
+    *(void**)key = value;
+}
+
+static void DummyThreadLocalDestroy(PlatformSpecificThreadLocal key)
+{
+    delete (void**)key;
+}
+
+PlatformSpecificThreadLocal (*PlatformSpecificThreadLocalCreate)(void) = DummyThreadLocalCreate;
+void* (*PlatformSpecificThreadLocalGet)(PlatformSpecificThreadLocal) = DummyThreadLocalGet;
+void (*PlatformSpecificThreadLocalSet)(PlatformSpecificThreadLocal, void*) = DummyThreadLocalSet;
+void (*PlatformSpecificThreadLocalDestroy)(PlatformSpecificThreadLocal) = DummyThreadLocalDestroy;
+
+static int DummyBacktrace(void** frames, int maxFrames)
+{
+    return 0;
+}
+
+static void DummyBacktraceSymbol(void* frame, char* symbol, size_t size)
+{
+    if (size) symbol[0] = '\0';
+}
+
+int (*PlatformSpecificBacktrace)(void**, int) = DummyBacktrace;
+void (*PlatformSpecificBacktraceSymbol)(void*, char*, size_t) = DummyBacktraceSymbol;
+
+static size_t DummyPageSize(void)
+{
+    return 0;
+}
+
+static void* DummyPageAlloc(size_t size)
+{
+    return 0;
+}
+
+static void DummyPageFree(void* memory, size_t size)
+{
+}
+
+static int DummyPageProtect(void* memory, size_t size, int accessible)
+{
+    return -1;
+}
+
+size_t (*PlatformSpecificPageSize)(void) = DummyPageSize;
+void* (*PlatformSpecificPageAlloc)(size_t) = DummyPageAlloc;
+void (*PlatformSpecificPageFree)(void*, size_t) = DummyPageFree;
+int (*PlatformSpecificPageProtect)(void*, size_t, int) = DummyPageProtect;
+
 }
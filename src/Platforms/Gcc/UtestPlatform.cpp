@@ -44,14 +44,22 @@
 #include <signal.h>
 #ifndef __MINGW32__
 #include <sys/wait.h>
+#include <sys/resource.h>
 #include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
 #endif
 #include <pthread.h>
+#if defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#define CPPUTEST_HAVE_EXECINFO 1
+#endif
 
 #include "CppUTest/PlatformSpecificFunctions.h"
 
-static jmp_buf test_exit_jmp_buf[10];
-static int jmp_buf_index = 0;
+/* Per thread, so tests can run on several threads at once */
+static CPPUTEST_THREAD_LOCAL jmp_buf test_exit_jmp_buf[10];
+static CPPUTEST_THREAD_LOCAL int jmp_buf_index = 0;
 
 #ifndef HAVE_FORK
 
@@ -70,12 +78,52 @@ static int PlatformSpecificWaitPidImplementation(int, int*, int)
     return 0;
 }
 
+static int PlatformSpecificWaitPidWithResourceUsageImplementation(int, int*, int, PlatformSpecificResourceUsage*)
+{
+    return 0;
+}
+
+static int PlatformSpecificGetResourceUsageImplementation(PlatformSpecificResourceUsage*)
+{
+    return -1;
+}
+
+static int PlatformSpecificPipeImplementation(int*, int*)
+{
+    return -1;
+}
+
+static int PlatformSpecificReadImplementation(int, char*, int)
+{
+    return -1;
+}
+
+static int PlatformSpecificWriteImplementation(int, const char*, int)
+{
+    return -1;
+}
+
+static void PlatformSpecificCloseImplementation(int)
+{
+}
+
+static int PlatformSpecificWaitForReadableImplementation(const int*, int)
+{
+    return -1;
+}
+
+static int PlatformSpecificTerminationSignalImplementation(int)
+{
+    return 0;
+}
+
 #else
 
 static void GccPlatformSpecificRunTestInASeperateProcess(UtestShell* shell, TestPlugin* plugin, TestResult* result)
 {
     pid_t cpid, w;
     int status;
+    PlatformSpecificResourceUsage usage;
 
     cpid = PlatformSpecificFork();
 
@@ -89,7 +137,7 @@ static void GccPlatformSpecificRunTestInASeperateProcess(UtestShell* shell, Test
         _exit(result->getFailureCount());                     // LCOV_EXCL_LINE
     } else {                    /* Code executed by parent */
         do {
-            w = PlatformSpecificWaitPid(cpid, &status, WUNTRACED);
+            w = PlatformSpecificWaitPidWithResourceUsage(cpid, &status, WUNTRACED, &usage);
             if (w == -1) {
                 if(EINTR ==errno) continue; /* OS X debugger */
                 result->addFailure(TestFailure(shell, "Call to waitpid() failed"));
@@ -110,6 +158,8 @@ static void GccPlatformSpecificRunTestInASeperateProcess(UtestShell* shell, Test
                 kill(w, SIGCONT);
             }
         } while (!WIFEXITED(status) && !WIFSIGNALED(status));
+
+        result->addResourceUsage(*shell, usage);
     }
 }
 
@@ -123,7 +173,113 @@ static pid_t PlatformSpecificWaitPidImplementation(int pid, int* status, int opt
     return waitpid(pid, status, options);
 }
 
+static double GccTimeValInNanos(const struct timeval& time)
+{
+    return (double) time.tv_sec * 1000000000.0 + (double) time.tv_usec * 1000.0;
+}
+
+static void GccResourceUsageFrom(const struct rusage& from, PlatformSpecificResourceUsage* usage)
+{
+    usage->userTimeInNanos = GccTimeValInNanos(from.ru_utime);
+    usage->systemTimeInNanos = GccTimeValInNanos(from.ru_stime);
+#ifdef __APPLE__
+    usage->maximumResidentSetSizeInKilobytes = from.ru_maxrss / 1024;
+#else
+    usage->maximumResidentSetSizeInKilobytes = from.ru_maxrss;
 #endif
+    usage->minorPageFaults = from.ru_minflt;
+    usage->majorPageFaults = from.ru_majflt;
+    usage->voluntaryContextSwitches = from.ru_nvcsw;
+    usage->involuntaryContextSwitches = from.ru_nivcsw;
+}
+
+static pid_t PlatformSpecificWaitPidWithResourceUsageImplementation(int pid, int* status, int options, PlatformSpecificResourceUsage* usage)
+{
+    struct rusage childUsage;
+    memset(&childUsage, 0, sizeof(childUsage));
+    pid_t w = wait4(pid, status, options, &childUsage);
+    GccResourceUsageFrom(childUsage, usage);
+    return w;
+}
+
+static int PlatformSpecificGetResourceUsageImplementation(PlatformSpecificResourceUsage* usage)
+{
+    struct rusage selfUsage;
+    if (getrusage(RUSAGE_SELF, &selfUsage) != 0)
+        return -1;
+    GccResourceUsageFrom(selfUsage, usage);
+    return 0;
+}
+
+static int PlatformSpecificPipeImplementation(int* readDescriptor, int* writeDescriptor)
+{
+    int descriptors[2];
+    if (pipe(descriptors) == -1)
+        return -1;
+    *readDescriptor = descriptors[0];
+    *writeDescriptor = descriptors[1];
+    return 0;
+}
+
+static int PlatformSpecificReadImplementation(int descriptor, char* buffer, int size)
+{
+    ssize_t bytesRead;
+    do {
+        bytesRead = read(descriptor, buffer, (size_t) size);
+    } while (bytesRead == -1 && errno == EINTR);
+    return (int) bytesRead;
+}
+
+static int PlatformSpecificWriteImplementation(int descriptor, const char* buffer, int size)
+{
+    ssize_t bytesWritten;
+    do {
+        bytesWritten = write(descriptor, buffer, (size_t) size);
+    } while (bytesWritten == -1 && errno == EINTR);
+    return (int) bytesWritten;
+}
+
+static void PlatformSpecificCloseImplementation(int descriptor)
+{
+    close(descriptor);
+}
+
+static int PlatformSpecificWaitForReadableImplementation(const int* descriptors, int count)
+{
+    struct pollfd* polled = new struct pollfd[count];
+    for (int i = 0; i < count; i++) {
+        polled[i].fd = descriptors[i];
+        polled[i].events = POLLIN;
+        polled[i].revents = 0;
+    }
+
+    int readable = -1;
+    int ready;
+    do {
+        ready = poll(polled, (nfds_t) count, -1);
+    } while (ready == -1 && errno == EINTR);
+
+    for (int i = 0; ready > 0 && i < count; i++) {
+        if (polled[i].revents != 0) {
+            readable = i;
+            break;
+        }
+    }
+    delete [] polled;
+    return readable;
+}
+
+static int PlatformSpecificTerminationSignalImplementation(int status)
+{
+    return WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+}
+
+#endif
+
+static void PlatformSpecificExitImplementation(int status)
+{
+    _exit(status);
+}
 
 TestOutput::WorkingEnvironment PlatformSpecificGetWorkingEnvironment()
 {
@@ -134,6 +290,15 @@ void (*PlatformSpecificRunTestInASeperateProcess)(UtestShell* shell, TestPlugin*
         GccPlatformSpecificRunTestInASeperateProcess;
 int (*PlatformSpecificFork)(void) = PlatformSpecificForkImplementation;
 int (*PlatformSpecificWaitPid)(int, int*, int) = PlatformSpecificWaitPidImplementation;
+int (*PlatformSpecificWaitPidWithResourceUsage)(int, int*, int, PlatformSpecificResourceUsage*) = PlatformSpecificWaitPidWithResourceUsageImplementation;
+int (*PlatformSpecificGetResourceUsage)(PlatformSpecificResourceUsage*) = PlatformSpecificGetResourceUsageImplementation;
+int (*PlatformSpecificPipe)(int*, int*) = PlatformSpecificPipeImplementation;
+int (*PlatformSpecificRead)(int, char*, int) = PlatformSpecificReadImplementation;
+int (*PlatformSpecificWrite)(int, const char*, int) = PlatformSpecificWriteImplementation;
+void (*PlatformSpecificClose)(int) = PlatformSpecificCloseImplementation;
+int (*PlatformSpecificWaitForReadable)(const int*, int) = PlatformSpecificWaitForReadableImplementation;
+int (*PlatformSpecificTerminationSignal)(int) = PlatformSpecificTerminationSignalImplementation;
+void (*PlatformSpecificExit)(int) = PlatformSpecificExitImplementation;
 
 extern "C" {
 
@@ -180,6 +345,18 @@ static long TimeInMillisImplementation()
     return (tv.tv_sec * 1000) + (long)((double)tv.tv_usec * 0.001);
 }
 
+static double MonotonicTimeInNanosImplementation()
+{
+#if defined(_POSIX_TIMERS) && (_POSIX_TIMERS > 0) && defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+        return (double) ts.tv_sec * 1000000000.0 + (double) ts.tv_nsec;
+#endif
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double) tv.tv_sec * 1000000000.0 + (double) tv.tv_usec * 1000.0;
+}
+
 static const char* TimeStringImplementation()
 {
     time_t tm = time(NULL);
@@ -190,6 +367,7 @@ static const char* TimeStringImplementation()
 }
 
 long (*GetPlatformSpecificTimeInMillis)() = TimeInMillisImplementation;
+double (*GetPlatformSpecificMonotonicTimeInNanos)() = MonotonicTimeInNanosImplementation;
 const char* (*GetPlatformSpecificTimeString)() = TimeStringImplementation;
 
 /* Wish we could add an attribute to the format for discovering mis-use... but the __attribute__(format) seems to not work on va_list */
@@ -209,11 +387,21 @@ static void PlatformSpecificFPutsImplementation(const char* str, PlatformSpecifi
    fputs(str, (FILE*)file);
 }
 
+static char* PlatformSpecificFGetsImplementation(char* str, int size, PlatformSpecificFile file)
+{
+    return fgets(str, size, (FILE*)file);
+}
+
 static void PlatformSpecificFCloseImplementation(PlatformSpecificFile file)
 {
    fclose((FILE*)file);
 }
 
+static PlatformSpecificFile PlatformSpecificStdInImplementation()
+{
+   return stdin;
+}
+
 static void PlatformSpecificFlushImplementation()
 {
   fflush(stdout);
@@ -221,7 +409,9 @@ static void PlatformSpecificFlushImplementation()
 
 PlatformSpecificFile (*PlatformSpecificFOpen)(const char*, const char*) = PlatformSpecificFOpenImplementation;
 void (*PlatformSpecificFPuts)(const char*, PlatformSpecificFile) = PlatformSpecificFPutsImplementation;
+char* (*PlatformSpecificFGets)(char*, int, PlatformSpecificFile) = PlatformSpecificFGetsImplementation;
 void (*PlatformSpecificFClose)(PlatformSpecificFile) = PlatformSpecificFCloseImplementation;
+PlatformSpecificFile (*PlatformSpecificStdIn)(void) = PlatformSpecificStdInImplementation;
 
 int (*PlatformSpecificPutchar)(int) = putchar;
 void (*PlatformSpecificFlush)() = PlatformSpecificFlushImplementation;
@@ -278,4 +468,227 @@ void (*PlatformSpecificMutexLock)(PlatformSpecificMutex) = PThreadMutexLock;
 void (*PlatformSpecificMutexUnlock)(PlatformSpecificMutex) = PThreadMutexUnlock;
 void (*PlatformSpecificMutexDestroy)(PlatformSpecificMutex) = PThreadMutexDestroy;
 
+struct PThread
+{
+    pthread_t thread;
+    void (*function)(void*);
+    void* data;
+};
+
+static void* PThreadRun(void* started)
+{
+    PThread* thread = (PThread*) started;
+    thread->function(thread->data);
+    return NULL;
+}
+
+static PlatformSpecificThread PThreadCreate(void (*function)(void*), void* data)
+{
+    PThread* thread = new PThread;
+    thread->function = function;
+    thread->data = data;
+    if (pthread_create(&thread->thread, NULL, PThreadRun, thread) != 0) {
+        delete thread;
+        return NULL;
+    }
+    return (PlatformSpecificThread)thread;
+}
+
+static void PThreadJoin(PlatformSpecificThread started)
+{
+    PThread* thread = (PThread*) started;
+    pthread_join(thread->thread, NULL);
+    delete thread;
+}
+
+PlatformSpecificThread (*PlatformSpecificThreadCreate)(void (*)(void*), void*) = PThreadCreate;
+void (*PlatformSpecificThreadJoin)(PlatformSpecificThread) = PThreadJoin;
+
+static PlatformSpecificCondition PThreadConditionCreate(void)
+{
+    pthread_cond_t *condition = new pthread_cond_t;
+
+    pthread_cond_init(condition, NULL);
+
+    return (PlatformSpecificCondition)condition;
+}
+
+static void PThreadConditionWait(PlatformSpecificCondition condition, PlatformSpecificMutex mtx)
+{
+    pthread_cond_wait((pthread_cond_t *)condition, (pthread_mutex_t *)mtx);
+}
+
+static void PThreadConditionSignal(PlatformSpecificCondition condition)
+{
+    pthread_cond_signal((pthread_cond_t *)condition);
+}
+
+static void PThreadConditionBroadcast(PlatformSpecificCondition condition)
+{
+    pthread_cond_broadcast((pthread_cond_t *)condition);
+}
+
+static void PThreadConditionDestroy(PlatformSpecificCondition cond)
+{
+    pthread_cond_t *condition = (pthread_cond_t *)cond;
+    pthread_cond_destroy(condition);
+    delete condition;
+}
+
+PlatformSpecificCondition (*PlatformSpecificConditionCreate)(void) = PThreadConditionCreate;
+void (*PlatformSpecificConditionWait)(PlatformSpecificCondition, PlatformSpecificMutex) = PThreadConditionWait;
+void (*PlatformSpecificConditionSignal)(PlatformSpecificCondition) = PThreadConditionSignal;
+void (*PlatformSpecificConditionBroadcast)(PlatformSpecificCondition) = PThreadConditionBroadcast;
+void (*PlatformSpecificConditionDestroy)(PlatformSpecificCondition) = PThreadConditionDestroy;
+
+static long GccAtomicLoad(volatile long* value)
+{
+    return __sync_fetch_and_add(value, 0);
+}
+
+static long GccAtomicAdd(volatile long* value, long delta)
+{
+    return __sync_add_and_fetch(value, delta);
+}
+
+static long GccAtomicCompareExchange(volatile long* value, long expected, long desired)
+{
+    return __sync_val_compare_and_swap(value, expected, desired);
+}
+
+long (*PlatformSpecificAtomicLoad)(volatile long*) = GccAtomicLoad;
+long (*PlatformSpecificAtomicAdd)(volatile long*, long) = GccAtomicAdd;
+long (*PlatformSpecificAtomicCompareExchange)(volatile long*, long, long) = GccAtomicCompareExchange;
+
+static PlatformSpecificThreadLocal PThreadLocalCreate(void)
+{
+    pthread_key_t *key = new pthread_key_t;
+
+    if (pthread_key_create(key, NULL) != 0) {
+        delete key;
+        return NULL;
+    }
+
+    return (PlatformSpecificThreadLocal)key;
+}
+
+static void* PThreadLocalGet(PlatformSpecificThreadLocal key)
+{
+    return pthread_getspecific(*(pthread_key_t *)key);
+}
+
+static void PThreadLocalSet(PlatformSpecificThreadLocal key, void* value)
+{
+    pthread_setspecific(*(pthread_key_t *)key, value);
+}
+
+static void PThreadLocalDestroy(PlatformSpecificThreadLocal threadLocal)
+{
+    pthread_key_t *key = (pthread_key_t *)threadLocal;
+    pthread_key_delete(*key);
+    delete key;
+}
+
+PlatformSpecificThreadLocal (*PlatformSpecificThreadLocalCreate)(void) = PThreadLocalCreate;
+void* (*PlatformSpecificThreadLocalGet)(PlatformSpecificThreadLocal) = PThreadLocalGet;
+void (*PlatformSpecificThreadLocalSet)(PlatformSpecificThreadLocal, void*) = PThreadLocalSet;
+void (*PlatformSpecificThreadLocalDestroy)(PlatformSpecificThreadLocal) = PThreadLocalDestroy;
+
+#ifdef CPPUTEST_HAVE_EXECINFO
+
+static int GccBacktrace(void** frames, int maxFrames)
+{
+    enum { max_frames = 64 };
+    void* buffer[max_frames + 1];
+
+    if (maxFrames <= 0) return 0;
+    if (maxFrames > max_frames) maxFrames = max_frames;
+
+    /* The first frame is this function itself */
+    int numberOfFrames = backtrace(buffer, maxFrames + 1) - 1;
+    if (numberOfFrames <= 0) return 0;
+    memcpy(frames, buffer + 1, (size_t) numberOfFrames * sizeof(void*));
+    return numberOfFrames;
+}
+
+static void GccBacktraceSymbol(void* frame, char* symbol, size_t size)
+{
+    if (size == 0) return;
+    symbol[0] = '\0';
+
+    char** symbols = backtrace_symbols(&frame, 1);
+    if (symbols == NULL) return;
+    snprintf(symbol, size, "%s", symbols[0]);
+    free(symbols);
+}
+
+#else
+
+static int GccBacktrace(void**, int)
+{
+    return 0;
+}
+
+static void GccBacktraceSymbol(void*, char* symbol, size_t size)
+{
+    if (size) symbol[0] = '\0';
+}
+
+#endif
+
+int (*PlatformSpecificBacktrace)(void**, int) = GccBacktrace;
+void (*PlatformSpecificBacktraceSymbol)(void*, char*, size_t) = GccBacktraceSymbol;
+
+#ifndef __MINGW32__
+
+static size_t GccPageSize(void)
+{
+    long pageSize = sysconf(_SC_PAGESIZE);
+    return (pageSize > 0) ? (size_t) pageSize : 0;
+}
+
+static void* GccPageAlloc(size_t size)
+{
+    void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return (memory == MAP_FAILED) ? NULL : memory;
+}
+
+static void GccPageFree(void* memory, size_t size)
+{
+    munmap(memory, size);
+}
+
+static int GccPageProtect(void* memory, size_t size, int accessible)
+{
+    return mprotect(memory, size, accessible ? PROT_READ | PROT_WRITE : PROT_NONE);
+}
+
+#else
+
+static size_t GccPageSize(void)
+{
+    return 0;
+}
+
+static void* GccPageAlloc(size_t)
+{
+    return NULL;
+}
+
+static void GccPageFree(void*, size_t)
+{
+}
+
+static int GccPageProtect(void*, size_t, int)
+{
+    return -1;
+}
+
+#endif
+
+size_t (*PlatformSpecificPageSize)(void) = GccPageSize;
+void* (*PlatformSpecificPageAlloc)(size_t) = GccPageAlloc;
+void (*PlatformSpecificPageFree)(void*, size_t) = GccPageFree;
+int (*PlatformSpecificPageProtect)(void*, size_t, int) = GccPageProtect;
+
 }
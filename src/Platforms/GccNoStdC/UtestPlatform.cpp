@@ -36,6 +36,15 @@
 void (*PlatformSpecificRunTestInASeperateProcess)(UtestShell*, TestPlugin*, TestResult*) = NULL;
 int (*PlatformSpecificFork)() = NULL;
 int (*PlatformSpecificWaitPid)(int, int*, int) = NULL;
+int (*PlatformSpecificWaitPidWithResourceUsage)(int, int*, int, PlatformSpecificResourceUsage*) = NULL;
+int (*PlatformSpecificGetResourceUsage)(PlatformSpecificResourceUsage*) = NULL;
+int (*PlatformSpecificPipe)(int*, int*) = NULL;
+int (*PlatformSpecificRead)(int, char*, int) = NULL;
+int (*PlatformSpecificWrite)(int, const char*, int) = NULL;
+void (*PlatformSpecificClose)(int) = NULL;
+int (*PlatformSpecificWaitForReadable)(const int*, int) = NULL;
+int (*PlatformSpecificTerminationSignal)(int) = NULL;
+void (*PlatformSpecificExit)(int) = NULL;
 
 TestOutput::WorkingEnvironment PlatformSpecificGetWorkingEnvironment()
 {
@@ -47,12 +56,15 @@ int (*PlatformSpecificSetJmp)(void (*)(void*), void*) = NULL;
 void (*PlatformSpecificRestoreJumpBuffer)() = NULL;
 
 long (*GetPlatformSpecificTimeInMillis)() = NULL;
+double (*GetPlatformSpecificMonotonicTimeInNanos)() = NULL;
 const char* (*GetPlatformSpecificTimeString)() = NULL;
 
 /* IO operations */
 PlatformSpecificFile (*PlatformSpecificFOpen)(const char* filename, const char* flag) = NULL;
 void (*PlatformSpecificFPuts)(const char* str, PlatformSpecificFile file) = NULL;
+char* (*PlatformSpecificFGets)(char* str, int size, PlatformSpecificFile file) = NULL;
 void (*PlatformSpecificFClose)(PlatformSpecificFile file) = NULL;
+PlatformSpecificFile (*PlatformSpecificStdIn)(void) = NULL;
 
 int (*PlatformSpecificPutchar)(int c) = NULL;
 void (*PlatformSpecificFlush)(void) = NULL;
@@ -76,3 +88,28 @@ void (*PlatformSpecificMutexLock)(PlatformSpecificMutex mtx) = NULL;
 void (*PlatformSpecificMutexUnlock)(PlatformSpecificMutex mtx) = NULL;
 void (*PlatformSpecificMutexDestroy)(PlatformSpecificMutex mtx) = NULL;
 
+PlatformSpecificThread (*PlatformSpecificThreadCreate)(void (*function)(void*), void* data) = NULL;
+void (*PlatformSpecificThreadJoin)(PlatformSpecificThread thread) = NULL;
+
+PlatformSpecificCondition (*PlatformSpecificConditionCreate)(void) = NULL;
+void (*PlatformSpecificConditionWait)(PlatformSpecificCondition condition, PlatformSpecificMutex mtx) = NULL;
+void (*PlatformSpecificConditionSignal)(PlatformSpecificCondition condition) = NULL;
+void (*PlatformSpecificConditionBroadcast)(PlatformSpecificCondition condition) = NULL;
+void (*PlatformSpecificConditionDestroy)(PlatformSpecificCondition condition) = NULL;
+
+long (*PlatformSpecificAtomicLoad)(volatile long* value) = NULL;
+long (*PlatformSpecificAtomicAdd)(volatile long* value, long delta) = NULL;
+long (*PlatformSpecificAtomicCompareExchange)(volatile long* value, long expected, long desired) = NULL;
+
+PlatformSpecificThreadLocal (*PlatformSpecificThreadLocalCreate)(void) = NULL;
+void* (*PlatformSpecificThreadLocalGet)(PlatformSpecificThreadLocal key) = NULL;
+void (*PlatformSpecificThreadLocalSet)(PlatformSpecificThreadLocal key, void* value) = NULL;
+void (*PlatformSpecificThreadLocalDestroy)(PlatformSpecificThreadLocal key) = NULL;
+
+int (*PlatformSpecificBacktrace)(void** frames, int maxFrames) = NULL;
+void (*PlatformSpecificBacktraceSymbol)(void* frame, char* symbol, size_t size) = NULL;
+
+size_t (*PlatformSpecificPageSize)(void) = NULL;
+void* (*PlatformSpecificPageAlloc)(size_t size) = NULL;
+void (*PlatformSpecificPageFree)(void* memory, size_t size) = NULL;
+int (*PlatformSpecificPageProtect)(void* memory, size_t size, int accessible) = NULL;
@@ -64,10 +64,62 @@ static int DummyPlatformSpecificWaitPid(int, int*, int)
     return 0;
 }
 
+static int DummyPlatformSpecificWaitPidWithResourceUsage(int, int*, int, PlatformSpecificResourceUsage*)
+{
+    return 0;
+}
+
+static int DummyPlatformSpecificGetResourceUsage(PlatformSpecificResourceUsage*)
+{
+    return -1;
+}
+
+static int DummyPlatformSpecificPipe(int*, int*)
+{
+    return -1;
+}
+
+static int DummyPlatformSpecificRead(int, char*, int)
+{
+    return -1;
+}
+
+static int DummyPlatformSpecificWrite(int, const char*, int)
+{
+    return -1;
+}
+
+static void DummyPlatformSpecificClose(int)
+{
+}
+
+static int DummyPlatformSpecificWaitForReadable(const int*, int)
+{
+    return -1;
+}
+
+static int DummyPlatformSpecificTerminationSignal(int)
+{
+    return 0;
+}
+
+static void DummyPlatformSpecificExit(int)
+{
+}
+
 void (*PlatformSpecificRunTestInASeperateProcess)(UtestShell* shell, TestPlugin* plugin, TestResult* result) =
         DummyPlatformSpecificRunTestInASeperateProcess;
 int (*PlatformSpecificFork)(void) = DummyPlatformSpecificFork;
 int (*PlatformSpecificWaitPid)(int, int*, int) = DummyPlatformSpecificWaitPid;
+int (*PlatformSpecificWaitPidWithResourceUsage)(int, int*, int, PlatformSpecificResourceUsage*) = DummyPlatformSpecificWaitPidWithResourceUsage;
+int (*PlatformSpecificGetResourceUsage)(PlatformSpecificResourceUsage*) = DummyPlatformSpecificGetResourceUsage;
+int (*PlatformSpecificPipe)(int*, int*) = DummyPlatformSpecificPipe;
+int (*PlatformSpecificRead)(int, char*, int) = DummyPlatformSpecificRead;
+int (*PlatformSpecificWrite)(int, const char*, int) = DummyPlatformSpecificWrite;
+void (*PlatformSpecificClose)(int) = DummyPlatformSpecificClose;
+int (*PlatformSpecificWaitForReadable)(const int*, int) = DummyPlatformSpecificWaitForReadable;
+int (*PlatformSpecificTerminationSignal)(int) = DummyPlatformSpecificTerminationSignal;
+void (*PlatformSpecificExit)(int) = DummyPlatformSpecificExit;
 
 extern "C" {
 
@@ -119,6 +171,13 @@ static const char* TimeStringImplementation()
 long (*GetPlatformSpecificTimeInMillis)() = TimeInMillisImplementation;
 const char* (*GetPlatformSpecificTimeString)() = TimeStringImplementation;
 
+static double MonotonicTimeInNanosImplementation()
+{
+    return (double) TimeInMillisImplementation() * 1000000.0;
+}
+
+double (*GetPlatformSpecificMonotonicTimeInNanos)() = MonotonicTimeInNanosImplementation;
+
 int (*PlatformSpecificVSNprintf)(char *str, size_t size, const char* format, va_list args) = vsnprintf;
 
 static PlatformSpecificFile PlatformSpecificFOpenImplementation(const char* filename, const char* flag)
@@ -134,18 +193,33 @@ static void PlatformSpecificFPutsImplementation(const char* str, PlatformSpecifi
     (void)file;
 }
 
+static char* PlatformSpecificFGetsImplementation(char* str, int size, PlatformSpecificFile file)
+{
+    (void)str;
+    (void)size;
+    (void)file;
+    return 0;
+}
+
 static void PlatformSpecificFCloseImplementation(PlatformSpecificFile file)
 {
     (void)file;
 }
 
+static PlatformSpecificFile PlatformSpecificStdInImplementation()
+{
+    return 0;
+}
+
 static void PlatformSpecificFlushImplementation()
 {
 }
 
 PlatformSpecificFile (*PlatformSpecificFOpen)(const char*, const char*) = PlatformSpecificFOpenImplementation;
 void (*PlatformSpecificFPuts)(const char*, PlatformSpecificFile) = PlatformSpecificFPutsImplementation;
+char* (*PlatformSpecificFGets)(char*, int, PlatformSpecificFile) = PlatformSpecificFGetsImplementation;
 void (*PlatformSpecificFClose)(PlatformSpecificFile) = PlatformSpecificFCloseImplementation;
+PlatformSpecificFile (*PlatformSpecificStdIn)(void) = PlatformSpecificStdInImplementation;
 
 int (*PlatformSpecificPutchar)(int) = putchar;
 void (*PlatformSpecificFlush)() = PlatformSpecificFlushImplementation;
@@ -193,4 +267,125 @@ void (*PlatformSpecificMutexLock)(PlatformSpecificMutex) = DummyMutexLock;
 void (*PlatformSpecificMutexUnlock)(PlatformSpecificMutex) = DummyMutexUnlock;
 void (*PlatformSpecificMutexDestroy)(PlatformSpecificMutex) = DummyMutexDestroy;
 
+static PlatformSpecificThread DummyThreadCreate(void (*)(void*), void*)
+{
+    return 0;
+}
+
+static void DummyThreadJoin(PlatformSpecificThread)
+{
+}
+
+PlatformSpecificThread (*PlatformSpecificThreadCreate)(void (*)(void*), void*) = DummyThreadCreate;
+void (*PlatformSpecificThreadJoin)(PlatformSpecificThread) = DummyThreadJoin;
+
+/* Without threads there is nothing to wait for or to race with */
+static PlatformSpecificCondition DummyConditionCreate(void)
+{
+    return 0;
+}
+
+static void DummyConditionWait(PlatformSpecificCondition, PlatformSpecificMutex)
+{
+}
+
+static void DummyConditionNotify(PlatformSpecificCondition)
+{
+}
+
+static void DummyConditionDestroy(PlatformSpecificCondition)
+{
+}
+
+PlatformSpecificCondition (*PlatformSpecificConditionCreate)(void) = DummyConditionCreate;
+void (*PlatformSpecificConditionWait)(PlatformSpecificCondition, PlatformSpecificMutex) = DummyConditionWait;
+void (*PlatformSpecificConditionSignal)(PlatformSpecificCondition) = DummyConditionNotify;
+void (*PlatformSpecificConditionBroadcast)(PlatformSpecificCondition) = DummyConditionNotify;
+void (*PlatformSpecificConditionDestroy)(PlatformSpecificCondition) = DummyConditionDestroy;
+
+static long DummyAtomicLoad(volatile long* value)
+{
+    return *value;
+}
+
+static long DummyAtomicAdd(volatile long* value, long delta)
+{
+    return *value += delta;
+}
+
+static long DummyAtomicCompareExchange(volatile long* value, long expected, long desired)
+{
+    long previous = *value;
+    if (previous == expected) *value = desired;
+    return previous;
+}
+
+long (*PlatformSpecificAtomicLoad)(volatile long*) = DummyAtomicLoad;
+long (*PlatformSpecificAtomicAdd)(volatile long*, long) = DummyAtomicAdd;
+long (*PlatformSpecificAtomicCompareExchange)(volatile long*, long, long) = DummyAtomicCompareExchange;
+
+static PlatformSpecificThreadLocal DummyThreadLocalCreate(void)
+{
+    void** key = new void*;
+    *key = 0;
+    return (PlatformSpecificThreadLocal)key;
+}
+
+static void* DummyThreadLocalGet(PlatformSpecificThreadLocal key)
+{
+    return *(void**)key;
+}
+
+static void DummyThreadLocalSet(PlatformSpecificThreadLocal key, void* value)
+{
+    *(void**)key = value;
+}
+
+static void DummyThreadLocalDestroy(PlatformSpecificThreadLocal key)
+{
+    delete (void**)key;
+}
+
+PlatformSpecificThreadLocal (*PlatformSpecificThreadLocalCreate)(void) = DummyThreadLocalCreate;
+void* (*PlatformSpecificThreadLocalGet)(PlatformSpecificThreadLocal) = DummyThreadLocalGet;
+void (*PlatformSpecificThreadLocalSet)(PlatformSpecificThreadLocal, void*) = DummyThreadLocalSet;
+void (*PlatformSpecificThreadLocalDestroy)(PlatformSpecificThreadLocal) = DummyThreadLocalDestroy;
+
+static int DummyBacktrace(void**, int)
+{
+    return 0;
+}
+
+static void DummyBacktraceSymbol(void*, char* symbol, size_t size)
+{
+    if (size) symbol[0] = '\0';
+}
+
+int (*PlatformSpecificBacktrace)(void**, int) = DummyBacktrace;
+void (*PlatformSpecificBacktraceSymbol)(void*, char*, size_t) = DummyBacktraceSymbol;
+
+static size_t DummyPageSize(void)
+{
+    return 0;
+}
+
+static void* DummyPageAlloc(size_t)
+{
+    return 0;
+}
+
+static void DummyPageFree(void*, size_t)
+{
+}
+
+static int DummyPageProtect(void*, size_t, int)
+{
+    return -1;
+}
+
+size_t (*PlatformSpecificPageSize)(void) = DummyPageSize;
+void* (*PlatformSpecificPageAlloc)(size_t) = DummyPageAlloc;
+void (*PlatformSpecificPageFree)(void*, size_t) = DummyPageFree;
+int (*PlatformSpecificPageProtect)(void*, size_t, int) = DummyPageProtect;
+
 }
@@ -67,6 +67,71 @@ void PlatformSpecificRunTestInASeperateProcess(UtestShell* shell, TestPlugin* pl
    shell->runOneTest(plugin, *result);
 }
 
+static int SymbianFork()
+{
+    return 0;
+}
+
+static int SymbianWaitPid(int, int*, int)
+{
+    return 0;
+}
+
+static int SymbianWaitPidWithResourceUsage(int, int*, int, PlatformSpecificResourceUsage*)
+{
+    return 0;
+}
+
+static int SymbianGetResourceUsage(PlatformSpecificResourceUsage*)
+{
+    return -1;
+}
+
+static int SymbianPipe(int*, int*)
+{
+    return -1;
+}
+
+static int SymbianRead(int, char*, int)
+{
+    return -1;
+}
+
+static int SymbianWrite(int, const char*, int)
+{
+    return -1;
+}
+
+static void SymbianClose(int)
+{
+}
+
+static int SymbianWaitForReadable(const int*, int)
+{
+    return -1;
+}
+
+static int SymbianTerminationSignal(int)
+{
+    return 0;
+}
+
+static void SymbianExit(int)
+{
+}
+
+int (*PlatformSpecificFork)() = SymbianFork;
+int (*PlatformSpecificWaitPid)(int, int*, int) = SymbianWaitPid;
+int (*PlatformSpecificWaitPidWithResourceUsage)(int, int*, int, PlatformSpecificResourceUsage*) = SymbianWaitPidWithResourceUsage;
+int (*PlatformSpecificGetResourceUsage)(PlatformSpecificResourceUsage*) = SymbianGetResourceUsage;
+int (*PlatformSpecificPipe)(int*, int*) = SymbianPipe;
+int (*PlatformSpecificRead)(int, char*, int) = SymbianRead;
+int (*PlatformSpecificWrite)(int, const char*, int) = SymbianWrite;
+void (*PlatformSpecificClose)(int) = SymbianClose;
+int (*PlatformSpecificWaitForReadable)(const int*, int) = SymbianWaitForReadable;
+int (*PlatformSpecificTerminationSignal)(int) = SymbianTerminationSignal;
+void (*PlatformSpecificExit)(int) = SymbianExit;
+
 static long TimeInMillisImplementation() {
     struct timeval tv;
     struct timezone tz;
@@ -76,6 +141,13 @@ static long TimeInMillisImplementation() {
 
 long (*GetPlatformSpecificTimeInMillis)() = TimeInMillisImplementation;
 
+static double MonotonicTimeInNanosImplementation()
+{
+    return (double) TimeInMillisImplementation() * 1000000.0;
+}
+
+double (*GetPlatformSpecificMonotonicTimeInNanos)() = MonotonicTimeInNanosImplementation;
+
 TestOutput::WorkingEnvironment PlatformSpecificGetWorkingEnvironment()
 {
     return TestOutput::eclipse;
@@ -133,10 +205,18 @@ void PlatformSpecificFPuts(const char* str, PlatformSpecificFile file) {
     fputs(str, (FILE*)file);
 }
 
+char* PlatformSpecificFGets(char* str, int size, PlatformSpecificFile file) {
+    return fgets(str, size, (FILE*)file);
+}
+
 void PlatformSpecificFClose(PlatformSpecificFile file) {
     fclose((FILE*)file);
 }
 
+PlatformSpecificFile PlatformSpecificStdIn() {
+    return stdin;
+}
+
 extern "C" {
     
 static int IsNanImplementation(double d)
@@ -180,3 +260,124 @@ void (*PlatformSpecificMutexLock)(PlatformSpecificMutex) = DummyMutexLock;
 void (*PlatformSpecificMutexUnlock)(PlatformSpecificMutex) = DummyMutexUnlock;
 void (*PlatformSpecificMutexDestroy)(PlatformSpecificMutex) = DummyMutexDestroy;
 
+static PlatformSpecificThread DummyThreadCreate(void (*function)(void*), void* data)
+{
+    return 0;
+}
+
+static void DummyThreadJoin(PlatformSpecificThread thread)
+{
+}
+
+PlatformSpecificThread (*PlatformSpecificThreadCreate)(void (*)(void*), void*) = DummyThreadCreate;
+void (*PlatformSpecificThreadJoin)(PlatformSpecificThread) = DummyThreadJoin;
+
+/* Without threads there is nothing to wait for or to race with */
+static PlatformSpecificCondition DummyConditionCreate(void)
+{
+    return 0;
+}
+
+static void DummyConditionWait(PlatformSpecificCondition condition, PlatformSpecificMutex mtx)
+{
+}
+
+static void DummyConditionNotify(PlatformSpecificCondition condition)
+{
+}
+
+static void DummyConditionDestroy(PlatformSpecificCondition condition)
+{
+}
+
+PlatformSpecificCondition (*PlatformSpecificConditionCreate)(void) = DummyConditionCreate;
+void (*PlatformSpecificConditionWait)(PlatformSpecificCondition, PlatformSpecificMutex) = DummyConditionWait;
+void (*PlatformSpecificConditionSignal)(PlatformSpecificCondition) = DummyConditionNotify;
+void (*PlatformSpecificConditionBroadcast)(PlatformSpecificCondition) = DummyConditionNotify;
+void (*PlatformSpecificConditionDestroy)(PlatformSpecificCondition) = DummyConditionDestroy;
+
+static long DummyAtomicLoad(volatile long* value)
+{
+    return *value;
+}
+
+static long DummyAtomicAdd(volatile long* value, long delta)
+{
+    return *value += delta;
+}
+
+static long DummyAtomicCompareExchange(volatile long* value, long expected, long desired)
+{
+    long previous = *value;
+    if (previous == expected) *value = desired;
+    return previous;
+}
+
+long (*PlatformSpecificAtomicLoad)(volatile long*) = DummyAtomicLoad;
+long (*PlatformSpecificAtomicAdd)(volatile long*, long) = DummyAtomicAdd;
+long (*PlatformSpecificAtomicCompareExchange)(volatile long*, long, long) = DummyAtomicCompareExchange;
+
+static PlatformSpecificThreadLocal DummyThreadLocalCreate(void)
+{
+    void** key = new void*;
+    *key = 0;
+    return (PlatformSpecificThreadLocal)key;
+}
+
+static void* DummyThreadLocalGet(PlatformSpecificThreadLocal key)
+{
+    return *(void**)key;
+}
+
+static void DummyThreadLocalSet(PlatformSpecificThreadLocal key, void* value)
+{
+    *(void**)key = value;
+}
+
+static void DummyThreadLocalDestroy(PlatformSpecificThreadLocal key)
+{
+    delete (void**)key;
+}
+
+PlatformSpecificThreadLocal (*PlatformSpecificThreadLocalCreate)(void) = DummyThreadLocalCreate;
+void* (*PlatformSpecificThreadLocalGet)(PlatformSpecificThreadLocal) = DummyThreadLocalGet;
+void (*PlatformSpecificThreadLocalSet)(PlatformSpecificThreadLocal, void*) = DummyThreadLocalSet;
+void (*PlatformSpecificThreadLocalDestroy)(PlatformSpecificThreadLocal) = DummyThreadLocalDestroy;
+
+static int DummyBacktrace(void** frames, int maxFrames)
+{
+    return 0;
+}
+
+static void DummyBacktraceSymbol(void* frame, char* symbol, size_t size)
+{
+    if (size) symbol[0] = '\0';
+}
+
+int (*PlatformSpecificBacktrace)(void**, int) = DummyBacktrace;
+void (*PlatformSpecificBacktraceSymbol)(void*, char*, size_t) = DummyBacktraceSymbol;
+
+static size_t DummyPageSize(void)
+{
+    return 0;
+}
+
+static void* DummyPageAlloc(size_t size)
+{
+    return 0;
+}
+
+static void DummyPageFree(void* memory, size_t size)
+{
+}
+
+static int DummyPageProtect(void* memory, size_t size, int accessible)
+{
+    return -1;
+}
+
+size_t (*PlatformSpecificPageSize)(void) = DummyPageSize;
+void* (*PlatformSpecificPageAlloc)(size_t) = DummyPageAlloc;
+void (*PlatformSpecificPageFree)(void*, size_t) = DummyPageFree;
+int (*PlatformSpecificPageProtect)(void*, size_t, int) = DummyPageProtect;
+
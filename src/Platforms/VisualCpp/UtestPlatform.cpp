@@ -30,8 +30,9 @@
     #define LOCALTIME(_tm, timer) memcpy(_tm, localtime(timer), sizeof(tm));
 #endif
 
-static jmp_buf test_exit_jmp_buf[10];
-static int jmp_buf_index = 0;
+/* Per thread, so tests can run on several threads at once */
+static CPPUTEST_THREAD_LOCAL jmp_buf test_exit_jmp_buf[10];
+static CPPUTEST_THREAD_LOCAL int jmp_buf_index = 0;
 
 static int VisualCppSetJmp(void (*function) (void* data), void* data)
 {
@@ -67,6 +68,71 @@ static void VisualCppRunTestInASeperateProcess(UtestShell* shell, TestPlugin* pl
 void (*PlatformSpecificRunTestInASeperateProcess)(UtestShell* shell, TestPlugin* plugin, TestResult* result) =
         VisualCppRunTestInASeperateProcess;
 
+static int VisualCppFork(void)
+{
+    return 0;
+}
+
+static int VisualCppWaitPid(int, int*, int)
+{
+    return 0;
+}
+
+static int VisualCppWaitPidWithResourceUsage(int, int*, int, PlatformSpecificResourceUsage*)
+{
+    return 0;
+}
+
+static int VisualCppGetResourceUsage(PlatformSpecificResourceUsage*)
+{
+    return -1;
+}
+
+static int VisualCppPipe(int*, int*)
+{
+    return -1;
+}
+
+static int VisualCppRead(int, char*, int)
+{
+    return -1;
+}
+
+static int VisualCppWrite(int, const char*, int)
+{
+    return -1;
+}
+
+static void VisualCppClose(int)
+{
+}
+
+static int VisualCppWaitForReadable(const int*, int)
+{
+    return -1;
+}
+
+static int VisualCppTerminationSignal(int)
+{
+    return 0;
+}
+
+static void VisualCppExit(int)
+{
+}
+
+int (*PlatformSpecificFork)(void) = VisualCppFork;
+int (*PlatformSpecificWaitPid)(int, int*, int) = VisualCppWaitPid;
+int (*PlatformSpecificWaitPidWithResourceUsage)(int, int*, int, PlatformSpecificResourceUsage*) = VisualCppWaitPidWithResourceUsage;
+int (*PlatformSpecificGetResourceUsage)(PlatformSpecificResourceUsage*) = VisualCppGetResourceUsage;
+int (*PlatformSpecificPipe)(int*, int*) = VisualCppPipe;
+int (*PlatformSpecificRead)(int, char*, int) = VisualCppRead;
+int (*PlatformSpecificWrite)(int, const char*, int) = VisualCppWrite;
+void (*PlatformSpecificClose)(int) = VisualCppClose;
+int (*PlatformSpecificWaitForReadable)(const int*, int) = VisualCppWaitForReadable;
+int (*PlatformSpecificTerminationSignal)(int) = VisualCppTerminationSignal;
+void (*PlatformSpecificExit)(int) = VisualCppExit;
+
 TestOutput::WorkingEnvironment PlatformSpecificGetWorkingEnvironment()
 {
     return TestOutput::vistualStudio;
@@ -81,6 +147,17 @@ static long VisualCppTimeInMillis()
 
 long (*GetPlatformSpecificTimeInMillis)() = VisualCppTimeInMillis;
 
+static double VisualCppMonotonicTimeInNanos()
+{
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (!QueryPerformanceFrequency(&frequency) || !QueryPerformanceCounter(&counter))
+        return (double) timeGetTime() * 1000000.0;
+    return (double) counter.QuadPart * (1000000000.0 / (double) frequency.QuadPart);
+}
+
+double (*GetPlatformSpecificMonotonicTimeInNanos)() = VisualCppMonotonicTimeInNanos;
+
 ///////////// Time in String
 
 static const char* VisualCppTimeString()
@@ -133,14 +210,26 @@ static void VisualCppFPuts(const char* str, PlatformSpecificFile file)
    fputs(str, (FILE*)file);
 }
 
+static char* VisualCppFGets(char* str, int size, PlatformSpecificFile file)
+{
+   return fgets(str, size, (FILE*)file);
+}
+
 static void VisualCppFClose(PlatformSpecificFile file)
 {
    fclose((FILE*)file);
 }
 
+static PlatformSpecificFile VisualCppStdIn()
+{
+   return stdin;
+}
+
 PlatformSpecificFile (*PlatformSpecificFOpen)(const char* filename, const char* flag) = VisualCppFOpen;
 void (*PlatformSpecificFPuts)(const char* str, PlatformSpecificFile file) = VisualCppFPuts;
+char* (*PlatformSpecificFGets)(char* str, int size, PlatformSpecificFile file) = VisualCppFGets;
 void (*PlatformSpecificFClose)(PlatformSpecificFile file) = VisualCppFClose;
+PlatformSpecificFile (*PlatformSpecificStdIn)(void) = VisualCppStdIn;
 
 static void VisualCppFlush()
 {
@@ -199,3 +288,163 @@ PlatformSpecificMutex (*PlatformSpecificMutexCreate)(void) = VisualCppMutexCreat
 void (*PlatformSpecificMutexLock)(PlatformSpecificMutex) = VisualCppMutexLock;
 void (*PlatformSpecificMutexUnlock)(PlatformSpecificMutex) = VisualCppMutexUnlock;
 void (*PlatformSpecificMutexDestroy)(PlatformSpecificMutex) = VisualCppMutexDestroy;
+
+struct VisualCppThread
+{
+	HANDLE handle;
+	void (*function)(void*);
+	void* data;
+};
+
+static DWORD WINAPI VisualCppThreadRun(LPVOID started)
+{
+	VisualCppThread* thread = (VisualCppThread*) started;
+	thread->function(thread->data);
+	return 0;
+}
+
+static PlatformSpecificThread VisualCppThreadCreate(void (*function)(void*), void* data)
+{
+	VisualCppThread* thread = new VisualCppThread;
+	thread->function = function;
+	thread->data = data;
+	thread->handle = CreateThread(NULL, 0, VisualCppThreadRun, thread, 0, NULL);
+	if (thread->handle == NULL) {
+		delete thread;
+		return NULL;
+	}
+	return (PlatformSpecificThread)thread;
+}
+
+static void VisualCppThreadJoin(PlatformSpecificThread started)
+{
+	VisualCppThread* thread = (VisualCppThread*) started;
+	WaitForSingleObject(thread->handle, INFINITE);
+	CloseHandle(thread->handle);
+	delete thread;
+}
+
+PlatformSpecificThread (*PlatformSpecificThreadCreate)(void (*)(void*), void*) = VisualCppThreadCreate;
+void (*PlatformSpecificThreadJoin)(PlatformSpecificThread) = VisualCppThreadJoin;
+
+static PlatformSpecificCondition VisualCppConditionCreate(void)
+{
+	CONDITION_VARIABLE *condition = new CONDITION_VARIABLE;
+	InitializeConditionVariable(condition);
+	return (PlatformSpecificCondition)condition;
+}
+
+static void VisualCppConditionWait(PlatformSpecificCondition condition, PlatformSpecificMutex mutex)
+{
+	SleepConditionVariableCS((CONDITION_VARIABLE*)condition, (CRITICAL_SECTION*)mutex, INFINITE);
+}
+
+static void VisualCppConditionSignal(PlatformSpecificCondition condition)
+{
+	WakeConditionVariable((CONDITION_VARIABLE*)condition);
+}
+
+static void VisualCppConditionBroadcast(PlatformSpecificCondition condition)
+{
+	WakeAllConditionVariable((CONDITION_VARIABLE*)condition);
+}
+
+static void VisualCppConditionDestroy(PlatformSpecificCondition condition)
+{
+	delete (CONDITION_VARIABLE*)condition;
+}
+
+PlatformSpecificCondition (*PlatformSpecificConditionCreate)(void) = VisualCppConditionCreate;
+void (*PlatformSpecificConditionWait)(PlatformSpecificCondition, PlatformSpecificMutex) = VisualCppConditionWait;
+void (*PlatformSpecificConditionSignal)(PlatformSpecificCondition) = VisualCppConditionSignal;
+void (*PlatformSpecificConditionBroadcast)(PlatformSpecificCondition) = VisualCppConditionBroadcast;
+void (*PlatformSpecificConditionDestroy)(PlatformSpecificCondition) = VisualCppConditionDestroy;
+
+static long VisualCppAtomicLoad(volatile long* value)
+{
+	return InterlockedCompareExchange(value, 0, 0);
+}
+
+static long VisualCppAtomicAdd(volatile long* value, long delta)
+{
+	return InterlockedExchangeAdd(value, delta) + delta;
+}
+
+static long VisualCppAtomicCompareExchange(volatile long* value, long expected, long desired)
+{
+	return InterlockedCompareExchange(value, desired, expected);
+}
+
+long (*PlatformSpecificAtomicLoad)(volatile long*) = VisualCppAtomicLoad;
+long (*PlatformSpecificAtomicAdd)(volatile long*, long) = VisualCppAtomicAdd;
+long (*PlatformSpecificAtomicCompareExchange)(volatile long*, long, long) = VisualCppAtomicCompareExchange;
+
+static PlatformSpecificThreadLocal VisualCppThreadLocalCreate(void)
+{
+	DWORD index = TlsAlloc();
+	if (index == TLS_OUT_OF_INDEXES) return NULL;
+	return (PlatformSpecificThreadLocal)(size_t)(index + 1);
+}
+
+static void* VisualCppThreadLocalGet(PlatformSpecificThreadLocal key)
+{
+	return TlsGetValue((DWORD)((size_t)key - 1));
+}
+
+static void VisualCppThreadLocalSet(PlatformSpecificThreadLocal key, void* value)
+{
+	TlsSetValue((DWORD)((size_t)key - 1), value);
+}
+
+static void VisualCppThreadLocalDestroy(PlatformSpecificThreadLocal key)
+{
+	TlsFree((DWORD)((size_t)key - 1));
+}
+
+PlatformSpecificThreadLocal (*PlatformSpecificThreadLocalCreate)(void) = VisualCppThreadLocalCreate;
+void* (*PlatformSpecificThreadLocalGet)(PlatformSpecificThreadLocal) = VisualCppThreadLocalGet;
+void (*PlatformSpecificThreadLocalSet)(PlatformSpecificThreadLocal, void*) = VisualCppThreadLocalSet;
+void (*PlatformSpecificThreadLocalDestroy)(PlatformSpecificThreadLocal) = VisualCppThreadLocalDestroy;
+
+/* Skips this function itself. Naming frames needs dbghelp, the report shows their addresses instead */
+static int VisualCppBacktrace(void** frames, int maxFrames)
+{
+	if (maxFrames <= 0) return 0;
+	return CaptureStackBackTrace(1, (DWORD)maxFrames, frames, NULL);
+}
+
+static void VisualCppBacktraceSymbol(void*, char* symbol, size_t size)
+{
+	if (size) symbol[0] = '\0';
+}
+
+int (*PlatformSpecificBacktrace)(void**, int) = VisualCppBacktrace;
+void (*PlatformSpecificBacktraceSymbol)(void*, char*, size_t) = VisualCppBacktraceSymbol;
+
+static size_t VisualCppPageSize(void)
+{
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	return systemInfo.dwPageSize;
+}
+
+static void* VisualCppPageAlloc(size_t size)
+{
+	return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+static void VisualCppPageFree(void* memory, size_t)
+{
+	VirtualFree(memory, 0, MEM_RELEASE);
+}
+
+static int VisualCppPageProtect(void* memory, size_t size, int accessible)
+{
+	DWORD oldProtection;
+	return VirtualProtect(memory, size, accessible ? PAGE_READWRITE : PAGE_NOACCESS, &oldProtection) ? 0 : -1;
+}
+
+size_t (*PlatformSpecificPageSize)(void) = VisualCppPageSize;
+void* (*PlatformSpecificPageAlloc)(size_t) = VisualCppPageAlloc;
+void (*PlatformSpecificPageFree)(void*, size_t) = VisualCppPageFree;
+int (*PlatformSpecificPageProtect)(void*, size_t, int) = VisualCppPageProtect;
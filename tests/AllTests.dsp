@@ -146,6 +146,10 @@ SOURCE=.\JUnitOutputTest.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\TraceEventTestOutputTest.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\MemoryLeakDetectorTest.cpp
 # End Source File
 # Begin Source File
@@ -166,6 +170,10 @@ SOURCE=.\CppUTestExt\MemoryReporterPluginTest.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\CppUTestExt\PerfCounterPluginTest.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\CppUTestExt\MemoryReportFormatterTest.cpp
 # End Source File
 # Begin Source File
@@ -266,6 +274,14 @@ SOURCE=.\TestRegistryTest.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\TestWorkerPoolTest.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\TestBaselineTest.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\TestResultTest.cpp
 # End Source File
 # Begin Source File
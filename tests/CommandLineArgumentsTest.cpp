@@ -28,6 +28,7 @@
 #include "CppUTest/TestHarness.h"
 #include "CppUTest/CommandLineArguments.h"
 #include "CppUTest/TestRegistry.h"
+#include "CppUTest/PlatformSpecificFunctions.h"
 
 class OptionsPlugin: public TestPlugin
 {
@@ -45,6 +46,43 @@ public:
     }
 };
 
+static const char* selectionsToRead = "";
+static int stdInFile;
+static int selectionFile;
+static int numberOfClosedFiles;
+
+extern "C" {
+
+    static PlatformSpecificFile FakeFOpen(const char* fileName, const char*)
+    {
+        return SimpleString(fileName) == "selection.txt" ? &selectionFile : NULL;
+    }
+
+    static PlatformSpecificFile FakeStdIn(void)
+    {
+        return &stdInFile;
+    }
+
+    static char* FakeFGets(char* str, int size, PlatformSpecificFile)
+    {
+        if (*selectionsToRead == '\0') return NULL;
+        int length = 0;
+        while (length < size - 1 && selectionsToRead[length] != '\0') {
+            str[length] = selectionsToRead[length];
+            if (selectionsToRead[length++] == '\n') break;
+        }
+        str[length] = '\0';
+        selectionsToRead += length;
+        return str;
+    }
+
+    static void FakeFClose(PlatformSpecificFile)
+    {
+        numberOfClosedFiles++;
+    }
+
+}
+
 TEST_GROUP(CommandLineArguments)
 {
     CommandLineArguments* args;
@@ -110,6 +148,100 @@ TEST(CommandLineArguments, repeatSetDefaultsToTwo)
     LONGS_EQUAL(2, args->getRepeatCount());
 }
 
+TEST(CommandLineArguments, numberOfWorkersDefaultsToOne)
+{
+    int argc = 1;
+    const char* argv[] = { "tests.exe" };
+    CHECK(newArgumentParser(argc, argv));
+    LONGS_EQUAL(1, args->getNumberOfWorkers());
+}
+
+TEST(CommandLineArguments, numberOfWorkersSet)
+{
+    int argc = 2;
+    const char* argv[] = { "tests.exe", "-j4" };
+    CHECK(newArgumentParser(argc, argv));
+    LONGS_EQUAL(4, args->getNumberOfWorkers());
+}
+
+TEST(CommandLineArguments, numberOfWorkersSetDifferentParameter)
+{
+    int argc = 3;
+    const char* argv[] = { "tests.exe", "-j", "3" };
+    CHECK(newArgumentParser(argc, argv));
+    LONGS_EQUAL(3, args->getNumberOfWorkers());
+}
+
+TEST(CommandLineArguments, numberOfWorkersWithoutNumberIsAnError)
+{
+    int argc = 2;
+    const char* argv[] = { "tests.exe", "-j" };
+    CHECK(!newArgumentParser(argc, argv));
+}
+
+TEST(CommandLineArguments, numberOfThreadsSet)
+{
+    int argc = 3;
+    const char* argv[] = { "tests.exe", "-t", "4" };
+    CHECK(newArgumentParser(argc, argv));
+    LONGS_EQUAL(4, args->getNumberOfThreads());
+}
+
+TEST(CommandLineArguments, numberOfThreadsWithoutNumberIsAnError)
+{
+    int argc = 2;
+    const char* argv[] = { "tests.exe", "-t" };
+    CHECK(!newArgumentParser(argc, argv));
+}
+
+TEST(CommandLineArguments, notShardedByDefault)
+{
+    int argc = 1;
+    const char* argv[] = { "tests.exe" };
+    CHECK(newArgumentParser(argc, argv));
+    LONGS_EQUAL(0, args->getShardIndex());
+    LONGS_EQUAL(1, args->getShardCount());
+}
+
+TEST(CommandLineArguments, shardIndexAndCount)
+{
+    int argc = 5;
+    const char* argv[] = { "tests.exe", "--shard-index", "3", "--shard-count", "16" };
+    CHECK(newArgumentParser(argc, argv));
+    LONGS_EQUAL(3, args->getShardIndex());
+    LONGS_EQUAL(16, args->getShardCount());
+}
+
+TEST(CommandLineArguments, shardIndexAndCountWithEqualsSign)
+{
+    int argc = 3;
+    const char* argv[] = { "tests.exe", "--shard-index=0", "--shard-count=2" };
+    CHECK(newArgumentParser(argc, argv));
+    LONGS_EQUAL(0, args->getShardIndex());
+    LONGS_EQUAL(2, args->getShardCount());
+}
+
+TEST(CommandLineArguments, shardIndexMustBeSmallerThanShardCount)
+{
+    int argc = 5;
+    const char* argv[] = { "tests.exe", "--shard-index", "2", "--shard-count", "2" };
+    CHECK(!newArgumentParser(argc, argv));
+}
+
+TEST(CommandLineArguments, shardIndexWithoutNumberIsAnError)
+{
+    int argc = 2;
+    const char* argv[] = { "tests.exe", "--shard-index" };
+    CHECK(!newArgumentParser(argc, argv));
+}
+
+TEST(CommandLineArguments, shardCountOfZeroIsAnError)
+{
+    int argc = 2;
+    const char* argv[] = { "tests.exe", "--shard-count=0" };
+    CHECK(!newArgumentParser(argc, argv));
+}
+
 TEST(CommandLineArguments, runningTestsInSeperateProcesses)
 {
     int argc = 2;
@@ -118,6 +250,69 @@ TEST(CommandLineArguments, runningTestsInSeperateProcesses)
     CHECK(args->runTestsInSeperateProcess());
 }
 
+TEST(CommandLineArguments, benchmarksAreNotRunOnlyByDefault)
+{
+    const char* argv[] = { "tests.exe" };
+    CHECK(newArgumentParser(1, argv));
+    CHECK_FALSE(args->isRunningBenchmarksOnly());
+}
+
+TEST(CommandLineArguments, runningBenchmarksOnly)
+{
+    const char* argv[] = { "tests.exe", "-b" };
+    CHECK(newArgumentParser(2, argv));
+    CHECK(args->isRunningBenchmarksOnly());
+}
+
+TEST(CommandLineArguments, noBaselineByDefault)
+{
+    const char* argv[] = { "tests.exe" };
+    CHECK(newArgumentParser(1, argv));
+    CHECK(args->getBaselineFileName().isEmpty());
+    CHECK(args->getSaveBaselineFileName().isEmpty());
+    LONGS_EQUAL(10, args->getBaselineThreshold());
+}
+
+TEST(CommandLineArguments, baselineFiles)
+{
+    const char* argv[] = { "tests.exe", "--baseline", "old.txt", "--save-baseline=new.txt" };
+    CHECK(newArgumentParser(4, argv));
+    STRCMP_EQUAL("old.txt", args->getBaselineFileName().asCharString());
+    STRCMP_EQUAL("new.txt", args->getSaveBaselineFileName().asCharString());
+}
+
+TEST(CommandLineArguments, baselineThreshold)
+{
+    const char* argv[] = { "tests.exe", "--baseline-threshold", "25" };
+    CHECK(newArgumentParser(3, argv));
+    LONGS_EQUAL(25, args->getBaselineThreshold());
+}
+
+TEST(CommandLineArguments, durationsFile)
+{
+    const char* argv[] = { "tests.exe", "--durations=durations.txt" };
+    CHECK(newArgumentParser(2, argv));
+    STRCMP_EQUAL("durations.txt", args->getDurationsFileName().asCharString());
+}
+
+TEST(CommandLineArguments, durationsWithoutFileIsAnError)
+{
+    const char* argv[] = { "tests.exe", "--durations" };
+    CHECK_FALSE(newArgumentParser(2, argv));
+}
+
+TEST(CommandLineArguments, baselineWithoutFileIsAnError)
+{
+    const char* argv[] = { "tests.exe", "--baseline" };
+    CHECK_FALSE(newArgumentParser(2, argv));
+}
+
+TEST(CommandLineArguments, baselineThresholdWithoutNumberIsAnError)
+{
+    const char* argv[] = { "tests.exe", "--baseline-threshold=ten" };
+    CHECK_FALSE(newArgumentParser(2, argv));
+}
+
 TEST(CommandLineArguments, setGroupFilter)
 {
     int argc = 3;
@@ -209,6 +404,34 @@ TEST(CommandLineArguments, setTestToRunUsingVerboseOutputOfIgnoreTest)
     CHECK_EQUAL(groupFilter, *args->getGroupFilters());
 }
 
+TEST(CommandLineArguments, setTestToRunUsingVerboseOutputOfBenchmark)
+{
+    int argc = 2;
+    const char* argv[] = { "tests.exe", "BENCHMARK(testgroup, testname) - stuff" };
+    CHECK(newArgumentParser(argc, argv));
+
+    TestFilter nameFilter("testname");
+    TestFilter groupFilter("testgroup");
+    nameFilter.strictMatching();
+    groupFilter.strictMatching();
+    CHECK_EQUAL(nameFilter, *args->getNameFilters());
+    CHECK_EQUAL(groupFilter, *args->getGroupFilters());
+}
+
+TEST(CommandLineArguments, setTestToRunUsingVerboseOutputOfConcurrentTest)
+{
+    int argc = 2;
+    const char* argv[] = { "tests.exe", "TEST_CONCURRENT(testgroup, testname) - stuff" };
+    CHECK(newArgumentParser(argc, argv));
+
+    TestFilter nameFilter("testname");
+    TestFilter groupFilter("testgroup");
+    nameFilter.strictMatching();
+    groupFilter.strictMatching();
+    CHECK_EQUAL(nameFilter, *args->getNameFilters());
+    CHECK_EQUAL(groupFilter, *args->getGroupFilters());
+}
+
 TEST(CommandLineArguments, setNormalOutput)
 {
     int argc = 2;
@@ -241,6 +464,15 @@ TEST(CommandLineArguments, setJUnitOutputDifferentParameter)
     CHECK(args->isJUnitOutput());
 }
 
+TEST(CommandLineArguments, setTraceOutput)
+{
+    int argc = 2;
+    const char* argv[] = { "tests.exe", "-otrace" };
+    CHECK(newArgumentParser(argc, argv));
+    CHECK(args->isTraceOutput());
+    CHECK(!args->isJUnitOutput());
+}
+
 TEST(CommandLineArguments, setOutputToGarbage)
 {
     int argc = 3;
@@ -269,7 +501,7 @@ TEST(CommandLineArguments, weirdParamatersPrintsUsageAndReturnsFalse)
     int argc = 2;
     const char* argv[] = { "tests.exe", "-SomethingWeird" };
     CHECK(!newArgumentParser(argc, argv));
-    STRCMP_EQUAL("usage [-v] [-c] [-p] [-lg] [-ln] [-r#] [-g|sg groupName]... [-n|sn testName]... [\"TEST(groupName, testName)\"]... [-o{normal, junit}] [-k packageName]\n",
+    STRCMP_EQUAL("usage [-v] [-c] [-p] [-b] [-lg] [-ln] [-r#] [-j#] [-t#] [--shard-index # --shard-count #] [--baseline file] [--save-baseline file] [--baseline-threshold #] [--durations file] [--tests-from-file file|-] [-g|sg groupName]... [-n|sn testName]... [\"TEST(groupName, testName)\"]... [-o{normal, junit, trace}] [-k packageName]\n",
             args->usage());
 }
 
@@ -323,3 +555,86 @@ TEST(CommandLineArguments, lastParameterFieldMissing)
     CHECK(newArgumentParser(argc, argv));
     CHECK_EQUAL(SimpleString(""), args->getPackageName());
 }
+
+TEST_GROUP(CommandLineArgumentsTestsFromFile)
+{
+    CommandLineArguments* args;
+    OptionsPlugin* plugin;
+
+    void setup()
+    {
+        UT_PTR_SET(PlatformSpecificFOpen, FakeFOpen);
+        UT_PTR_SET(PlatformSpecificStdIn, FakeStdIn);
+        UT_PTR_SET(PlatformSpecificFGets, FakeFGets);
+        UT_PTR_SET(PlatformSpecificFClose, FakeFClose);
+        numberOfClosedFiles = 0;
+        plugin = new OptionsPlugin("options");
+        args = NULL;
+    }
+    void teardown()
+    {
+        delete args;
+        delete plugin;
+    }
+
+    bool parseSelections(const char* fileName, const char* selections)
+    {
+        const char* argv[] = { "tests.exe", "--tests-from-file", fileName };
+        selectionsToRead = selections;
+        args = new CommandLineArguments(3, argv);
+        return args->parse(plugin);
+    }
+
+    SimpleString selectedTests()
+    {
+        SimpleString tests;
+        for (const TestFilter* filter = args->getTestFilters(); filter; filter = filter->getNext())
+            tests += StringFrom(*filter) + "\n";
+        return tests;
+    }
+};
+
+TEST(CommandLineArgumentsTestsFromFile, noTestFiltersByDefault)
+{
+    const char* argv[] = { "tests.exe" };
+    args = new CommandLineArguments(1, argv);
+    CHECK(args->parse(plugin));
+    POINTERS_EQUAL(NULL, args->getTestFilters());
+}
+
+TEST(CommandLineArgumentsTestsFromFile, readsOneSelectionPerWord)
+{
+    CHECK(parseSelections("selection.txt", "Group.first\nGroup.second  Other.third\r\n\n"));
+    STRCMP_EQUAL("TestFilter: \"Other.third\" with strict matching\n"
+                 "TestFilter: \"Group.second\" with strict matching\n"
+                 "TestFilter: \"Group.first\" with strict matching\n", selectedTests().asCharString());
+    LONGS_EQUAL(1, numberOfClosedFiles);
+}
+
+TEST(CommandLineArgumentsTestsFromFile, readsSelectionsLongerThanTheReadBuffer)
+{
+    SimpleString name("n", 300);
+    SimpleString selections = SimpleString("Group.") + name;
+    CHECK(parseSelections("selection.txt", selections.asCharString()));
+    TestFilter expected(selections);
+    expected.strictMatching();
+    CHECK(*args->getTestFilters() == expected);
+}
+
+TEST(CommandLineArgumentsTestsFromFile, readsSelectionsFromStdInWithoutClosingIt)
+{
+    CHECK(parseSelections("-", "Group.first"));
+    STRCMP_EQUAL("TestFilter: \"Group.first\" with strict matching\n", selectedTests().asCharString());
+    LONGS_EQUAL(0, numberOfClosedFiles);
+}
+
+TEST(CommandLineArgumentsTestsFromFile, emptySelectionSelectsNoTest)
+{
+    CHECK(parseSelections("selection.txt", "\n"));
+    STRCMP_EQUAL("TestFilter: \"\" with strict matching\n", selectedTests().asCharString());
+}
+
+TEST(CommandLineArgumentsTestsFromFile, missingFileIsAnError)
+{
+    CHECK_FALSE(parseSelections("missing.txt", ""));
+}
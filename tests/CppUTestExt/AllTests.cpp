@@ -29,6 +29,7 @@
 #include "CppUTest/TestRegistry.h"
 #include "CppUTestExt/MemoryReporterPlugin.h"
 #include "CppUTestExt/MockSupportPlugin.h"
+#include "CppUTestExt/PerfCounterPlugin.h"
 
 #ifdef INCLUDE_GTEST_TESTS
 #include "CppUTestExt/GTestConvertor.h"
@@ -43,8 +44,10 @@ int main(int ac, const char** av)
 
     MemoryReporterPlugin plugin;
     MockSupportPlugin mockPlugin;
+    PerfCounterPlugin perfCounterPlugin;
     TestRegistry::getCurrentRegistry()->installPlugin(&plugin);
     TestRegistry::getCurrentRegistry()->installPlugin(&mockPlugin);
+    TestRegistry::getCurrentRegistry()->installPlugin(&perfCounterPlugin);
 
 #ifndef GMOCK_RENAME_MAIN
     return CommandLineTestRunner::RunAllTests(ac, av);
@@ -234,6 +234,94 @@ TEST(MockExpectedCallsList, amountOfExpectationsForHasNone)
     LONGS_EQUAL(0, list->amountOfExpectationsFor("bar"));
 }
 
+TEST(MockExpectedCallsList, addUnfulfilledExpectationsRelatedToOnlyAddsThatName)
+{
+    call1->withName("foo");
+    call2->withName("bar");
+    call3->withName("foo");
+    call3->callWasMade(1);
+    call4->withName("foo");
+    list->addExpectedCall(call1);
+    list->addExpectedCall(call2);
+    list->addExpectedCall(call3);
+    list->addExpectedCall(call4);
+
+    MockExpectedCallsList newList;
+    newList.addUnfulfilledExpectationsRelatedTo("foo", *list);
+    LONGS_EQUAL(2, newList.size());
+    LONGS_EQUAL(2, newList.amountOfExpectationsFor("foo"));
+    CHECK(!newList.hasExpectationWithName("bar"));
+}
+
+TEST(MockExpectedCallsList, expectationsByNameAreUpdatedWhenPruned)
+{
+    call1->withName("foo");
+    call2->withName("bar");
+    call3->withName("foo");
+    list->addExpectedCall(call1);
+    list->addExpectedCall(call2);
+    list->addExpectedCall(call3);
+    list->onlyKeepExpectationsRelatedTo("bar");
+
+    LONGS_EQUAL(0, list->amountOfExpectationsFor("foo"));
+    CHECK(!list->hasExpectationWithName("foo"));
+    LONGS_EQUAL(1, list->amountOfExpectationsFor("bar"));
+
+    list->addExpectedCall(call1);
+    LONGS_EQUAL(1, list->amountOfExpectationsFor("foo"));
+    LONGS_EQUAL(2, list->size());
+}
+
+TEST(MockExpectedCallsList, manyDifferentNamesCanBeFound)
+{
+    MockCheckedExpectedCall calls[100];
+    for (int i = 0; i < 100; i++) {
+        calls[i].withName(StringFrom(i));
+        list->addExpectedCall(&calls[i]);
+    }
+
+    for (int i = 0; i < 100; i++)
+        LONGS_EQUAL(1, list->amountOfExpectationsFor(StringFrom(i)));
+    CHECK(!list->hasExpectationWithName("100"));
+}
+
+TEST(MockExpectedCallsList, namesCanBeFoundAfterTheListWasClearedAndFilledAgain)
+{
+    for (int i = 0; i < 200; i++) {
+        MockCheckedExpectedCall* call = new MockCheckedExpectedCall;
+        call->withName(StringFrom(i));
+        list->addExpectedCall(call);
+    }
+    list->deleteAllExpectationsAndClearList();
+    CHECK(!list->hasExpectationWithName("1"));
+
+    call1->withName("foo");
+    list->addExpectedCall(call1);
+    LONGS_EQUAL(1, list->amountOfExpectationsFor("foo"));
+}
+
+TEST(MockExpectedCallsList, firstUnfulfilledNodeRelatedToSkipsTheFulfilledOnes)
+{
+    call1->withName("foo");
+    call2->withName("foo");
+    call3->withName("foo");
+    list->addExpectedCall(call1);
+    list->addExpectedCall(call2);
+    list->addExpectedCall(call3);
+
+    call1->callWasMade(1);
+    POINTERS_EQUAL(call2, list->firstUnfulfilledNodeRelatedTo("foo")->expectedCall_);
+    call2->callWasMade(2);
+    POINTERS_EQUAL(call3, list->firstUnfulfilledNodeRelatedTo("foo")->expectedCall_);
+    call3->callWasMade(3);
+    POINTERS_EQUAL(NULL, list->firstUnfulfilledNodeRelatedTo("foo"));
+
+    call4->withName("foo");
+    list->addExpectedCall(call4);
+    POINTERS_EQUAL(call4, list->firstUnfulfilledNodeRelatedTo("foo")->expectedCall_);
+    POINTERS_EQUAL(NULL, list->firstUnfulfilledNodeRelatedTo("bar"));
+}
+
 TEST(MockExpectedCallsList, callToStringForUnfulfilledFunctions)
 {
     call1->withName("foo");
@@ -122,6 +122,66 @@ TEST(MockCheckedActualCall, multipleSameFunctionsExpectingAndHappenGradually)
     list->deleteAllExpectationsAndClearList();
 }
 
+TEST(MockCheckedActualCall, expectationsAfterTheMatchingOneAreNotChecked)
+{
+    MockCheckedExpectedCall* call1 = new MockCheckedExpectedCall();
+    MockCheckedExpectedCall* call2 = new MockCheckedExpectedCall();
+    call1->withName("func").withParameter("p", 1);
+    call2->withName("func").withParameter("p", 2);
+    list->addExpectedCall(call1);
+    list->addExpectedCall(call2);
+
+    MockCheckedActualCall actualCall(1, reporter, *list);
+    actualCall.withName("func").withIntParameter("p", 1);
+    actualCall.checkExpectations();
+
+    CHECK(call1->isFulfilled());
+    LONGS_EQUAL(MockCheckedExpectedCall::NOT_CALLED_YET, call2->getCallOrder());
+
+    list->deleteAllExpectationsAndClearList();
+}
+
+TEST(MockCheckedActualCall, laterExpectationsAreMatchedAgainstACopyOfAStringParameter)
+{
+    MockCheckedExpectedCall* call1 = new MockCheckedExpectedCall();
+    MockCheckedExpectedCall* call2 = new MockCheckedExpectedCall();
+    call1->withName("func").withParameter("s", "value").withParameter("other", 1);
+    call2->withName("func").withParameter("s", "value");
+    list->addExpectedCall(call1);
+    list->addExpectedCall(call2);
+
+    char buffer[] = "value";
+    MockCheckedActualCall actualCall(1, reporter, *list);
+    actualCall.withName("func").withStringParameter("s", buffer);
+    buffer[0] = 'X';
+    actualCall.checkExpectations();
+
+    CHECK(call2->isFulfilled());
+
+    list->deleteAllExpectationsAndClearList();
+}
+
+TEST(MockCheckedActualCall, expectationsAddedAfterTheCallAreNotMatched)
+{
+    MockCheckedExpectedCall* call1 = new MockCheckedExpectedCall();
+    call1->withName("func").withParameter("p", 1).withParameter("other", 1);
+    list->addExpectedCall(call1);
+
+    MockCheckedActualCall actualCall(1, reporter, *list);
+    actualCall.withName("func").withIntParameter("p", 1);
+
+    MockCheckedExpectedCall* call2 = new MockCheckedExpectedCall();
+    call2->withName("func").withParameter("p", 1);
+    list->addExpectedCall(call2);
+    actualCall.checkExpectations();
+
+    CHECK(!call2->isFulfilled());
+    MockExpectedParameterDidntHappenFailure expectedFailure(mockFailureTest(), "func", *list);
+    CHECK_EXPECTED_MOCK_FAILURE(expectedFailure);
+
+    list->deleteAllExpectationsAndClearList();
+}
+
 TEST(MockCheckedActualCall, MockIgnoredActualCallWorksAsItShould)
 {
     MockIgnoredActualCall actual;
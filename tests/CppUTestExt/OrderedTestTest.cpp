@@ -95,6 +95,14 @@ TEST(TestOrderedTest, InstallOneText)
     CHECK(firstTest() == &orderedTest);
 }
 
+TEST(TestOrderedTest, OrderedTestLinkedInAfterTheFirstLookupIsFound)
+{
+    OrderedTestInstaller(orderedTest, "testgroup", "first", __FILE__, __LINE__, 3);
+    CHECK(fixture->registry_->findTestWithName("first") == &orderedTest);
+    OrderedTestInstaller(orderedTest2, "testgroup", "second", __FILE__, __LINE__, 5);
+    CHECK(fixture->registry_->findTestWithName("second") == &orderedTest2);
+}
+
 TEST(TestOrderedTest, OrderedTestsAreLast)
 {
     InstallNormalTest(normalTest);
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2007, Michael Feathers, James Grenning and Bas Vodde
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE EARLIER MENTIONED AUTHORS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestOutput.h"
+#include "CppUTestExt/PerfCounterPlugin.h"
+
+class FakePerfCounterPlugin : public PerfCounterPlugin
+{
+public:
+    FakePerfCounterPlugin(bool available) : available_(available), opened_(0), closed_(0), started_(0)
+    {
+    }
+
+    virtual ~FakePerfCounterPlugin()
+    {
+        closeCounters();
+    }
+
+    void closeAll()
+    {
+        closeCounters();
+    }
+
+    bool available_;
+    int opened_;
+    int closed_;
+    int started_;
+
+protected:
+    virtual int openCounter(Counter counter) _override
+    {
+        if (!available_) return -1;
+        opened_++;
+        return (int) counter;
+    }
+
+    virtual void startCounter(int) _override
+    {
+        started_++;
+    }
+
+    virtual double stopAndReadCounter(int handle) _override
+    {
+        return 1000.0 * (handle + 1);
+    }
+
+    virtual void closeCounter(int) _override
+    {
+        closed_++;
+    }
+};
+
+TEST_GROUP(PerfCounterPlugin)
+{
+    StringBufferTestOutput output;
+    TestResult* result;
+    UtestShell* test;
+
+    void setup()
+    {
+        output.verbose();
+        result = new TestResult(output);
+        test = new UtestShell("group", "name", "file", 1);
+    }
+
+    void teardown()
+    {
+        delete result;
+        delete test;
+    }
+
+    void enable(PerfCounterPlugin& plugin)
+    {
+        const char* av[] = { "-pperfcounters" };
+        CHECK(plugin.parseArguments(1, av, 0));
+    }
+};
+
+TEST(PerfCounterPlugin, isNotMeasuringByDefault)
+{
+    FakePerfCounterPlugin plugin(true);
+    CHECK_FALSE(plugin.isMeasuring());
+
+    plugin.preTestAction(*test, *result);
+    plugin.postTestAction(*test, *result);
+
+    LONGS_EQUAL(0, plugin.opened_);
+    STRCMP_EQUAL("", output.getOutput().asCharString());
+}
+
+TEST(PerfCounterPlugin, ignoresOtherArguments)
+{
+    FakePerfCounterPlugin plugin(true);
+    const char* av[] = { "-pmemoryreport=normal" };
+    CHECK_FALSE(plugin.parseArguments(1, av, 0));
+    CHECK_FALSE(plugin.isMeasuring());
+}
+
+TEST(PerfCounterPlugin, reportsAllCountersAsTestProperties)
+{
+    FakePerfCounterPlugin plugin(true);
+    enable(plugin);
+
+    plugin.preTestAction(*test, *result);
+    plugin.postTestAction(*test, *result);
+
+    STRCMP_EQUAL(" - cycles 1000 - instructions 2000 - cache_misses 3000 - branch_misses 4000",
+                 output.getOutput().asCharString());
+}
+
+TEST(PerfCounterPlugin, opensCountersOnceAndClosesThemWhenDone)
+{
+    FakePerfCounterPlugin plugin(true);
+    enable(plugin);
+
+    plugin.preTestAction(*test, *result);
+    plugin.postTestAction(*test, *result);
+    plugin.preTestAction(*test, *result);
+    plugin.postTestAction(*test, *result);
+    plugin.closeAll();
+
+    LONGS_EQUAL(PerfCounterPlugin::numberOfCounters, plugin.opened_);
+    LONGS_EQUAL(2 * PerfCounterPlugin::numberOfCounters, plugin.started_);
+    LONGS_EQUAL(PerfCounterPlugin::numberOfCounters, plugin.closed_);
+}
+
+TEST(PerfCounterPlugin, printsANoteOnceWhenNoCountersAreAvailable)
+{
+    FakePerfCounterPlugin plugin(false);
+    enable(plugin);
+
+    plugin.preTestAction(*test, *result);
+    plugin.postTestAction(*test, *result);
+    plugin.preTestAction(*test, *result);
+    plugin.postTestAction(*test, *result);
+
+    STRCMP_EQUAL("\nNote: performance counters are not available on this system, running without them.\n",
+                 output.getOutput().asCharString());
+    LONGS_EQUAL(0, plugin.started_);
+}
+
+TEST(PerfCounterPlugin, counterNames)
+{
+    STRCMP_EQUAL("cycles", PerfCounterPlugin::getCounterName(PerfCounterPlugin::cycles));
+    STRCMP_EQUAL("branch_misses", PerfCounterPlugin::getCounterName(PerfCounterPlugin::branchMisses));
+}
+
+TEST(PerfCounterPlugin, realCountersDoNotBreakTheTest)
+{
+    PerfCounterPlugin plugin;
+    enable(plugin);
+
+    plugin.preTestAction(*test, *result);
+    plugin.postTestAction(*test, *result);
+
+    LONGS_EQUAL(0, result->getFailureCount());
+}
@@ -135,12 +135,12 @@ public:
 };
 
 extern "C" {
-    static long millisTime = 0;
+    static double nanosTime = 0;
     static const char* theTime = "";
 
-    static long MockGetPlatformSpecificTimeInMillis()
+    static double MockGetPlatformSpecificMonotonicTimeInNanos()
     {
-        return millisTime;
+        return nanosTime;
     }
 
     static const char* MockGetPlatformSpecificTimeString()
@@ -156,18 +156,22 @@ class JUnitTestOutputTestRunner
     const char* currentGroupName_;
     UtestShell* currentTest_;
     bool firstTestInGroup_;
-    int timeTheTestTakes_;
+    double timeTheTestTakes_;
     TestFailure* testFailure_;
+    bool benchmarked_;
+    BenchmarkResult benchmark_;
+    const char* propertyName_;
+    const char* propertyValue_;
 
 public:
 
     JUnitTestOutputTestRunner(TestResult result) :
-        result_(result), currentGroupName_(0), currentTest_(0), firstTestInGroup_(true), timeTheTestTakes_(0), testFailure_(0)
+        result_(result), currentGroupName_(0), currentTest_(0), firstTestInGroup_(true), timeTheTestTakes_(0), testFailure_(0), benchmarked_(false), propertyName_(0), propertyValue_(0)
     {
-        millisTime = 0;
+        nanosTime = 0;
         theTime =  "1978-10-03T00:00:00";
 
-        UT_PTR_SET(GetPlatformSpecificTimeInMillis, MockGetPlatformSpecificTimeInMillis);
+        UT_PTR_SET(GetPlatformSpecificMonotonicTimeInNanos, MockGetPlatformSpecificMonotonicTimeInNanos);
         UT_PTR_SET(GetPlatformSpecificTimeString, MockGetPlatformSpecificTimeString);
     }
 
@@ -233,7 +237,17 @@ public:
         }
         result_.currentTestStarted(currentTest_);
 
-        millisTime += timeTheTestTakes_;
+        nanosTime += timeTheTestTakes_;
+
+        if (propertyName_) {
+            result_.addTestProperty(*currentTest_, propertyName_, propertyValue_);
+            propertyName_ = 0;
+        }
+
+        if (benchmarked_) {
+            result_.addBenchmarkResult(*currentTest_, benchmark_);
+            benchmarked_ = false;
+        }
 
         if (testFailure_) {
             result_.addFailure(*testFailure_);
@@ -246,7 +260,7 @@ public:
 
     JUnitTestOutputTestRunner& thatTakes(int timeElapsed)
     {
-        timeTheTestTakes_ = timeElapsed;
+        timeTheTestTakes_ = timeElapsed * 1000000.0;
         return *this;
     }
 
@@ -255,6 +269,26 @@ public:
         return *this;
     }
 
+    JUnitTestOutputTestRunner& nanoseconds()
+    {
+        timeTheTestTakes_ /= 1000000.0;
+        return *this;
+    }
+
+    JUnitTestOutputTestRunner& thatBenchmarks(double* nanosPerIteration, int numberOfSamples, long iterationsPerSample)
+    {
+        benchmark_.calculate(nanosPerIteration, numberOfSamples, iterationsPerSample);
+        benchmarked_ = true;
+        return *this;
+    }
+
+    JUnitTestOutputTestRunner& withProperty(const char* name, const char* value)
+    {
+        propertyName_ = name;
+        propertyValue_ = value;
+        return *this;
+    }
+
     JUnitTestOutputTestRunner& thatFails(const char* message, const char* file, int line)
     {
         testFailure_ = new TestFailure(	currentTest_, file, line, message);
@@ -340,7 +374,7 @@ TEST(JUnitOutputTest, withOneTestGroupAndOneTestoutputsTestSuiteStartAndEndBlock
             .end();
 
     outputFile = fileSystem.file("cpputest_groupname.xml");
-    STRCMP_EQUAL("<testsuite errors=\"0\" failures=\"0\" hostname=\"localhost\" name=\"groupname\" tests=\"1\" time=\"0.000\" timestamp=\"1978-10-03T00:00:00\">\n", outputFile->line(2));
+    STRCMP_EQUAL("<testsuite errors=\"0\" failures=\"0\" hostname=\"localhost\" name=\"groupname\" tests=\"1\" time=\"0.000000\" timestamp=\"1978-10-03T00:00:00\">\n", outputFile->line(2));
     STRCMP_EQUAL("</testsuite>", outputFile->lineFromTheBack(1));
 }
 
@@ -383,7 +417,7 @@ TEST(JUnitOutputTest, withOneTestGroupAndOneTestFileShouldContainsATestCaseBlock
 
     outputFile = fileSystem.file("cpputest_groupname.xml");
 
-    STRCMP_EQUAL("<testcase classname=\"groupname\" name=\"testname\" time=\"0.000\">\n", outputFile->line(5));
+    STRCMP_EQUAL("<testcase classname=\"groupname\" name=\"testname\" time=\"0.000000\">\n", outputFile->line(5));
     STRCMP_EQUAL("</testcase>\n", outputFile->line(6));
 }
 
@@ -395,10 +429,10 @@ TEST(JUnitOutputTest, withOneTestGroupAndTwoTestCasesCreateCorrectTestgroupBlock
 
     outputFile = fileSystem.file("cpputest_twoTestsGroup.xml");
 
-    STRCMP_EQUAL("<testsuite errors=\"0\" failures=\"0\" hostname=\"localhost\" name=\"twoTestsGroup\" tests=\"2\" time=\"0.000\" timestamp=\"1978-10-03T00:00:00\">\n", outputFile->line(2));
-    STRCMP_EQUAL("<testcase classname=\"twoTestsGroup\" name=\"firstTestName\" time=\"0.000\">\n", outputFile->line(5));
+    STRCMP_EQUAL("<testsuite errors=\"0\" failures=\"0\" hostname=\"localhost\" name=\"twoTestsGroup\" tests=\"2\" time=\"0.000000\" timestamp=\"1978-10-03T00:00:00\">\n", outputFile->line(2));
+    STRCMP_EQUAL("<testcase classname=\"twoTestsGroup\" name=\"firstTestName\" time=\"0.000000\">\n", outputFile->line(5));
     STRCMP_EQUAL("</testcase>\n", outputFile->line(6));
-    STRCMP_EQUAL("<testcase classname=\"twoTestsGroup\" name=\"secondTestName\" time=\"0.000\">\n", outputFile->line(7));
+    STRCMP_EQUAL("<testcase classname=\"twoTestsGroup\" name=\"secondTestName\" time=\"0.000000\">\n", outputFile->line(7));
     STRCMP_EQUAL("</testcase>\n", outputFile->line(8));
 }
 
@@ -410,7 +444,55 @@ TEST(JUnitOutputTest, withOneTestGroupAndTimeHasElapsedAndTimestampChanged)
 
     outputFile = fileSystem.file("cpputest_timeGroup.xml");
 
-    STRCMP_EQUAL("<testsuite errors=\"0\" failures=\"0\" hostname=\"localhost\" name=\"timeGroup\" tests=\"1\" time=\"0.010\" timestamp=\"2013-07-04T22:28:00\">\n", outputFile->line(2));
+    STRCMP_EQUAL("<testsuite errors=\"0\" failures=\"0\" hostname=\"localhost\" name=\"timeGroup\" tests=\"1\" time=\"0.010000\" timestamp=\"2013-07-04T22:28:00\">\n", outputFile->line(2));
+}
+
+TEST(JUnitOutputTest, withOneTestGroupAndSubMillisecondElapsedTime)
+{
+    testCaseRunner->start()
+            .withGroup("fastGroup")
+                .withTest("firstTestName").thatTakes(1500).nanoseconds()
+                .withTest("secondTestName").thatTakes(2500999).nanoseconds()
+            .end();
+
+    outputFile = fileSystem.file("cpputest_fastGroup.xml");
+    STRCMP_EQUAL("<testsuite errors=\"0\" failures=\"0\" hostname=\"localhost\" name=\"fastGroup\" tests=\"2\" time=\"0.002502\" timestamp=\"1978-10-03T00:00:00\">\n", outputFile->line(2));
+    STRCMP_EQUAL("<testcase classname=\"fastGroup\" name=\"firstTestName\" time=\"0.000001\">\n", outputFile->line(5));
+    STRCMP_EQUAL("<testcase classname=\"fastGroup\" name=\"secondTestName\" time=\"0.002500\">\n", outputFile->line(7));
+}
+
+TEST(JUnitOutputTest, benchmarkResultsAreWrittenAsProperties)
+{
+    double nanosPerIteration[] = { 2.0, 1.0, 3.0 };
+    testCaseRunner->start()
+            .withGroup("benchmarkGroup")
+                .withTest("plainTest")
+                .withTest("benchmarkName").thatBenchmarks(nanosPerIteration, 3, 1000)
+            .end();
+
+    outputFile = fileSystem.file("cpputest_benchmarkGroup.xml");
+    STRCMP_EQUAL("<properties>\n", outputFile->line(3));
+    STRCMP_EQUAL("<property name=\"benchmarkName.min_ns\" value=\"1.000\"/>\n", outputFile->line(4));
+    STRCMP_EQUAL("<property name=\"benchmarkName.median_ns\" value=\"2.000\"/>\n", outputFile->line(5));
+    STRCMP_EQUAL("<property name=\"benchmarkName.p99_ns\" value=\"3.000\"/>\n", outputFile->line(6));
+    STRCMP_EQUAL("<property name=\"benchmarkName.stddev_ns\" value=\"1.000\"/>\n", outputFile->line(7));
+    STRCMP_EQUAL("<property name=\"benchmarkName.samples\" value=\"3\"/>\n", outputFile->line(8));
+    STRCMP_EQUAL("<property name=\"benchmarkName.iterations\" value=\"1000\"/>\n", outputFile->line(9));
+    STRCMP_EQUAL("</properties>\n", outputFile->line(10));
+}
+
+TEST(JUnitOutputTest, testPropertiesAreWrittenAsProperties)
+{
+    testCaseRunner->start()
+            .withGroup("propertyGroup")
+                .withTest("firstTestName").withProperty("cycles", "1234")
+                .withTest("secondTestName")
+            .end();
+
+    outputFile = fileSystem.file("cpputest_propertyGroup.xml");
+    STRCMP_EQUAL("<properties>\n", outputFile->line(3));
+    STRCMP_EQUAL("<property name=\"firstTestName.cycles\" value=\"1234\"/>\n", outputFile->line(4));
+    STRCMP_EQUAL("</properties>\n", outputFile->line(5));
 }
 
 TEST(JUnitOutputTest, withOneTestGroupAndMultipleTestCasesWithElapsedTime)
@@ -422,10 +504,10 @@ TEST(JUnitOutputTest, withOneTestGroupAndMultipleTestCasesWithElapsedTime)
             .end();
 
     outputFile = fileSystem.file("cpputest_twoTestsGroup.xml");
-    STRCMP_EQUAL("<testsuite errors=\"0\" failures=\"0\" hostname=\"localhost\" name=\"twoTestsGroup\" tests=\"2\" time=\"0.060\" timestamp=\"1978-10-03T00:00:00\">\n", outputFile->line(2));
-    STRCMP_EQUAL("<testcase classname=\"twoTestsGroup\" name=\"firstTestName\" time=\"0.010\">\n", outputFile->line(5));
+    STRCMP_EQUAL("<testsuite errors=\"0\" failures=\"0\" hostname=\"localhost\" name=\"twoTestsGroup\" tests=\"2\" time=\"0.060000\" timestamp=\"1978-10-03T00:00:00\">\n", outputFile->line(2));
+    STRCMP_EQUAL("<testcase classname=\"twoTestsGroup\" name=\"firstTestName\" time=\"0.010000\">\n", outputFile->line(5));
     STRCMP_EQUAL("</testcase>\n", outputFile->line(6));
-    STRCMP_EQUAL("<testcase classname=\"twoTestsGroup\" name=\"secondTestName\" time=\"0.050\">\n", outputFile->line(7));
+    STRCMP_EQUAL("<testcase classname=\"twoTestsGroup\" name=\"secondTestName\" time=\"0.050000\">\n", outputFile->line(7));
     STRCMP_EQUAL("</testcase>\n", outputFile->line(8));
 }
 
@@ -437,8 +519,8 @@ TEST(JUnitOutputTest, withOneTestGroupAndOneFailingTest)
             .end();
 
     outputFile = fileSystem.file("cpputest_testGroupWithFailingTest.xml");
-    STRCMP_EQUAL("<testsuite errors=\"0\" failures=\"1\" hostname=\"localhost\" name=\"testGroupWithFailingTest\" tests=\"1\" time=\"0.000\" timestamp=\"1978-10-03T00:00:00\">\n", outputFile->line(2));
-    STRCMP_EQUAL("<testcase classname=\"testGroupWithFailingTest\" name=\"FailingTestName\" time=\"0.000\">\n", outputFile->line(5));
+    STRCMP_EQUAL("<testsuite errors=\"0\" failures=\"1\" hostname=\"localhost\" name=\"testGroupWithFailingTest\" tests=\"1\" time=\"0.000000\" timestamp=\"1978-10-03T00:00:00\">\n", outputFile->line(2));
+    STRCMP_EQUAL("<testcase classname=\"testGroupWithFailingTest\" name=\"FailingTestName\" time=\"0.000000\">\n", outputFile->line(5));
     STRCMP_EQUAL("<failure message=\"thisfile:10: Test failed\" type=\"AssertionFailedError\">\n", outputFile->line(6));
     STRCMP_EQUAL("</failure>\n", outputFile->line(7));
     STRCMP_EQUAL("</testcase>\n", outputFile->line(8));
@@ -454,8 +536,8 @@ TEST(JUnitOutputTest, withTwoTestGroupAndOneFailingTest)
 
     outputFile = fileSystem.file("cpputest_testGroupWithFailingTest.xml");
 
-    STRCMP_EQUAL("<testsuite errors=\"0\" failures=\"1\" hostname=\"localhost\" name=\"testGroupWithFailingTest\" tests=\"2\" time=\"0.000\" timestamp=\"1978-10-03T00:00:00\">\n", outputFile->line(2));
-    STRCMP_EQUAL("<testcase classname=\"testGroupWithFailingTest\" name=\"FailingTestName\" time=\"0.000\">\n", outputFile->line(7));
+    STRCMP_EQUAL("<testsuite errors=\"0\" failures=\"1\" hostname=\"localhost\" name=\"testGroupWithFailingTest\" tests=\"2\" time=\"0.000000\" timestamp=\"1978-10-03T00:00:00\">\n", outputFile->line(2));
+    STRCMP_EQUAL("<testcase classname=\"testGroupWithFailingTest\" name=\"FailingTestName\" time=\"0.000000\">\n", outputFile->line(7));
     STRCMP_EQUAL("<failure message=\"thisfile:10: Test failed\" type=\"AssertionFailedError\">\n", outputFile->line(8));
 }
 
@@ -573,6 +655,21 @@ TEST(JUnitOutputTest, testGroupWithWeirdName)
     STRCMP_EQUAL("cpputest_group_weird_name.xml", junitOutput->createFileName("group/weird/name").asCharString());
 }
 
+TEST(JUnitOutputTest, fileNameContainsTheShardIndex)
+{
+    junitOutput->setShardIndex(3);
+    STRCMP_EQUAL("cpputest_groupname_shard3.xml", junitOutput->createFileName("groupname").asCharString());
+}
+
+TEST(JUnitOutputTest, groupWithoutAnyTestRunWritesNoFile)
+{
+    UtestShell test("groupname", "testname", "file", 1);
+    result->currentGroupStarted(&test);
+    result->currentGroupEnded(&test);
+
+    LONGS_EQUAL(0, fileSystem.amountOfFiles());
+}
+
 TEST(JUnitOutputTest, TestCaseBlockWithAPackageName)
 {
     junitOutput->setPackageName("packagename");
@@ -582,7 +679,7 @@ TEST(JUnitOutputTest, TestCaseBlockWithAPackageName)
 
     outputFile = fileSystem.file("cpputest_groupname.xml");
 
-    STRCMP_EQUAL("<testcase classname=\"packagename.groupname\" name=\"testname\" time=\"0.000\">\n", outputFile->line(5));
+    STRCMP_EQUAL("<testcase classname=\"packagename.groupname\" name=\"testname\" time=\"0.000000\">\n", outputFile->line(5));
     STRCMP_EQUAL("</testcase>\n", outputFile->line(6));
 }
 
@@ -595,7 +692,7 @@ TEST(JUnitOutputTest, TestCaseBlockForIgnoredTest)
 
    outputFile = fileSystem.file("cpputest_groupname.xml");
 
-   STRCMP_EQUAL("<testcase classname=\"packagename.groupname\" name=\"testname\" time=\"0.000\">\n", outputFile->line(5));
+   STRCMP_EQUAL("<testcase classname=\"packagename.groupname\" name=\"testname\" time=\"0.000000\">\n", outputFile->line(5));
    STRCMP_EQUAL("<skipped />\n", outputFile->line(6));
    STRCMP_EQUAL("</testcase>\n", outputFile->line(7));
 }
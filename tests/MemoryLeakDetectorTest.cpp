@@ -362,6 +362,19 @@ TEST(MemoryLeakDetectorTest, OneRealloc)
     detector->stopChecking();
     LONGS_EQUAL(1, testAllocator->alloc_called);
     LONGS_EQUAL(1, testAllocator->free_called);
+    LONGS_EQUAL(0, testAllocator->allocMemoryLeakNodeCalled);
+    LONGS_EQUAL(0, testAllocator->freeMemoryLeakNodeCalled);
+}
+
+TEST(MemoryLeakDetectorTest, OneReallocWithNodePoolDisabled)
+{
+    detector->disableNodePool();
+    char* mem1 = detector->allocMemory(testAllocator, 10, "file.cpp", 1234, true);
+    char* mem2 = detector->reallocMemory(testAllocator, mem1, 1000, "other.cpp", 5678, true);
+    detector->deallocMemory(testAllocator, mem2, true);
+    detector->stopChecking();
+
+    LONGS_EQUAL(0, detector->totalMemoryLeaks(mem_leak_period_all));
     LONGS_EQUAL(2, testAllocator->allocMemoryLeakNodeCalled);
     LONGS_EQUAL(2, testAllocator->freeMemoryLeakNodeCalled);
 }
@@ -499,6 +512,627 @@ TEST(MemoryLeakDetectorTest, invalidateMemoryNULLShouldWork)
   detector->invalidateMemory(NULL);
 }
 
+static PlatformSpecificMutex lastLockedMutex = 0;
+static int numberOfMutexLocks = 0;
+static int numberOfMutexUnlocks = 0;
+
+static void RecordingMutexLock(PlatformSpecificMutex mutex)
+{
+    lastLockedMutex = mutex;
+    numberOfMutexLocks++;
+}
+
+static void RecordingMutexUnlock(PlatformSpecificMutex)
+{
+    numberOfMutexUnlocks++;
+}
+
+TEST_GROUP(MemoryLeakDetectorShardLockingTest)
+{
+    MemoryLeakDetector* detector;
+    MemoryLeakFailureForTest *reporter;
+
+    void setup()
+    {
+        UT_PTR_SET(PlatformSpecificMutexLock, RecordingMutexLock);
+        UT_PTR_SET(PlatformSpecificMutexUnlock, RecordingMutexUnlock);
+        lastLockedMutex = 0;
+        numberOfMutexLocks = 0;
+        numberOfMutexUnlocks = 0;
+
+        reporter = new MemoryLeakFailureForTest;
+        detector = new MemoryLeakDetector(reporter);
+        detector->enable();
+    }
+    void teardown()
+    {
+        delete detector;
+        delete reporter;
+    }
+};
+
+TEST(MemoryLeakDetectorShardLockingTest, noLockingUnlessEnabled)
+{
+    char* mem = detector->allocMemory(defaultMallocAllocator(), 10, true);
+    detector->deallocMemory(defaultMallocAllocator(), mem, true);
+    LONGS_EQUAL(0, numberOfMutexLocks);
+}
+
+TEST(MemoryLeakDetectorShardLockingTest, allocationLocksShardAndSequenceFreeOnlyTheShard)
+{
+    detector->enableShardLocking();
+    char* mem = detector->allocMemory(defaultMallocAllocator(), 10, true);
+    detector->deallocMemory(defaultMallocAllocator(), mem, true);
+    LONGS_EQUAL(3, numberOfMutexLocks);
+    LONGS_EQUAL(3, numberOfMutexUnlocks);
+}
+
+TEST(MemoryLeakDetectorShardLockingTest, memoryInDifferentShardsUsesDifferentLocks)
+{
+    detector->enableShardLocking();
+    char* mem[MemoryLeakDetectorTable::number_of_shards * 4];
+    PlatformSpecificMutex firstMutex = 0;
+    bool differentMutexUsed = false;
+
+    for (int i = 0; i < MemoryLeakDetectorTable::number_of_shards * 4; i++)
+        mem[i] = detector->allocMemory(defaultMallocAllocator(), 10, true);
+    for (int j = 0; j < MemoryLeakDetectorTable::number_of_shards * 4; j++) {
+        detector->invalidateMemory(mem[j]);
+        if (j == 0) firstMutex = lastLockedMutex;
+        else if (lastLockedMutex != firstMutex) differentMutexUsed = true;
+        detector->deallocMemory(defaultMallocAllocator(), mem[j], true);
+    }
+
+    CHECK(differentMutexUsed);
+    LONGS_EQUAL(0, detector->totalMemoryLeaks(mem_leak_period_all));
+}
+
+TEST_GROUP(MemoryLeakDetectorSamplingTest)
+{
+    MemoryLeakDetector* detector;
+    MemoryLeakFailureForTest *reporter;
+    char* memory[1000];
+
+    void setup()
+    {
+        reporter = new MemoryLeakFailureForTest;
+        detector = new MemoryLeakDetector(reporter);
+        detector->enable();
+        detector->startChecking();
+        detector->sampleAllocations(10);
+        reporter->message = new SimpleString();
+    }
+    void teardown()
+    {
+        delete reporter->message;
+        delete detector;
+        delete reporter;
+    }
+
+    void allocate()
+    {
+        for (int i = 0; i < 1000; i++)
+            memory[i] = detector->allocMemory(defaultMallocAllocator(), 10);
+    }
+
+    void deallocate()
+    {
+        for (int i = 0; i < 1000; i++)
+            detector->deallocMemory(defaultMallocAllocator(), memory[i]);
+    }
+};
+
+TEST(MemoryLeakDetectorSamplingTest, tracksAboutOneInNAllocations)
+{
+    allocate();
+    int tracked = detector->totalMemoryLeaks(mem_leak_period_checking);
+    CHECK(tracked > 50 && tracked < 150);
+    LONGS_EQUAL(1000 - tracked, (long) detector->getNumberOfUntrackedAllocations());
+    deallocate();
+}
+
+TEST(MemoryLeakDetectorSamplingTest, freeingTrackedAndUntrackedMemoryLeavesNoLeaks)
+{
+    allocate();
+    deallocate();
+    LONGS_EQUAL(0, detector->totalMemoryLeaks(mem_leak_period_all));
+    STRCMP_EQUAL("", reporter->message->asCharString());
+}
+
+TEST(MemoryLeakDetectorSamplingTest, untrackedMemoryCanBeReallocated)
+{
+    allocate();
+    for (int i = 0; i < 1000; i++)
+        memory[i] = detector->reallocMemory(defaultMallocAllocator(), memory[i], 20, "file", 1);
+    deallocate();
+    LONGS_EQUAL(0, detector->totalMemoryLeaks(mem_leak_period_all));
+}
+
+TEST(MemoryLeakDetectorSamplingTest, reportEstimatesTheNumberOfLeaks)
+{
+    allocate();
+    int tracked = detector->totalMemoryLeaks(mem_leak_period_checking);
+    SimpleString report = detector->report(mem_leak_period_checking);
+    STRCMP_CONTAINS(StringFromFormat("Sampled 1 in 10 allocations, estimated number of leaks: %d", tracked * 10).asCharString(), report.asCharString());
+    deallocate();
+}
+
+TEST(MemoryLeakDetectorSamplingTest, deallocatingNonAllocatedMemoryIsStillReportedWithoutUntrackedMemory)
+{
+    char notAllocated[10];
+    detector->deallocMemory(defaultMallocAllocator(), notAllocated);
+    STRCMP_CONTAINS("Deallocating non-allocated memory", reporter->message->asCharString());
+}
+
+TEST(MemoryLeakDetectorSamplingTest, deallocatingNonAllocatedMemoryInTheSampleIsReportedWithUntrackedMemory)
+{
+    char notAllocated[1024];
+    char* inTheSample = notAllocated;
+    while (!detector->wouldTrackAllocationAt(inTheSample) && inTheSample < notAllocated + sizeof(notAllocated) - 8) inTheSample += 8;
+    CHECK(detector->wouldTrackAllocationAt(inTheSample));
+
+    allocate();
+    detector->deallocMemory(defaultMallocAllocator(), inTheSample);
+    STRCMP_CONTAINS("Deallocating non-allocated memory", reporter->message->asCharString());
+    deallocate();
+}
+
+TEST(MemoryLeakDetectorSamplingTest, untrackedMemoryOfAnEarlierTestDoesNotHideDeallocatingNonAllocatedMemory)
+{
+    char notAllocated[1024];
+    char* outOfTheSample = notAllocated;
+    while (detector->wouldTrackAllocationAt(outOfTheSample) && outOfTheSample < notAllocated + sizeof(notAllocated) - 8) outOfTheSample += 8;
+    CHECK(!detector->wouldTrackAllocationAt(outOfTheSample));
+
+    allocate();
+    int untracked = 0;
+    while (detector->wouldTrackAllocationAt(memory[untracked])) untracked++;
+    for (int i = 0; i < 1000; i++)
+        if (i != untracked) detector->deallocMemory(defaultMallocAllocator(), memory[i]);
+    detector->markCheckingPeriodLeaksAsNonCheckingPeriod();
+
+    detector->deallocMemory(defaultMallocAllocator(), outOfTheSample);
+    STRCMP_CONTAINS("Deallocating non-allocated memory", reporter->message->asCharString());
+    defaultMallocAllocator()->free_memory(memory[untracked], __FILE__, __LINE__);
+}
+
+TEST(MemoryLeakDetectorSamplingTest, untrackedMemoryCanBeFreedAfterSamplingStopped)
+{
+    allocate();
+    detector->sampleAllocations(1);
+    deallocate();
+    LONGS_EQUAL(0, detector->totalMemoryLeaks(mem_leak_period_all));
+    STRCMP_EQUAL("", reporter->message->asCharString());
+}
+
+TEST(MemoryLeakDetectorSamplingTest, samplingRateOfOneTracksEveryAllocation)
+{
+    detector->sampleAllocations(1);
+    allocate();
+    LONGS_EQUAL(1000, detector->totalMemoryLeaks(mem_leak_period_checking));
+    LONGS_EQUAL(0, (long) detector->getNumberOfUntrackedAllocations());
+    deallocate();
+}
+
+static char fakeFrames[8];
+static char fakeOperatorFrame;
+static int fakeCallSite = 0;
+
+static int FakeBacktrace(void** frames, int maxFrames)
+{
+    int depth = (maxFrames < 3) ? maxFrames : 3;
+    frames[0] = &fakeFrames[0];
+    for (int i = 1; i < depth; i++)
+        frames[i] = &fakeFrames[fakeCallSite + i];
+    return depth;
+}
+
+/* The detector and one of its operators on top of seven callers */
+static int DeepFakeBacktrace(void** frames, int maxFrames)
+{
+    int depth = (maxFrames < 9) ? maxFrames : 9;
+    frames[0] = &fakeFrames[0];
+    if (depth > 1) frames[1] = &fakeOperatorFrame;
+    for (int i = 2; i < depth; i++)
+        frames[i] = &fakeFrames[i - 1];
+    return depth;
+}
+
+static void FakeBacktraceSymbol(void* frame, char* symbol, size_t size)
+{
+    if (frame == &fakeFrames[0]) SimpleString::StrNCpy(symbol, "MemoryLeakDetector::allocMemory", size);
+    else if (frame == &fakeOperatorFrame) SimpleString::StrNCpy(symbol, "mem_leak_operator_new", size);
+    else SimpleString::StrNCpy(symbol, StringFromFormat("caller_%d", (int) ((char*) frame - fakeFrames)).asCharString(), size);
+}
+
+TEST_GROUP(MemoryLeakDetectorCallStackTest)
+{
+    MemoryLeakDetector* detector;
+    MemoryLeakFailureForTest *reporter;
+
+    void setup()
+    {
+        UT_PTR_SET(PlatformSpecificBacktrace, FakeBacktrace);
+        UT_PTR_SET(PlatformSpecificBacktraceSymbol, FakeBacktraceSymbol);
+        fakeCallSite = 0;
+        reporter = new MemoryLeakFailureForTest;
+        detector = new MemoryLeakDetector(reporter);
+        detector->enable();
+        detector->startChecking();
+        detector->captureCallStacks(3);
+        reporter->message = new SimpleString();
+    }
+    void teardown()
+    {
+        delete reporter->message;
+        delete detector;
+        delete reporter;
+    }
+
+    char* allocateFrom(int callSite, size_t size)
+    {
+        fakeCallSite = callSite;
+        return detector->allocMemory(defaultMallocAllocator(), size, "file", 1);
+    }
+};
+
+TEST(MemoryLeakDetectorCallStackTest, noCallStacksAreCapturedByDefault)
+{
+    detector->captureCallStacks(0);
+    char* mem = allocateFrom(0, 10);
+    LONGS_EQUAL(0, detector->getNumberOfCallStacks());
+    STRCMP_CONTAINS("Content:", detector->report(mem_leak_period_checking));
+    detector->deallocMemory(defaultMallocAllocator(), mem);
+}
+
+TEST(MemoryLeakDetectorCallStackTest, depthIsLimited)
+{
+    detector->captureCallStacks(1000);
+    LONGS_EQUAL(MemoryLeakDetector::max_call_stack_depth, detector->getCallStackDepth());
+    detector->captureCallStacks(-1);
+    LONGS_EQUAL(0, detector->getCallStackDepth());
+}
+
+TEST(MemoryLeakDetectorCallStackTest, identicalStacksAreStoredOnce)
+{
+    char* mem1 = allocateFrom(0, 10);
+    char* mem2 = allocateFrom(0, 10);
+    char* mem3 = allocateFrom(1, 10);
+    LONGS_EQUAL(2, detector->getNumberOfCallStacks());
+    detector->deallocMemory(defaultMallocAllocator(), mem1);
+    detector->deallocMemory(defaultMallocAllocator(), mem2);
+    detector->deallocMemory(defaultMallocAllocator(), mem3);
+}
+
+TEST(MemoryLeakDetectorCallStackTest, stacksAreKeptAfterTheirAllocationsAreFreed)
+{
+    detector->deallocMemory(defaultMallocAllocator(), allocateFrom(0, 10));
+    detector->deallocMemory(defaultMallocAllocator(), allocateFrom(0, 10));
+    LONGS_EQUAL(1, detector->getNumberOfCallStacks());
+    LONGS_EQUAL(0, detector->totalMemoryLeaks(mem_leak_period_checking));
+}
+
+TEST(MemoryLeakDetectorCallStackTest, leaksAreGroupedPerCallStack)
+{
+    char* mem1 = allocateFrom(0, 10);
+    char* mem2 = allocateFrom(1, 5);
+    char* mem3 = allocateFrom(0, 20);
+    SimpleString report = detector->report(mem_leak_period_checking);
+    STRCMP_CONTAINS("2 leak(s) with 30 bytes in total. First alloc num", report.asCharString());
+    STRCMP_CONTAINS("1 leak(s) with 5 bytes in total. First alloc num", report.asCharString());
+    STRCMP_CONTAINS("Total number of leaks:  3", report.asCharString());
+    CHECK(!report.contains("Content:"));
+    detector->deallocMemory(defaultMallocAllocator(), mem1);
+    detector->deallocMemory(defaultMallocAllocator(), mem2);
+    detector->deallocMemory(defaultMallocAllocator(), mem3);
+}
+
+TEST(MemoryLeakDetectorCallStackTest, reportShowsTheCallStackWithoutTheFramesOfTheDetector)
+{
+    char* mem = allocateFrom(0, 10);
+    SimpleString report = detector->report(mem_leak_period_checking);
+    STRCMP_CONTAINS("Call stack:\n\t#0 <", report.asCharString());
+    STRCMP_CONTAINS("> caller_1\n\t#1 <", report.asCharString());
+    STRCMP_CONTAINS("> caller_2\n", report.asCharString());
+    CHECK(!report.contains("MemoryLeakDetector::allocMemory"));
+    detector->deallocMemory(defaultMallocAllocator(), mem);
+}
+
+TEST(MemoryLeakDetectorCallStackTest, framesOfTheDetectorDoNotCountAgainstTheDepth)
+{
+    UT_PTR_SET(PlatformSpecificBacktrace, DeepFakeBacktrace);
+    detector->captureCallStacks(2);
+    char* mem = allocateFrom(0, 10);
+    SimpleString report = detector->report(mem_leak_period_checking);
+    STRCMP_CONTAINS("Call stack:\n\t#0 <", report.asCharString());
+    STRCMP_CONTAINS("> caller_1\n\t#1 <", report.asCharString());
+    STRCMP_CONTAINS("> caller_2\n", report.asCharString());
+    CHECK(!report.contains("caller_3"));
+    CHECK(!report.contains("mem_leak_operator"));
+    detector->deallocMemory(defaultMallocAllocator(), mem);
+}
+
+TEST(MemoryLeakDetectorCallStackTest, reportingTwiceGivesTheSameCounts)
+{
+    char* mem1 = allocateFrom(0, 10);
+    char* mem2 = allocateFrom(0, 10);
+    detector->report(mem_leak_period_checking);
+    STRCMP_CONTAINS("2 leak(s) with 20 bytes in total", detector->report(mem_leak_period_checking));
+    detector->deallocMemory(defaultMallocAllocator(), mem1);
+    detector->deallocMemory(defaultMallocAllocator(), mem2);
+}
+
+TEST(MemoryLeakDetectorCallStackTest, leaksWithoutCallStackAreReportedOneByOne)
+{
+    char* mem1 = allocateFrom(0, 10);
+    detector->captureCallStacks(0);
+    char* mem2 = allocateFrom(0, 10);
+    SimpleString report = detector->report(mem_leak_period_checking);
+    STRCMP_CONTAINS("1 leak(s) with 10 bytes in total", report.asCharString());
+    STRCMP_CONTAINS("Content:", report.asCharString());
+    STRCMP_CONTAINS("Total number of leaks:  2", report.asCharString());
+    detector->deallocMemory(defaultMallocAllocator(), mem1);
+    detector->deallocMemory(defaultMallocAllocator(), mem2);
+}
+
+class StringMemoryLeakReportSink : public MemoryLeakReportSink
+{
+public:
+    StringMemoryLeakReportSink() : writes(0) {}
+
+    virtual void write(const char* text) _override
+    {
+        report += text;
+        writes++;
+    }
+    virtual const char* getName() _override
+    {
+        return "the string";
+    }
+
+    SimpleString report;
+    int writes;
+};
+
+TEST_GROUP(MemoryLeakDetectorStreamingTest)
+{
+    enum { amountOfLeaks = 500 };
+    MemoryLeakDetector* detector;
+    MemoryLeakFailureForTest *reporter;
+    StringMemoryLeakReportSink* sink;
+    char* leaks[amountOfLeaks];
+
+    void setup()
+    {
+        reporter = new MemoryLeakFailureForTest;
+        detector = new MemoryLeakDetector(reporter);
+        sink = new StringMemoryLeakReportSink;
+        detector->enable();
+        detector->startChecking();
+        detector->streamReportTo(sink);
+        reporter->message = new SimpleString();
+    }
+    void teardown()
+    {
+        delete reporter->message;
+        delete sink;
+        delete detector;
+        delete reporter;
+    }
+
+    void leak(int amount, size_t size)
+    {
+        for (int i = 0; i < amount; i++)
+            leaks[i] = detector->allocMemory(defaultMallocAllocator(), size, "file", i);
+    }
+
+    void freeLeaks(int amount)
+    {
+        for (int i = 0; i < amount; i++)
+            detector->deallocMemory(defaultMallocAllocator(), leaks[i]);
+    }
+};
+
+TEST(MemoryLeakDetectorStreamingTest, streamedReportIsNotTruncated)
+{
+    leak(amountOfLeaks, 100);
+    detector->report(mem_leak_period_checking);
+    CHECK(sink->writes > 1);
+    CHECK(!sink->report.contains("Too much memory leaks"));
+    STRCMP_CONTAINS("Allocated at: file and line: 499.", sink->report.asCharString());
+    STRCMP_CONTAINS("Total number of leaks:  500\n", sink->report.asCharString());
+    freeLeaks(amountOfLeaks);
+}
+
+TEST(MemoryLeakDetectorStreamingTest, reportOnlySummarizesAStreamedReport)
+{
+    leak(2, 10);
+    STRCMP_EQUAL("Memory leak(s) found.\nTotal number of leaks:  2\nThe leak report was written to the string\n",
+            detector->report(mem_leak_period_checking));
+    freeLeaks(2);
+}
+
+TEST(MemoryLeakDetectorStreamingTest, nothingIsStreamedWithoutLeaks)
+{
+    STRCMP_EQUAL("No memory leaks were detected.", detector->report(mem_leak_period_checking));
+    LONGS_EQUAL(0, sink->writes);
+}
+
+TEST(MemoryLeakDetectorStreamingTest, reportIsKeptInTheBufferAfterStreamingStops)
+{
+    leak(1, 10);
+    detector->streamReportTo(NULL);
+    STRCMP_CONTAINS("Content:", detector->report(mem_leak_period_checking));
+    LONGS_EQUAL(0, sink->writes);
+    freeLeaks(1);
+}
+
+TEST(MemoryLeakDetectorStreamingTest, leakDumpSizeLimitsTheDumpOfEachLeak)
+{
+    detector->setLeakDumpSize(4);
+    leak(1, 20);
+    detector->report(mem_leak_period_checking);
+    STRCMP_CONTAINS("Content:\n    0000: ", sink->report.asCharString());
+    STRCMP_CONTAINS("|\n    (16 more bytes)\n", sink->report.asCharString());
+    freeLeaks(1);
+}
+
+TEST(MemoryLeakDetectorStreamingTest, leaksNotLargerThanTheDumpSizeAreDumpedEntirely)
+{
+    detector->setLeakDumpSize(20);
+    leak(1, 20);
+    detector->report(mem_leak_period_checking);
+    CHECK(!sink->report.contains("more bytes"));
+    freeLeaks(1);
+}
+
+static SimpleString* fileSinkOutput;
+static int fileSinkCloses;
+
+static PlatformSpecificFile FakeFOpen(const char*, const char*)
+{
+    return (PlatformSpecificFile) &fileSinkOutput;
+}
+
+static void FakeFPuts(const char* str, PlatformSpecificFile)
+{
+    *fileSinkOutput += str;
+}
+
+static void FakeFClose(PlatformSpecificFile)
+{
+    fileSinkCloses++;
+}
+
+TEST(MemoryLeakDetectorStreamingTest, reportCanBeStreamedToAFile)
+{
+    UT_PTR_SET(PlatformSpecificFOpen, FakeFOpen);
+    UT_PTR_SET(PlatformSpecificFPuts, FakeFPuts);
+    UT_PTR_SET(PlatformSpecificFClose, FakeFClose);
+    SimpleString output;
+    fileSinkOutput = &output;
+    fileSinkCloses = 0;
+
+    FileMemoryLeakReportSink* fileSink = new FileMemoryLeakReportSink("leaks.txt");
+    detector->streamReportTo(fileSink);
+    leak(1, 10);
+    STRCMP_CONTAINS("written to leaks.txt", detector->report(mem_leak_period_checking));
+    delete fileSink;
+
+    STRCMP_CONTAINS("Total number of leaks:  1", output.asCharString());
+    LONGS_EQUAL(1, fileSinkCloses);
+    freeLeaks(1);
+}
+
+TEST_GROUP(MemoryLeakDetectorGuardPageTest)
+{
+    MemoryLeakDetector* detector;
+    MemoryLeakFailureForTest *reporter;
+    GuardPageMemoryAllocator* guardedNew;
+    GuardPageMemoryAllocator* guardedMalloc;
+
+    void setup()
+    {
+        reporter = new MemoryLeakFailureForTest;
+        detector = new MemoryLeakDetector(reporter);
+        guardedNew = new GuardPageMemoryAllocator(GuardPageMemoryAllocator::detect_overflow, defaultNewAllocator()->name(), "new", "delete");
+        guardedMalloc = new GuardPageMemoryAllocator(GuardPageMemoryAllocator::detect_overflow, defaultMallocAllocator()->name(), "malloc", "free");
+        guardedNew->setAlignment(1);
+        guardedMalloc->setAlignment(1);
+        detector->enable();
+        detector->startChecking();
+        reporter->message = new SimpleString();
+    }
+    void teardown()
+    {
+        delete reporter->message;
+        delete guardedMalloc;
+        delete guardedNew;
+        delete detector;
+        delete reporter;
+    }
+};
+
+TEST(MemoryLeakDetectorGuardPageTest, guardedMemoryIsTrackedWithoutWritingPastItsEnd)
+{
+    char* mem = detector->allocMemory(guardedNew, 10, "file", 1);
+    PlatformSpecificMemset(mem, 0xAB, 10);
+    LONGS_EQUAL(1, detector->totalMemoryLeaks(mem_leak_period_checking));
+    STRCMP_CONTAINS("Leak size: 10", detector->report(mem_leak_period_checking));
+    detector->deallocMemory(guardedNew, mem, "file", 2);
+    LONGS_EQUAL(0, detector->totalMemoryLeaks(mem_leak_period_checking));
+    STRCMP_EQUAL("", reporter->message->asCharString());
+}
+
+TEST(MemoryLeakDetectorGuardPageTest, ordinaryMemoryCanBeFreedWhileGuarding)
+{
+    char* mem = detector->allocMemory(defaultNewAllocator(), 10, "file", 1);
+    detector->deallocMemory(guardedNew, mem, "file", 2);
+    LONGS_EQUAL(0, detector->totalMemoryLeaks(mem_leak_period_checking));
+    STRCMP_EQUAL("", reporter->message->asCharString());
+}
+
+TEST(MemoryLeakDetectorGuardPageTest, guardedMemoryCanBeFreedAfterGuarding)
+{
+    char* mem = detector->allocMemory(guardedMalloc, 10, "file", 1, true);
+    detector->deallocMemory(defaultMallocAllocator(), mem, "file", 2, true);
+    LONGS_EQUAL(0, detector->totalMemoryLeaks(mem_leak_period_checking));
+    STRCMP_EQUAL("", reporter->message->asCharString());
+}
+
+TEST(MemoryLeakDetectorGuardPageTest, typeMismatchIsStillReported)
+{
+    char* mem = detector->allocMemory(guardedNew, 10, "file", 1);
+    detector->deallocMemory(guardedMalloc, mem, "file", 2, true);
+    STRCMP_CONTAINS("Allocation/deallocation type mismatch", reporter->message->asCharString());
+}
+
+TEST(MemoryLeakDetectorGuardPageTest, reallocatingGuardedMemoryMovesItsContent)
+{
+    char* mem = detector->allocMemory(guardedMalloc, 10, "file", 1, true);
+    PlatformSpecificMemCpy(mem, "0123456789", 10);
+    mem = detector->reallocMemory(guardedMalloc, mem, 20, "file", 2, true);
+    STRNCMP_EQUAL("0123456789", mem, 10);
+    mem[19] = 'x';
+    mem = detector->reallocMemory(defaultMallocAllocator(), mem, 5, "file", 3, true);
+    STRNCMP_EQUAL("01234", mem, 5);
+    LONGS_EQUAL(1, detector->totalMemoryLeaks(mem_leak_period_checking));
+    detector->deallocMemory(defaultMallocAllocator(), mem, "file", 4, true);
+    STRCMP_EQUAL("", reporter->message->asCharString());
+}
+
+TEST(MemoryLeakDetectorGuardPageTest, guardedMemoryIsAlwaysTrackedWhileSampling)
+{
+    char* memory[100];
+    detector->sampleAllocations(10);
+    for (int i = 0; i < 100; i++)
+        memory[i] = detector->allocMemory(guardedNew, 10, "file", 1);
+    LONGS_EQUAL(100, detector->totalMemoryLeaks(mem_leak_period_checking));
+    LONGS_EQUAL(0, (long) detector->getNumberOfUntrackedAllocations());
+    for (int i = 0; i < 100; i++)
+        detector->deallocMemory(guardedNew, memory[i], "file", 2);
+    STRCMP_EQUAL("", reporter->message->asCharString());
+}
+
+TEST(MemoryLeakDetectorGuardPageTest, reallocatingUntrackedMemoryWhileGuardingKeepsItsContent)
+{
+    char* memory[100];
+    detector->sampleAllocations(10);
+    for (int i = 0; i < 100; i++) {
+        memory[i] = detector->allocMemory(defaultMallocAllocator(), 10, "file", 1, true);
+        PlatformSpecificMemCpy(memory[i], "0123456789", 10);
+    }
+    CHECK(detector->getNumberOfUntrackedAllocations() > 0);
+    for (int i = 0; i < 100; i++) {
+        memory[i] = detector->reallocMemory(guardedMalloc, memory[i], 20, "file", 2, true);
+        STRNCMP_EQUAL("0123456789", memory[i], 10);
+    }
+    for (int i = 0; i < 100; i++)
+        detector->deallocMemory(guardedMalloc, memory[i], "file", 3, true);
+    LONGS_EQUAL(0, detector->totalMemoryLeaks(mem_leak_period_all));
+    STRCMP_EQUAL("", reporter->message->asCharString());
+}
+
 TEST_GROUP(MemoryLeakDetectorListTest)
 {
 };
@@ -518,6 +1152,155 @@ TEST(MemoryLeakDetectorListTest, clearAllAccountingIsWorkingProperly)
     CHECK(&node3 == listForTesting.getFirstLeak(mem_leak_period_disabled));
 }
 
+TEST_GROUP(MemoryLeakDetectorTableTest)
+{
+    enum { amountOfNodes = 2000 };
+    MemoryLeakDetectorTable* table;
+    MemoryLeakDetectorNode* nodes;
+
+    void setup()
+    {
+        table = new MemoryLeakDetectorTable;
+        nodes = new MemoryLeakDetectorNode[amountOfNodes];
+        for (int i = 0; i < amountOfNodes; i++)
+            nodes[i].memory_ = (char*) 0 + (i + 1) * 8;
+    }
+    void teardown()
+    {
+        delete [] nodes;
+        delete table;
+    }
+    void addAllNodes()
+    {
+        for (int i = 0; i < amountOfNodes; i++)
+            table->addNewNode(&nodes[i]);
+    }
+};
+
+TEST(MemoryLeakDetectorTableTest, indexGrowsWithTheNumberOfNodes)
+{
+    addAllNodes();
+    CHECK(table->getIndexCapacity() > (size_t) amountOfNodes);
+    LONGS_EQUAL(amountOfNodes, table->getTotalLeaks(mem_leak_period_all));
+}
+
+TEST(MemoryLeakDetectorTableTest, allNodesCanBeRetrievedAndRemoved)
+{
+    addAllNodes();
+    for (int i = 0; i < amountOfNodes; i++)
+        POINTERS_EQUAL(&nodes[i], table->retrieveNode(nodes[i].memory_));
+
+    for (int j = 0; j < amountOfNodes; j += 2)
+        POINTERS_EQUAL(&nodes[j], table->removeNode(nodes[j].memory_));
+    for (int k = 0; k < amountOfNodes; k++)
+        POINTERS_EQUAL((k % 2) ? &nodes[k] : NULL, table->retrieveNode(nodes[k].memory_));
+    for (int l = 1; l < amountOfNodes; l += 2)
+        POINTERS_EQUAL(&nodes[l], table->removeNode(nodes[l].memory_));
+
+    POINTERS_EQUAL(NULL, table->getFirstLeak(mem_leak_period_all));
+}
+
+TEST(MemoryLeakDetectorTableTest, removingUnknownMemoryReturnsNull)
+{
+    addAllNodes();
+    POINTERS_EQUAL(NULL, table->removeNode((char*) 0 + 3));
+    LONGS_EQUAL(amountOfNodes, table->getTotalLeaks(mem_leak_period_all));
+}
+
+TEST(MemoryLeakDetectorTableTest, leaksAreIteratedPerBucketNewestFirst)
+{
+    addAllNodes();
+    const size_t buckets = MEMORY_LEAK_HASH_TABLE_SIZE;
+    MemoryLeakDetectorNode* node = table->getFirstLeak(mem_leak_period_all);
+    for (size_t bucket = 0; bucket < buckets; bucket++) {
+        for (int i = amountOfNodes - 1; i >= 0; i--) {
+            if ((size_t) (nodes[i].memory_ - (char*) 0) % buckets != bucket) continue;
+            POINTERS_EQUAL(&nodes[i], node);
+            node = table->getNextLeak(node, mem_leak_period_all);
+        }
+    }
+    POINTERS_EQUAL(NULL, node);
+}
+
+TEST(MemoryLeakDetectorTableTest, sameMemoryAddedTwiceIsRemovedNewestFirst)
+{
+    nodes[1].memory_ = nodes[0].memory_;
+    table->addNewNode(&nodes[0]);
+    table->addNewNode(&nodes[1]);
+
+    POINTERS_EQUAL(&nodes[1], table->removeNode(nodes[0].memory_));
+    POINTERS_EQUAL(&nodes[0], table->removeNode(nodes[0].memory_));
+    POINTERS_EQUAL(NULL, table->removeNode(nodes[0].memory_));
+}
+
+TEST(MemoryLeakDetectorTableTest, indexNoLongerHasShadowedNodesOnceTheyAreUnshadowed)
+{
+    MemoryLeakDetectorIndex index;
+    nodes[1].memory_ = nodes[0].memory_;
+    nodes[3].memory_ = nodes[2].memory_;
+    index.add(&nodes[0]);
+    index.add(&nodes[1]);
+    index.add(&nodes[2]);
+    index.add(&nodes[3]);
+    CHECK(index.hasShadowedNodes());
+
+    index.remove(nodes[1].memory_);
+    index.unshadow(&nodes[0]);
+    CHECK(index.hasShadowedNodes());
+    POINTERS_EQUAL(&nodes[0], index.find(nodes[0].memory_));
+
+    index.remove(nodes[3].memory_);
+    index.unshadow(&nodes[2]);
+    CHECK_FALSE(index.hasShadowedNodes());
+    POINTERS_EQUAL(&nodes[2], index.find(nodes[2].memory_));
+}
+
+TEST(MemoryLeakDetectorTableTest, clearAllAccountingAlsoClearsTheIndex)
+{
+    nodes[1].period_ = mem_leak_period_disabled;
+    table->addNewNode(&nodes[0]);
+    table->addNewNode(&nodes[1]);
+
+    table->clearAllAccounting(mem_leak_period_enabled);
+
+    POINTERS_EQUAL(NULL, table->retrieveNode(nodes[0].memory_));
+    POINTERS_EQUAL(&nodes[1], table->retrieveNode(nodes[1].memory_));
+}
+
+TEST_GROUP(MemoryLeakDetectorNodePoolTest)
+{
+    MemoryLeakDetectorNodePool pool;
+};
+
+TEST(MemoryLeakDetectorNodePoolTest, noSlabsBeforeTheFirstNode)
+{
+    LONGS_EQUAL(0, pool.getNumberOfSlabs());
+}
+
+TEST(MemoryLeakDetectorNodePoolTest, freedNodesAreReused)
+{
+    MemoryLeakDetectorNode* node = pool.allocNode();
+    pool.freeNode(node);
+    POINTERS_EQUAL(node, pool.allocNode());
+    LONGS_EQUAL(1, pool.getNumberOfSlabs());
+}
+
+TEST(MemoryLeakDetectorNodePoolTest, aNewSlabIsAddedWhenAllNodesAreInUse)
+{
+    MemoryLeakDetectorNode* nodes[MemoryLeakDetectorNodePool::nodes_per_slab + 1];
+    for (int i = 0; i < MemoryLeakDetectorNodePool::nodes_per_slab + 1; i++)
+        nodes[i] = pool.allocNode();
+
+    LONGS_EQUAL(2, pool.getNumberOfSlabs());
+    CHECK(nodes[0] != nodes[MemoryLeakDetectorNodePool::nodes_per_slab]);
+}
+
+TEST(MemoryLeakDetectorNodePoolTest, freeingNullIsIgnored)
+{
+    pool.freeNode(NULL);
+    LONGS_EQUAL(0, pool.getNumberOfSlabs());
+}
+
 TEST_GROUP(SimpleStringBuffer)
 {
 };
@@ -136,6 +136,132 @@ TEST(MemoryLeakWarningTest, Ignore2)
     LONGS_EQUAL(0, fixture->getFailureCount());
 }
 
+static char* manyLeaks[100];
+
+static void _testManyLeaks()
+{
+    for (int i = 0; i < 100; i++)
+        manyLeaks[i] = detector->allocMemory(allocator, 10);
+}
+
+static void freeManyLeaks()
+{
+    for (int i = 0; i < 100; i++)
+        detector->deallocMemory(allocator, manyLeaks[i]);
+}
+
+static void _testExpectManyLeaks()
+{
+    memPlugin->expectLeaksInTest(100);
+    _testManyLeaks();
+}
+
+TEST(MemoryLeakWarningTest, SampledLeaksAreReportedWithAnEstimate)
+{
+    memPlugin->sampleAllocations(4);
+    fixture->setTestFunction(_testManyLeaks);
+    fixture->runAllTests();
+    LONGS_EQUAL(1, fixture->getFailureCount());
+    fixture->assertPrintContains("Sampled 1 in 4 allocations, estimated number of leaks:");
+    freeManyLeaks();
+}
+
+TEST(MemoryLeakWarningTest, FewerSampledLeaksThanExpectedPass)
+{
+    memPlugin->sampleAllocations(4);
+    fixture->setTestFunction(_testExpectManyLeaks);
+    fixture->runAllTests();
+    LONGS_EQUAL(0, fixture->getFailureCount());
+    freeManyLeaks();
+}
+
+TEST(MemoryLeakWarningTest, SamplingIsSetFromTheCommandLine)
+{
+    const char* av[] = { "-pleaksampling=8", "-pleaksampling=x" };
+    CHECK(memPlugin->parseArguments(2, av, 0));
+    LONGS_EQUAL(8, detector->getSamplingRate());
+    CHECK(!memPlugin->parseArguments(2, av, 1));
+}
+
+TEST(MemoryLeakWarningTest, CallStacksAreCapturedFromTheCommandLine)
+{
+    const char* av[] = { "-pleakstacks=6", "-pleakstacks=0" };
+    CHECK(memPlugin->parseArguments(2, av, 0));
+    LONGS_EQUAL(6, detector->getCallStackDepth());
+    CHECK(!memPlugin->parseArguments(2, av, 1));
+}
+
+TEST(MemoryLeakWarningTest, LeakReportIsStreamedToTheTestOutput)
+{
+    memPlugin->streamLeakReportsToTestOutput();
+    fixture->setTestFunction(_testManyLeaks);
+    fixture->runAllTests();
+    LONGS_EQUAL(1, fixture->getFailureCount());
+    fixture->assertPrintContains("Total number of leaks:  100\nThe leak report was written to the test output");
+    CHECK(!fixture->output_->getOutput().contains("Too much memory leaks"));
+    freeManyLeaks();
+}
+
+TEST(MemoryLeakWarningTest, LeakReportStreamingAndDumpSizeAreSetFromTheCommandLine)
+{
+    const char* av[] = { "-pleakstream", "-pleakdump=0", "-pleakdump=x" };
+    CHECK(memPlugin->parseArguments(3, av, 0));
+    CHECK(memPlugin->parseArguments(3, av, 1));
+    CHECK(!memPlugin->parseArguments(3, av, 2));
+
+    fixture->setTestFunction(_testTwoLeaks);
+    fixture->runAllTests();
+    fixture->assertPrintContains("Content:\n    (10 more bytes)\n");
+}
+
+static bool guardedNewInTest;
+static bool guardedMallocInTest;
+
+static void _testRecordingGuardPages()
+{
+    guardedNewInTest = getCurrentNewAllocator()->guardsMemoryBounds();
+    guardedMallocInTest = getCurrentMallocAllocator()->guardsMemoryBounds();
+}
+
+static void _testDetectingOverflows()
+{
+    memPlugin->guardPagesInTest(GuardPageMemoryAllocator::detect_overflow);
+    _testRecordingGuardPages();
+}
+
+TEST(MemoryLeakWarningTest, GuardPagesAreUsedUntilTheEndOfTheTest)
+{
+    TestMemoryAllocator* newAllocator = getCurrentNewAllocator();
+    fixture->setTestFunction(_testDetectingOverflows);
+    fixture->runAllTests();
+    CHECK(guardedNewInTest);
+    CHECK(guardedMallocInTest);
+    POINTERS_EQUAL(newAllocator, getCurrentNewAllocator());
+}
+
+TEST(MemoryLeakWarningTest, GuardPagesInAllTestsAreSetFromTheCommandLine)
+{
+    TestMemoryAllocator* mallocAllocator = getCurrentMallocAllocator();
+    const char* av[] = { "-pguardpages=underflow", "-pguardpages=sideways" };
+    CHECK(memPlugin->parseArguments(2, av, 0));
+    CHECK(!memPlugin->parseArguments(2, av, 1));
+
+    fixture->setTestFunction(_testRecordingGuardPages);
+    fixture->runAllTests();
+    CHECK(guardedNewInTest);
+    CHECK(guardedMallocInTest);
+    POINTERS_EQUAL(mallocAllocator, getCurrentMallocAllocator());
+}
+
+TEST(MemoryLeakWarningTest, DetectOverflowsGuardsTheRestOfTheTest)
+{
+    DETECT_OVERFLOWS_IN_TEST()
+    char* memory = new char[10];
+    memory[9] = 'x';
+    CHECK(getCurrentNewArrayAllocator()->guardsMemoryBounds());
+    delete [] memory;
+}
+
 static void _failAndLeakMemory()
 {
     leak1 = detector->allocMemory(allocator, 10);
@@ -387,6 +513,7 @@ TEST_GROUP(MemoryLeakWarningThreadSafe)
 
     void teardown()
     {
+        MemoryLeakWarningPlugin::getGlobalDetector()->disableShardLocking();
     }
 };
 
@@ -399,20 +526,20 @@ TEST(MemoryLeakWarningThreadSafe, turnOnThreadSafeMallocFreeReallocOverloadsDebu
     int *n = (int*) cpputest_malloc(sizeof(int));
 
     LONGS_EQUAL(storedAmountOfLeaks + 1, MemoryLeakWarningPlugin::getGlobalDetector()->totalMemoryLeaks(mem_leak_period_all));
-    CHECK_EQUAL(1, mutexLockCount);
-    CHECK_EQUAL(1, mutexUnlockCount);
+    CHECK_EQUAL(2, mutexLockCount);
+    CHECK_EQUAL(2, mutexUnlockCount);
 
     n = (int*) cpputest_realloc(n, sizeof(int)*3);
 
     LONGS_EQUAL(storedAmountOfLeaks + 1, MemoryLeakWarningPlugin::getGlobalDetector()->totalMemoryLeaks(mem_leak_period_all));
-    CHECK_EQUAL(2, mutexLockCount);
-    CHECK_EQUAL(2, mutexUnlockCount);
+    CHECK_EQUAL(5, mutexLockCount);
+    CHECK_EQUAL(5, mutexUnlockCount);
 
     cpputest_free(n);
 
     LONGS_EQUAL(storedAmountOfLeaks, MemoryLeakWarningPlugin::getGlobalDetector()->totalMemoryLeaks(mem_leak_period_all));
-    CHECK_EQUAL(3, mutexLockCount);
-    CHECK_EQUAL(3, mutexUnlockCount);
+    CHECK_EQUAL(7, mutexLockCount);
+    CHECK_EQUAL(7, mutexUnlockCount);
 
     MemoryLeakWarningPlugin::turnOnNewDeleteOverloads();
 }
@@ -427,19 +554,26 @@ TEST(MemoryLeakWarningThreadSafe, turnOnThreadSafeNewDeleteOverloadsDebug)
     char *str = new char[20];
 
     LONGS_EQUAL(storedAmountOfLeaks + 2, MemoryLeakWarningPlugin::getGlobalDetector()->totalMemoryLeaks(mem_leak_period_all));
-    CHECK_EQUAL(2, mutexLockCount);
-    CHECK_EQUAL(2, mutexUnlockCount);
+    CHECK_EQUAL(4, mutexLockCount);
+    CHECK_EQUAL(4, mutexUnlockCount);
 
     delete [] str;
     delete n;
 
     LONGS_EQUAL(storedAmountOfLeaks, MemoryLeakWarningPlugin::getGlobalDetector()->totalMemoryLeaks(mem_leak_period_all));
-    CHECK_EQUAL(4, mutexLockCount);
-    CHECK_EQUAL(4, mutexUnlockCount);
+    CHECK_EQUAL(8, mutexLockCount);
+    CHECK_EQUAL(8, mutexUnlockCount);
 
     MemoryLeakWarningPlugin::turnOnNewDeleteOverloads();
 }
 
+TEST(MemoryLeakWarningThreadSafe, turnOnNewDeleteOverloadsKeepsTheLocking)
+{
+    MemoryLeakWarningPlugin::turnOnThreadSafeNewDeleteOverloads();
+    MemoryLeakWarningPlugin::turnOnNewDeleteOverloads();
+    CHECK(MemoryLeakWarningPlugin::getGlobalDetector()->isShardLockingEnabled());
+}
+
 #ifdef __clang__
 
 IGNORE_TEST(MemoryLeakWarningThreadSafe, turnOnThreadSafeNewDeleteOverloads)
@@ -464,8 +598,8 @@ TEST(MemoryLeakWarningThreadSafe, turnOnThreadSafeNewDeleteOverloads)
     char *str_nothrow = new (std::nothrow) char[20];
 
     LONGS_EQUAL(storedAmountOfLeaks + 4, MemoryLeakWarningPlugin::getGlobalDetector()->totalMemoryLeaks(mem_leak_period_all));
-    CHECK_EQUAL(4, mutexLockCount);
-    CHECK_EQUAL(4, mutexUnlockCount);
+    CHECK_EQUAL(8, mutexLockCount);
+    CHECK_EQUAL(8, mutexUnlockCount);
 
     delete [] str_nothrow;
     delete [] str;
@@ -473,8 +607,8 @@ TEST(MemoryLeakWarningThreadSafe, turnOnThreadSafeNewDeleteOverloads)
     delete n_nothrow;
 
     LONGS_EQUAL(storedAmountOfLeaks, MemoryLeakWarningPlugin::getGlobalDetector()->totalMemoryLeaks(mem_leak_period_all));
-    CHECK_EQUAL(8, mutexLockCount);
-    CHECK_EQUAL(8, mutexUnlockCount);
+    CHECK_EQUAL(16, mutexLockCount);
+    CHECK_EQUAL(16, mutexUnlockCount);
 
     MemoryLeakWarningPlugin::turnOnNewDeleteOverloads();
 #ifdef CPPUTEST_USE_NEW_MACROS
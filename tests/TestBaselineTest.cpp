@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2007, Michael Feathers, James Grenning and Bas Vodde
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE EARLIER MENTIONED AUTHORS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestBaseline.h"
+#include "CppUTest/PlatformSpecificFunctions.h"
+
+static SimpleString* fileContents = NULL;
+static const char* fileContentsToRead = NULL;
+static bool fileExists;
+
+extern "C" {
+
+    static PlatformSpecificFile FakeFOpen(const char*, const char* flag)
+    {
+        if (*flag == 'r' && !fileExists) return NULL;
+        if (*flag == 'w') *fileContents = "";
+        return fileContents;
+    }
+
+    static void FakeFPuts(const char* str, PlatformSpecificFile)
+    {
+        *fileContents += str;
+    }
+
+    static char* FakeFGets(char* str, int size, PlatformSpecificFile)
+    {
+        if (*fileContentsToRead == '\0') return NULL;
+        int length = 0;
+        while (length < size - 1 && fileContentsToRead[length] != '\0') {
+            str[length] = fileContentsToRead[length];
+            if (fileContentsToRead[length++] == '\n') break;
+        }
+        str[length] = '\0';
+        fileContentsToRead += length;
+        return str;
+    }
+
+    static void FakeFClose(PlatformSpecificFile)
+    {
+    }
+
+}
+
+TEST_GROUP(TestBaseline)
+{
+    TestBaseline* baseline;
+    UtestShell* test;
+    SimpleString contents;
+
+    void setup()
+    {
+        fileContents = &contents;
+        fileExists = true;
+        UT_PTR_SET(PlatformSpecificFOpen, FakeFOpen);
+        UT_PTR_SET(PlatformSpecificFPuts, FakeFPuts);
+        UT_PTR_SET(PlatformSpecificFGets, FakeFGets);
+        UT_PTR_SET(PlatformSpecificFClose, FakeFClose);
+        baseline = new TestBaseline;
+        test = new UtestShell("group", "name", "file", 1);
+    }
+
+    void teardown()
+    {
+        delete test;
+        delete baseline;
+        fileContents = NULL;
+    }
+
+    void load(const char* text)
+    {
+        fileContentsToRead = text;
+        CHECK(baseline->load("baseline.txt"));
+    }
+};
+
+TEST(TestBaseline, defaultThresholdIsTenPercent)
+{
+    LONGS_EQUAL(10, baseline->getThreshold());
+}
+
+TEST(TestBaseline, loadingAMissingFileFails)
+{
+    fileExists = false;
+    CHECK_FALSE(baseline->load("baseline.txt"));
+}
+
+TEST(TestBaseline, savesTheRecordedTests)
+{
+    UtestShell other("otherGroup", "otherName", "file", 1);
+    baseline->record(*test, 2000000.0, 0.0, 1);
+    baseline->record(other, 12.5, 0.25, 100);
+    CHECK(baseline->save("baseline.txt"));
+    STRCMP_EQUAL("otherGroup otherName 12.500 0.250 100\ngroup name 2000000.000 0.000 1\n", contents.asCharString());
+}
+
+TEST(TestBaseline, recordingATestAgainKeepsTheLastTime)
+{
+    baseline->record(*test, 1.0, 0.0, 1);
+    baseline->record(*test, 2.0, 0.0, 1);
+    LONGS_EQUAL(1, baseline->getNumberOfRecordedTests());
+    CHECK(baseline->save("baseline.txt"));
+    STRCMP_EQUAL("group name 2.000 0.000 1\n", contents.asCharString());
+}
+
+TEST(TestBaseline, loadsWhatWasSaved)
+{
+    load("group name 2000000.000 0.000 1\nother name 12.500 0.250 100\n");
+    LONGS_EQUAL(2, baseline->getNumberOfLoadedTests());
+}
+
+TEST(TestBaseline, skipsMalformedLines)
+{
+    load("group name 2000000.000 0.000 1\ngroup\n\ngroup other fast 0 1\n");
+    LONGS_EQUAL(1, baseline->getNumberOfLoadedTests());
+}
+
+TEST(TestBaseline, readsLinesLongerThanTheReadBuffer)
+{
+    SimpleString group("g", 300);
+    SimpleString line = group + " name 1.000 0.000 1\n";
+    load(line.asCharString());
+    LONGS_EQUAL(1, baseline->getNumberOfLoadedTests());
+}
+
+TEST(TestBaseline, testWithoutBaselineDoesNotRegress)
+{
+    CHECK(baseline->checkForRegression(*test, 1000000000.0).isEmpty());
+}
+
+TEST(TestBaseline, singleTimingWithinTheThresholdDoesNotRegress)
+{
+    load("group name 20000000.000 0.000 1\n");
+    CHECK(baseline->checkForRegression(*test, 22000000.0).isEmpty());
+}
+
+TEST(TestBaseline, singleTimingAboveTheThresholdRegresses)
+{
+    load("group name 20000000.000 0.000 1\n");
+    STRCMP_CONTAINS("Performance regression: 22000001.000 ns against a baseline of 20000000.000 ns", baseline->checkForRegression(*test, 22000001.0).asCharString());
+}
+
+TEST(TestBaseline, singleTimingsMayBeAMillisecondSlower)
+{
+    load("group name 1000.000 0.000 1\n");
+    CHECK(baseline->checkForRegression(*test, 1001000.0).isEmpty());
+    CHECK_FALSE(baseline->checkForRegression(*test, 1001001.0).isEmpty());
+}
+
+TEST(TestBaseline, benchmarksMayBeThreeStandardDeviationsSlower)
+{
+    load("group name 100.000 5.000 100\n");
+    CHECK(baseline->checkForRegression(*test, 115.0).isEmpty());
+    CHECK_FALSE(baseline->checkForRegression(*test, 115.5).isEmpty());
+}
+
+TEST(TestBaseline, thresholdIsConfigurable)
+{
+    load("group name 100.000 0.000 100\n");
+    baseline->setThreshold(50);
+    CHECK(baseline->checkForRegression(*test, 150.0).isEmpty());
+    CHECK_FALSE(baseline->checkForRegression(*test, 151.0).isEmpty());
+}
+
+TEST_GROUP(TestDurations)
+{
+    TestDurations* durations;
+    UtestShell* slow;
+    UtestShell* medium;
+    UtestShell* fast;
+    SimpleString contents;
+
+    void setup()
+    {
+        fileContents = &contents;
+        fileExists = true;
+        UT_PTR_SET(PlatformSpecificFOpen, FakeFOpen);
+        UT_PTR_SET(PlatformSpecificFPuts, FakeFPuts);
+        UT_PTR_SET(PlatformSpecificFGets, FakeFGets);
+        UT_PTR_SET(PlatformSpecificFClose, FakeFClose);
+        durations = new TestDurations;
+        slow = new UtestShell("group", "slow", "file", 1);
+        medium = new UtestShell("group", "medium", "file", 1);
+        fast = new UtestShell("group", "fast", "file", 1);
+    }
+
+    void teardown()
+    {
+        delete fast;
+        delete medium;
+        delete slow;
+        delete durations;
+        fileContents = NULL;
+    }
+
+    void load(const char* text)
+    {
+        fileContentsToRead = text;
+        CHECK(durations->load("durations.txt"));
+    }
+};
+
+TEST(TestDurations, loadingAMissingFileFails)
+{
+    fileExists = false;
+    CHECK_FALSE(durations->load("durations.txt"));
+}
+
+TEST(TestDurations, savesTheRecordedTestsInTheOrderTheyWereFirstSeen)
+{
+    durations->record(*slow, 3000.0);
+    durations->record(*fast, 1000.0);
+    durations->record(*slow, 3500.0);
+    CHECK(durations->save("durations.txt"));
+    STRCMP_EQUAL("group slow 3500\ngroup fast 1000\n", contents.asCharString());
+}
+
+TEST(TestDurations, laterLinesOfTheFileWin)
+{
+    load("group slow 3000\ngroup fast 1000\ngroup slow 5000\nmalformed\n");
+    LONGS_EQUAL(2, durations->getNumberOfTests());
+    DOUBLES_EQUAL(5000.0, durations->getExpectedNanos(*slow), 0.0);
+}
+
+TEST(TestDurations, recordingOverridesTheLoadedTime)
+{
+    load("group slow 3000\n");
+    durations->record(*slow, 4000.0);
+    CHECK(durations->save("durations.txt"));
+    STRCMP_EQUAL("group slow 4000\n", contents.asCharString());
+}
+
+TEST(TestDurations, unknownTestsAreExpectedToTakeTheAverageTime)
+{
+    DOUBLES_EQUAL(0.0, durations->getExpectedNanos(*medium), 0.0);
+    load("group slow 3000\ngroup fast 1000\n");
+    DOUBLES_EQUAL(2000.0, durations->getExpectedNanos(*medium), 0.0);
+}
+
+TEST(TestDurations, sortsLongestFirstKeepingTheOrderOfEqualTimes)
+{
+    double nanos[] = { 1.0, 5.0, 3.0, 5.0, 1.0 };
+    int order[5];
+    TestDurations::sortLongestFirst(order, nanos, 5);
+    LONGS_EQUAL(1, order[0]);
+    LONGS_EQUAL(3, order[1]);
+    LONGS_EQUAL(2, order[2]);
+    LONGS_EQUAL(0, order[3]);
+    LONGS_EQUAL(4, order[4]);
+}
+
+TEST(TestDurations, testsAreNotInAShardBeforePacking)
+{
+    load("group slow 3000\n");
+    LONGS_EQUAL(-1, durations->getShard(*slow));
+}
+
+TEST(TestDurations, packsTheLongestTestsIntoTheLeastLoadedShards)
+{
+    UtestShell other("group", "other", "file", 1);
+    load("group fast 1000\ngroup other 1000\ngroup medium 2000\ngroup slow 3000\n");
+    UtestShell* tests[] = { fast, &other, medium, slow };
+    durations->packIntoShards(tests, 4, 2);
+    LONGS_EQUAL(0, durations->getShard(*slow));
+    LONGS_EQUAL(1, durations->getShard(*medium));
+    LONGS_EQUAL(1, durations->getShard(*fast));
+    LONGS_EQUAL(0, durations->getShard(other));
+}
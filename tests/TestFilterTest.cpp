@@ -121,3 +121,140 @@ TEST(TestFilter, constructors)
     CHECK(filter2.match("ab"));
     CHECK(filter3.match("ab"));
 }
+
+TEST_GROUP(TestFilterMatcher)
+{
+    TestFilterMatcher matcher;
+    TestFilter* filters;
+
+    void setup()
+    {
+        filters = NULL;
+    }
+
+    void teardown()
+    {
+        while (filters) {
+            TestFilter* next = filters->getNext();
+            delete filters;
+            filters = next;
+        }
+    }
+
+    void addFilter(const char* text, bool strict = false)
+    {
+        TestFilter* filter = new TestFilter(text);
+        if (strict) filter->strictMatching();
+        filters = filter->add(filters);
+    }
+};
+
+TEST(TestFilterMatcher, withoutFiltersMatchesEverything)
+{
+    matcher.compile(NULL);
+    CHECK(matcher.match("random_name"));
+    CHECK(matcher.match(""));
+}
+
+TEST(TestFilterMatcher, emptyFilterMatchesEverything)
+{
+    addFilter("");
+    matcher.compile(filters);
+    CHECK(matcher.match("random_name"));
+    CHECK(matcher.match(""));
+}
+
+TEST(TestFilterMatcher, strictFiltersMatchWholeNames)
+{
+    addFilter("filter", true);
+    addFilter("other", true);
+    matcher.compile(filters);
+    CHECK(matcher.match("filter"));
+    CHECK(matcher.match("other"));
+    CHECK(!matcher.match("filterr"));
+    CHECK(!matcher.match(" filter"));
+    CHECK(!matcher.match(""));
+}
+
+TEST(TestFilterMatcher, filtersMatchAnywhereInTheName)
+{
+    addFilter("he");
+    addFilter("she");
+    addFilter("his");
+    addFilter("hers");
+    matcher.compile(filters);
+    CHECK(matcher.match("ushers"));
+    CHECK(matcher.match("this"));
+    CHECK(matcher.match("aahe"));
+    CHECK(!matcher.match("hi"));
+    CHECK(!matcher.match("shs"));
+    CHECK(!matcher.match(""));
+}
+
+TEST(TestFilterMatcher, followsFailureTransitionsToShorterPatterns)
+{
+    addFilter("abcd");
+    addFilter("bce");
+    addFilter("cx");
+    matcher.compile(filters);
+    CHECK(matcher.match("abce"));
+    CHECK(matcher.match("abcx"));
+    CHECK(matcher.match("aabcd"));
+    CHECK(!matcher.match("abcf"));
+}
+
+TEST(TestFilterMatcher, mixesStrictAndSubstringFilters)
+{
+    addFilter("exact", true);
+    addFilter("part");
+    matcher.compile(filters);
+    CHECK(matcher.match("exact"));
+    CHECK(matcher.match("apartment"));
+    CHECK(!matcher.match("exactly"));
+}
+
+TEST(TestFilterMatcher, matchesLikeTheFilterChain)
+{
+    const char* texts[] = { "Group", "roup", "up", "Gr", "Test", "est", "Testing", "x" };
+    const char* names[] = { "Group", "TestGroup", "Testing", "Gx", "", "upup", "rou" };
+    for (size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); i++)
+        addFilter(texts[i], i % 3 == 0);
+    matcher.compile(filters);
+
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        bool chainMatches = false;
+        for (TestFilter* filter = filters; filter; filter = filter->getNext())
+            chainMatches = chainMatches || filter->match(names[i]);
+        CHECK_EQUAL(chainMatches, matcher.match(names[i]));
+    }
+}
+
+TEST(TestFilterMatcher, clearedMatcherMatchesEverything)
+{
+    addFilter("first", true);
+    matcher.compile(filters);
+    CHECK(!matcher.match("anything"));
+    matcher.clear();
+    CHECK(matcher.match("anything"));
+}
+
+TEST(TestFilterMatcher, recompilingReplacesTheFilters)
+{
+    addFilter("first", true);
+    matcher.compile(filters);
+    addFilter("second");
+    matcher.compile(filters);
+    CHECK(matcher.match("first"));
+    CHECK(matcher.match("a second"));
+}
+
+TEST(TestFilterMatcher, matchesGroupAndNameJoinedByADot)
+{
+    addFilter("Group.Name", true);
+    addFilter("p.Oth");
+    matcher.compile(filters);
+    CHECK(matcher.match("Group", "Name"));
+    CHECK(matcher.match("Group", "Other"));
+    CHECK(!matcher.match("Group", "Nam"));
+    CHECK(!matcher.match("GroupName", ""));
+}
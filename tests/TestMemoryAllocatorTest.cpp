@@ -129,3 +129,144 @@ TEST(TestMemoryAllocatorTest, TryingToAllocateTooMuchFailsTest)
     fixture.runAllTests();
     fixture.assertPrintContains("malloc returned null pointer");
 }
+
+TEST_GROUP(GuardPageMemoryAllocatorTest)
+{
+    GuardPageMemoryAllocator* allocator;
+    size_t pageSize;
+
+    void setup()
+    {
+        allocator = NULL;
+        pageSize = PlatformSpecificPageSize();
+    }
+
+    void teardown()
+    {
+        delete allocator;
+    }
+};
+
+TEST(GuardPageMemoryAllocatorTest, OverflowModePlacesTheMemoryAgainstTheNextPage)
+{
+    allocator = new GuardPageMemoryAllocator(GuardPageMemoryAllocator::detect_overflow);
+    allocator->setAlignment(1);
+    char* memory = allocator->alloc_memory(10, "file", 1);
+    PlatformSpecificMemset(memory, 0xAB, 10);
+    CHECK(allocator->guardsMemoryBounds());
+    LONGS_EQUAL(0, (long) ((size_t) (memory + 10) % pageSize));
+    allocator->free_memory(memory, "file", 1);
+}
+
+TEST(GuardPageMemoryAllocatorTest, OverflowModeAlignsTheMemory)
+{
+    allocator = new GuardPageMemoryAllocator(GuardPageMemoryAllocator::detect_overflow);
+    allocator->setAlignment(8);
+    char* memory = allocator->alloc_memory(10, "file", 1);
+    LONGS_EQUAL(0, (long) ((size_t) memory % 8));
+    LONGS_EQUAL(0, (long) ((size_t) (memory + 16) % pageSize));
+    allocator->free_memory(memory, "file", 1);
+}
+
+TEST(GuardPageMemoryAllocatorTest, UnderflowModeStartsTheMemoryAtAPage)
+{
+    allocator = new GuardPageMemoryAllocator(GuardPageMemoryAllocator::detect_underflow);
+    char* memory = allocator->alloc_memory(3 * pageSize, "file", 1);
+    PlatformSpecificMemset(memory, 0xAB, 3 * pageSize);
+    LONGS_EQUAL(0, (long) ((size_t) memory % pageSize));
+    allocator->free_memory(memory, "file", 1);
+}
+
+TEST(GuardPageMemoryAllocatorTest, ZeroBytesCanBeAllocatedAndFreed)
+{
+    allocator = new GuardPageMemoryAllocator(GuardPageMemoryAllocator::detect_underflow);
+    allocator->free_memory(allocator->alloc_memory(0, "file", 1), "file", 1);
+    allocator->free_memory(NULL, "file", 1);
+}
+
+static size_t NoPageSize()
+{
+    return 0;
+}
+
+TEST(GuardPageMemoryAllocatorTest, PlatformWithoutPagesGetsOrdinaryMemory)
+{
+    UT_PTR_SET(PlatformSpecificPageSize, NoPageSize);
+    allocator = new GuardPageMemoryAllocator(GuardPageMemoryAllocator::detect_overflow, "name", "alloc", "free");
+    CHECK(!allocator->guardsMemoryBounds());
+    STRCMP_EQUAL("alloc", allocator->alloc_name());
+    allocator->free_memory(allocator->alloc_memory(10, "file", 1), "file", 1);
+}
+
+static int FailingPageProtect(void*, size_t, int)
+{
+    return -1;
+}
+
+static void _allocateWithoutGuardPage()
+{
+    GuardPageMemoryAllocator guardedAllocator(GuardPageMemoryAllocator::detect_overflow);
+    guardedAllocator.alloc_memory(10, "file", 1);
+} // LCOV_EXCL_LINE
+
+TEST(GuardPageMemoryAllocatorTest, FailingToProtectTheGuardPageFailsTest)
+{
+    UT_PTR_SET(PlatformSpecificPageProtect, FailingPageProtect);
+    TestTestingFixture fixture;
+    fixture.setTestFunction(_allocateWithoutGuardPage);
+    fixture.runAllTests();
+    fixture.assertPrintContains("could not protect guard page");
+}
+
+static void _freeWithoutUnprotectingTheGuardPage()
+{
+    GuardPageMemoryAllocator guardedAllocator(GuardPageMemoryAllocator::detect_underflow);
+    char* memory = guardedAllocator.alloc_memory(10, "file", 1);
+    UT_PTR_SET(PlatformSpecificPageProtect, FailingPageProtect);
+    guardedAllocator.free_memory(memory, "file", 1);
+} // LCOV_EXCL_LINE
+
+TEST(GuardPageMemoryAllocatorTest, FailingToUnprotectTheGuardPageFailsTest)
+{
+    TestTestingFixture fixture;
+    fixture.setTestFunction(_freeWithoutUnprotectingTheGuardPage);
+    fixture.runAllTests();
+    fixture.assertPrintContains("could not unprotect guard page");
+}
+
+#ifdef HAVE_FORK
+
+static void _writeOnePastTheEnd()
+{
+    GuardPageMemoryAllocator guardedAllocator(GuardPageMemoryAllocator::detect_overflow);
+    guardedAllocator.setAlignment(1);
+    volatile char* memory = guardedAllocator.alloc_memory(10, "file", 1);
+    memory[10] = 'x';
+} // LCOV_EXCL_LINE
+
+static void _readOneBeforeTheStart()
+{
+    GuardPageMemoryAllocator guardedAllocator(GuardPageMemoryAllocator::detect_underflow);
+    volatile char* memory = guardedAllocator.alloc_memory(10, "file", 1);
+    (void) memory[-1];
+} // LCOV_EXCL_LINE
+
+TEST(GuardPageMemoryAllocatorTest, OverflowFaultsRightAway)
+{
+    TestTestingFixture fixture;
+    fixture.registry_->setRunTestsInSeperateProcess();
+    fixture.setTestFunction(_writeOnePastTheEnd);
+    fixture.runAllTests();
+    fixture.assertPrintContains("Failed in separate process - killed by signal");
+}
+
+TEST(GuardPageMemoryAllocatorTest, UnderflowFaultsRightAway)
+{
+    TestTestingFixture fixture;
+    fixture.registry_->setRunTestsInSeperateProcess();
+    fixture.setTestFunction(_readOneBeforeTheStart);
+    fixture.runAllTests();
+    fixture.assertPrintContains("Failed in separate process - killed by signal");
+}
+
+#endif
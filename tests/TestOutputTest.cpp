@@ -30,13 +30,13 @@
 #include "CppUTest/TestResult.h"
 #include "CppUTest/PlatformSpecificFunctions.h"
 
-static long millisTime;
+static double nanosTime;
 
 extern "C" {
 
-    static long MockGetPlatformSpecificTimeInMillis()
+    static double MockGetPlatformSpecificMonotonicTimeInNanos()
     {
-        return millisTime;
+        return nanosTime;
     }
 
 }
@@ -61,8 +61,8 @@ TEST_GROUP(TestOutput)
         f3 = new TestFailure(tst, "file", 2, "message");
         result = new TestResult(*mock);
         result->setTotalExecutionTime(10);
-        millisTime = 0;
-        UT_PTR_SET(GetPlatformSpecificTimeInMillis, MockGetPlatformSpecificTimeInMillis);
+        nanosTime = 0;
+        UT_PTR_SET(GetPlatformSpecificMonotonicTimeInNanos, MockGetPlatformSpecificMonotonicTimeInNanos);
         TestOutput::setWorkingEnvironment(TestOutput::eclipse);
 
     }
@@ -140,9 +140,46 @@ TEST(TestOutput, PrintTestVerboseEnded)
 {
     mock->verbose();
     result->currentTestStarted(tst);
-    millisTime = 5;
+    nanosTime = 5000000;
     result->currentTestEnded(tst);
-    STRCMP_EQUAL("TEST(group, test) - 5 ms\n", mock->getOutput().asCharString());
+    STRCMP_EQUAL("TEST(group, test) - 5.000 ms\n", mock->getOutput().asCharString());
+}
+
+TEST(TestOutput, PrintTestVerboseEndedShowsMicroseconds)
+{
+    mock->verbose();
+    result->currentTestStarted(tst);
+    nanosTime = 5012999;
+    result->currentTestEnded(tst);
+    STRCMP_EQUAL("TEST(group, test) - 5.012 ms\n", mock->getOutput().asCharString());
+}
+
+TEST(TestOutput, PrintBenchmarkResult)
+{
+    double nanosPerIteration[] = { 2.0, 1.0, 3.0 };
+    BenchmarkResult benchmark;
+    benchmark.calculate(nanosPerIteration, 3, 1000);
+    printer->printBenchmarkResult(*tst, benchmark);
+    STRCMP_EQUAL("\nTEST(group, test) - min 1.000 ns, median 2.000 ns, p99 3.000 ns, stddev 1.000 ns (3 samples of 1000 iterations)\n", mock->getOutput().asCharString());
+}
+
+TEST(TestOutput, PrintBenchmarkResultVerboseFollowsTheTestName)
+{
+    double nanosPerIteration[] = { 2.0, 1.0, 3.0 };
+    BenchmarkResult benchmark;
+    benchmark.calculate(nanosPerIteration, 3, 1000);
+    mock->verbose();
+    printer->printBenchmarkResult(*tst, benchmark);
+    STRCMP_EQUAL(" - min 1.000 ns, median 2.000 ns, p99 3.000 ns, stddev 1.000 ns (3 samples of 1000 iterations)", mock->getOutput().asCharString());
+}
+
+TEST(TestOutput, PrintTestPropertyOnlyWhenVerbose)
+{
+    printer->printTestProperty(*tst, "cycles", "1234");
+    STRCMP_EQUAL("", mock->getOutput().asCharString());
+    mock->verbose();
+    printer->printTestProperty(*tst, "cycles", "1234");
+    STRCMP_EQUAL(" - cycles 1234", mock->getOutput().asCharString());
 }
 
 TEST(TestOutput, printColorWithSuccess)
@@ -28,6 +28,7 @@
 #include "CppUTest/TestHarness.h"
 #include "CppUTest/TestRegistry.h"
 #include "CppUTest/TestOutput.h"
+#include "CppUTest/TestBaseline.h"
 
 namespace
 {
@@ -49,6 +50,15 @@ public:
     bool hasRun_;
 };
 
+class MockBenchmark: public MockTest
+{
+public:
+    virtual bool isBenchmark() const _override
+    {
+        return true;
+    }
+};
+
 class MockTestResult: public TestResult
 {
 public:
@@ -174,6 +184,67 @@ TEST(TestRegistry, addOneTwoTests)
     CHECK(myRegistry->countTests() == 2);
 }
 
+TEST(TestRegistry, countsLongListsOfTests)
+{
+    const int numberOfTests = 100000;
+    MockTest* tests = new MockTest[numberOfTests];
+    for (int i = 0; i < numberOfTests; i++)
+        myRegistry->addTest(&tests[i]);
+    LONGS_EQUAL(numberOfTests, myRegistry->countTests());
+    delete [] tests;
+}
+
+TEST(TestRegistry, findsTestsByNameAndGroup)
+{
+    MockTest other("other");
+    other.setTestName("otherName");
+    myRegistry->addTest(test1);
+    myRegistry->addTest(&other);
+    myRegistry->addTest(test3);
+    POINTERS_EQUAL(&other, myRegistry->findTestWithName("otherName"));
+    POINTERS_EQUAL(&other, myRegistry->findTestWithGroup("other"));
+    POINTERS_EQUAL(test3, myRegistry->findTestWithGroup("group2"));
+    POINTERS_EQUAL(NULL, myRegistry->findTestWithName("unknown"));
+    POINTERS_EQUAL(NULL, myRegistry->findTestWithGroup("unknown"));
+}
+
+TEST(TestRegistry, findsTheFirstTestOfAName)
+{
+    myRegistry->addTest(test1);
+    myRegistry->addTest(test2);
+    POINTERS_EQUAL(test2, myRegistry->findTestWithName("Name"));
+    POINTERS_EQUAL(test2, myRegistry->findTestWithGroup("Group"));
+}
+
+TEST(TestRegistry, findsTestsAddedAfterTheFirstLookup)
+{
+    myRegistry->addTest(test1);
+    POINTERS_EQUAL(NULL, myRegistry->findTestWithGroup("group2"));
+    myRegistry->addTest(test3);
+    POINTERS_EQUAL(test3, myRegistry->findTestWithGroup("group2"));
+    myRegistry->unDoLastAddTest();
+    POINTERS_EQUAL(NULL, myRegistry->findTestWithGroup("group2"));
+}
+
+TEST(TestRegistry, findsTestsRenamedAfterTheFirstLookup)
+{
+    myRegistry->addTest(test1);
+    POINTERS_EQUAL(test1, myRegistry->findTestWithName("Name"));
+    test1->setTestName("renamed");
+    POINTERS_EQUAL(test1, myRegistry->findTestWithName("renamed"));
+    POINTERS_EQUAL(NULL, myRegistry->findTestWithName("Name"));
+}
+
+TEST(TestRegistry, unknownNamesAreNotFoundAfterTheIndexIsBuilt)
+{
+    myRegistry->addTest(test1);
+    myRegistry->addTest(test3);
+    POINTERS_EQUAL(test1, myRegistry->findTestWithGroup("Group"));
+    POINTERS_EQUAL(NULL, myRegistry->findTestWithGroup("unknown"));
+    POINTERS_EQUAL(NULL, myRegistry->findTestWithName("unknown"));
+    POINTERS_EQUAL(test3, myRegistry->findTestWithGroup("group2"));
+}
+
 TEST(TestRegistry, runTwoTests)
 {
     myRegistry->addTest(test1);
@@ -284,6 +355,120 @@ TEST(TestRegistry, groupFilterWorks)
     CHECK(!test2->hasRun_);
 }
 
+TEST(TestRegistry, eachTestRunsInExactlyOneShard)
+{
+    const char* groups[] = { "g0", "g1", "g2", "g3", "g4", "g5", "g6", "g7", "g8", "g9" };
+    const int numberOfTests = 10;
+    const int numberOfShards = 3;
+    MockTest* tests[numberOfTests];
+    int timesRun[numberOfTests];
+    int testsRunInShard[numberOfShards];
+
+    for (int i = 0; i < numberOfTests; i++) {
+        tests[i] = new MockTest(groups[i]);
+        timesRun[i] = 0;
+        myRegistry->addTest(tests[i]);
+    }
+
+    for (int shard = 0; shard < numberOfShards; shard++) {
+        myRegistry->setShard(shard, numberOfShards);
+        for (int j = 0; j < numberOfTests; j++) tests[j]->hasRun_ = false;
+        myRegistry->runAllTests(*result);
+
+        testsRunInShard[shard] = 0;
+        for (int k = 0; k < numberOfTests; k++) {
+            if (tests[k]->hasRun_) {
+                timesRun[k]++;
+                testsRunInShard[shard]++;
+            }
+        }
+    }
+
+    for (int l = 0; l < numberOfTests; l++) {
+        LONGS_EQUAL(1, timesRun[l]);
+        delete tests[l];
+    }
+    CHECK(testsRunInShard[0] < numberOfTests);
+    CHECK(testsRunInShard[1] < numberOfTests);
+    CHECK(testsRunInShard[2] < numberOfTests);
+}
+
+TEST(TestRegistry, testsNotInTheShardAreCountedAsFilteredOut)
+{
+    myRegistry->addTest(test1);
+    myRegistry->addTest(test3);
+    myRegistry->setShard(0, 2);
+    myRegistry->runAllTests(*result);
+    myRegistry->setShard(1, 2);
+    myRegistry->runAllTests(*result);
+
+    LONGS_EQUAL(2, result->getFilteredOutCount());
+}
+
+TEST(TestRegistry, recordedDurationsPackTheShardsEvenly)
+{
+    MockTest slow("slow"), medium("medium"), fast("fast"), other("other");
+    TestDurations durations;
+    durations.record(slow, 4000.0);
+    durations.record(medium, 2000.0);
+    durations.record(fast, 1000.0);
+    durations.record(other, 1000.0);
+    myRegistry->addTest(&fast);
+    myRegistry->addTest(&slow);
+    myRegistry->addTest(&other);
+    myRegistry->addTest(&medium);
+    myRegistry->setDurations(&durations);
+    myRegistry->setShard(0, 2);
+    myRegistry->runAllTests(*result);
+
+    CHECK(slow.hasRun_);
+    CHECK_FALSE(medium.hasRun_);
+    CHECK_FALSE(fast.hasRun_);
+    CHECK_FALSE(other.hasRun_);
+}
+
+TEST(TestRegistry, testFiltersSelectGroupAndNameTogether)
+{
+    MockTest other("group2");
+    other.setTestName("other");
+    TestFilter filter("group2.Name");
+    filter.strictMatching();
+    myRegistry->addTest(test1);
+    myRegistry->addTest(test3);
+    myRegistry->addTest(&other);
+    myRegistry->setTestFilters(&filter);
+    myRegistry->runAllTests(*result);
+
+    CHECK(test3->hasRun_);
+    CHECK_FALSE(test1->hasRun_);
+    CHECK_FALSE(other.hasRun_);
+    LONGS_EQUAL(2, result->getFilteredOutCount());
+}
+
+TEST(TestRegistry, runBenchmarksOnlySkipsTheOtherTests)
+{
+    MockBenchmark benchmark;
+    myRegistry->addTest(test1);
+    myRegistry->addTest(&benchmark);
+    myRegistry->setRunBenchmarksOnly();
+    myRegistry->runAllTests(*result);
+
+    CHECK(benchmark.hasRun_);
+    CHECK_FALSE(test1->hasRun_);
+    LONGS_EQUAL(1, result->getFilteredOutCount());
+}
+
+TEST(TestRegistry, benchmarksRunWithTheOtherTestsByDefault)
+{
+    MockBenchmark benchmark;
+    myRegistry->addTest(test1);
+    myRegistry->addTest(&benchmark);
+    myRegistry->runAllTests(*result);
+
+    CHECK(benchmark.hasRun_);
+    CHECK(test1->hasRun_);
+}
+
 TEST(TestRegistry, runTestInSeperateProcess)
 {
     myRegistry->setRunTestsInSeperateProcess();
@@ -28,12 +28,13 @@
 #include "CppUTest/TestHarness.h"
 #include "CppUTest/PlatformSpecificFunctions.h"
 #include "CppUTest/TestOutput.h"
+#include "CppUTest/TestBaseline.h"
 
 extern "C" {
 
-    static long MockGetPlatformSpecificTimeInMillis()
+    static double MockGetPlatformSpecificMonotonicTimeInNanos()
     {
-        return 10;
+        return 10000000.0;
     }
 
 }
@@ -50,7 +51,7 @@ TEST_GROUP(TestResult)
         mock = new StringBufferTestOutput();
         printer = mock;
         res = new TestResult(*printer);
-        UT_PTR_SET(GetPlatformSpecificTimeInMillis, MockGetPlatformSpecificTimeInMillis);
+        UT_PTR_SET(GetPlatformSpecificMonotonicTimeInNanos, MockGetPlatformSpecificMonotonicTimeInNanos);
     }
     void teardown()
     {
@@ -64,3 +65,94 @@ TEST(TestResult, TestEndedWillPrintResultsAndExecutionTime)
     res->testsEnded();
     CHECK(mock->getOutput().contains("10 ms"));
 }
+
+TEST(TestResult, SetTotalExecutionTimeIsInMillis)
+{
+    res->setTotalExecutionTime(10);
+    LONGS_EQUAL(10, res->getTotalExecutionTime());
+    DOUBLES_EQUAL(10000000.0, res->getTotalExecutionTimeInNanos(), 0.0);
+}
+
+TEST(TestResult, TestEndedWithTimeUsesTheGivenExecutionTime)
+{
+    res->currentTestEndedWithTime(0, 42000000.0);
+    LONGS_EQUAL(42, res->getCurrentTestTotalExecutionTime());
+}
+
+TEST(TestResult, TestEndedWithTimeKeepsNanoseconds)
+{
+    res->currentTestEndedWithTime(0, 1500.0);
+    LONGS_EQUAL(0, res->getCurrentTestTotalExecutionTime());
+    DOUBLES_EQUAL(1500.0, res->getCurrentTestTotalExecutionTimeInNanos(), 0.0);
+}
+
+TEST(TestResult, GroupEndedWithTimeUsesTheGivenExecutionTime)
+{
+    res->currentGroupEndedWithTime(0, 84000000.0);
+    LONGS_EQUAL(84, res->getCurrentGroupTotalExecutionTime());
+}
+
+class RegressingTestBaseline : public TestBaseline
+{
+public:
+    RegressingTestBaseline(const char* regression) : regression_(regression), recordedNanos_(0), recordedSamples_(0) {}
+
+    virtual SimpleString checkForRegression(const UtestShell&, double) const _override
+    {
+        return regression_;
+    }
+
+    virtual void record(const UtestShell&, double nanos, double, int numberOfSamples) _override
+    {
+        recordedNanos_ = nanos;
+        recordedSamples_ = numberOfSamples;
+    }
+
+    const char* regression_;
+    double recordedNanos_;
+    int recordedSamples_;
+};
+
+TEST(TestResult, TestSlowerThanItsBaselineFails)
+{
+    UtestShell test("group", "name", "file", 1);
+    RegressingTestBaseline baseline("Performance regression");
+    res->setBaseline(&baseline);
+    res->currentTestEndedWithTime(&test, 42.0);
+    LONGS_EQUAL(1, res->getFailureCount());
+    STRCMP_CONTAINS("Performance regression", mock->getOutput().asCharString());
+    DOUBLES_EQUAL(42.0, baseline.recordedNanos_, 0.0);
+}
+
+TEST(TestResult, TestWithinItsBaselinePasses)
+{
+    UtestShell test("group", "name", "file", 1);
+    RegressingTestBaseline baseline("");
+    res->setBaseline(&baseline);
+    res->currentTestEndedWithTime(&test, 42.0);
+    LONGS_EQUAL(0, res->getFailureCount());
+}
+
+TEST(TestResult, BenchmarksRecordTheirMedianInTheBaseline)
+{
+    UtestShell test("group", "name", "file", 1);
+    double nanosPerIteration[] = { 3.0, 1.0, 2.0 };
+    BenchmarkResult benchmark;
+    benchmark.calculate(nanosPerIteration, 3, 10);
+    RegressingTestBaseline baseline("");
+    res->setBaseline(&baseline);
+    res->currentTestStarted(&test);
+    res->addBenchmarkResult(test, benchmark);
+    res->currentTestEnded(&test);
+    DOUBLES_EQUAL(2.0, baseline.recordedNanos_, 0.0);
+    LONGS_EQUAL(3, baseline.recordedSamples_);
+}
+
+TEST(TestResult, IgnoredTestsAreNotComparedWithTheBaseline)
+{
+    IgnoredUtestShell test("group", "name", "file", 1);
+    RegressingTestBaseline baseline("Performance regression");
+    res->setBaseline(&baseline);
+    res->currentTestEndedWithTime(&test, 42.0);
+    LONGS_EQUAL(0, res->getFailureCount());
+}
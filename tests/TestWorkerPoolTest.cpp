@@ -0,0 +1,680 @@
+/*
+ * Copyright (c) 2007, Michael Feathers, James Grenning and Bas Vodde
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE EARLIER MENTIONED AUTHORS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TestTestingFixture.h"
+#include "CppUTest/TestWorkerPool.h"
+#include "CppUTest/TestBaseline.h"
+#include "CppUTest/PlatformSpecificFunctions.h"
+#include "CppUTest/MemoryLeakDetector.h"
+
+TEST_GROUP(TestWorkerPool)
+{
+    TestTestingFixture fixture;
+
+    void setup()
+    {
+        fixture.registry_->setRunTestsInParallel(2);
+    }
+};
+
+#ifndef HAVE_FORK
+
+TEST(TestWorkerPool, FailsWhenWorkersCannotBeStarted)
+{
+    fixture.runAllTests();
+    fixture.assertPrintContains("Failed to start worker process");
+}
+
+#else
+
+static void _passFunction()
+{
+    CHECK(true);
+}
+
+static void _failFunction()
+{
+    FAIL("This test fails");
+}
+
+static void _printFunction()
+{
+    UT_PRINT("Printed in a worker");
+}
+
+static void _accessViolationTestFunction()
+{
+    (void) *(volatile int*) 0;
+}
+
+static size_t positionOf(const SimpleString& output, const SimpleString& text)
+{
+    for (size_t i = 0; i < output.size(); i++)
+        if (output.subString(i, text.size()) == text) return i;
+    FAIL(StringFromFormat("<%s> not found in output", text.asCharString()).asCharString());
+    return 0;
+}
+
+extern "C" {
+    static int (*original_fork)(void) = NULL;
+    static int fork_count = 0;
+
+    static int fork_failed_stub(void) { return -1; }
+    static int pipe_failed_stub(int*, int*) { return -1; }
+    static int fork_counting_stub(void) { fork_count++; return original_fork(); }
+
+    static int resource_usage_calls = 0;
+    static int resource_usage_stub(PlatformSpecificResourceUsage* usage)
+    {
+        resource_usage_calls++;
+        usage->userTimeInNanos = resource_usage_calls * 1000000.0;
+        usage->systemTimeInNanos = resource_usage_calls * 500000.0;
+        usage->maximumResidentSetSizeInKilobytes = resource_usage_calls * 1024;
+        usage->minorPageFaults = resource_usage_calls * 10;
+        usage->majorPageFaults = resource_usage_calls;
+        usage->voluntaryContextSwitches = resource_usage_calls * 2;
+        usage->involuntaryContextSwitches = resource_usage_calls * 3;
+        return 0;
+    }
+}
+
+TEST(TestWorkerPool, PassingTestIsCountedInParent)
+{
+    fixture.setTestFunction(_passFunction);
+    fixture.runAllTests();
+    fixture.assertPrintContains("OK (1 tests, 1 ran, 1 checks, 0 ignored, 0 filtered out");
+}
+
+TEST(TestWorkerPool, FailureInWorkerIsReplayed)
+{
+    fixture.setTestFunction(_failFunction);
+    fixture.runAllTests();
+    fixture.assertPrintContains("This test fails");
+    LONGS_EQUAL(1, fixture.getFailureCount());
+}
+
+TEST(TestWorkerPool, PrintInWorkerIsReplayed)
+{
+    fixture.setTestFunction(_printFunction);
+    fixture.runAllTests();
+    fixture.assertPrintContains("Printed in a worker");
+}
+
+class PropertyAddingPlugin : public TestPlugin
+{
+public:
+    PropertyAddingPlugin() : TestPlugin("PropertyAddingPlugin") {}
+
+    virtual void postTestAction(UtestShell& test, TestResult& result) _override
+    {
+        result.addTestProperty(test, "measured", "42");
+    }
+};
+
+TEST(TestWorkerPool, PropertyAddedInWorkerIsReplayed)
+{
+    PropertyAddingPlugin plugin;
+    fixture.registry_->installPlugin(&plugin);
+    fixture.output_->verbose();
+    fixture.setTestFunction(_passFunction);
+    fixture.runAllTests();
+    fixture.assertPrintContains("TEST(Generic, Generic) - measured 42");
+}
+
+TEST(TestWorkerPool, CrashInWorkerIsReportedAndNextTestsStillRun)
+{
+    ExecFunctionTestShell passingTest;
+    passingTest.testFunction_ = _passFunction;
+    fixture.addTest(&passingTest);
+    fixture.setTestFunction(_accessViolationTestFunction);
+    fixture.runAllTests();
+    fixture.assertPrintContains("Failed in worker process - killed by signal 11");
+    fixture.assertPrintContains("Errors (1 failures, 2 tests, 2 ran, 1 checks");
+}
+
+TEST(TestWorkerPool, ResultsAreReplayedInRegistryOrder)
+{
+    ExecFunctionTestShell first, second, third;
+    first.setTestName("first");
+    second.setTestName("second");
+    third.setTestName("third");
+    fixture.addTest(&third);
+    fixture.addTest(&second);
+    fixture.addTest(&first);
+    fixture.output_->verbose();
+    fixture.runAllTests();
+
+    SimpleString output = fixture.output_->getOutput();
+    CHECK(positionOf(output, "TEST(Generic, first)") < positionOf(output, "TEST(Generic, second)"));
+    CHECK(positionOf(output, "TEST(Generic, second)") < positionOf(output, "TEST(Generic, third)"));
+    CHECK(positionOf(output, "TEST(Generic, third)") < positionOf(output, "TEST(Generic, Generic)"));
+}
+
+TEST(TestWorkerPool, FilteredOutTestsAreNotRunInWorkers)
+{
+    ExecFunctionTestShell filteredTest;
+    filteredTest.setTestName("filtered");
+    filteredTest.testFunction_ = _failFunction;
+    fixture.addTest(&filteredTest);
+    TestFilter filter("Generic");
+    filter.strictMatching();
+    fixture.registry_->setNameFilters(&filter);
+    fixture.runAllTests();
+    fixture.assertPrintContains("OK (2 tests, 1 ran, 0 checks, 0 ignored, 1 filtered out");
+}
+
+TEST(TestWorkerPool, CallToForkFailedFailsTheTest)
+{
+    UT_PTR_SET(PlatformSpecificFork, fork_failed_stub);
+    fixture.runAllTests();
+    fixture.assertPrintContains("Failed to start worker process");
+}
+
+TEST(TestWorkerPool, CallToPipeFailedFailsTheTest)
+{
+    UT_PTR_SET(PlatformSpecificPipe, pipe_failed_stub);
+    fixture.runAllTests();
+    fixture.assertPrintContains("Failed to start worker process");
+}
+
+TEST(TestWorkerPool, ResourceUsageIsOnlyMeasuredWithPreforkedProcesses)
+{
+    UT_PTR_SET(PlatformSpecificGetResourceUsage, resource_usage_stub);
+    fixture.output_->verbose();
+    fixture.runAllTests();
+    CHECK(!fixture.output_->getOutput().contains("user_time_ms"));
+}
+
+class PhaseRecordingTestOutput : public StringBufferTestOutput
+{
+public:
+    virtual bool isTracingTestPhases() const _override
+    {
+        return true;
+    }
+
+    virtual void printTestPhaseStarted(const UtestShell&, const char* phase, double, int track) _override
+    {
+        phases_ += StringFromFormat("%s@%d ", phase, track);
+    }
+
+    SimpleString phases_;
+};
+
+TEST(TestWorkerPool, TestPhasesAreReplayedOnTheTrackOfTheWorker)
+{
+    PhaseRecordingTestOutput output;
+    TestResult result(output);
+    fixture.registry_->runAllTests(result);
+    STRCMP_EQUAL("TEST@1 preTestAction@1 setup@1 testBody@1 teardown@1 postTestAction@1 ", output.phases_.asCharString());
+}
+
+TEST(TestWorkerPool, RunsInSeparateProcessInsideWorker)
+{
+    fixture.registry_->setRunTestsInSeperateProcess();
+    fixture.setTestFunction(_failFunction);
+    fixture.runAllTests();
+    fixture.assertPrintContains("Failed in separate process");
+}
+
+TEST_GROUP(TestWorkerPoolPreforked)
+{
+    TestTestingFixture fixture;
+    ExecFunctionTestShell secondTest;
+    ExecFunctionTestShell thirdTest;
+
+    void setup()
+    {
+        fork_count = 0;
+        UT_PTR_SET(original_fork, PlatformSpecificFork);
+        UT_PTR_SET(PlatformSpecificFork, fork_counting_stub);
+        fixture.addTest(&secondTest);
+        fixture.addTest(&thirdTest);
+        fixture.registry_->setRunTestsInPreforkedProcesses();
+    }
+};
+
+TEST(TestWorkerPoolPreforked, WorkerIsReusedAfterPassingTests)
+{
+    fixture.runAllTests();
+    LONGS_EQUAL(1, fork_count);
+    fixture.assertPrintContains("OK (3 tests, 3 ran");
+}
+
+TEST(TestWorkerPoolPreforked, WorkerIsReplacedAfterFailingTest)
+{
+    thirdTest.testFunction_ = _failFunction;
+    fixture.runAllTests();
+    LONGS_EQUAL(2, fork_count);
+    fixture.assertPrintContains("Errors (1 failures, 3 tests, 3 ran");
+}
+
+TEST(TestWorkerPoolPreforked, ResourceUsageOfEachTestIsReported)
+{
+    resource_usage_calls = 0;
+    UT_PTR_SET(PlatformSpecificGetResourceUsage, resource_usage_stub);
+    fixture.output_->verbose();
+    fixture.runAllTests();
+    fixture.assertPrintContains(" - user_time_ms 1.000 - system_time_ms 0.500 - max_rss_kb 2048"
+                                " - minor_faults 10 - major_faults 1"
+                                " - voluntary_context_switches 2 - involuntary_context_switches 3");
+    fixture.assertPrintContains(" - minor_faults 10 - major_faults 1"
+                                " - voluntary_context_switches 2 - involuntary_context_switches 3 - worker_max_rss_kb 4096");
+    CHECK(!fixture.output_->getOutput().contains(" - max_rss_kb 4096"));
+}
+
+class TestStartRecordingTestOutput : public StringBufferTestOutput
+{
+public:
+    virtual bool isTracingTestPhases() const _override
+    {
+        return true;
+    }
+
+    virtual void printTestPhaseStarted(const UtestShell& test, const char* phase, double timeInNanos, int) _override
+    {
+        if (SimpleString(phase) != "TEST") return;
+        if (test.getName() == "second") secondStarted_ = timeInNanos;
+        if (test.getName() == "third") thirdStarted_ = timeInNanos;
+    }
+
+    TestStartRecordingTestOutput() : secondStarted_(0), thirdStarted_(0)
+    {
+    }
+
+    double secondStarted_;
+    double thirdStarted_;
+};
+
+TEST(TestWorkerPoolPreforked, LongestTestIsDispatchedFirstButReplayedInRegistryOrder)
+{
+    secondTest.setTestName("second");
+    thirdTest.setTestName("third");
+    TestDurations durations;
+    durations.record(secondTest, 5000.0);
+    durations.record(thirdTest, 1000.0);
+    fixture.registry_->setDurations(&durations);
+    TestStartRecordingTestOutput output;
+    output.verbose();
+    TestResult result(output);
+    fixture.registry_->runAllTests(result);
+
+    CHECK(output.secondStarted_ < output.thirdStarted_);
+    SimpleString printed = output.getOutput();
+    CHECK(positionOf(printed, "TEST(Generic, third)") < positionOf(printed, "TEST(Generic, second)"));
+}
+
+TEST(TestWorkerPoolPreforked, CrashIsIsolatedToTheTest)
+{
+    thirdTest.testFunction_ = _accessViolationTestFunction;
+    fixture.runAllTests();
+    LONGS_EQUAL(2, fork_count);
+    fixture.assertPrintContains("Failed in worker process - killed by signal 11");
+    fixture.assertPrintContains("Errors (1 failures, 3 tests, 3 ran");
+}
+
+#endif
+
+extern "C" {
+    static int pipe_unavailable_stub(int*, int*) { return -1; }
+    static void run_in_separate_process_stub(UtestShell* shell, TestPlugin*, TestResult* result)
+    {
+        result->addFailure(TestFailure(shell, "-p doesn't work on this platform, as it is lacking fork."));
+    }
+}
+
+TEST(TestWorkerPool, PreforkedProcessesFallBackToASeparateProcessPerTestWithoutWorkers)
+{
+    UT_PTR_SET(PlatformSpecificPipe, pipe_unavailable_stub);
+    UT_PTR_SET(PlatformSpecificRunTestInASeperateProcess, run_in_separate_process_stub);
+    fixture.registry_->setRunTestsInPreforkedProcesses();
+    fixture.runAllTests();
+    fixture.assertPrintContains("-p doesn't work on this platform, as it is lacking fork.");
+    CHECK(!fixture.output_->getOutput().contains("Failed to start worker process"));
+}
+
+class ThreadSafeTestShell : public ExecFunctionTestShell
+{
+public:
+    virtual bool isThreadSafe() const _override
+    {
+        return true;
+    }
+};
+
+static void _passOnThreadFunction()
+{
+    CHECK(UtestShell::getCurrent()->isThreadSafe());
+}
+
+static void _failOnThreadFunction()
+{
+    FAIL("This test fails on a thread");
+}
+
+static size_t positionOfText(const SimpleString& output, const SimpleString& text)
+{
+    for (size_t i = 0; i < output.size(); i++)
+        if (output.subString(i, text.size()) == text) return i;
+    FAIL(StringFromFormat("<%s> not found in output", text.asCharString()).asCharString());
+    return 0;
+}
+
+extern "C" {
+    static PlatformSpecificThread thread_create_failed_stub(void (*)(void*), void*) { return NULL; }
+}
+
+class PreTestActionCountingPlugin : public TestPlugin
+{
+public:
+    PreTestActionCountingPlugin() : TestPlugin("PreTestActionCountingPlugin"), count_(0) {}
+
+    virtual void preTestAction(UtestShell&, TestResult&) _override
+    {
+        count_++;
+    }
+
+    int count_;
+};
+
+class TrackRecordingTestOutput : public StringBufferTestOutput
+{
+public:
+    virtual bool isTracingTestPhases() const _override
+    {
+        return true;
+    }
+
+    virtual void printTestPhaseStarted(const UtestShell& test, const char* phase, double, int track) _override
+    {
+        if (SimpleString(phase) == "TEST")
+            tracks_ += StringFromFormat("%s@%d ", test.getName().asCharString(), track);
+    }
+
+    SimpleString tracks_;
+};
+
+class StartTimeRecordingTestOutput : public StringBufferTestOutput
+{
+public:
+    StartTimeRecordingTestOutput() : firstStarted_(0), secondStarted_(0)
+    {
+    }
+
+    virtual bool isTracingTestPhases() const _override
+    {
+        return true;
+    }
+
+    virtual void printTestPhaseStarted(const UtestShell& test, const char* phase, double timeInNanos, int) _override
+    {
+        if (SimpleString(phase) != "TEST") return;
+        if (test.getName() == "first") firstStarted_ = timeInNanos;
+        if (test.getName() == "second") secondStarted_ = timeInNanos;
+    }
+
+    double firstStarted_;
+    double secondStarted_;
+};
+
+TEST_GROUP(TestThreadPool)
+{
+    TestTestingFixture fixture;
+    ThreadSafeTestShell firstTest;
+    ThreadSafeTestShell secondTest;
+
+    void setup()
+    {
+        firstTest.setTestName("first");
+        firstTest.testFunction_ = _passOnThreadFunction;
+        secondTest.setTestName("second");
+        secondTest.testFunction_ = _passOnThreadFunction;
+        fixture.addTest(&secondTest);
+        fixture.addTest(&firstTest);
+        fixture.registry_->setRunTestsInThreads(2);
+    }
+};
+
+TEST(TestThreadPool, ThreadSafeTestsAreCountedInCaller)
+{
+    fixture.runAllTests();
+    fixture.assertPrintContains("OK (3 tests, 3 ran, 2 checks, 0 ignored, 0 filtered out");
+}
+
+TEST(TestThreadPool, FailureOnThreadIsReplayed)
+{
+    secondTest.testFunction_ = _failOnThreadFunction;
+    fixture.runAllTests();
+    fixture.assertPrintContains("This test fails on a thread");
+    LONGS_EQUAL(1, fixture.getFailureCount());
+}
+
+TEST(TestThreadPool, ResultsAreReplayedInRegistryOrder)
+{
+    fixture.output_->verbose();
+    fixture.runAllTests();
+
+    SimpleString output = fixture.output_->getOutput();
+    CHECK(positionOfText(output, "TEST(Generic, first)") < positionOfText(output, "TEST(Generic, second)"));
+    CHECK(positionOfText(output, "TEST(Generic, second)") < positionOfText(output, "TEST(Generic, Generic)"));
+}
+
+TEST(TestThreadPool, PluginsOnlyRunAroundSerializedTests)
+{
+    PreTestActionCountingPlugin plugin;
+    fixture.registry_->installPlugin(&plugin);
+    fixture.runAllTests();
+    LONGS_EQUAL(1, plugin.count_);
+}
+
+TEST(TestThreadPool, FilteredOutTestsAreNotRunOnThreads)
+{
+    secondTest.testFunction_ = _failOnThreadFunction;
+    TestFilter filter("Generic");
+    filter.strictMatching();
+    fixture.registry_->setNameFilters(&filter);
+    fixture.runAllTests();
+    fixture.assertPrintContains("OK (3 tests, 1 ran, 0 checks, 0 ignored, 2 filtered out");
+}
+
+TEST(TestThreadPool, RunsOnTheCallingThreadWhenThreadsCannotBeCreated)
+{
+    UT_PTR_SET(PlatformSpecificThreadCreate, thread_create_failed_stub);
+    fixture.runAllTests();
+    fixture.assertPrintContains("OK (3 tests, 3 ran, 2 checks, 0 ignored, 0 filtered out");
+}
+
+TEST(TestThreadPool, ThreadSafeTestPhasesAreReplayedOnTheTrackOfTheirThread)
+{
+    TrackRecordingTestOutput output;
+    TestResult result(output);
+    fixture.registry_->runAllTests(result);
+    CHECK(output.tracks_.contains("Generic@0"));
+    CHECK(!output.tracks_.contains("first@0"));
+    CHECK(!output.tracks_.contains("second@0"));
+}
+
+TEST(TestThreadPool, LongestTestIsTakenFirst)
+{
+    TestThreadPool pool(1, NullTestPlugin::instance());
+    pool.traceTestPhases();
+    pool.scheduleTest(&firstTest, 1000.0);
+    pool.scheduleTest(&secondTest, 5000.0);
+    pool.runTests();
+
+    StartTimeRecordingTestOutput output;
+    TestResult result(output);
+    pool.replayNextTest(result);
+    pool.replayNextTest(result);
+    CHECK(output.secondStarted_ < output.firstStarted_);
+}
+
+static void _allocateOnThreadFunction()
+{
+    for (int i = 0; i < 200; i++) {
+        char* memory = new char[(size_t) i + 1];
+        void* block = malloc((size_t) i + 8);
+        memory[0] = 'a';
+        free(block);
+        delete [] memory;
+    }
+}
+
+TEST(TestThreadPool, ManyThreadSafeTestsCanAllocateConcurrently)
+{
+    enum { numberOfTests = 32 };
+    ThreadSafeTestShell* tests = new ThreadSafeTestShell[numberOfTests];
+    for (int i = 0; i < numberOfTests; i++) {
+        tests[i].testFunction_ = _allocateOnThreadFunction;
+        fixture.addTest(&tests[i]);
+    }
+    fixture.registry_->setRunTestsInThreads(4);
+    fixture.runAllTests();
+    fixture.assertPrintContains("OK (35 tests, 35 ran");
+    delete [] tests;
+}
+
+class NullMemoryLeakFailure: public MemoryLeakFailure
+{
+public:
+    virtual void fail(char*) _override
+    {
+    }
+};
+
+static MemoryLeakDetector* threadLeakDetector = NULL;
+static TestMemoryAllocator threadLeakAllocator;
+static char* leakedOnThread = NULL;
+
+static void _leakOnThreadFunction()
+{
+    leakedOnThread = threadLeakDetector->allocMemory(&threadLeakAllocator, 10);
+}
+
+static void _leakExpectedlyOnThreadFunction()
+{
+    EXPECT_N_LEAKS(1);
+    _leakOnThreadFunction();
+}
+
+TEST(TestThreadPool, PluginsOnlyRunAroundSerializedTestsWhenThreadsCannotBeCreated)
+{
+    UT_PTR_SET(PlatformSpecificThreadCreate, thread_create_failed_stub);
+    PreTestActionCountingPlugin plugin;
+    fixture.registry_->installPlugin(&plugin);
+    fixture.runAllTests();
+    LONGS_EQUAL(1, plugin.count_);
+}
+
+TEST_GROUP(TestThreadPoolLeaks)
+{
+    TestTestingFixture fixture;
+    ThreadSafeTestShell leakingTest;
+    NullMemoryLeakFailure reporter;
+    MemoryLeakWarningPlugin* plugin;
+
+    void setup()
+    {
+        threadLeakDetector = new MemoryLeakDetector(&reporter);
+        threadLeakDetector->enableShardLocking();
+        plugin = new MemoryLeakWarningPlugin("leaks", threadLeakDetector);
+        fixture.registry_->installPlugin(plugin);
+        fixture.addTest(&leakingTest);
+        fixture.registry_->setRunTestsInThreads(2);
+        leakedOnThread = NULL;
+    }
+
+    void teardown()
+    {
+        threadLeakDetector->deallocMemory(&threadLeakAllocator, leakedOnThread);
+        delete plugin;
+        delete threadLeakDetector;
+    }
+};
+
+TEST(TestThreadPoolLeaks, LeakOnThreadIsReported)
+{
+    leakingTest.testFunction_ = _leakOnThreadFunction;
+    fixture.runAllTests();
+
+    fixture.assertPrintContains("Memory leak(s) found");
+    fixture.assertPrintContains("Total number of leaks:  1");
+    LONGS_EQUAL(1, fixture.getFailureCount());
+}
+
+TEST(TestThreadPoolLeaks, ExpectedLeakOnThreadPasses)
+{
+    leakingTest.testFunction_ = _leakExpectedlyOnThreadFunction;
+    fixture.runAllTests();
+
+    LONGS_EQUAL(0, fixture.getFailureCount());
+}
+
+static void _guardPagesOnThreadFunction()
+{
+    DETECT_OVERFLOWS_IN_TEST();
+}
+
+TEST(TestThreadPoolLeaks, GuardPagesOnThreadFail)
+{
+    leakingTest.testFunction_ = _guardPagesOnThreadFunction;
+    fixture.runAllTests();
+
+    fixture.assertPrintContains("not available in tests that run on threads");
+    LONGS_EQUAL(1, fixture.getFailureCount());
+}
+
+TEST(TestThreadPoolLeaks, GuardPagesFailWhenThreadsCannotBeCreated)
+{
+    UT_PTR_SET(PlatformSpecificThreadCreate, thread_create_failed_stub);
+    leakingTest.testFunction_ = _guardPagesOnThreadFunction;
+    fixture.runAllTests();
+
+    fixture.assertPrintContains("not available in tests that run on threads");
+    LONGS_EQUAL(1, fixture.getFailureCount());
+}
+
+static int originalValueOnThread = 1;
+static int otherValueOnThread = 2;
+static int* pointerSetOnThread = &originalValueOnThread;
+
+static void _setPointerOnThreadFunction()
+{
+    UT_PTR_SET(pointerSetOnThread, &otherValueOnThread);
+}
+
+TEST(TestThreadPool, PointerSetOnThreadIsRestored)
+{
+    SetPointerPlugin plugin("pointers");
+    fixture.registry_->installPlugin(&plugin);
+    secondTest.testFunction_ = _setPointerOnThreadFunction;
+    fixture.runAllTests();
+
+    POINTERS_EQUAL(&originalValueOnThread, pointerSetOnThread);
+}
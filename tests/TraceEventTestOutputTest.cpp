@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2007, Michael Feathers, James Grenning and Bas Vodde
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE EARLIER MENTIONED AUTHORS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/TraceEventTestOutput.h"
+#include "CppUTest/TestRegistry.h"
+#include "CppUTest/TestResult.h"
+#include "CppUTest/TestTestingFixture.h"
+#include "CppUTest/PlatformSpecificFunctions.h"
+
+class TraceEventTestOutputWritingToString : public TraceEventTestOutput
+{
+public:
+    TraceEventTestOutputWritingToString() : opened_(false), closed_(false)
+    {
+    }
+
+    SimpleString fileName_;
+    SimpleString content_;
+    bool opened_;
+    bool closed_;
+
+protected:
+    virtual void openFileForWrite(const SimpleString& fileName) _override
+    {
+        fileName_ = fileName;
+        opened_ = true;
+    }
+
+    virtual void writeToFile(const SimpleString& buffer) _override
+    {
+        content_ += buffer;
+    }
+
+    virtual void closeFile() _override
+    {
+        closed_ = true;
+    }
+};
+
+static double fakeTimeInNanos = 0;
+
+static double FakeMonotonicTimeInNanos(void)
+{
+    return fakeTimeInNanos;
+}
+
+TEST_GROUP(TraceEventTestOutput)
+{
+    TraceEventTestOutputWritingToString output;
+    UtestShell* test;
+
+    void setup()
+    {
+        fakeTimeInNanos = 0;
+        UT_PTR_SET(GetPlatformSpecificMonotonicTimeInNanos, FakeMonotonicTimeInNanos);
+        test = new UtestShell("group", "name", "file", 1);
+    }
+
+    void teardown()
+    {
+        delete test;
+    }
+};
+
+TEST(TraceEventTestOutput, writesAJsonArrayNamingTheMainTrack)
+{
+    TestResult result(output);
+    output.printTestsStarted();
+    output.printTestsEnded(result);
+
+    STRCMP_EQUAL("cpputest_trace.json", output.fileName_.asCharString());
+    STRCMP_EQUAL("[\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"main\"}}\n]\n", output.content_.asCharString());
+    CHECK(output.opened_);
+    CHECK(output.closed_);
+}
+
+TEST(TraceEventTestOutput, shardIndexIsPartOfTheFileName)
+{
+    output.setShardIndex(3);
+    STRCMP_EQUAL("cpputest_trace_shard3.json", output.createFileName().asCharString());
+}
+
+TEST(TraceEventTestOutput, groupsAreTracedOnTheMainTrack)
+{
+    TestResult result(output);
+    output.printTestsStarted();
+    fakeTimeInNanos = 1000;
+    output.printCurrentGroupStarted(*test);
+    output.printTestPhaseStarted(*test, "setup", 1500.0, 0);
+    output.printCurrentTestEnded(result);
+    fakeTimeInNanos = 2000;
+    output.printCurrentGroupEnded(result);
+
+    STRCMP_CONTAINS(",\n{\"name\":\"group\",\"cat\":\"group\",\"ph\":\"B\",\"ts\":1.000,\"pid\":1,\"tid\":0}"
+                    ",\n{\"name\":\"setup\",\"cat\":\"test\",\"ph\":\"B\",\"ts\":1.500,\"pid\":1,\"tid\":0}"
+                    ",\n{\"name\":\"group\",\"cat\":\"group\",\"ph\":\"E\",\"ts\":2.000,\"pid\":1,\"tid\":0}",
+                    output.content_.asCharString());
+}
+
+TEST(TraceEventTestOutput, longPhaseNamesAreCut)
+{
+    output.printTestsStarted();
+    output.printTestPhaseStarted(*test, "aPluginWithAVeryLongNameThatDoesNotFitInTheLogOfPhases", 0.0, 0);
+    output.printCurrentTestEnded(TestResult(output));
+
+    STRCMP_CONTAINS("\"name\":\"aPluginWithAVeryLongNameThatDoesNotFitInTheLogO\"", output.content_.asCharString());
+}
+
+TEST(TraceEventTestOutput, eventsAreOnlyWrittenWhenTheTestEnded)
+{
+    output.printTestsStarted();
+    output.printTestPhaseStarted(*test, "setup", 1500.0, 0);
+    CHECK(!output.content_.contains("setup"));
+    output.printCurrentTestEnded(TestResult(output));
+    CHECK(output.content_.contains("setup"));
+}
+
+TEST(TraceEventTestOutput, groupsWithoutRunningTestsAreLeftOut)
+{
+    TestResult result(output);
+    output.printTestsStarted();
+    output.printCurrentGroupStarted(*test);
+    output.printCurrentGroupEnded(result);
+
+    CHECK(!output.content_.contains("\"cat\":\"group\""));
+}
+
+TEST(TraceEventTestOutput, testPhaseIsNamedAfterTheTest)
+{
+    output.printTestsStarted();
+    output.printTestPhaseStarted(*test, "TEST", 1500.0, 0);
+    output.printTestPhaseStarted(*test, "setup", 2500.0, 0);
+    output.printCurrentTestEnded(TestResult(output));
+
+    STRCMP_CONTAINS("{\"name\":\"TEST(group, name)\",\"cat\":\"test\",\"ph\":\"B\",\"ts\":1.500,\"pid\":1,\"tid\":0}", output.content_.asCharString());
+    STRCMP_CONTAINS("{\"name\":\"setup\",\"cat\":\"test\",\"ph\":\"B\",\"ts\":2.500,\"pid\":1,\"tid\":0}", output.content_.asCharString());
+}
+
+TEST(TraceEventTestOutput, workerTracksAreNamedWhenFirstUsed)
+{
+    output.printTestsStarted();
+    output.printTestPhaseEnded(*test, "testBody", 1000.0, 2);
+    output.printCurrentTestEnded(TestResult(output));
+
+    STRCMP_CONTAINS("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"worker 1\"}}", output.content_.asCharString());
+    STRCMP_CONTAINS("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"worker 2\"}}", output.content_.asCharString());
+    STRCMP_CONTAINS("{\"name\":\"testBody\",\"cat\":\"test\",\"ph\":\"E\",\"ts\":1.000,\"pid\":1,\"tid\":2}", output.content_.asCharString());
+}
+
+TEST(TraceEventTestOutput, namesAreEscaped)
+{
+    output.printTestsStarted();
+    output.printTestPhaseStarted(*test, "a \"quoted\\\" plugin", 0.0, 0);
+    output.printCurrentTestEnded(TestResult(output));
+
+    STRCMP_CONTAINS("\"name\":\"a \\\"quoted\\\\\\\" plugin\"", output.content_.asCharString());
+}
+
+class NamedTracePlugin : public TestPlugin
+{
+public:
+    NamedTracePlugin() : TestPlugin("TracePlugin") {}
+};
+
+TEST(TraceEventTestOutput, allPhasesOfATestAreTracedInOrder)
+{
+    NamedTracePlugin plugin;
+    ExecFunctionTestShell shell;
+    TestRegistry registry;
+    registry.addTest(&shell);
+    registry.installPlugin(&plugin);
+
+    TestResult result(output);
+    registry.runAllTests(result);
+
+    const char* expectedPhases[] = {
+        "\"name\":\"Generic\",\"cat\":\"group\",\"ph\":\"B\"",
+        "\"name\":\"TEST(Generic, Generic)\",\"cat\":\"test\",\"ph\":\"B\"",
+        "\"name\":\"preTestAction\",\"cat\":\"test\",\"ph\":\"B\"",
+        "\"name\":\"TracePlugin\",\"cat\":\"test\",\"ph\":\"B\"",
+        "\"name\":\"TracePlugin\",\"cat\":\"test\",\"ph\":\"E\"",
+        "\"name\":\"preTestAction\",\"cat\":\"test\",\"ph\":\"E\"",
+        "\"name\":\"setup\",\"cat\":\"test\",\"ph\":\"B\"",
+        "\"name\":\"setup\",\"cat\":\"test\",\"ph\":\"E\"",
+        "\"name\":\"testBody\",\"cat\":\"test\",\"ph\":\"B\"",
+        "\"name\":\"testBody\",\"cat\":\"test\",\"ph\":\"E\"",
+        "\"name\":\"teardown\",\"cat\":\"test\",\"ph\":\"B\"",
+        "\"name\":\"teardown\",\"cat\":\"test\",\"ph\":\"E\"",
+        "\"name\":\"postTestAction\",\"cat\":\"test\",\"ph\":\"B\"",
+        "\"name\":\"TracePlugin\",\"cat\":\"test\",\"ph\":\"B\"",
+        "\"name\":\"TracePlugin\",\"cat\":\"test\",\"ph\":\"E\"",
+        "\"name\":\"postTestAction\",\"cat\":\"test\",\"ph\":\"E\"",
+        "\"name\":\"TEST(Generic, Generic)\",\"cat\":\"test\",\"ph\":\"E\"",
+        "\"name\":\"Generic\",\"cat\":\"group\",\"ph\":\"E\""
+    };
+
+    SimpleStringCollection lines;
+    output.content_.split("\n", lines);
+    LONGS_EQUAL(sizeof(expectedPhases) / sizeof(expectedPhases[0]) + 3, lines.size());
+    for (size_t i = 0; i < sizeof(expectedPhases) / sizeof(expectedPhases[0]); i++)
+        STRCMP_CONTAINS(expectedPhases[i], lines[i + 2].asCharString());
+}
+
+static void _failFunction()
+{
+    FAIL("fails");
+}
+
+TEST(TraceEventTestOutput, phaseEndsWhenATestFails)
+{
+    TestTestingFixture fixture;
+    fixture.setTestFunction(_failFunction);
+
+    TestResult result(output);
+    fixture.registry_->runAllTests(result);
+
+    STRCMP_CONTAINS("\"name\":\"testBody\",\"cat\":\"test\",\"ph\":\"E\"", output.content_.asCharString());
+    STRCMP_CONTAINS("\"name\":\"teardown\",\"cat\":\"test\",\"ph\":\"E\"", output.content_.asCharString());
+}
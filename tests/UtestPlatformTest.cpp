@@ -55,11 +55,11 @@ static void _failFunction()
 
 extern "C" {
 
-    static int (*original_waitpid)(int, int*, int) = NULL;
+    static int (*original_waitpid)(int, int*, int, PlatformSpecificResourceUsage*) = NULL;
 
     static int fork_failed_stub(void) { return -1; }
 
-    static int waitpid_while_debugging_stub(int pid, int* status, int options)
+    static int waitpid_while_debugging_stub(int pid, int* status, int options, PlatformSpecificResourceUsage* usage)
     {
         static int number_called = 0;
         static int saved_status;
@@ -71,11 +71,24 @@ extern "C" {
         }
         else {
             *status = saved_status;
-            return original_waitpid(pid, status, options);
+            return original_waitpid(pid, status, options, usage);
         }
     }
 
-    static int waitpid_failed_stub(int, int*, int) { return -1; }
+    static int waitpid_failed_stub(int, int*, int, PlatformSpecificResourceUsage*) { return -1; }
+
+    static int waitpid_with_usage_stub(int pid, int* status, int options, PlatformSpecificResourceUsage* usage)
+    {
+        int w = original_waitpid(pid, status, options, usage);
+        usage->userTimeInNanos = 1500000.0;
+        usage->systemTimeInNanos = 250000.0;
+        usage->maximumResidentSetSizeInKilobytes = 2048;
+        usage->minorPageFaults = 10;
+        usage->majorPageFaults = 1;
+        usage->voluntaryContextSwitches = 3;
+        usage->involuntaryContextSwitches = 4;
+        return w;
+    }
 }
 
 static int _accessViolationTestFunction()
@@ -125,8 +138,8 @@ TEST(UTestPlatformsTest_PlatformSpecificRunTestInASeperateProcess, CallToForkFai
 
 TEST(UTestPlatformsTest_PlatformSpecificRunTestInASeperateProcess, CallToWaitPidWhileDebuggingInSeparateProcessWorks)
 {
-    UT_PTR_SET(original_waitpid, PlatformSpecificWaitPid);
-    UT_PTR_SET(PlatformSpecificWaitPid, waitpid_while_debugging_stub);
+    UT_PTR_SET(original_waitpid, PlatformSpecificWaitPidWithResourceUsage);
+    UT_PTR_SET(PlatformSpecificWaitPidWithResourceUsage, waitpid_while_debugging_stub);
     fixture.registry_->setRunTestsInSeperateProcess();
     fixture.runAllTests();
     fixture.assertPrintContains("OK (1 tests, 0 ran, 0 checks, 0 ignored, 0 filtered out");
@@ -134,10 +147,134 @@ TEST(UTestPlatformsTest_PlatformSpecificRunTestInASeperateProcess, CallToWaitPid
 
 TEST(UTestPlatformsTest_PlatformSpecificRunTestInASeperateProcess, CallToWaitPidFailedInSeparateProcessWorks)
 {
-    UT_PTR_SET(PlatformSpecificWaitPid, waitpid_failed_stub);
+    UT_PTR_SET(PlatformSpecificWaitPidWithResourceUsage, waitpid_failed_stub);
     fixture.registry_->setRunTestsInSeperateProcess();
     fixture.runAllTests();
     fixture.assertPrintContains("Call to waitpid() failed");
 }
 
+TEST(UTestPlatformsTest_PlatformSpecificRunTestInASeperateProcess, ResourceUsageOfSeparateProcessIsReported)
+{
+    UT_PTR_SET(original_waitpid, PlatformSpecificWaitPidWithResourceUsage);
+    UT_PTR_SET(PlatformSpecificWaitPidWithResourceUsage, waitpid_with_usage_stub);
+    fixture.output_->verbose();
+    fixture.registry_->setRunTestsInSeperateProcess();
+    fixture.runAllTests();
+    fixture.assertPrintContains(" - user_time_ms 1.500 - system_time_ms 0.250 - max_rss_kb 2048"
+                                " - minor_faults 10 - major_faults 1"
+                                " - voluntary_context_switches 3 - involuntary_context_switches 4");
+}
+
 #endif
+
+TEST_GROUP(UTestPlatformsTest_Threads)
+{
+    PlatformSpecificMutex mutex;
+    PlatformSpecificCondition condition;
+
+    void setup()
+    {
+        mutex = PlatformSpecificMutexCreate();
+        condition = PlatformSpecificConditionCreate();
+    }
+
+    void teardown()
+    {
+        PlatformSpecificConditionDestroy(condition);
+        PlatformSpecificMutexDestroy(mutex);
+    }
+};
+
+static volatile long sharedCounter = 0;
+
+static void _addToSharedCounter(void*)
+{
+    for (int i = 0; i < 10000; i++)
+        PlatformSpecificAtomicAdd(&sharedCounter, 1);
+}
+
+TEST(UTestPlatformsTest_Threads, AtomicAddOnSeveralThreadsLosesNoIncrement)
+{
+    sharedCounter = 0;
+    PlatformSpecificThread threads[4];
+    for (int i = 0; i < 4; i++)
+        threads[i] = PlatformSpecificThreadCreate(_addToSharedCounter, NULL);
+    for (int i = 0; i < 4; i++)
+        PlatformSpecificThreadJoin(threads[i]);
+    LONGS_EQUAL(40000, PlatformSpecificAtomicLoad(&sharedCounter));
+}
+
+TEST(UTestPlatformsTest_Threads, AtomicAddReturnsTheNewValue)
+{
+    volatile long value = 5;
+    LONGS_EQUAL(7, PlatformSpecificAtomicAdd(&value, 2));
+    LONGS_EQUAL(4, PlatformSpecificAtomicAdd(&value, -3));
+}
+
+TEST(UTestPlatformsTest_Threads, AtomicCompareExchangeOnlyExchangesTheExpectedValue)
+{
+    volatile long value = 1;
+    LONGS_EQUAL(1, PlatformSpecificAtomicCompareExchange(&value, 2, 3));
+    LONGS_EQUAL(1, PlatformSpecificAtomicLoad(&value));
+    LONGS_EQUAL(1, PlatformSpecificAtomicCompareExchange(&value, 1, 3));
+    LONGS_EQUAL(3, PlatformSpecificAtomicLoad(&value));
+}
+
+struct ConditionFlag
+{
+    PlatformSpecificMutex mutex_;
+    PlatformSpecificCondition condition_;
+    bool set_;
+};
+
+static void _setFlagAndSignal(void* data)
+{
+    ConditionFlag* flag = (ConditionFlag*) data;
+    PlatformSpecificMutexLock(flag->mutex_);
+    flag->set_ = true;
+    PlatformSpecificConditionSignal(flag->condition_);
+    PlatformSpecificMutexUnlock(flag->mutex_);
+}
+
+TEST(UTestPlatformsTest_Threads, ConditionWakesTheWaitingThread)
+{
+    ConditionFlag flag = { mutex, condition, false };
+    PlatformSpecificMutexLock(mutex);
+    PlatformSpecificThread thread = PlatformSpecificThreadCreate(_setFlagAndSignal, &flag);
+    while (!flag.set_)
+        PlatformSpecificConditionWait(condition, mutex);
+    PlatformSpecificMutexUnlock(mutex);
+    PlatformSpecificThreadJoin(thread);
+    CHECK(flag.set_);
+}
+
+struct ThreadLocalProbe
+{
+    PlatformSpecificThreadLocal key_;
+    void* seenBeforeSet_;
+    void* seenAfterSet_;
+};
+
+static int threadValue = 0;
+
+static void _probeThreadLocal(void* data)
+{
+    ThreadLocalProbe* probe = (ThreadLocalProbe*) data;
+    probe->seenBeforeSet_ = PlatformSpecificThreadLocalGet(probe->key_);
+    PlatformSpecificThreadLocalSet(probe->key_, &threadValue);
+    probe->seenAfterSet_ = PlatformSpecificThreadLocalGet(probe->key_);
+}
+
+TEST(UTestPlatformsTest_Threads, ThreadLocalValueIsSeparatePerThread)
+{
+    int mainValue = 0;
+    ThreadLocalProbe probe = { PlatformSpecificThreadLocalCreate(), NULL, NULL };
+    PlatformSpecificThreadLocalSet(probe.key_, &mainValue);
+
+    PlatformSpecificThreadJoin(PlatformSpecificThreadCreate(_probeThreadLocal, &probe));
+
+    POINTERS_EQUAL(NULL, probe.seenBeforeSet_);
+    POINTERS_EQUAL(&threadValue, probe.seenAfterSet_);
+    POINTERS_EQUAL(&mainValue, PlatformSpecificThreadLocalGet(probe.key_));
+    PlatformSpecificThreadLocalDestroy(probe.key_);
+}
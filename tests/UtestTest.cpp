@@ -286,3 +286,369 @@ TEST(CanHaveMemberVariablesInTestGroupThatAllocateMemoryWithoutCausingMemoryLeak
     dummy.allocateMoreMemory();
 }
 
+
+TEST_GROUP(BenchmarkResult)
+{
+};
+
+TEST(BenchmarkResult, calculatesTheStatisticsOfTheSamples)
+{
+    double nanosPerIteration[] = { 5.0, 1.0, 4.0, 2.0, 3.0 };
+    BenchmarkResult benchmark;
+    benchmark.calculate(nanosPerIteration, 5, 10);
+    LONGS_EQUAL(5, benchmark.getNumberOfSamples());
+    LONGS_EQUAL(10, benchmark.getIterationsPerSample());
+    DOUBLES_EQUAL(1.0, benchmark.getMinimum(), 0.0);
+    DOUBLES_EQUAL(3.0, benchmark.getMedian(), 0.0);
+    DOUBLES_EQUAL(5.0, benchmark.getPercentile99(), 0.0);
+    DOUBLES_EQUAL(1.5811388, benchmark.getStandardDeviation(), 0.0000001);
+}
+
+TEST(BenchmarkResult, medianOfAnEvenNumberOfSamplesIsTheMeanOfTheMiddleTwo)
+{
+    double nanosPerIteration[] = { 4.0, 1.0, 2.0, 3.0 };
+    BenchmarkResult benchmark;
+    benchmark.calculate(nanosPerIteration, 4, 1);
+    DOUBLES_EQUAL(2.5, benchmark.getMedian(), 0.0);
+}
+
+TEST(BenchmarkResult, percentile99IgnoresTheSlowestOfHundredSamples)
+{
+    double nanosPerIteration[100];
+    for (int i = 0; i < 100; i++)
+        nanosPerIteration[i] = (double) (100 - i);
+    BenchmarkResult benchmark;
+    benchmark.calculate(nanosPerIteration, 100, 1);
+    DOUBLES_EQUAL(99.0, benchmark.getPercentile99(), 0.0);
+}
+
+TEST(BenchmarkResult, noSamplesHasNoStatistics)
+{
+    BenchmarkResult benchmark;
+    benchmark.calculate(NULL, 0, 0);
+    DOUBLES_EQUAL(0.0, benchmark.getMedian(), 0.0);
+    DOUBLES_EQUAL(0.0, benchmark.getStandardDeviation(), 0.0);
+}
+
+static double fakeNanos;
+
+static double FakeMonotonicTimeInNanos()
+{
+    return fakeNanos;
+}
+
+class BenchmarkOfShell : public Utest
+{
+public:
+    BenchmarkOfShell(BenchmarkUtestShell* shell) : shell_(shell) {}
+
+    void testBody() _override
+    {
+        shell_->runBenchmark(this);
+    }
+private:
+    BenchmarkUtestShell* shell_;
+};
+
+class FakeClockBenchmarkShell : public BenchmarkUtestShell
+{
+public:
+    FakeClockBenchmarkShell(double nanosPerIteration)
+        : BenchmarkUtestShell("BenchmarkGroup", "benchmarkName", "file", 1), iterations_(0), nanosPerIteration_(nanosPerIteration)
+    {
+    }
+
+    long iterations_;
+
+protected:
+    virtual void runIteration(Utest*) _override
+    {
+        fakeNanos += nanosPerIteration_;
+        iterations_++;
+    }
+
+    virtual Utest* createTest() _override
+    {
+        return new BenchmarkOfShell(this);
+    }
+
+private:
+    double nanosPerIteration_;
+};
+
+class BenchmarkResultRecorder : public TestResult
+{
+public:
+    BenchmarkResultRecorder(TestOutput& output) : TestResult(output), benchmarked_(false) {}
+
+    virtual void addBenchmarkResult(const UtestShell& test, const BenchmarkResult& benchmark) _override
+    {
+        TestResult::addBenchmarkResult(test, benchmark);
+        benchmarked_ = true;
+        benchmark_ = benchmark;
+    }
+
+    bool benchmarked_;
+    BenchmarkResult benchmark_;
+};
+
+TEST_GROUP(BenchmarkUtestShell)
+{
+    StringBufferTestOutput output;
+    BenchmarkResultRecorder* result;
+
+    void setup()
+    {
+        fakeNanos = 0.0;
+        UT_PTR_SET(GetPlatformSpecificMonotonicTimeInNanos, FakeMonotonicTimeInNanos);
+        result = new BenchmarkResultRecorder(output);
+    }
+
+    void teardown()
+    {
+        delete result;
+    }
+
+    void runBenchmark(FakeClockBenchmarkShell& shell)
+    {
+        shell.runOneTestInCurrentProcess(NullTestPlugin::instance(), *result);
+    }
+};
+
+TEST(BenchmarkUtestShell, isABenchmark)
+{
+    FakeClockBenchmarkShell shell(1.0);
+    CHECK(shell.isBenchmark());
+    STRCMP_EQUAL("BENCHMARK(BenchmarkGroup, benchmarkName)", shell.getFormattedName().asCharString());
+}
+
+TEST(BenchmarkUtestShell, scalesTheIterationsUntilASampleTakesAMillisecond)
+{
+    FakeClockBenchmarkShell shell(1000.0);
+    runBenchmark(shell);
+    CHECK(result->benchmarked_);
+    LONGS_EQUAL(1000, result->benchmark_.getIterationsPerSample());
+    LONGS_EQUAL(BenchmarkUtestShell::maximumNumberOfSamples, result->benchmark_.getNumberOfSamples());
+    DOUBLES_EQUAL(1000.0, result->benchmark_.getMinimum(), 0.0);
+    DOUBLES_EQUAL(1000.0, result->benchmark_.getPercentile99(), 0.0);
+    DOUBLES_EQUAL(0.0, result->benchmark_.getStandardDeviation(), 0.0);
+}
+
+TEST(BenchmarkUtestShell, warmsUpBeforeSampling)
+{
+    FakeClockBenchmarkShell shell(1000.0);
+    runBenchmark(shell);
+    long calibrationIterations = 1 + 10 + 100 + 1000;
+    long sampledIterations = 1000L * (BenchmarkUtestShell::numberOfWarmupSamples + BenchmarkUtestShell::maximumNumberOfSamples);
+    LONGS_EQUAL(calibrationIterations + sampledIterations, shell.iterations_);
+}
+
+TEST(BenchmarkUtestShell, slowBenchmarksTakeFewerSamples)
+{
+    FakeClockBenchmarkShell shell(500000000.0);
+    runBenchmark(shell);
+    LONGS_EQUAL(1, result->benchmark_.getIterationsPerSample());
+    LONGS_EQUAL(BenchmarkUtestShell::minimumNumberOfSamples, result->benchmark_.getNumberOfSamples());
+}
+
+BENCHMARK_GROUP(BenchmarkMacro)
+{
+    int iterations;
+
+    void setup()
+    {
+        iterations = 0;
+    }
+
+    void teardown()
+    {
+        CHECK(iterations > 0);
+    }
+};
+
+BENCHMARK(BenchmarkMacro, runsTheBodyRepeatedlyBetweenSetupAndTeardown)
+{
+    iterations++;
+}
+
+THREAD_SAFE_TEST_GROUP(ThreadSafeMacro)
+{
+};
+
+TEST(ThreadSafeMacro, marksTheTestsOfTheGroupThreadSafe)
+{
+    CHECK(UtestShell::getCurrent()->isThreadSafe());
+}
+
+TEST(UtestShell, testsAreNotThreadSafeByDefault)
+{
+    CHECK(!UtestShell::getCurrent()->isThreadSafe());
+}
+
+class ConcurrentBodyOfShell : public Utest
+{
+public:
+    ConcurrentBodyOfShell(ConcurrentUtestShell* shell) : shell_(shell) {}
+
+    virtual void testBody() _override
+    {
+        shell_->runConcurrently(this);
+    }
+private:
+    ConcurrentUtestShell* shell_;
+};
+
+class ConcurrentFunctionShell : public ConcurrentUtestShell
+{
+public:
+    ConcurrentFunctionShell(int numberOfThreads, void (*body)())
+        : ConcurrentUtestShell(numberOfThreads), body_(body)
+    {
+        setGroupName("ConcurrentGroup");
+        setTestName("concurrentName");
+    }
+
+protected:
+    virtual void runConcurrentBody(Utest*) _override
+    {
+        body_();
+    }
+
+    virtual Utest* createTest() _override
+    {
+        return new ConcurrentBodyOfShell(this);
+    }
+
+private:
+    void (*body_)();
+};
+
+static volatile long bodiesRunning = 0;
+
+static void _concurrentCheckMethod()
+{
+    CHECK(true);
+}
+
+static void _concurrentFailMethod()
+{
+    FAIL("This body fails");
+}
+
+static void _waitForAllBodiesMethod()
+{
+    PlatformSpecificAtomicAdd(&bodiesRunning, 1);
+    double deadline = GetPlatformSpecificMonotonicTimeInNanos() + 5000000000.0;
+    while (PlatformSpecificAtomicLoad(&bodiesRunning) < 4 && GetPlatformSpecificMonotonicTimeInNanos() < deadline)
+        ;
+    LONGS_EQUAL(4, PlatformSpecificAtomicLoad(&bodiesRunning));
+}
+
+extern "C" {
+    static PlatformSpecificThread thread_create_failed_stub(void (*)(void*), void*) { return NULL; }
+}
+
+TEST_GROUP(ConcurrentUtestShell)
+{
+    TestTestingFixture fixture;
+};
+
+TEST(ConcurrentUtestShell, isNamedAfterItsMacro)
+{
+    ConcurrentFunctionShell shell(2, _concurrentCheckMethod);
+    LONGS_EQUAL(2, shell.getNumberOfThreads());
+    STRCMP_EQUAL("TEST_CONCURRENT(ConcurrentGroup, concurrentName)", shell.getFormattedName().asCharString());
+}
+
+TEST(ConcurrentUtestShell, checksOfAllThreadsAreCounted)
+{
+    ConcurrentFunctionShell shell(4, _concurrentCheckMethod);
+    fixture.addTest(&shell);
+    fixture.runAllTests();
+    fixture.assertPrintContains("OK (2 tests, 2 ran, 4 checks");
+}
+
+TEST(ConcurrentUtestShell, failuresOfEveryThreadAreGathered)
+{
+    ConcurrentFunctionShell shell(3, _concurrentFailMethod);
+    fixture.addTest(&shell);
+    fixture.runAllTests();
+    LONGS_EQUAL(3, fixture.getFailureCount());
+    fixture.assertPrintContains("Failed in thread 1: This body fails");
+    fixture.assertPrintContains("Failed in thread 3: This body fails");
+}
+
+TEST(ConcurrentUtestShell, testFailsOnceTheFailuresOfTheThreadsAreGathered)
+{
+    ConcurrentFunctionShell shell(2, _concurrentFailMethod);
+    fixture.addTest(&shell);
+    fixture.runAllTests();
+    CHECK(shell.hasFailed());
+}
+
+static void _concurrentAllocateMethod()
+{
+    for (int i = 0; i < 200; i++) {
+        char* memory = new char[(size_t) i + 1];
+        void* block = malloc((size_t) i + 8);
+        memory[0] = 'a';
+        free(block);
+        delete [] memory;
+    }
+}
+
+TEST(ConcurrentUtestShell, bodiesAllocateConcurrentlyWithoutLeaks)
+{
+    ConcurrentFunctionShell shell(8, _concurrentAllocateMethod);
+    fixture.addTest(&shell);
+    fixture.runAllTests();
+    LONGS_EQUAL(0, fixture.getFailureCount());
+}
+
+TEST(ConcurrentUtestShell, bodiesRunAtTheSameTime)
+{
+    bodiesRunning = 0;
+    ConcurrentFunctionShell shell(4, _waitForAllBodiesMethod);
+    fixture.addTest(&shell);
+    fixture.runAllTests();
+    LONGS_EQUAL(0, fixture.getFailureCount());
+}
+
+TEST(ConcurrentUtestShell, executionTimeOfEachThreadIsReported)
+{
+    ConcurrentFunctionShell shell(2, _concurrentCheckMethod);
+    fixture.addTest(&shell);
+    fixture.output_->verbose();
+    fixture.runAllTests();
+    fixture.assertPrintContains("thread_1_ms");
+    fixture.assertPrintContains("thread_2_ms");
+}
+
+TEST(ConcurrentUtestShell, bodiesRunOnTheCallingThreadWhenThreadsCannotBeCreated)
+{
+    UT_PTR_SET(PlatformSpecificThreadCreate, thread_create_failed_stub);
+    ConcurrentFunctionShell shell(3, _concurrentFailMethod);
+    fixture.addTest(&shell);
+    fixture.runAllTests();
+    LONGS_EQUAL(3, fixture.getFailureCount());
+}
+
+TEST_GROUP(ConcurrentMacro)
+{
+    volatile long bodies;
+
+    void setup()
+    {
+        bodies = 0;
+    }
+
+    void teardown()
+    {
+        LONGS_EQUAL(4, bodies);
+    }
+};
+
+TEST_CONCURRENT(ConcurrentMacro, runsTheBodyOnEachThreadBetweenSetupAndTeardown, 4)
+{
+    PlatformSpecificAtomicAdd(&bodies, 1);
+}